@@ -0,0 +1,72 @@
+//-------------------------------------------------------------------------
+//----------------------------Dynamic AABB Tree----------------------------
+//-------------------------------------------------------------------------
+
+#include "Harness.h"
+#include "scene/AABBTree.h"
+#include "asset/Model.h"
+#include <cmath>
+#include <cstdio>
+
+//Frustum culling through the tree against testing every box, with the same density of
+//unit boxes at every scene size. The camera sits in the middle of the scene
+BENCHMARK(AABBTreeVsBruteForceFrustum)
+{
+	const UINT counts[3] = { 1000, 10000, 100000 };
+	for (UINT count : counts)
+	{
+		float side = 8.0f * cbrt((float)count);
+		unsigned int seed = 12345;
+		auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+		vector<AABB> boxes(count);
+		AABBTree tree;
+		for (UINT i = 0; i < count; i++)
+		{
+			aiVector3D center((random() - 0.5f) * side, (random() - 0.5f) * side, (random() - 0.5f) * side);
+			boxes[i] = AABB(center - aiVector3D(0.5f, 0.5f, 0.5f), center + aiVector3D(0.5f, 0.5f, 0.5f));
+			tree.Insert(boxes[i], (void*)(size_t)(i + 1));
+		}
+
+		Camera camera;
+		camera.zFar = side;
+		camera.UpdateProjectionMatrix();
+		camera.SetPosition(0, 0, 0);
+		camera.LookAt(aiVector3D(0, 0, 1));
+		Frustum frustum(camera.GetViewProjectionMatrix());
+
+		const UINT queries = count >= 100000 ? 20 : 200;
+		vector<UINT> bruteResult;
+		Timer timer;
+		for (UINT q = 0; q < queries; q++)
+		{
+			bruteResult.clear();
+			for (UINT i = 0; i < count; i++)
+			{
+				if (frustum.Overlaps(boxes[i]))
+					bruteResult.push_back(i);
+			}
+		}
+		double bruteTime = timer.Milliseconds() / queries;
+
+		vector<void*> treeResult;
+		size_t visits = 0;
+		timer.Restart();
+		for (UINT q = 0; q < queries; q++)
+		{
+			treeResult.clear();
+			tree.QueryFrustum(frustum, treeResult);
+			visits += tree.lastQueryVisits;
+		}
+		double treeTime = timer.Milliseconds() / queries;
+
+		//Leaves are fat, the tree may add boxes just outside
+		size_t exact = 0;
+		for (void* p : treeResult)
+		{
+			if (frustum.Overlaps(boxes[(size_t)p - 1])) exact++;
+		}
+		CHECK(exact == bruteResult.size());
+		printf("  %6u boxes, %zu visible: brute force %.3f ms, tree %.3f ms (%zu nodes visited, height %d)\n",
+			count, bruteResult.size(), bruteTime, treeTime, visits / queries, tree.GetHeight());
+	}
+}
@@ -0,0 +1,193 @@
+//-------------------------------------------------------------------------
+//-------------------------Heap allocations per frame----------------------
+//The test program's operator new counts every allocation, on every thread.
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <cstdio>
+
+static atomic<size_t> allocationCount(0);
+
+//Every form of the global operators is replaced, so no block from the runtime's own allocator, or a
+//sanitizer's, reaches the free below
+static void* CountedAllocate(size_t size)
+{
+	allocationCount++;
+	return malloc(size ? size : 1);
+}
+
+//Over-aligned blocks keep the malloc'ed pointer just before the aligned one
+static void* CountedAllocate(size_t size, align_val_t alignment)
+{
+	size_t align = (size_t)alignment;
+	void* raw = CountedAllocate(size + align + sizeof(void*));
+	if (!raw) return NULL;
+	uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + align - 1) & ~(uintptr_t)(align - 1);
+	((void**)aligned)[-1] = raw;
+	return (void*)aligned;
+}
+
+//GCC sees the free inlined into a delete of a new'ed block, the block came from CountedAllocate's malloc
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static void CountedFree(void* p)
+{
+	free(p);
+}
+
+static void CountedFree(void* p, align_val_t)
+{
+	if (p) free(((void**)p)[-1]);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void* operator new(size_t size)
+{
+	void* p = CountedAllocate(size);
+	if (!p) throw bad_alloc();
+	return p;
+}
+void* operator new[](size_t size)
+{
+	void* p = CountedAllocate(size);
+	if (!p) throw bad_alloc();
+	return p;
+}
+void* operator new(size_t size, const nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new(size_t size, align_val_t alignment)
+{
+	void* p = CountedAllocate(size, alignment);
+	if (!p) throw bad_alloc();
+	return p;
+}
+void* operator new[](size_t size, align_val_t alignment)
+{
+	void* p = CountedAllocate(size, alignment);
+	if (!p) throw bad_alloc();
+	return p;
+}
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept { return CountedAllocate(size, alignment); }
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept { return CountedAllocate(size, alignment); }
+
+void operator delete(void* p) noexcept { CountedFree(p); }
+void operator delete[](void* p) noexcept { CountedFree(p); }
+void operator delete(void* p, size_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, size_t) noexcept { CountedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { CountedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { CountedFree(p); }
+void operator delete(void* p, align_val_t alignment) noexcept { CountedFree(p, alignment); }
+void operator delete[](void* p, align_val_t alignment) noexcept { CountedFree(p, alignment); }
+void operator delete(void* p, size_t, align_val_t alignment) noexcept { CountedFree(p, alignment); }
+void operator delete[](void* p, size_t, align_val_t alignment) noexcept { CountedFree(p, alignment); }
+void operator delete(void* p, align_val_t alignment, const nothrow_t&) noexcept { CountedFree(p, alignment); }
+void operator delete[](void* p, align_val_t alignment, const nothrow_t&) noexcept { CountedFree(p, alignment); }
+
+//What the single ID overload did before: a temporary ID list, and the list overload's view array
+static void ListBinding(PipelineStage stage, BindFlag bindFlag, UINT slot, int id)
+{
+	vector<int> idList(1, id);
+	vector<void*> newView(idList.size());
+	PipeLine::Resources().SetBinding(stage, bindFlag, slot, idList);
+}
+
+TEST(SetBindingAllocatesNothing)
+{
+	if (!CHECK(PipeLine::InitHeadless(64, 64))) return;
+	ResourceDesc desc;
+	desc.name = "buffer";
+	desc.type = Resource_Buffer;
+	desc.bindFlag = Bind_Constant_Buffer;
+	desc.access = Access_Dynamic;
+	desc.size[0] = 256;
+	int buffers[4];
+	for (int &id : buffers) id = PipeLine::Resources().Create(desc);
+	PipelineStage stage = (PipelineStage)(Stage_Vertex_Shader | Stage_Pixel_Shader);
+
+	const UINT binds = 1000;
+	size_t before = allocationCount;
+	for (UINT i = 0; i < binds; i++)
+	{
+		PipeLine::Resources().SetBinding(stage, Bind_Constant_Buffer, i % 4, buffers[i % 4]);
+		PipeLine::Resources().SetBinding(stage, Bind_Constant_Buffer, 0, buffers, 4);
+		PipeLine::Resources().CommitBindings();
+	}
+	size_t spans = allocationCount - before;
+	before = allocationCount;
+	for (UINT i = 0; i < binds; i++)
+	{
+		ListBinding(stage, Bind_Constant_Buffer, i % 4, buffers[i % 4]);
+	}
+	size_t lists = allocationCount - before;
+	CHECK(spans == 0);
+	CHECK(lists == 2 * binds);
+	PipeLine::Shutdown();
+}
+
+//Replays into the pipeline like GEngine does, counting the ResourceManager::SetBinding calls it makes
+class BindCountingTarget : public PipelineTarget
+{
+public:
+	UINT binds = 0;
+	UINT lastPassPorts = 0;
+	void BindPass(const Pass* pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const int* resourceIDs, unsigned int numResources, const int* samplerIDs, unsigned int numSamplers) override
+	{
+		//The previous pass unbinds its ports, then each port is bound
+		binds += lastPassPorts + numResources;
+		lastPassPorts = numResourcePorts;
+		PipelineTarget::BindPass(pass, numResourcePorts, numSamplerPorts, resourceIDs, numResources, samplerIDs, numSamplers);
+	}
+	void BindMesh(const int* vertexBufferIDs, int indexBufferID) override
+	{
+		binds += numMeshStreams + 1;
+		PipelineTarget::BindMesh(vertexBufferIDs, indexBufferID);
+	}
+	void SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID) override
+	{
+		binds++;
+		PipelineTarget::SetBinding(stages, bindFlag, slot, resourceID);
+	}
+};
+
+//Allocations of a whole headless frame once buffers have grown, and what binding the old
+//way would add on top: two allocations for every binding call the frame makes
+BENCHMARK(FrameAllocations)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	engine.frustumCulling = true;
+	Model box;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, engine.LoadAsset(box, "box"), 100, 100, 2.0f, handles);
+	engine.camera.SetPosition(0, 20, -110);
+	engine.camera.LookAt(aiVector3D(0, 0, 0));
+	for (UINT i = 0; i < 10; i++)
+	{
+		engine.Render("direct_light");
+		PipeLine::Swap();
+	}
+
+	const UINT frames = 100;
+	BindCountingTarget target;
+	engine.commandTarget = &target;
+	size_t before = allocationCount;
+	for (UINT i = 0; i < frames; i++)
+	{
+		engine.Render("direct_light");
+		PipeLine::Swap();
+	}
+	size_t perFrame = (allocationCount - before) / frames;
+	engine.commandTarget = NULL;
+	printf("  %zu instances: %zu allocations per frame, %u SetBinding calls. Binding through ID lists would add %u\n",
+		handles.size(), perFrame, target.binds / frames, 2 * target.binds / frames);
+	engine.Shutdown();
+}
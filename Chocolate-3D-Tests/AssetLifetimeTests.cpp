@@ -0,0 +1,57 @@
+//-------------------------------------------------------------------------
+//------------------Asset load / unload on the NullDevice------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include <cstdio>
+
+//Loads, draws and unloads a pack every frame. Retired resources must not pile up:
+//at most FRAMES_IN_FLIGHT frames of packs wait, and all of them go within FRAMES_IN_FLIGHT swaps
+TEST(AssetLoadUnloadStress)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	ResourceManager &resources = PipeLine::Resources();
+
+	//One round first so per frame buffers have grown to what a pack needs
+	auto round = [&](UINT i)
+	{
+		Model box;
+		BuildBox(box, 0.5f, 0.5f, 0.5f);
+		char name[32];
+		sprintf_s(name, "stress_box_%u", i);
+		AssetPack* pack = engine.LoadAsset(box, name);
+		if (!pack) return false;
+		vector<InstanceHandle> handles;
+		PlaceGrid(engine, pack, 4, 4, 2.0f, handles);
+		engine.Render("direct_light");
+		for (InstanceHandle h : handles) engine.DestroyInstance(h);
+		bool unloaded = engine.UnloadModel(pack);
+		PipeLine::Swap();
+		return unloaded;
+	};
+	if (!CHECK(round(0))) return;
+	size_t packBytes = resources.GetRetiredBytes();
+	CHECK(packBytes > 0);
+	for (UINT i = 0; i < FRAMES_IN_FLIGHT; i++) PipeLine::Swap();
+	CHECK(resources.GetRetiredBytes() == 0);
+	size_t baseline = resources.GetMemoryUsage();
+	size_t packCount = engine.assets.GetCount();
+
+	const UINT rounds = 500;
+	size_t maxRetired = 0, maxMemory = 0;
+	for (UINT i = 1; i <= rounds; i++)
+	{
+		if (!CHECK(round(i))) return;
+		maxRetired = max(maxRetired, resources.GetRetiredBytes());
+		maxMemory = max(maxMemory, resources.GetMemoryUsage());
+	}
+	CHECK(maxRetired <= FRAMES_IN_FLIGHT * packBytes);
+	CHECK(maxMemory <= baseline + FRAMES_IN_FLIGHT * packBytes);
+	CHECK(engine.assets.GetCount() == packCount);
+
+	for (UINT i = 0; i < FRAMES_IN_FLIGHT; i++) PipeLine::Swap();
+	CHECK(resources.GetRetiredCount() == 0 && resources.GetRetiredBytes() == 0);
+	CHECK(resources.GetMemoryUsage() == baseline);
+	engine.Shutdown();
+}
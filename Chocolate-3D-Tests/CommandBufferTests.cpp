@@ -0,0 +1,101 @@
+//-------------------------------------------------------------------------
+//-------------------Command buffer and ValidationTarget-------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+
+static int CreateBuffer(UINT bindFlag, AccessType access, UINT size)
+{
+	ResourceDesc desc;
+	desc.name = "buffer";
+	desc.type = Resource_Buffer;
+	desc.bindFlag = bindFlag;
+	desc.access = access;
+	desc.size[0] = size;
+	return PipeLine::Resources().Create(desc);
+}
+
+//Runs one command on a fresh target, true when it was flagged
+template <typename Command>
+static bool Flagged(Command command)
+{
+	ValidationTarget target;
+	command(target);
+	return target.errorCount != 0;
+}
+
+TEST(ValidationTargetChecksResources)
+{
+	if (!CHECK(PipeLine::InitHeadless(64, 64))) return;
+	int vb = CreateBuffer(Bind_Vertex_Buffer, Access_Default, 64);
+	int cb = CreateBuffer(Bind_Constant_Buffer, Access_Dynamic, 512);
+	ResourceDesc texDesc;
+	texDesc.name = "texture";
+	texDesc.type = Resource_Texture2D;
+	texDesc.bindFlag = Bind_Shader_Resource;
+	texDesc.format = Format_R8G8B8A8_UNORM;
+	texDesc.size[0] = 4;
+	texDesc.size[1] = 4;
+	texDesc.mipLevel = 1;
+	int tex = PipeLine::Resources().Create(texDesc);
+	CHECK(vb >= 0 && cb >= 0 && tex >= 0);
+	BYTE data[64] = {};
+
+	//Writes stay inside writable buffers
+	CHECK(!Flagged([&](ValidationTarget &t) { t.UpdateBuffer(vb, data, 32, 32, false); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.UpdateBuffer(vb, data, 33, 32, false); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.UpdateBuffer(tex, data, 16, 0, false); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.UpdateBuffer(vb + 12345, data, 16, 0, false); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.UpdateBuffer(vb, NULL, 16, 0, false); }));
+	CHECK(!Flagged([&](ValidationTarget &t) { t.UpdateBuffer(cb, data, 64, 0, true); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.UpdateBuffer(cb, data, 64, 256, true); }));
+
+	//Bindings need the matching bind flag, -1 unbinds
+	CHECK(!Flagged([&](ValidationTarget &t) { t.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, 0, tex); }));
+	CHECK(!Flagged([&](ValidationTarget &t) { t.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, 0, -1); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, 0, vb); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource | Bind_Vertex_Buffer, 0, vb); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.SetBinding(0, Bind_Shader_Resource, 0, tex); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, MAX_SLOT_NUMBER, tex); }));
+
+	//Constant ranges are 256 byte aligned and inside the buffer
+	CHECK(!Flagged([&](ValidationTarget &t) { t.BindConstantRange(Stage_Vertex_Shader, 1, cb, 256, 256); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.BindConstantRange(Stage_Vertex_Shader, 1, cb, 512, 256); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.BindConstantRange(Stage_Vertex_Shader, 1, cb, 128, 256); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.BindConstantRange(Stage_Vertex_Shader, 1, vb, 0, 256); }));
+
+	//Meshes bind vertex and index buffers
+	int streams[numMeshStreams];
+	for (int &s : streams) s = -1;
+	streams[0] = vb;
+	CHECK(Flagged([&](ValidationTarget &t) { t.BindMesh(streams, vb); }));
+	streams[1] = tex;
+	CHECK(Flagged([&](ValidationTarget &t) { t.BindMesh(streams, -1); }));
+
+	//Reset and mips need views that support them
+	UINT zero[4] = {};
+	CHECK(Flagged([&](ValidationTarget &t) { t.Reset(tex, zero); }));
+	CHECK(Flagged([&](ValidationTarget &t) { t.GenerateMipMap(tex); }));
+	PipeLine::Shutdown();
+}
+
+//A frame of the test effect has nothing to flag
+TEST(ValidationTargetHeadlessFrame)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	Model box;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, engine.LoadAsset(box, "box"), 10, 10, 2.0f, handles);
+	engine.camera.SetPosition(0, 5, -20);
+
+	ValidationTarget validation;
+	engine.commandTarget = &validation;
+	engine.Render("direct_light");
+	CHECK(validation.commandCount[Command_Draw] > 0);
+	CHECK(validation.drawnInstances >= handles.size());
+	if (!CHECK(validation.errorCount == 0))
+		printf("  %u errors, first: %s\n", (UINT)validation.errorCount, validation.firstError.c_str());
+	engine.Shutdown();
+}
@@ -0,0 +1,153 @@
+//-------------------------------------------------------------------------
+//----------------------GEngine frames on the NullDevice-------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include <cstdio>
+#include <climits>
+
+//Renders "direct_light" over a 100x100 grid of boxes and reports the CPU cost of a frame
+BENCHMARK(HeadlessFrame)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	engine.frustumCulling = true;
+
+	Model box;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	AssetPack* pack = engine.LoadAsset(box, "box");
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, pack, 100, 100, 2.0f, handles);
+	CHECK(handles.size() == 10000);
+	engine.camera.SetPosition(0, 20, -110);
+	engine.camera.LookAt(aiVector3D(0, 0, 0));
+
+	NullDevice* device = (NullDevice*)PipeLine::GetDevice();
+	const UINT warmup = 10, frames = 200;
+	for (UINT i = 0; i < warmup; i++)
+	{
+		engine.Render("direct_light");
+		PipeLine::Swap();
+	}
+	device->ResetCounters();
+	double bucketTime = 0;
+	Timer timer;
+	for (UINT i = 0; i < frames; i++)
+	{
+		engine.Render("direct_light");
+		PipeLine::Swap();
+		bucketTime += engine.bucketUpdateTime;
+	}
+	double frameTime = timer.Milliseconds() / frames;
+	CHECK(engine.stats.drawCalls > 0);
+	CHECK(device->drawnInstances > 0);
+
+	printf("  %zu instances: %.3f ms/frame, %.3f ms buckets, %u draw calls, %u state calls (%u skipped)\n",
+		handles.size(), frameTime, bucketTime / frames, engine.stats.drawCalls, engine.stats.stateCalls, engine.stats.stateCallsSkipped);
+	printf("  per frame on the device: %llu draws, %llu instances drawn, %llu uploads\n",
+		(unsigned long long)(device->callCount[NullCall_Draw] / frames), (unsigned long long)(device->drawnInstances / frames),
+		(unsigned long long)(device->callCount[NullCall_Upload] / frames));
+	engine.Shutdown();
+}
+
+//One frame of a 10x10 grid on a fresh headless engine, shut down afterwards. Draw calls of the frame
+static UINT RenderOnFreshEngine()
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return 0;
+	Model box;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, engine.LoadAsset(box, "box"), 10, 10, 2.0f, handles);
+	engine.camera.SetPosition(0, 5, -20);
+	engine.Render("direct_light");
+	PipeLine::Swap();
+	NullDevice* device = (NullDevice*)PipeLine::GetDevice();
+	CHECK(device->drawnInstances >= handles.size());
+	UINT drawCalls = engine.stats.drawCalls;
+	engine.Shutdown();
+	return drawCalls;
+}
+
+//Tests start engines one after another in the same process. Whatever the pipeline keeps in statics,
+//like the pass bound last, must not reach from one engine's Shutdown into the next engine's frames
+TEST(HeadlessEnginesBackToBack)
+{
+	UINT first = RenderOnFreshEngine();
+	UINT second = RenderOnFreshEngine();
+	CHECK(first > 0);
+	CHECK(second == first);
+}
+
+//FNV-1a over what a frame draws: instance data and draw sizes. Draw constants hold the ring offset,
+//which moves between frames, they are left out
+class FrameHashTarget : public CommandTarget
+{
+public:
+	unsigned long long hash = 14695981039346656037ull;
+	void Add(const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+	}
+	void BindPass(const Pass*, unsigned int, unsigned int, const int*, unsigned int, const int*, unsigned int) override {}
+	void BindMesh(const int*, int indexBufferID) override { Add(&indexBufferID, sizeof(int)); }
+	void SetBinding(unsigned int, unsigned int, unsigned int, int) override {}
+	void UpdateBuffer(int, const void* data, unsigned int size, unsigned int, bool) override
+	{
+		if (size % sizeof(InstanceData) == 0)
+			Add(data, size);
+	}
+	void Draw(unsigned int indexCount, unsigned int instanceCount) override
+	{
+		Add(&indexCount, sizeof(indexCount));
+		Add(&instanceCount, sizeof(instanceCount));
+	}
+	void Compute(unsigned int, unsigned int, unsigned int) override {}
+	void Reset(int, const unsigned int[4]) override {}
+	void GenerateMipMap(int) override {}
+	void BindConstantRange(unsigned int, unsigned int, int, unsigned int, unsigned int) override {}
+};
+
+//UpdateBuckets over 50k components, in one task against split over the thread pool, which runs as
+//wide as the hardware.
+//The merge is in task order, both have to draw the same frame
+BENCHMARK(ParallelBuckets)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	Model box;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, engine.LoadAsset(box, "box"), 224, 224, 2.0f, handles);
+	engine.camera.SetPosition(0, 40, -260);
+	engine.camera.LookAt(aiVector3D(0, 0, 0));
+
+	const UINT pooledTaskSize = engine.bucketTaskSize;
+	const UINT taskSizes[2] = { UINT_MAX, pooledTaskSize };
+	const char* names[2] = { "serial", "pool" };
+	unsigned long long hashes[2];
+	const UINT frames = 50;
+	for (int mode = 0; mode < 2; mode++)
+	{
+		engine.bucketTaskSize = taskSizes[mode];
+		FrameHashTarget target;
+		engine.commandTarget = &target;
+		engine.Render("direct_light");
+		hashes[mode] = target.hash;
+		engine.commandTarget = NULL;
+		double bucketTime = 0;
+		for (UINT i = 0; i < frames; i++)
+		{
+			engine.Render("direct_light");
+			PipeLine::Swap();
+			bucketTime += engine.bucketUpdateTime;
+		}
+		printf("  %zu components, %s: %.3f ms UpdateBuckets on %u threads\n", handles.size(), names[mode], bucketTime / frames, mode ? max(1u, thread::hardware_concurrency()) : 1u);
+	}
+	CHECK(hashes[0] == hashes[1]);
+	engine.Shutdown();
+}
@@ -0,0 +1,102 @@
+#include "Fixtures.h"
+#include <stdexcept>
+
+void BuildBox(Model & model, float halfX, float halfY, float halfZ)
+{
+	model.meshList.assign(1, Mesh());
+	model.materialList.assign(1, Material());
+	model.nodeList.assign(1, Node());
+	model.nodeList[0].id = 0;
+	model.nodeList[0].name = "box";
+	model.hasAnimation = false;
+
+	Mesh &mesh = model.meshList[0];
+	mesh.name = "box";
+	mesh.materialID = 0;
+	mesh.nodeID = 0;
+	//Four vertices per face so every face keeps its own normal
+	const aiVector3D normals[6] = { aiVector3D(1, 0, 0), aiVector3D(-1, 0, 0), aiVector3D(0, 1, 0), aiVector3D(0, -1, 0), aiVector3D(0, 0, 1), aiVector3D(0, 0, -1) };
+	const aiVector3D half(halfX, halfY, halfZ);
+	for (UINT face = 0; face < 6; face++)
+	{
+		aiVector3D n = normals[face];
+		aiVector3D u(n.y != 0 || n.z != 0 ? 1.0f : 0.0f, n.x != 0 ? 1.0f : 0.0f, 0);
+		aiVector3D v = n ^ u;
+		UINT base = (UINT)mesh.vertexPositions.size();
+		for (UINT corner = 0; corner < 4; corner++)
+		{
+			float su = (corner == 1 || corner == 2) ? 1.0f : -1.0f;
+			float sv = (corner >= 2) ? 1.0f : -1.0f;
+			aiVector3D p = n + su * u + sv * v;
+			mesh.vertexPositions.push_back(aiVector3D(p.x * half.x, p.y * half.y, p.z * half.z));
+			mesh.vertexNormals.push_back(n);
+			mesh.vertexTexCoords.push_back(aiVector2D(su * 0.5f + 0.5f, sv * 0.5f + 0.5f));
+		}
+		UINT quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for (UINT i : quad) mesh.indices.push_back(base + i);
+	}
+}
+
+void BuildFullScreenQuad(Model & model)
+{
+	model.meshList.assign(1, Mesh());
+	model.materialList.assign(1, Material());
+	model.nodeList.assign(1, Node());
+	model.nodeList[0].id = 0;
+	model.hasAnimation = false;
+
+	Mesh &mesh = model.meshList[0];
+	mesh.name = "full_screen";
+	mesh.materialID = 0;
+	mesh.nodeID = 0;
+	//Same quad as Models/fullScreen.obj
+	mesh.vertexPositions.push_back(aiVector3D(-1, 1, 0));
+	mesh.vertexPositions.push_back(aiVector3D(1, 1, 0));
+	mesh.vertexPositions.push_back(aiVector3D(1, -1, 0));
+	mesh.vertexPositions.push_back(aiVector3D(-1, -1, 0));
+	mesh.vertexTexCoords.push_back(aiVector2D(0, 0));
+	mesh.vertexTexCoords.push_back(aiVector2D(1, 0));
+	mesh.vertexTexCoords.push_back(aiVector2D(1, 1));
+	mesh.vertexTexCoords.push_back(aiVector2D(0, 1));
+	UINT indices[6] = { 0, 3, 1, 1, 3, 2 };
+	mesh.indices.assign(indices, indices + 6);
+}
+
+bool StartHeadlessEngine(GEngine & engine, int width, int height)
+{
+	if (!engine.InitHeadless(width, height))
+		return false;
+	try
+	{
+		engine.LoadEffect("../Effects/test.json");
+	}
+	catch (const exception &ex)
+	{
+		printf("  %s\n", ex.what());
+		return false;
+	}
+	catch (...)
+	{
+		return false;
+	}
+	Model quad;
+	BuildFullScreenQuad(quad);
+	engine.LoadPostMesh(quad, "full_screen");
+	engine.camera.screenAspect = (float)width / height;
+	engine.camera.UpdateProjectionMatrix();
+	return true;
+}
+
+void PlaceGrid(GEngine & engine, AssetPack * pack, UINT columns, UINT rows, float spacing, vector<InstanceHandle>& outHandles)
+{
+	for (UINT z = 0; z < rows; z++)
+	{
+		for (UINT x = 0; x < columns; x++)
+		{
+			InstanceHandle h = engine.CreateInstance(pack->defaultInstance);
+			if (h == InstancePool::INVALID_HANDLE) return;
+			engine.instances.GetTransform(h).SetPosition((x - columns * 0.5f) * spacing, 0, (z - rows * 0.5f) * spacing);
+			outHandles.push_back(h);
+		}
+	}
+}
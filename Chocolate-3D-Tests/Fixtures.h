@@ -0,0 +1,21 @@
+//-------------------------------------------------------------------------
+//--------------------------Test Fixtures----------------------------------
+//Procedural models and a headless engine, so tests need no model file.
+//GEngine::LoadAsset(Model&, name) turns the models into asset packs.
+//-------------------------------------------------------------------------
+
+#pragma once
+#include "Harness.h"
+#include "GEngine.h"
+
+//Box centered on the origin: one node, one mesh, one untextured material
+void BuildBox(Model &model, float halfX, float halfY, float halfZ);
+
+//Two triangles over clip space, the post processing mesh
+void BuildFullScreenQuad(Model &model);
+
+//GEngine::InitHeadless with ../Effects/test.json and the quad as post mesh, false when either fails
+bool StartHeadlessEngine(GEngine &engine, int width = 1280, int height = 720);
+
+//Instances of pack on a columns x rows grid in the XZ plane, spacing apart
+void PlaceGrid(GEngine &engine, AssetPack* pack, UINT columns, UINT rows, float spacing, vector<InstanceHandle> &outHandles);
@@ -0,0 +1,49 @@
+//-------------------------------------------------------------------------
+//------------------------Test and Benchmark Harness------------------------
+//Tests and benchmarks of the engine's CPU side. Nothing needs a GPU: the
+//pipeline runs on the NullDevice of PipeLine::InitHeadless.
+//Built by Chocolate-3D-Tests.vcxproj. Elsewhere, from this folder:
+//  g++ -std=c++17 -O2 -I../Chocolate-3D -I../Chocolate-3D/include -I../Chocolate-3D/common -o tests *.cpp $(find ../Chocolate-3D -name '*.cpp' ! -name test.cpp ! -name D3D11Device.cpp) -lassimp -lpthread
+//Run from this folder, effects are read from ../Effects.
+//-------------------------------------------------------------------------
+
+#pragma once
+#include "Platform.h"
+#include <string>
+#include <vector>
+#include <chrono>
+using namespace std;
+
+struct TestCase
+{
+	const char* name;
+	void(*function)();
+	bool benchmark;
+};
+vector<TestCase>& GetTestCases();
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, void(*function)(), bool benchmark);
+};
+
+//Tests run by default, benchmarks with -bench or by name
+#define TEST(name) static void name(); static TestRegistrar name##Registrar(#name, name, false); static void name()
+#define BENCHMARK(name) static void name(); static TestRegistrar name##Registrar(#name, name, true); static void name()
+
+//A failed check is logged and counted, the test goes on
+#define CHECK(condition) CheckResult((condition), #condition, __FILE__, __LINE__)
+bool CheckResult(bool passed, const char* expression, const char* file, int line);
+
+class Timer
+{
+public:
+	Timer();
+	void Restart();
+	double Milliseconds() const;
+private:
+	chrono::high_resolution_clock::time_point start;
+};
+
+//Keeps a benchmark's result alive so the optimizer can't drop the work
+void Consume(const void* data);
@@ -0,0 +1,92 @@
+//-------------------------------------------------------------------------
+//------------------------IDContainer and slot map-------------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include <unordered_map>
+#include <climits>
+#include <cstdio>
+
+//IDContainer before the slot map: the lowest free ID probed from 0 in an unordered_map
+class ProbingIDs
+{
+public:
+	unordered_map<UINT, void*> pool;
+	int Insert(void* element)
+	{
+		for (int i = 0; i < INT_MAX; i++)
+		{
+			if (pool.find(i) == pool.end())
+			{
+				pool[i] = element;
+				return i;
+			}
+		}
+		return -1;
+	}
+};
+
+//Creating and destroying resources: the bare containers, then ResourceManager on the NullDevice
+//with 100k buffers. Probing is quadratic, it only runs up to 10k
+BENCHMARK(ResourceCreateDestroy)
+{
+	const UINT counts[3] = { 1000, 10000, 100000 };
+	for (UINT count : counts)
+	{
+		Timer timer;
+		SlotMap<void*> slots;
+		vector<UINT> ids(count);
+		for (UINT i = 0; i < count; i++) ids[i] = slots.Insert(NULL);
+		double slotCreate = timer.Milliseconds();
+		timer.Restart();
+		for (UINT id : ids) slots.Erase(id);
+		double slotDestroy = timer.Milliseconds();
+		CHECK(slots.Size() == 0);
+		if (count > 10000)
+		{
+			printf("  %6u IDs: slot map create %.3f ms, destroy %.3f ms\n", count, slotCreate, slotDestroy);
+			continue;
+		}
+		timer.Restart();
+		ProbingIDs probing;
+		for (UINT i = 0; i < count; i++) ids[i] = probing.Insert(NULL);
+		double probeCreate = timer.Milliseconds();
+		timer.Restart();
+		for (UINT id : ids) probing.pool.erase(id);
+		double probeDestroy = timer.Milliseconds();
+		printf("  %6u IDs: slot map create %.3f ms, destroy %.3f ms. Probing create %.3f ms, destroy %.3f ms\n",
+			count, slotCreate, slotDestroy, probeCreate, probeDestroy);
+	}
+
+	const UINT count = 100000;
+	if (!CHECK(PipeLine::InitHeadless(64, 64))) return;
+	ResourceManager &resources = PipeLine::Resources();
+	size_t memoryBefore = resources.GetMemoryUsage();
+	ResourceDesc desc;
+	desc.name = "buffer";
+	desc.type = Resource_Buffer;
+	desc.bindFlag = Bind_Constant_Buffer;
+	desc.access = Access_Dynamic;
+	desc.size[0] = 256;
+	vector<int> ids(count);
+	Timer timer;
+	for (UINT i = 0; i < count; i++) ids[i] = resources.Create(desc);
+	double createTime = timer.Milliseconds();
+	UINT found = 0;
+	timer.Restart();
+	for (int id : ids) found += resources.GetDesc(id) != NULL;
+	double lookupTime = timer.Milliseconds();
+	timer.Restart();
+	for (int id : ids) resources.Delete(id);
+	double deleteTime = timer.Milliseconds();
+	CHECK(found == count);
+	//Deleted IDs are stale at once, the buffers go once the frames in flight are done
+	CHECK(resources.GetDesc(ids[0]) == NULL);
+	timer.Restart();
+	for (UINT i = 0; i < FRAMES_IN_FLIGHT; i++) PipeLine::Swap();
+	double releaseTime = timer.Milliseconds();
+	CHECK(resources.GetRetiredCount() == 0 && resources.GetMemoryUsage() == memoryBefore);
+	printf("  %u resources: create %.2f ms, look up %.3f ms, delete %.2f ms, release %.2f ms\n",
+		count, createTime, lookupTime, deleteTime, releaseTime);
+	PipeLine::Shutdown();
+}
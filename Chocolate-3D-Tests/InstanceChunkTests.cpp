@@ -0,0 +1,105 @@
+//-------------------------------------------------------------------------
+//--------------------------SplitInstanceChunks----------------------------
+//-------------------------------------------------------------------------
+
+#include "Harness.h"
+#include "InstanceChunk.h"
+
+//Instances with the given bind matrix counts, packed back to back. Returns the total
+static UINT MakeInstances(const vector<UINT> &matrixCounts, vector<InstanceData> &outInstances)
+{
+	outInstances.assign(matrixCounts.size(), InstanceData());
+	UINT offset = 0;
+	for (size_t i = 0; i < matrixCounts.size(); i++)
+	{
+		outInstances[i].bindMatrixOffset = offset;
+		offset += matrixCounts[i];
+	}
+	return offset;
+}
+
+TEST(SplitInstanceChunksInstanceLimit)
+{
+	vector<InstanceData> instances;
+	vector<InstanceChunk> chunks;
+	UINT numBindMatrix = MakeInstances(vector<UINT>(8, 0), instances);
+
+	//Exactly two full chunks
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 4, 16, chunks) == 0);
+	CHECK(chunks.size() == 2);
+	CHECK(chunks[0].firstInstance == 0 && chunks[0].numInstances == 4);
+	CHECK(chunks[1].firstInstance == 4 && chunks[1].numInstances == 4);
+
+	//One over a chunk boundary
+	numBindMatrix = MakeInstances(vector<UINT>(9, 0), instances);
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 4, 16, chunks) == 0);
+	CHECK(chunks.size() == 3);
+	CHECK(chunks[2].firstInstance == 8 && chunks[2].numInstances == 1);
+
+	//One instance per draw
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 1, 16, chunks) == 0);
+	CHECK(chunks.size() == 9);
+
+	//No instance fits a draw
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 0, 16, chunks) == 9);
+	CHECK(chunks.empty());
+
+	instances.clear();
+	CHECK(SplitInstanceChunks(instances, 0, 4, 16, chunks) == 0);
+	CHECK(chunks.empty());
+}
+
+TEST(SplitInstanceChunksBindMatrixLimit)
+{
+	vector<InstanceData> instances;
+	vector<InstanceChunk> chunks;
+	UINT counts[] = { 3, 3, 3, 2, 2 };
+	UINT numBindMatrix = MakeInstances(vector<UINT>(counts, counts + 5), instances);
+
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 16, 7, chunks) == 0);
+	CHECK(chunks.size() == 2);
+	CHECK(chunks[0].firstInstance == 0 && chunks[0].numInstances == 2);
+	CHECK(chunks[0].firstBindMatrix == 0 && chunks[0].numBindMatrix == 6);
+	//A chunk fills up to the limit exactly
+	CHECK(chunks[1].firstInstance == 2 && chunks[1].numInstances == 3);
+	CHECK(chunks[1].firstBindMatrix == 6 && chunks[1].numBindMatrix == 7);
+}
+
+TEST(SplitInstanceChunksOversizedInstance)
+{
+	vector<InstanceData> instances;
+	vector<InstanceChunk> chunks;
+	UINT counts[] = { 2, 2, 9, 2, 9 };
+	UINT numBindMatrix = MakeInstances(vector<UINT>(counts, counts + 5), instances);
+
+	//Instances 2 and 4 alone need more than a draw holds
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 16, 8, chunks) == 2);
+	CHECK(chunks.size() == 2);
+	CHECK(chunks[0].firstInstance == 0 && chunks[0].numInstances == 2);
+	CHECK(chunks[0].firstBindMatrix == 0 && chunks[0].numBindMatrix == 4);
+	CHECK(chunks[1].firstInstance == 3 && chunks[1].numInstances == 1);
+	CHECK(chunks[1].firstBindMatrix == 13 && chunks[1].numBindMatrix == 2);
+}
+
+TEST(RebaseInstanceChunkOffsets)
+{
+	vector<InstanceData> instances;
+	vector<InstanceChunk> chunks;
+	UINT counts[] = { 4, 4, 1, 3 };
+	UINT numBindMatrix = MakeInstances(vector<UINT>(counts, counts + 4), instances);
+	CHECK(SplitInstanceChunks(instances, numBindMatrix, 16, 8, chunks) == 0);
+	CHECK(chunks.size() == 2);
+	if (chunks.size() != 2) return;
+
+	//The second chunk's matrices start at 8 in the bucket, placed at 100 in the ring
+	const InstanceChunk &chunk = chunks[1];
+	CHECK(chunk.firstBindMatrix == 8 && chunk.numBindMatrix == 4);
+	vector<InstanceData> rebased(chunk.numInstances);
+	RebaseInstanceChunk(&instances[0], chunk, 100, &rebased[0]);
+	CHECK(rebased[0].bindMatrixOffset == 100);
+	CHECK(rebased[1].bindMatrixOffset == 101);
+
+	RebaseInstanceChunk(&instances[0], chunks[0], 0, &rebased[0]);
+	CHECK(rebased[0].bindMatrixOffset == 0);
+	CHECK(rebased[1].bindMatrixOffset == 4);
+}
@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------
+//-----------------------Test and Benchmark Runner-------------------------
+//Usage: Chocolate-3D-Tests [-bench] [name ...]
+//No argument runs every test, -bench adds the benchmarks, names run only those
+//-------------------------------------------------------------------------
+
+#include "Harness.h"
+#include <cstdio>
+
+static int failedChecks = 0;
+static volatile const void* sink = NULL;
+
+vector<TestCase>& GetTestCases()
+{
+	static vector<TestCase> cases;
+	return cases;
+}
+
+TestRegistrar::TestRegistrar(const char * name, void(*function)(), bool benchmark)
+{
+	TestCase c = { name, function, benchmark };
+	GetTestCases().push_back(c);
+}
+
+bool CheckResult(bool passed, const char * expression, const char * file, int line)
+{
+	if (!passed)
+	{
+		printf("  FAILED %s(%d): %s\n", file, line, expression);
+		failedChecks++;
+	}
+	return passed;
+}
+
+Timer::Timer()
+{
+	Restart();
+}
+
+void Timer::Restart()
+{
+	start = chrono::high_resolution_clock::now();
+}
+
+double Timer::Milliseconds() const
+{
+	return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+}
+
+void Consume(const void * data)
+{
+	sink = data;
+}
+
+int main(int argc, char* argv[])
+{
+	bool benchmarks = false;
+	vector<string> names;
+	for (int i = 1; i < argc; i++)
+	{
+		if (string(argv[i]) == "-bench") benchmarks = true;
+		else names.push_back(argv[i]);
+	}
+
+	int run = 0, failed = 0;
+	for (const TestCase &c : GetTestCases())
+	{
+		bool selected = names.empty() ? (!c.benchmark || benchmarks) : false;
+		for (const string &n : names)
+		{
+			if (n == c.name) selected = true;
+		}
+		if (!selected) continue;
+
+		printf("%s %s\n", c.benchmark ? "[bench]" : "[test] ", c.name);
+		fflush(stdout);
+		int before = failedChecks;
+		c.function();
+		run++;
+		if (failedChecks != before) failed++;
+	}
+	printf("%d run, %d failed\n", run, failed);
+	return failed ? 1 : 0;
+}
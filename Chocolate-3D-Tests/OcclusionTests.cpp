@@ -0,0 +1,91 @@
+//-------------------------------------------------------------------------
+//---------------------------Occlusion culling-----------------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include <cstdio>
+
+//A wall in front of the camera, boxes behind it, beside its edge and in front of it
+TEST(MaskedOcclusionHidesOnlyCoveredBoxes)
+{
+	Camera camera;
+	camera.screenAspect = 16.0f / 9.0f;
+	camera.UpdateProjectionMatrix();
+	camera.SetPosition(0, 0, -20);
+	camera.LookAt(aiVector3D(0, 0, 0));
+	aiMatrix4x4 viewProjection = camera.GetViewProjectionMatrix();
+
+	Model wall;
+	BuildBox(wall, 5, 5, 0.5f);
+	const Mesh &mesh = wall.meshList[0];
+	MaskedOcclusion buffer;
+	buffer.SetResolution(256, 144);
+	//Both windings, the test is about depth
+	buffer.backfaceCulling = false;
+	buffer.Clear();
+	buffer.AddOccluder(&mesh.vertexPositions[0], &mesh.indices[0], mesh.indices.size(), viewProjection);
+	CHECK(buffer.GetTriangleCount() == 12);
+	buffer.Rasterize(0, buffer.GetTileRowCount());
+
+	//Wall edges are at x, y = +-5, 20 in front of the camera
+	AABB hidden(aiVector3D(-1, -1, 5), aiVector3D(1, 1, 7));
+	AABB pastEdge(aiVector3D(4, -1, 5), aiVector3D(10, 1, 7));
+	AABB inFront(aiVector3D(-1, -1, -5), aiVector3D(1, 1, -3));
+	AABB aside(aiVector3D(20, -1, 5), aiVector3D(22, 1, 7));
+	CHECK(!buffer.IsVisible(hidden, viewProjection));
+	CHECK(buffer.IsVisible(pastEdge, viewProjection));
+	CHECK(buffer.IsVisible(inFront, viewProjection));
+	CHECK(buffer.IsVisible(aside, viewProjection));
+}
+
+//A 100x100 box grid partly behind a wall. Reports the share occlusion culling drops,
+//its cost, and the frame with and without it
+BENCHMARK(OcclusionCulling)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	engine.frustumCulling = true;
+
+	Model box, wall;
+	BuildBox(box, 0.5f, 0.5f, 0.5f);
+	BuildBox(wall, 12, 6, 0.5f);
+	AssetPack* boxPack = engine.LoadAsset(box, "box");
+	AssetPack* wallPack = engine.LoadAsset(wall, "wall");
+	vector<InstanceHandle> handles;
+	PlaceGrid(engine, boxPack, 100, 100, 2.0f, handles);
+	InstanceHandle wallHandle = engine.CreateInstance(wallPack->defaultInstance);
+	engine.instances.SetOccluder(wallHandle, true);
+	engine.instances.GetTransform(wallHandle).SetPosition(0, 0, -105);
+	engine.camera.SetPosition(0, 4, -130);
+	engine.camera.LookAt(aiVector3D(0, 0, 0));
+
+	const UINT warmup = 10, frames = 200;
+	for (int culling = 0; culling < 2; culling++)
+	{
+		engine.occlusionCulling = culling != 0;
+		for (UINT i = 0; i < warmup; i++)
+		{
+			engine.Render("direct_light");
+			PipeLine::Swap();
+		}
+		double cullTime = 0;
+		Timer timer;
+		for (UINT i = 0; i < frames; i++)
+		{
+			engine.Render("direct_light");
+			PipeLine::Swap();
+			cullTime += engine.occlusionStats.time;
+		}
+		double frameTime = timer.Milliseconds() / frames;
+		if (!culling)
+		{
+			printf("  occlusion off: %.3f ms/frame, %u draw calls\n", frameTime, engine.stats.drawCalls);
+			continue;
+		}
+		const GEngine::OcclusionStats &s = engine.occlusionStats;
+		CHECK(s.occluded > 0 && s.occluded < s.tested);
+		printf("  occlusion on: %.3f ms/frame, %u draw calls. %u of %u tested occluded (%.1f%%) in %.3f ms, %u occluder triangles\n",
+			frameTime, engine.stats.drawCalls, s.occluded, s.tested, 100.0 * s.occluded / s.tested, cullTime / frames, s.occluderTriangles);
+	}
+	engine.Shutdown();
+}
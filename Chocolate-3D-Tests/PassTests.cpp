@@ -0,0 +1,87 @@
+//-------------------------------------------------------------------------
+//------------------------Pass and Effect loading--------------------------
+//-------------------------------------------------------------------------
+
+#include "Fixtures.h"
+#include "json11/json11.hpp"
+#include <stdexcept>
+#include <cstdio>
+#include <fstream>
+using namespace json11;
+
+static bool PassLoads(const string &text)
+{
+	string err;
+	Json json = Json::parse(text, err);
+	if (!err.empty()) return false;
+	unordered_map<string, unordered_map<string, int>> resourceMap;
+	try
+	{
+		Pass pass(json, resourceMap);
+	}
+	catch (const exception&)
+	{
+		return false;
+	}
+	return true;
+}
+
+TEST(PassMinCoverageNeedsCameraView)
+{
+	CHECK(PassLoads("{ \"name\": \"p\", \"view\": \"camera\", \"min_coverage\": 4 }"));
+	CHECK(PassLoads("{ \"name\": \"p\", \"view\": \"light\" }"));
+	//Coverage is measured on the main camera
+	CHECK(!PassLoads("{ \"name\": \"p\", \"view\": \"light\", \"min_coverage\": 4 }"));
+	CHECK(!PassLoads("{ \"name\": \"p\", \"view\": \"voxel\", \"min_coverage\": 4 }"));
+	CHECK(!PassLoads("{ \"name\": \"p\", \"min_coverage\": 4 }"));
+}
+
+//Effect loading the shared sample resources, run from the test folder
+static const char* TRANSIENT_EFFECT = R"({
+  "config": { "input_layout": "..\\Effects\\Shaders\\DirectLightVS.hlsl" },
+  "resource": {
+    "resource": {
+      "first": "..\\Effects\\Resources\\Target.json",
+      "second": "..\\Effects\\Resources\\Target.json",
+      "third": "..\\Effects\\Resources\\Target.json"
+    }
+  },
+  "transient_resource": [ "first", "second", "third" ],
+  "pass": {},
+  "renderer": {
+    "r": [
+      { "reset": "first", "value": [ 0, 0, 0, 0 ], "value_type": "float" },
+      { "gen_mip": "first" },
+      { "reset": "second", "value": [ 0, 0, 0, 0 ], "value_type": "float" },
+      { "reset": "third", "value": [ 0, 0, 0, 0 ], "value_type": "float" },
+      { "gen_mip": "second" }
+    ]
+  }
+})";
+
+TEST(EffectAliasesOnlyNonOverlappingTransients)
+{
+	GEngine engine;
+	if (!CHECK(StartHeadlessEngine(engine))) return;
+	const string path = "transient_test.json";
+	{
+		ofstream file(path);
+		if (!CHECK(file.good())) return;
+		file << TRANSIENT_EFFECT;
+	}
+
+	Effect* effect = NULL;
+	try
+	{
+		effect = Effect::Create(path);
+	}
+	catch (const exception&)
+	{
+	}
+	remove(path.c_str());
+	if (!CHECK(effect != NULL)) return;
+	//second starts after first's last use and takes its memory, third is live while second is
+	CHECK(effect->transientCount == 3);
+	CHECK(effect->transientBytes > 0 && effect->aliasedBytes == effect->transientBytes / 3);
+	delete effect;
+}
@@ -0,0 +1,71 @@
+//-------------------------------------------------------------------------
+//-----------------------------Ring Allocator------------------------------
+//-------------------------------------------------------------------------
+
+#include "Harness.h"
+#include "RingAllocator.h"
+
+TEST(RingAllocatorAlignment)
+{
+	RingAllocator ring(1000, 2);
+	ring.BeginFrame();
+	size_t offset;
+	bool discard;
+	//The buffer starts with a discard
+	CHECK(ring.Allocate(10, 1, offset, discard) && offset == 0 && discard);
+	CHECK(ring.Allocate(16, 64, offset, discard) && offset == 64 && !discard);
+	CHECK(ring.GetHead() == 80);
+	//0 is no alignment
+	CHECK(ring.Allocate(4, 0, offset, discard) && offset == 80 && !discard);
+	CHECK(ring.Allocate(1, 256, offset, discard) && offset == 256);
+	//Alignment gaps count as live
+	CHECK(ring.GetLiveSize() == 257);
+	CHECK(!ring.Allocate(0, 1, offset, discard));
+	CHECK(!ring.Allocate(1001, 1, offset, discard));
+	CHECK(ring.GetDiscardCount() == 1 && ring.GetWrapCount() == 0);
+}
+
+//Two frames in flight on a 100 unit ring, 40 units a frame
+TEST(RingAllocatorWrapsOverLiftedFrames)
+{
+	RingAllocator ring(100, 2);
+	size_t offset;
+	bool discard;
+	ring.BeginFrame();
+	CHECK(ring.Allocate(40, 1, offset, discard) && offset == 0 && discard);
+	ring.BeginFrame();
+	CHECK(ring.Allocate(40, 1, offset, discard) && offset == 40 && !discard);
+	//The first frame's fence lifts: the tail wraps onto its space without a discard
+	ring.BeginFrame();
+	CHECK(ring.Allocate(40, 1, offset, discard) && offset == 0 && !discard);
+	CHECK(ring.GetWrapCount() == 1 && ring.GetDiscardCount() == 1);
+	ring.BeginFrame();
+	CHECK(ring.Allocate(20, 1, offset, discard) && offset == 40 && !discard);
+	CHECK(ring.GetLiveSize() == 80);
+}
+
+TEST(RingAllocatorDiscardsOnOverflow)
+{
+	RingAllocator ring(100, 2);
+	size_t offset;
+	bool discard;
+	ring.BeginFrame();
+	CHECK(ring.Allocate(40, 1, offset, discard) && discard);
+	ring.BeginFrame();
+	CHECK(ring.Allocate(40, 1, offset, discard) && !discard);
+	//Both frames are still in flight, 30 more would overwrite the first one
+	CHECK(ring.Allocate(30, 1, offset, discard) && offset == 0 && discard);
+	CHECK(ring.GetDiscardCount() == 2 && ring.GetWrapCount() == 1);
+	//Everything before lives in the renamed buffer, only the new data is live
+	CHECK(ring.GetLiveSize() == 30);
+	CHECK(ring.Allocate(70, 1, offset, discard) && offset == 30 && !discard);
+
+	//Nothing fenced: every wrap discards
+	RingAllocator unfenced(100);
+	unfenced.BeginFrame();
+	CHECK(unfenced.Allocate(60, 1, offset, discard) && discard);
+	unfenced.BeginFrame();
+	CHECK(unfenced.Allocate(30, 1, offset, discard) && offset == 60 && !discard);
+	CHECK(unfenced.Allocate(60, 1, offset, discard) && offset == 0 && discard);
+	CHECK(unfenced.GetDiscardCount() == 2);
+}
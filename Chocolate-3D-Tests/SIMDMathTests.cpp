@@ -0,0 +1,281 @@
+//-------------------------------------------------------------------------
+//-------------------------------SIMD Math---------------------------------
+//-------------------------------------------------------------------------
+
+#include "Harness.h"
+#include "SIMDMath.h"
+#include "asset/Model.h"
+#include <cstdio>
+#include <cmath>
+#include <functional>
+
+static unsigned int seed = 2024;
+static float Random(float low, float high)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return low + (high - low) * ((seed >> 8) / 16777216.0f);
+}
+
+static aiQuaternion RandomRotation()
+{
+	aiQuaternion q(Random(-1, 1), Random(-1, 1), Random(-1, 1), Random(-1, 1));
+	return q.Normalize();
+}
+
+static aiMatrix4x4 RandomAffine()
+{
+	return aiMatrix4x4(aiVector3D(Random(0.5f, 2), Random(0.5f, 2), Random(0.5f, 2)), RandomRotation(),
+		aiVector3D(Random(-100, 100), Random(-100, 100), Random(-100, 100)));
+}
+
+//The wVP stage of UpdateBuckets for 50k instances, three ways: as it used to be, projection * view * world
+//per component with the view inverted every time; with viewProjection hoisted out of the loop; and the
+//batched SSE kernel UpdateBuckets uses now
+BENCHMARK(WVPBatch)
+{
+	const size_t count = 50000;
+	const UINT passes = 20;
+	Camera camera;
+	camera.UpdateProjectionMatrix();
+	camera.SetPosition(10, 20, -30);
+	camera.LookAt(aiVector3D(0, 0, 0));
+	aiMatrix4x4 projection = camera.GetProjectionMatrix();
+	aiMatrix4x4 cameraMatrix = camera.GetMatrix();
+	aiMatrix4x4 viewProjection = camera.GetViewProjectionMatrix();
+
+	vector<aiMatrix4x4> world(count);
+	vector<const aiMatrix4x4*> worldPointers(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		world[i] = RandomAffine();
+		worldPointers[i] = &world[i];
+	}
+	vector<aiMatrix4x4> perComponent(count), hoisted(count), batched(count);
+
+	Timer timer;
+	for (UINT pass = 0; pass < passes; pass++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			aiMatrix4x4 view = cameraMatrix;
+			perComponent[i] = projection * view.Inverse() * world[i];
+		}
+	}
+	double perComponentTime = timer.Milliseconds() / passes;
+	timer.Restart();
+	for (UINT pass = 0; pass < passes; pass++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			hoisted[i] = viewProjection * world[i];
+		}
+	}
+	double hoistedTime = timer.Milliseconds() / passes;
+	timer.Restart();
+	for (UINT pass = 0; pass < passes; pass++)
+	{
+		MultiplyMatrixBatch(viewProjection, &worldPointers[0], count, &batched[0]);
+	}
+	double batchedTime = timer.Milliseconds() / passes;
+
+	float maxError = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int e = 0; e < 16; e++)
+		{
+			float scale = max(1.0f, fabs(hoisted[i][e / 4][e % 4]));
+			maxError = max(maxError, fabs(batched[i][e / 4][e % 4] - hoisted[i][e / 4][e % 4]) / scale);
+			maxError = max(maxError, fabs(perComponent[i][e / 4][e % 4] - hoisted[i][e / 4][e % 4]) / scale);
+		}
+	}
+	CHECK(maxError < 1e-4f);
+	Consume(&perComponent[0]);
+	Consume(&hoisted[0]);
+	Consume(&batched[0]);
+	printf("  %zu wVP: per component with inverse %.3f ms, hoisted viewProjection %.3f ms, batched SSE %.3f ms\n",
+		count, perComponentTime, hoistedTime, batchedTime);
+}
+
+static float Error(float a, float b)
+{
+	return fabs(a - b) / max(1.0f, fabs(b));
+}
+
+static float Error(const aiMatrix4x4 &m, const aiMatrix4x4 &expected)
+{
+	float e = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		e = max(e, Error(m[i / 4][i % 4], expected[i / 4][i % 4]));
+	}
+	return e;
+}
+
+static float Error(const aiVector3D &v, const aiVector3D &expected)
+{
+	return max(Error(v.x, expected.x), max(Error(v.y, expected.y), Error(v.z, expected.z)));
+}
+
+//Translation * Rotation * Scaling the way NodeFrame::ToMatrix and Transform built it before.
+//Assimp's (scaling, rotation, position) constructor scales rows instead of columns
+static aiMatrix4x4 ComposeReference(const aiVector3D &translation, const aiQuaternion &rotation, const aiVector3D &scaling)
+{
+	aiMatrix4x4 m = aiMatrix4x4(rotation.GetMatrix());
+	for (int row = 0; row < 3; row++)
+	{
+		m[row][0] *= scaling.x;
+		m[row][1] *= scaling.y;
+		m[row][2] *= scaling.z;
+	}
+	m.a4 = translation.x;
+	m.b4 = translation.y;
+	m.c4 = translation.z;
+	return m;
+}
+
+static aiMatrix4x4 Store(const AffineMatrix &m)
+{
+	aiMatrix4x4 out;
+	StoreAffine(m, out);
+	return out;
+}
+
+//Every primitive against the Assimp code it replaces in the hot paths
+TEST(SIMDMathMatchesAssimp)
+{
+	const float tolerance = 1e-4f;
+	float worst[10] = {};
+	enum { Compose, Multiply, Inverse, Quaternion, Rotate, Point, Cross3, Dot, Bound, Batch };
+	for (int test = 0; test < 200; test++)
+	{
+		aiVector3D scaling(Random(0.5f, 2), Random(0.5f, 2), Random(0.5f, 2));
+		aiQuaternion rotation = RandomRotation();
+		aiVector3D translation(Random(-100, 100), Random(-100, 100), Random(-100, 100));
+		aiMatrix4x4 a = ComposeReference(translation, rotation, scaling);
+		aiMatrix4x4 b = RandomAffine();
+		AffineMatrix sa = LoadAffine(a), sb = LoadAffine(b);
+		aiVector3D p(Random(-10, 10), Random(-10, 10), Random(-10, 10));
+		aiVector3D q(Random(-10, 10), Random(-10, 10), Random(-10, 10));
+
+		worst[Compose] = max(worst[Compose], Error(Store(ComposeAffine(LoadVector(translation, 0), LoadQuaternion(rotation), LoadVector(scaling, 0))), a));
+		worst[Multiply] = max(worst[Multiply], Error(Store(MultiplyAffine(sa, sb)), a * b));
+		aiMatrix4x4 inverse = a;
+		worst[Inverse] = max(worst[Inverse], Error(Store(InverseAffine(sa)), inverse.Inverse()));
+
+		aiQuaternion other = RandomRotation();
+		aiQuaternion product = StoreQuaternion(MultiplyQuaternion(LoadQuaternion(rotation), LoadQuaternion(other)));
+		aiQuaternion expected = rotation * other;
+		worst[Quaternion] = max(worst[Quaternion], max(max(Error(product.x, expected.x), Error(product.y, expected.y)), max(Error(product.z, expected.z), Error(product.w, expected.w))));
+		worst[Rotate] = max(worst[Rotate], Error(StoreVector(RotateVector(LoadQuaternion(rotation), LoadVector(p, 0))), aiMatrix4x4(rotation.GetMatrix()) * p));
+		worst[Point] = max(worst[Point], Error(StoreVector(TransformPoint(sa, LoadVector(p, 1))), a * p));
+		worst[Cross3] = max(worst[Cross3], Error(StoreVector(Cross(LoadVector(p, 0), LoadVector(q, 0))), p ^ q));
+		worst[Dot] = max(worst[Dot], Error(_mm_cvtss_f32(Dot3(LoadVector(p, 0), LoadVector(q, 0))), p * q));
+
+		//The bound has to be the box around the eight transformed corners
+		float halfX = fabs(p.x) + 1;
+		aiVector3D boxMin(-halfX, -1, q.z - 2), boxMax(halfX, 1, q.z + 2);
+		aiVector3D cornerMin(1e30f, 1e30f, 1e30f), cornerMax(-1e30f, -1e30f, -1e30f);
+		for (int c = 0; c < 8; c++)
+		{
+			aiVector3D corner = a * aiVector3D(c & 1 ? boxMax.x : boxMin.x, c & 2 ? boxMax.y : boxMin.y, c & 4 ? boxMax.z : boxMin.z);
+			cornerMin = aiVector3D(min(cornerMin.x, corner.x), min(cornerMin.y, corner.y), min(cornerMin.z, corner.z));
+			cornerMax = aiVector3D(max(cornerMax.x, corner.x), max(cornerMax.y, corner.y), max(cornerMax.z, corner.z));
+		}
+		TransformBound(sa, boxMin, boxMax);
+		worst[Bound] = max(worst[Bound], max(Error(boxMin, cornerMin), Error(boxMax, cornerMax)));
+
+		aiMatrix4x4 rights[3] = { b, RandomAffine(), RandomAffine() };
+		const aiMatrix4x4* pointers[3] = { &rights[0], &rights[1], &rights[2] };
+		aiMatrix4x4 full[3], gathered[3], affine[3];
+		MultiplyMatrixBatch(a, rights, 3, full);
+		MultiplyMatrixBatch(a, pointers, 3, gathered);
+		MultiplyAffineBatch(sa, rights, 3, affine);
+		aiVector3D points[3] = { p, q, translation }, transformed[3];
+		TransformPointBatch(sa, points, 3, transformed);
+		for (int i = 0; i < 3; i++)
+		{
+			aiMatrix4x4 m = a * rights[i];
+			worst[Batch] = max(worst[Batch], max(Error(full[i], m), max(Error(gathered[i], m), Error(affine[i], m))));
+			worst[Batch] = max(worst[Batch], Error(transformed[i], a * points[i]));
+		}
+	}
+	const char* names[10] = { "ComposeAffine", "MultiplyAffine", "InverseAffine", "MultiplyQuaternion", "RotateVector",
+		"TransformPoint", "Cross", "Dot3", "TransformBound", "batches" };
+	for (int i = 0; i < 10; i++)
+	{
+		if (!CHECK(worst[i] < tolerance))
+			printf("  %s is off by %g\n", names[i], worst[i]);
+	}
+}
+
+//Keeps the register type's alignment inside a vector
+struct Vector4Slot
+{
+	Vector4 v;
+};
+
+//Nanoseconds per call of each primitive and of the Assimp code it replaces
+BENCHMARK(SIMDMathPrimitives)
+{
+	const size_t count = 1024;
+	const UINT passes = 1000;
+	vector<aiMatrix4x4> matrices(count), results(count);
+	vector<AffineMatrix> affines(count), affineResults(count);
+	vector<aiQuaternion> rotations(count), rotationResults(count);
+	vector<Vector4Slot> simdRotations(count), simdResults(count);
+	vector<aiVector3D> points(count), pointResults(count);
+	vector<Vector4Slot> simdPoints(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		matrices[i] = RandomAffine();
+		affines[i] = LoadAffine(matrices[i]);
+		rotations[i] = RandomRotation();
+		simdRotations[i].v = LoadQuaternion(rotations[i]);
+		points[i] = aiVector3D(Random(-10, 10), Random(-10, 10), Random(-10, 10));
+		simdPoints[i].v = LoadVector(points[i], 1);
+	}
+	auto measure = [&](const char* name, const function<void(size_t)> &simd, const function<void(size_t)> &assimp)
+	{
+		Timer timer;
+		for (UINT pass = 0; pass < passes; pass++)
+		{
+			for (size_t i = 0; i < count; i++) simd(i);
+		}
+		double simdTime = timer.Milliseconds();
+		timer.Restart();
+		for (UINT pass = 0; pass < passes; pass++)
+		{
+			for (size_t i = 0; i < count; i++) assimp(i);
+		}
+		double assimpTime = timer.Milliseconds();
+		double calls = (double)count * passes;
+		printf("  %-20s SSE %6.2f ns, Assimp %6.2f ns\n", name, simdTime * 1e6 / calls, assimpTime * 1e6 / calls);
+	};
+	size_t last = count - 1;
+	measure("ComposeAffine",
+		[&](size_t i) { affineResults[i] = ComposeAffine(simdPoints[i].v, simdRotations[i].v, simdPoints[last - i].v); },
+		[&](size_t i) { results[i] = ComposeReference(points[i], rotations[i], points[last - i]); });
+	measure("MultiplyAffine",
+		[&](size_t i) { affineResults[i] = MultiplyAffine(affines[i], affines[last - i]); },
+		[&](size_t i) { results[i] = matrices[i] * matrices[last - i]; });
+	measure("InverseAffine",
+		[&](size_t i) { affineResults[i] = InverseAffine(affines[i]); },
+		[&](size_t i) { results[i] = matrices[i]; results[i].Inverse(); });
+	measure("MultiplyQuaternion",
+		[&](size_t i) { simdResults[i].v = MultiplyQuaternion(simdRotations[i].v, simdRotations[last - i].v); },
+		[&](size_t i) { rotationResults[i] = rotations[i] * rotations[last - i]; });
+	measure("RotateVector",
+		[&](size_t i) { simdResults[i].v = RotateVector(simdRotations[i].v, simdPoints[i].v); },
+		[&](size_t i) { pointResults[i] = aiMatrix4x4(rotations[i].GetMatrix()) * points[i]; });
+	measure("TransformPoint",
+		[&](size_t i) { simdResults[i].v = TransformPoint(affines[i], simdPoints[last - i].v); },
+		[&](size_t i) { pointResults[i] = matrices[i] * points[last - i]; });
+	measure("MultiplyMatrixBatch",
+		[&](size_t i) { if (i == 0) MultiplyMatrixBatch(matrices[last], &matrices[0], count, &results[0]); },
+		[&](size_t i) { results[i] = matrices[last] * matrices[i]; });
+	Consume(&results[0]);
+	Consume(&affineResults[0]);
+	Consume(&rotationResults[0]);
+	Consume(&simdResults[0].v);
+	Consume(&pointResults[0]);
+}
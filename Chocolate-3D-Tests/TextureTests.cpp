@@ -0,0 +1,169 @@
+//-------------------------------------------------------------------------
+//--------------------Material texture loading and mips--------------------
+//-------------------------------------------------------------------------
+
+//stb_image_write sets up the CRT defines it needs, so it comes first
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb-master/stb_image_write.h"
+#include "Harness.h"
+#include "asset/Model.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <cmath>
+
+//Smooth gradients with some high frequency detail, so filters and codecs have work to do
+static bool WriteTestImage(const string &path, int width, int height)
+{
+	vector<unsigned char> pixels((size_t)width * height * 4);
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			unsigned char* p = &pixels[((size_t)y * width + x) * 4];
+			p[0] = (unsigned char)(255 * x / width);
+			p[1] = (unsigned char)(255 * y / height);
+			p[2] = (unsigned char)(127 + 127 * sin(x * 0.3f) * cos(y * 0.2f));
+			p[3] = 255;
+		}
+	}
+	bool written = stbi_write_png(path.c_str(), width, height, 4, &pixels[0], width * 4) != 0;
+	//FindFile keeps folder listings
+	TextureData::ClearFileIndex();
+	return written;
+}
+
+static void RemoveTestImage(const string &path)
+{
+	remove(path.c_str());
+	remove((path + ".ctex").c_str());
+	TextureData::ClearFileIndex();
+}
+
+//Model::LoadTextures is what LoadFileD3D runs on the material textures
+class TextureLoadModel : public Model
+{
+public:
+	using Model::TextureLoad;
+	void Load(const vector<TextureLoad> &loads)
+	{
+		LoadTextures(loads);
+	}
+};
+
+TEST(ModelTextureLoadsShareRepeatedImages)
+{
+	const string image = "texture_test_shared.png";
+	if (!CHECK(WriteTestImage(image, 64, 64))) return;
+	RemoveTestImage(image);
+	WriteTestImage(image, 64, 64);
+
+	ThreadPool threads;
+	TextureLoadModel model;
+	model.compressTextures = true;
+	model.textureThreads = &threads;
+	TextureData textures[4];
+	bool loaded[4] = { false, false, false, false };
+	//The second names the image without its extension, the last doesn't exist
+	TextureLoadModel::TextureLoad loads[4] =
+	{
+		{ &textures[0], image, false, &loaded[0] },
+		{ &textures[1], "texture_test_shared", false, &loaded[1] },
+		{ &textures[2], image, false, &loaded[2] },
+		{ &textures[3], "texture_test_missing.png", false, &loaded[3] },
+	};
+	model.Load(vector<TextureLoadModel::TextureLoad>(loads, loads + 4));
+
+	CHECK(loaded[0] && loaded[1] && loaded[2]);
+	CHECK(!loaded[3]);
+	for (int i = 1; i < 3; i++)
+	{
+		CHECK(textures[i].width == textures[0].width && textures[i].height == textures[0].height);
+		CHECK(textures[i].codec == textures[0].codec && textures[i].mipLevels == textures[0].mipLevels);
+		CHECK(textures[i].imageSize == textures[0].imageSize &&
+			!memcmp(textures[i].GetImageDataPtr(), textures[0].GetImageDataPtr(), textures[0].imageSize));
+	}
+	for (TextureData &t : textures) t.Clear();
+	RemoveTestImage(image);
+}
+
+//CPU mip chains per filter, and what block compression saves against the RGBA8 render target
+//chain GPU mip generation needed
+BENCHMARK(TextureMipChain)
+{
+	const string image = "texture_test_mips.png";
+	const int size = 1024;
+	if (!CHECK(WriteTestImage(image, size, size))) return;
+	ThreadPool threads;
+	const MipFilter filters[2] = { Mip_Box, Mip_Kaiser };
+	const char* filterNames[2] = { "box", "kaiser" };
+	for (int f = 0; f < 2; f++)
+	{
+		for (int threaded = 0; threaded < 2; threaded++)
+		{
+			TextureData texture;
+			if (!CHECK(texture.LoadFromFile(image))) break;
+			size_t topLevel = TextureData::GetLevelSize(Codec_None, size, size);
+			Timer timer;
+			CHECK(texture.GenerateMips(false, filters[f], threaded ? &threads : NULL));
+			double mipTime = timer.Milliseconds();
+			size_t chain = texture.imageSize;
+			timer.Restart();
+			CHECK(texture.Compress(false, threaded ? &threads : NULL));
+			double compressTime = timer.Milliseconds();
+			printf("  %dx%d %s, %s: mips %.2f ms, compress %.2f ms. Top %zu KB, RGBA8 chain %zu KB, BC chain %d KB (%.0f%% saved)\n",
+				size, size, filterNames[f], threaded ? "pool" : "serial", mipTime, compressTime,
+				topLevel / 1024, chain / 1024, texture.imageSize / 1024, 100.0 * (1.0 - (double)texture.imageSize / chain));
+		}
+	}
+	RemoveTestImage(image);
+}
+
+//Per texture load time both ways: stb decode, and the .ctex container mapped in place.
+//Cold is each load's first time through, the container written and the folder listing built,
+//warm repeats it with both in place
+BENCHMARK(TextureDecodeVsContainer)
+{
+	const string image = "texture_test_container.png";
+	const int size = 1024;
+	const int repeats = 20;
+	if (!CHECK(WriteTestImage(image, size, size))) return;
+	ThreadPool threads;
+
+	Timer timer;
+	TextureData decoded;
+	CHECK(decoded.LoadFromFile(image));
+	double decodeCold = timer.Milliseconds();
+	decoded.Clear();
+	timer.Restart();
+	for (int i = 0; i < repeats; i++)
+	{
+		decoded.LoadFromFile(image);
+		Consume(decoded.GetImageDataPtr());
+		decoded.Clear();
+	}
+	double decodeWarm = timer.Milliseconds() / repeats;
+
+	//Writes the container, then maps it with a fresh folder listing
+	TextureData texture;
+	timer.Restart();
+	CHECK(texture.LoadCached(image, false, true, Mip_Box, &threads));
+	double build = timer.Milliseconds();
+	texture.Clear();
+	TextureData::ClearFileIndex();
+	timer.Restart();
+	CHECK(texture.LoadCached(image, false, true, Mip_Box, &threads));
+	double mapCold = timer.Milliseconds();
+	texture.Clear();
+	timer.Restart();
+	for (int i = 0; i < repeats; i++)
+	{
+		texture.LoadCached(image, false, true, Mip_Box, &threads);
+		Consume(texture.GetImageDataPtr());
+		texture.Clear();
+	}
+	double mapWarm = timer.Milliseconds() / repeats;
+
+	printf("  %dx%d: decode %.3f ms cold, %.3f ms warm. Container build %.2f ms, mapped %.3f ms cold, %.3f ms warm\n",
+		size, size, decodeCold, decodeWarm, build, mapCold, mapWarm);
+	RemoveTestImage(image);
+}
@@ -0,0 +1,147 @@
+#include "AssetRegistry.h"
+#include <algorithm>
+#include <cstdlib>
+
+AssetRegistry::AssetRegistry()
+{
+}
+
+AssetRegistry::~AssetRegistry()
+{
+	Clear();
+}
+
+string AssetRegistry::MakeKey(const string & file, const string & options)
+{
+#ifdef _WIN32
+	char fullPath[MAX_PATH];
+	DWORD length = GetFullPathNameA(file.c_str(), MAX_PATH, fullPath, NULL);
+	string key = length && length < MAX_PATH ? string(fullPath, length) : file;
+#else
+	char* fullPath = realpath(file.c_str(), NULL);
+	string key = fullPath ? string(fullPath) : file;
+	free(fullPath);
+#endif
+	for (char &c : key)
+	{
+		if (c == '/') c = '\\';
+		else c = (char)tolower((unsigned char)c);
+	}
+	if (!options.empty())
+		key += "|" + options;
+	return key;
+}
+
+AssetPack * AssetRegistry::Acquire(const string & key)
+{
+	auto it = packOfKey.find(key);
+	if (it == packOfKey.end())
+		return NULL;
+	entries[it->second].references++;
+	return it->second;
+}
+
+bool AssetRegistry::Add(const string & key, AssetPack * pack)
+{
+	if (!pack || packOfKey.count(key) || entries.count(pack))
+		return false;
+	packOfKey[key] = pack;
+	Entry entry = { key, 1, 0 };
+	entries[pack] = entry;
+	return true;
+}
+
+bool AssetRegistry::Release(AssetPack * pack)
+{
+	auto it = entries.find(pack);
+	if (it == entries.end() || !it->second.references)
+		return false;
+	it->second.references--;
+	return DeleteIfUnused(pack);
+}
+
+void AssetRegistry::AddInstance(AssetPack * pack)
+{
+	auto it = entries.find(pack);
+	if (it != entries.end())
+		it->second.instances++;
+}
+
+bool AssetRegistry::RemoveInstance(AssetPack * pack)
+{
+	auto it = entries.find(pack);
+	if (it == entries.end() || !it->second.instances)
+		return false;
+	it->second.instances--;
+	return DeleteIfUnused(pack);
+}
+
+bool AssetRegistry::DeleteIfUnused(AssetPack * pack)
+{
+	auto it = entries.find(pack);
+	if (it->second.references || it->second.instances)
+		return false;
+	packOfKey.erase(it->second.key);
+	entries.erase(it);
+	delete pack;
+	return true;
+}
+
+bool AssetRegistry::Contains(const AssetPack * pack) const
+{
+	return entries.count(pack) != 0;
+}
+
+UINT AssetRegistry::GetReferenceCount(const AssetPack * pack) const
+{
+	auto it = entries.find(pack);
+	return it == entries.end() ? 0 : it->second.references;
+}
+
+UINT AssetRegistry::GetInstanceCount(const AssetPack * pack) const
+{
+	auto it = entries.find(pack);
+	return it == entries.end() ? 0 : it->second.instances;
+}
+
+size_t AssetRegistry::GetCount() const
+{
+	return entries.size();
+}
+
+vector<AssetResidency> AssetRegistry::GetResidentSet() const
+{
+	vector<AssetResidency> residents;
+	residents.reserve(entries.size());
+	for (auto &e : entries)
+	{
+		AssetResidency r;
+		r.key = e.second.key;
+		r.references = e.second.references;
+		r.instances = e.second.instances;
+		r.bytes = e.first->GetMemoryUsage();
+		residents.push_back(r);
+	}
+	sort(residents.begin(), residents.end(), [](const AssetResidency &a, const AssetResidency &b) { return a.key < b.key; });
+	return residents;
+}
+
+size_t AssetRegistry::GetResidentBytes() const
+{
+	size_t bytes = 0;
+	for (auto &e : entries)
+	{
+		bytes += e.first->GetMemoryUsage();
+	}
+	return bytes;
+}
+
+void AssetRegistry::Clear()
+{
+	for (auto &e : entries)
+	{
+		delete (AssetPack*)e.first;
+	}
+	entries.clear();
+	packOfKey.clear();
+}
@@ -0,0 +1,66 @@
+//-------------------------------Asset Registry----------------------------------
+//Loaded AssetPacks keyed by canonical file path and import options, so a file is
+//imported and uploaded once however many times it is loaded.
+//A pack lives while it has references or instances: GEngine::LoadAsset hands out a
+//reference per call and UnloadModel drops one, instances are counted from
+//GEngine::CreateInstance to DestroyInstance. When both reach 0 the pack is deleted,
+//its resources are retired through ResourceManager::Delete.
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Platform.h"
+#include "ResourcePack.h"
+using namespace std;
+
+//One loaded pack, see AssetRegistry::GetResidentSet
+struct AssetResidency
+{
+	string key;
+	UINT references;
+	UINT instances;
+	size_t bytes; //Graphics memory counted for the pack's owner, retired resources included
+};
+
+class AssetRegistry
+{
+public:
+	AssetRegistry();
+	~AssetRegistry();
+
+	//Full path, lower case with backslashes, then the options: "c:\models\rect.obj|bones=4"
+	static string MakeKey(const string &file, const string &options);
+	//Adds a reference to the pack loaded with key, NULL if there is none
+	AssetPack* Acquire(const string &key);
+	//Takes a newly loaded pack with one reference. False if the key is taken, the pack is left to the caller
+	bool Add(const string &key, AssetPack* pack);
+	//Drop a reference or an instance. True when that deleted the pack, false also for unknown packs
+	bool Release(AssetPack* pack);
+	void AddInstance(AssetPack* pack);
+	bool RemoveInstance(AssetPack* pack);
+
+	bool Contains(const AssetPack* pack) const;
+	UINT GetReferenceCount(const AssetPack* pack) const;
+	UINT GetInstanceCount(const AssetPack* pack) const;
+	size_t GetCount() const;
+	//Sorted by key
+	vector<AssetResidency> GetResidentSet() const;
+	size_t GetResidentBytes() const;
+	//Deletes every pack whatever its counts, for shutdown
+	void Clear();
+
+private:
+	struct Entry
+	{
+		string key;
+		UINT references;
+		UINT instances;
+	};
+	unordered_map<string, AssetPack*> packOfKey;
+	unordered_map<const AssetPack*, Entry> entries;
+	bool DeleteIfUnused(AssetPack* pack);
+	AssetRegistry(AssetRegistry const&);
+	AssetRegistry& operator=(AssetRegistry const&);
+};
@@ -28,6 +28,13 @@ struct FrameBufferData
 	float pad3[2];
 };
 
+//Per draw constants, one draw covers a chunk of a bucket
+struct DrawBufferData
+{
+	UINT instanceBase; //Offset of the chunk in the instance ring buffer
+	UINT pad[3];
+};
+
 struct InstanceData
 {
 	float	wVP[16];
@@ -0,0 +1,48 @@
+#include "DrawKey.h"
+
+static unsigned long long Field(unsigned long long value, int bits, int shift)
+{
+	return (value & ((1ull << bits) - 1)) << shift;
+}
+
+unsigned long long DrawKey::Make(unsigned int pass, bool translucent, float depth, unsigned int materialID, unsigned int meshID)
+{
+	if (!(depth > 0)) depth = 0; //Also catches NaN
+	if (depth > 1) depth = 1;
+	unsigned int maxDepth = (1u << depthBits) - 1;
+	unsigned int quantized = (unsigned int)(depth * maxDepth);
+	if (translucent)
+	{
+		quantized = maxDepth - quantized;
+	}
+	else
+	{
+		quantized &= ~((1u << (depthBits - opaqueDepthBits)) - 1);
+	}
+
+	return Field(pass, passBits, passShift) |
+		Field(translucent ? 1 : 0, 1, translucentShift) |
+		Field(quantized, depthBits, depthShift) |
+		Field(materialID, materialBits, materialShift) |
+		Field(meshID, meshBits, meshShift);
+}
+
+unsigned int DrawKey::GetPass(unsigned long long key)
+{
+	return (unsigned int)((key >> passShift) & ((1ull << passBits) - 1));
+}
+
+bool DrawKey::IsTranslucent(unsigned long long key)
+{
+	return ((key >> translucentShift) & 1) != 0;
+}
+
+unsigned int DrawKey::GetMaterial(unsigned long long key)
+{
+	return (unsigned int)((key >> materialShift) & ((1ull << materialBits) - 1));
+}
+
+unsigned int DrawKey::GetMesh(unsigned long long key)
+{
+	return (unsigned int)((key >> meshShift) & ((1ull << meshBits) - 1));
+}
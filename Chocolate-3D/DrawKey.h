@@ -0,0 +1,30 @@
+//Packed 64-bit draw sort key, draws are issued in ascending key order
+//| pass 8 | translucent 1 | depth 16 | material 19 | mesh 20 |
+//Pure CPU, no device access
+#pragma once
+
+class DrawKey
+{
+public:
+	static const int meshBits = 20;
+	static const int materialBits = 19;
+	static const int depthBits = 16;
+	static const int passBits = 8;
+	//Opaque draws only keep the top bits of depth, so material and mesh decide the order inside a depth bucket
+	static const int opaqueDepthBits = 4;
+
+	static const int meshShift = 0;
+	static const int materialShift = meshShift + meshBits;
+	static const int depthShift = materialShift + materialBits;
+	static const int translucentShift = depthShift + depthBits;
+	static const int passShift = translucentShift + 1;
+
+	//depth is view depth normalized to [0, 1].
+	//Opaque draws go front to back, translucent ones back to front after all opaque draws of the pass
+	static unsigned long long Make(unsigned int pass, bool translucent, float depth, unsigned int materialID, unsigned int meshID);
+
+	static unsigned int GetPass(unsigned long long key);
+	static bool IsTranslucent(unsigned long long key);
+	static unsigned int GetMaterial(unsigned long long key);
+	static unsigned int GetMesh(unsigned long long key);
+};
@@ -2,8 +2,11 @@
 #include <fstream>
 #include <sstream>
 #include <math.h>
+#include <chrono>
+#include <algorithm>
+#include <cfloat>
 #include "json11/json11.hpp"
-#include "Pipeline/DescFileLoader.h"
+#include "pipeline/DescFileLoader.h"
 using namespace std;
 using namespace json11;
 using namespace FileLoader;
@@ -18,9 +21,37 @@ float Saturate(float in)
 GEngine::GEngine()
 {
 	effect = NULL;
+	commandTarget = NULL;
+	frustumCulling = false;
+	multiViewCulling = false;
+	occlusionCulling = false;
+	occlusionWidth = 256;
+	occluderTriangleLimit = 4096;
+	compressTextures = true;
+	textureMipFilter = Mip_Box;
+	ZeroMemory(&occlusionStats, sizeof(occlusionStats));
+	bucketTaskSize = 512;
+	bucketUpdateTime = 0;
+	wvpUpdateTime = 0;
+	hierarchyUpdateTime = 0;
+	hierarchyUpdateCount = 0;
+	numBatches = 0;
+	boundMesh = NULL;
+	boundMaterial = NULL;
+	postMeshPack = NULL;
+	meshSortCounter = 0;
+	materialSortCounter = 0;
+	ZeroMemory(&stats, sizeof(stats));
 	numBonePerVertex = 4;
-	numBonePerBatch = 1024;
-	maxInstances = 256;
+	numBonePerBatch = 4096;
+	maxInstances = 4096;
+	bindMatrixRingSize = 4 * numBonePerBatch;
+	instanceRingSize = 4 * maxInstances;
+	drawConstantRingSize = 1024 * 256;
+	drawConstantRingID = -1;
+	ringFrame = 0;
+	loggedSkips = 0;
+	ZeroMemory(&drawData, sizeof(drawData));
 
 	vsync_enabled = false;
 	fullscreen = false;
@@ -50,31 +81,50 @@ GEngine::~GEngine()
 	Shutdown();
 }
 
-bool GEngine::Init(HWND window, bool fullscreen) 
+bool GEngine::Init(void* window, bool fullscreen) 
 {
 	resolutionX = 1280;
 	resolutionY = 720;
-	hwnd = window;
+	this->window = window;
+	occlusionBuffer.SetResolution(occlusionWidth, occlusionWidth * resolutionY / resolutionX);
 
 	bool result = PipeLine::Init(resolutionX, resolutionY, window, fullscreen);
 
 	if (!result)
 		return false;
 
-	result = InitBuffers();
-	if (!result)
+	return InitDefaults();
+}
+
+bool GEngine::InitHeadless(int width, int height)
+{
+	resolutionX = width;
+	resolutionY = height;
+	window = NULL;
+	occlusionBuffer.SetResolution(occlusionWidth, occlusionWidth * resolutionY / resolutionX);
+
+	if (!PipeLine::InitHeadless(resolutionX, resolutionY))
+		return false;
+
+	return InitDefaults();
+}
+
+bool GEngine::InitDefaults()
+{
+	if (!InitBuffers())
 		return false;
 
 	//int def = PipeLine::SamplerState().CreateFromFile("");
 	//PipeLine::SamplerState().Apply(def, 0xffff, Slot_Sampler_Default);
 	//int clamp = PipeLine::SamplerState().CreateFromFile("clamp");
 	//PipeLine::SamplerState().Apply(clamp, 0xffff, Slot_Sampler_Clamp);
-	PipeLine::SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	PipeLine::SetPrimitiveType(Topology_Triangle_List);
 	return true;
 }
 
 bool GEngine::InitBuffers()
 {
+	MemoryOwnerScope memoryScope("engine");
 
 	ResourceDesc descCB;
 	descCB.type = Resource_Buffer;
@@ -88,6 +138,13 @@ bool GEngine::InitBuffers()
 	if (frameBufferID == -1)
 		return false;
 
+	//Constant Buffer PerDraw
+	descCB.name = "DrawBuffer";
+	descCB.size[0] = sizeof(DrawBufferData);
+	drawBufferID = PipeLine::Resources().Create(descCB);
+	if (drawBufferID == -1)
+		return false;
+
 	ResourceDesc descSRV;
 	descSRV.type = Resource_Buffer;
 	descSRV.access = Access_Dynamic;
@@ -95,7 +152,7 @@ bool GEngine::InitBuffers()
 
 	//BindMatrix Buffer 
 	descSRV.name = "BindMatrixBuffer";
-	descSRV.size[0] = numBonePerBatch * sizeof(float[16]);
+	descSRV.size[0] = bindMatrixRingSize * sizeof(float[16]);
 	descSRV.elementStride = sizeof(float[16]);
 	animationMatrixBufferID = PipeLine::Resources().Create(descSRV);
 	if (animationMatrixBufferID == -1)
@@ -103,12 +160,26 @@ bool GEngine::InitBuffers()
 
 	//Instance Buffer 
 	descSRV.name = "Instance Buffer";
-	descSRV.size[0] = maxInstances * sizeof(InstanceData);
+	descSRV.size[0] = instanceRingSize * sizeof(InstanceData);
 	descSRV.elementStride = sizeof(InstanceData);
 	instanceBufferID = PipeLine::Resources().Create(descSRV);
 	if (instanceBufferID == -1)
 		return false;
 
+	bindMatrixRing.Reset(bindMatrixRingSize, FRAMES_IN_FLIGHT);
+	instanceRing.Reset(instanceRingSize, FRAMES_IN_FLIGHT);
+
+	//Constant ring, bound by range
+	if (PipeLine::SupportsConstantBufferRanges())
+	{
+		descCB.name = "DrawBuffer Ring";
+		descCB.size[0] = drawConstantRingSize;
+		drawConstantRingID = PipeLine::Resources().Create(descCB);
+		if (drawConstantRingID == -1)
+			return false;
+		drawConstantRing.Reset(drawConstantRingSize, FRAMES_IN_FLIGHT);
+	}
+
 	//Light Buffer
 	descSRV.name = "Light Buffer";
 	descSRV.size[0] = MaxLightNumber * sizeof(Light);
@@ -122,6 +193,8 @@ bool GEngine::InitBuffers()
 	PipeLine::Resources().SetBinding(Stage_Compute_Shader, Bind_Constant_Buffer, Slot_CBuffer_Frame, frameBufferID);
 	PipeLine::Resources().SetBinding(Stage_Geometry_Shader, Bind_Constant_Buffer, Slot_CBuffer_Frame, frameBufferID);
 
+	PipeLine::Resources().SetBinding(Stage_Vertex_Shader, Bind_Constant_Buffer, Slot_CBuffer_Object, drawBufferID);
+
 	PipeLine::Resources().SetBinding(Stage_Vertex_Shader, Bind_Shader_Resource, Slot_Texture_AnimMatrix, animationMatrixBufferID);
 
 	PipeLine::Resources().SetBinding(Stage_Vertex_Shader, Bind_Shader_Resource, Slot_Texture_Instance, instanceBufferID);
@@ -155,6 +228,12 @@ bool GEngine::Tiling()
 
 void GEngine::Shutdown()
 {
+	instances.Clear();
+	sceneTree.Clear();
+	assets.Clear();
+	postMeshPack = NULL;
+	postMesh = MeshResource();
+	CloseEffect();
 	PipeLine::Shutdown();
 	return;
 }
@@ -165,34 +244,100 @@ void GEngine::UpdateLight(vector<Light> lights)
 	lightList = lights;
 }
 
-void GEngine::UpdateBuckets()
+void GEngine::UpdateBounds()
 {
-	RenderPair key(NULL, NULL);
-	instanceBuckets.clear();
-	bindMatrixBuckets.clear();
-	vector<ModelInstance*> destroied;
-	for (ModelInstance* p : instances)
+	auto startTime = chrono::high_resolution_clock::now();
+	hierarchyUpdateCount = instances.UpdateWorldMatrices();
+	hierarchyUpdateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - startTime).count();
+	for (UINT i = 0; i < instances.GetCount(); i++)
 	{
-		if (!p->visible) continue;
-		if (p->IsDestroied())
+		if (instances.worldChanged[i])
 		{
-			destroied.push_back(p);
-			continue;
+			UpdateWorldBound(i);
+			sceneTree.Move(instances.boundProxies[i], instances.worldBounds[i]);
 		}
-		for (GraphicInstance &unit : p->components)
+	}
+}
+
+void GEngine::UpdateWorldBound(UINT slot)
+{
+	AABB &bound = instances.worldBounds[slot];
+	bound = ModelInstance::GetLocalBound(instances.cold[slot].components);
+	if (!bound.IsEmpty())
+		TransformBound(LoadAffine(instances.worldMatrices[slot]), bound.min, bound.max);
+}
+
+GEngine::PartialBucket & GEngine::BucketTask::Get(const RenderPair & key)
+{
+	auto it = slots.find(key);
+	if (it != slots.end())
+		return buckets[it->second];
+
+	slots[key] = numUsed;
+	return Add(key);
+}
+
+GEngine::PartialBucket & GEngine::BucketTask::Add(const RenderPair & key)
+{
+	if (numUsed == buckets.size())
+		buckets.push_back(PartialBucket());
+	PartialBucket &bucket = buckets[numUsed++];
+	bucket.key = key;
+	bucket.translucent = false;
+	bucket.depth = 1;
+	bucket.instanceData.clear();
+	bucket.bindMatrix.clear();
+	bucket.coverage.clear();
+	bucket.viewMask.clear();
+	return bucket;
+}
+
+void GEngine::FillBucketTask(BucketTask & task, size_t begin, size_t end, const aiMatrix4x4 & view, float pixelScale)
+{
+	task.slots.clear();
+	task.numUsed = 0;
+
+	//Tasks split components, not instances: find the instance owning the first component
+	size_t i = upper_bound(componentStart.begin(), componentStart.end(), begin) - componentStart.begin() - 1;
+	for (size_t c = begin; c < end; i++)
+	{
+		UINT slot = bucketCandidates[i];
+		vector<GraphicInstance> &components = instances.cold[slot].components;
+		AssetPack* pack = instances.cold[slot].pack;
+		const AABB &worldBound = instances.worldBounds[slot];
+		size_t first = c - componentStart[i];
+		size_t last = min(components.size(), end - componentStart[i]);
+		c += last - first;
+
+		const aiMatrix4x4 &wvp = candidateWVP[i];
+		bool animated = pack && pack->nodeList.size();
+		const aiMatrix4x4 &world = instances.worldMatrices[slot];
+		aiVector3D center = worldBound.IsEmpty() ? aiVector3D(world.a4, world.b4, world.c4) : worldBound.Center();
+		float viewDepth = view.c1 * center.x + view.c2 * center.y + view.c3 * center.z + view.c4;
+		float depth = (viewDepth - camera.zNear) / (camera.zFar - camera.zNear);
+		//Screen area of the bounding sphere, unbounded when the camera is inside it
+		float radius = worldBound.IsEmpty() ? 0 : worldBound.Extent().Length();
+		float coverage = FLT_MAX;
+		if (viewDepth > radius)
 		{
-			key.pMeshResource = unit.meshInstance.pResource;
-			key.pMaterialResource = unit.materialInstance.pResource;
-			if (!instanceBuckets.count(key)) instanceBuckets[key] = vector<InstanceData>();
-			if (!bindMatrixBuckets.count(key)) bindMatrixBuckets[key] = vector<aiMatrix4x4>();
+			float pixelRadius = radius * pixelScale / viewDepth;
+			coverage = 3.14159265f * pixelRadius * pixelRadius;
+		}
+		for (size_t u = first; u < last; u++)
+		{
+			GraphicInstance &unit = components[u];
+			RenderPair key(unit.meshInstance.pResource, unit.materialInstance.pResource);
+			//Translucent components get their own batch so they can be sorted back to front
+			bool translucent = unit.materialInstance.opacity < 1;
+			PartialBucket &bucket = translucent ? task.Add(key) : task.Get(key);
+			bucket.translucent = translucent;
+			bucket.depth = min(bucket.depth, depth);
 
 			//Update InstanceData
 			InstanceData iData;
 			ZeroMemory(&iData, sizeof(iData));
 
-			aiMatrix4x4 wvp = camera.GetProjectionMatrix()*camera.GetViewMatrix()*p->transform.transformMatrix;
-
-			memcpy(iData.worldMatrix, &p->transform.transformMatrix, sizeof(float[16]));
+			memcpy(iData.worldMatrix, &world, sizeof(float[16]));
 			memcpy(&iData.wVP, &wvp, sizeof(float[16]));
 			memcpy(&iData.diffuseColor, &unit.materialInstance.diffuseColor, sizeof(float[3]));
 			memcpy(&iData.specularColor, &unit.materialInstance.specularColor, sizeof(float[3]));
@@ -201,45 +346,310 @@ void GEngine::UpdateBuckets()
 			memcpy(&iData.specularTextureOffset, &unit.materialInstance.specularTextureOffset, sizeof(float[2]));
 			memcpy(&iData.emissiveTextureOffset, &unit.materialInstance.emissiveTextureOffset, sizeof(float[2]));
 			memcpy(&iData.normalTextureOffset, &unit.materialInstance.normalTextureOffset, sizeof(float[2]));
-			iData.bindMatrixOffset = bindMatrixBuckets[key].size();
-			iData.diffusePower = max(unit.materialInstance.diffusePower, 0);
-			iData.specularPower = max(unit.materialInstance.specularPower, 0);
-			iData.emissivePower = max(unit.materialInstance.emissivePower, 0);
+			iData.bindMatrixOffset = bucket.bindMatrix.size();
+			iData.diffusePower = max(unit.materialInstance.diffusePower, 0.0f);
+			iData.specularPower = max(unit.materialInstance.specularPower, 0.0f);
+			iData.emissivePower = max(unit.materialInstance.emissivePower, 0.0f);
 			iData.alphaFactor = Saturate(unit.materialInstance.opacity);
 			iData.diffuseBlendFactor = unit.materialInstance.pResource->diffuseMap == -1 ? 1 : Saturate(unit.materialInstance.diffuseBlendFactor);
 			iData.specularBlendFactor = unit.materialInstance.pResource->specularMap == -1 ? 1 : Saturate(unit.materialInstance.specularBlendFactor);
 			iData.emissiveBlendFactor = unit.materialInstance.pResource->ambientMap == -1 ? 1 : Saturate(unit.materialInstance.emissiveBlendFactor);
 			iData.refractiveIndex = unit.materialInstance.refractiveIndex;
-			iData.specularHardness = max(unit.materialInstance.specularHardness, 0);
-			iData.flags |= (p->pack && p->pack->nodeList.size() && unit.meshInstance.pResource->boneIndexID != -1); // Animation flag
+			iData.specularHardness = max(unit.materialInstance.specularHardness, 0.0f);
+			iData.flags |= (animated && unit.meshInstance.pResource->boneIndexID != -1); // Animation flag
 			iData.flags |= (iData.diffuseBlendFactor < 1) << 1;	//Diffuse texture flag
 			iData.flags |= (iData.specularBlendFactor < 1) << 2;	 //Specular texture flag
 			iData.flags |= (unit.materialInstance.pResource->normalMap != -1 && unit.materialInstance.normalTextureEnable) << 3; //Normal map flag
 			iData.flags |= (iData.emissiveBlendFactor < 1) << 4; //Emissive texture flag
 
-			instanceBuckets[key].push_back(move(iData));
+			bucket.instanceData.push_back(iData);
+			bucket.coverage.push_back(coverage);
+			bucket.viewMask.push_back(candidateMasks[i]);
 
 			//Update bind matrix
-			if(unit.meshInstance.bindMatrix.size() > 0)
-				bindMatrixBuckets[key].insert(bindMatrixBuckets[key].end(), unit.meshInstance.bindMatrix.begin(), unit.meshInstance.bindMatrix.end());
+			if (unit.meshInstance.bindMatrix.size() > 0)
+				bucket.bindMatrix.insert(bucket.bindMatrix.end(), unit.meshInstance.bindMatrix.begin(), unit.meshInstance.bindMatrix.end());
+		}
+	}
+}
+
+void GEngine::MergeBucketTasks(size_t numTasks)
+{
+	numBatches = 0;
+	batchSlots.clear();
+
+	//Prefix sum in task order: every partial bucket gets its place in the final batches
+	for (size_t t = 0; t < numTasks; t++)
+	{
+		BucketTask &task = bucketTasks[t];
+		for (size_t b = 0; b < task.numUsed; b++)
+		{
+			PartialBucket &bucket = task.buckets[b];
+			auto it = bucket.translucent ? batchSlots.end() : batchSlots.find(bucket.key);
+			if (it == batchSlots.end())
+			{
+				if (numBatches == batches.size())
+					batches.push_back(DrawBatch());
+				DrawBatch &batch = batches[numBatches];
+				batch.key = bucket.key;
+				batch.translucent = bucket.translucent;
+				batch.depth = 1;
+				batch.instanceData.clear();
+				batch.bindMatrix.clear();
+				batch.coverage.clear();
+				batch.viewMask.clear();
+				if (!bucket.translucent)
+					batchSlots[bucket.key] = numBatches;
+				bucket.batch = numBatches++;
+			}
+			else
+			{
+				bucket.batch = it->second;
+			}
+
+			DrawBatch &batch = batches[bucket.batch];
+			batch.depth = min(batch.depth, bucket.depth);
+			bucket.instanceBase = batch.instanceData.size();
+			bucket.bindMatrixBase = batch.bindMatrix.size();
+			batch.instanceData.resize(batch.instanceData.size() + bucket.instanceData.size());
+			batch.coverage.resize(batch.coverage.size() + bucket.coverage.size());
+			batch.viewMask.resize(batch.viewMask.size() + bucket.viewMask.size());
+			batch.bindMatrix.resize(batch.bindMatrix.size() + bucket.bindMatrix.size());
 		}
 	}
 
-	for (ModelInstance* p : destroied)
+	//Copy into disjoint ranges and rebase bind matrix offsets
+	threadPool.ParallelFor(numTasks, 1, [this](size_t, size_t begin, size_t end)
 	{
-		instances.erase(p);
-		delete p;
+		for (size_t t = begin; t < end; t++)
+		{
+			BucketTask &task = bucketTasks[t];
+			for (size_t b = 0; b < task.numUsed; b++)
+			{
+				const PartialBucket &bucket = task.buckets[b];
+				DrawBatch &batch = batches[bucket.batch];
+				InstanceData* dstInstance = &batch.instanceData[bucket.instanceBase];
+				for (size_t i = 0; i < bucket.instanceData.size(); i++)
+				{
+					dstInstance[i] = bucket.instanceData[i];
+					dstInstance[i].bindMatrixOffset += bucket.bindMatrixBase;
+				}
+				if (!bucket.coverage.empty())
+				{
+					memcpy(&batch.coverage[bucket.instanceBase], &bucket.coverage[0], sizeof(float) * bucket.coverage.size());
+					memcpy(&batch.viewMask[bucket.instanceBase], &bucket.viewMask[0], sizeof(UINT) * bucket.viewMask.size());
+				}
+				if (!bucket.bindMatrix.empty())
+				{
+					memcpy(&batch.bindMatrix[bucket.bindMatrixBase], &bucket.bindMatrix[0], sizeof(aiMatrix4x4) * bucket.bindMatrix.size());
+				}
+			}
+		}
+	});
+}
+
+UINT GEngine::GetViewBit(const Pass & pass) const
+{
+	switch (pass.view)
+	{
+	case View_Camera:
+		return viewCameraBit;
+	case View_Voxel:
+		return viewVoxelBit;
+	case View_Light:
+		if (pass.viewLight < lightList.size() && viewFirstLightBit + pass.viewLight < 31)
+			return 1u << (viewFirstLightBit + pass.viewLight);
+		return viewAllBit;
+	default:
+		return viewAllBit;
 	}
 }
 
-void GEngine::ApplyAnimation()
+void GEngine::BuildViewSet()
+{
+	//Added in bit order: camera, voxel volume, then lights
+	viewSet.Clear();
+	viewSet.AddFrustum(camera.GetViewProjectionMatrix());
+	//The voxel grid is centered on the origin
+	aiVector3D halfExtent(0.5f * voxelDimention[0] * voxelSize[0], 0.5f * voxelDimention[1] * voxelSize[1], 0.5f * voxelDimention[2] * voxelSize[2]);
+	viewSet.AddVolume(AABB(-halfExtent, halfExtent));
+	for (size_t i = 0; i < lightList.size() && viewFirstLightBit + i < 31; i++)
+	{
+		aiMatrix4x4 lightViewProjection;
+		memcpy(&lightViewProjection, lightList[i].vP, sizeof(float[16]));
+		viewSet.AddFrustum(lightViewProjection);
+	}
+}
+
+void GEngine::UpdateBuckets(UINT requiredViews)
 {
-	for (ModelInstance* p : instances)
+	auto startTime = chrono::high_resolution_clock::now();
+	UpdateBounds();
+
+	bucketCandidates.clear();
+	candidateMasks.clear();
+	if (multiViewCulling)
+	{
+		//One linear pass over the pool bounds tests every view at once
+		BuildViewSet();
+		candidateMasks.resize(instances.GetCount());
+		threadPool.ParallelFor(instances.GetCount(), 4 * bucketTaskSize, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t slot = begin; slot < end; slot++)
+			{
+				candidateMasks[slot] = viewSet.Test(instances.worldBounds[slot]) | viewAllBit;
+			}
+		});
+		for (UINT i = 0; i < instances.GetCount(); i++)
+		{
+			if (candidateMasks[i] & requiredViews)
+			{
+				candidateMasks[bucketCandidates.size()] = candidateMasks[i];
+				bucketCandidates.push_back(i);
+			}
+		}
+		candidateMasks.resize(bucketCandidates.size());
+	}
+	else if (frustumCulling)
 	{
-		if (!p->IsDestroied() && p->visible)
+		candidateHandles.clear();
+		QueryFrustum(Frustum(camera.GetViewProjectionMatrix()), candidateHandles);
+		for (InstanceHandle handle : candidateHandles)
 		{
-			p->ApplyAnimation();
+			bucketCandidates.push_back(instances.GetSlot(handle));
 		}
+		//Tree order depends on its history, go back to pool order
+		sort(bucketCandidates.begin(), bucketCandidates.end());
+	}
+	else
+	{
+		bucketCandidates.resize(instances.GetCount());
+		for (UINT i = 0; i < instances.GetCount(); i++)
+		{
+			bucketCandidates[i] = i;
+		}
+	}
+	candidateMasks.resize(bucketCandidates.size(), ~0u);
+	size_t numCandidates = 0;
+	for (size_t i = 0; i < bucketCandidates.size(); i++)
+	{
+		UINT slot = bucketCandidates[i];
+		if (!instances.visible[slot] || instances.cold[slot].components.empty())
+			continue;
+		bucketCandidates[numCandidates] = slot;
+		candidateMasks[numCandidates++] = candidateMasks[i];
+	}
+	bucketCandidates.resize(numCandidates);
+	candidateMasks.resize(numCandidates);
+
+	aiMatrix4x4 view = camera.GetViewMatrix();
+	aiMatrix4x4 viewProjection = camera.GetViewProjectionMatrix();
+	//Pixels per world unit at view depth 1
+	float pixelScale = camera.GetProjectionMatrix().b2 * resolutionY * 0.5f;
+	if (occlusionCulling)
+		OcclusionCull(viewProjection, requiredViews);
+
+	componentStart.resize(bucketCandidates.size() + 1);
+	componentStart[0] = 0;
+	for (size_t i = 0; i < bucketCandidates.size(); i++)
+	{
+		componentStart[i + 1] = componentStart[i] + instances.cold[bucketCandidates[i]].components.size();
+	}
+	size_t numComponents = componentStart.back();
+	//Drop the sentinel so upper_bound never lands past the last instance
+	componentStart.pop_back();
+
+	size_t numTasks = ThreadPool::GetTaskCount(numComponents, bucketTaskSize);
+	if (bucketTasks.size() < numTasks)
+		bucketTasks.resize(numTasks);
+
+	//wVP of every visible instance in one batched pass, view and projection are cached on the camera
+	auto wvpStartTime = chrono::high_resolution_clock::now();
+	candidateWorld.resize(bucketCandidates.size());
+	candidateWVP.resize(bucketCandidates.size());
+	for (size_t i = 0; i < bucketCandidates.size(); i++)
+	{
+		candidateWorld[i] = &instances.worldMatrices[bucketCandidates[i]];
+	}
+	threadPool.ParallelFor(bucketCandidates.size(), 4 * bucketTaskSize, [&](size_t, size_t begin, size_t end)
+	{
+		MultiplyMatrixBatch(viewProjection, &candidateWorld[begin], end - begin, &candidateWVP[begin]);
+	});
+	wvpUpdateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - wvpStartTime).count();
+
+	threadPool.ParallelFor(numComponents, bucketTaskSize, [&](size_t taskIndex, size_t begin, size_t end)
+	{
+		FillBucketTask(bucketTasks[taskIndex], begin, end, view, pixelScale);
+	});
+	MergeBucketTasks(numTasks);
+
+	bucketUpdateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void GEngine::OcclusionCull(const aiMatrix4x4 & viewProjection, UINT requiredViews)
+{
+	auto startTime = chrono::high_resolution_clock::now();
+	occlusionBuffer.Clear();
+	for (UINT slot : bucketCandidates)
+	{
+		if (!instances.occluders[slot])
+			continue;
+		aiMatrix4x4 wvp = viewProjection * instances.worldMatrices[slot];
+		for (const GraphicInstance &unit : instances.cold[slot].components)
+		{
+			const MeshResource* mesh = unit.meshInstance.pResource;
+			if (mesh && !mesh->occluderIndices.empty())
+				occlusionBuffer.AddOccluder(&mesh->occluderPositions[0], &mesh->occluderIndices[0], mesh->occluderIndices.size(), wvp);
+		}
+	}
+	//Tile rows are independent, one task per row
+	threadPool.ParallelFor(occlusionBuffer.GetTileRowCount(), 1, [this](size_t, size_t begin, size_t end)
+	{
+		occlusionBuffer.Rasterize((UINT)begin, (UINT)end);
+	});
+
+	candidateVisible.resize(bucketCandidates.size());
+	threadPool.ParallelFor(bucketCandidates.size(), bucketTaskSize, [&](size_t, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			UINT slot = bucketCandidates[i];
+			candidateVisible[i] = instances.occluders[slot] || occlusionBuffer.IsVisible(instances.worldBounds[slot], viewProjection);
+		}
+	});
+	//The buffer only holds the camera's view: with multi-view culling an occluded instance
+	//just loses the camera bit and stays for the other views that need it
+	size_t numVisible = 0;
+	UINT numOccluded = 0;
+	for (size_t i = 0; i < bucketCandidates.size(); i++)
+	{
+		UINT mask = candidateMasks[i];
+		if (!candidateVisible[i])
+		{
+			numOccluded++;
+			mask = multiViewCulling ? mask & ~viewCameraBit : 0;
+		}
+		if (mask & requiredViews)
+		{
+			bucketCandidates[numVisible] = bucketCandidates[i];
+			candidateMasks[numVisible++] = mask;
+		}
+	}
+
+	occlusionStats.occluderTriangles = occlusionBuffer.GetTriangleCount();
+	occlusionStats.tested = bucketCandidates.size();
+	occlusionStats.occluded = numOccluded;
+	bucketCandidates.resize(numVisible);
+	candidateMasks.resize(numVisible);
+	occlusionStats.time = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void GEngine::ApplyAnimation()
+{
+	for (UINT i = 0; i < instances.GetCount(); i++)
+	{
+		InstancePool::ColdData &data = instances.cold[i];
+		data.nodesChanged = instances.visible[i] && ModelInstance::ApplyAnimation(data.pack, instances.animationIDs[i], instances.animationTimes[i], data.components, data.nodeGlobals);
 	}
 }
 
@@ -249,21 +659,162 @@ void GEngine::Instancing(const RenderPair & rpair, const vector<InstanceData>& i
 		return;
 
 	//Bind mesh to pipeLine
-	rpair.Render();
+	BindRenderPair(rpair);
+
+	//Draw the bucket in chunks that fit one draw, each chunk is appended to the ring buffers
+	stats.instancesSkipped += SplitInstanceChunks(instanceData, bindMatrix.size(), maxInstances, numBonePerBatch, instanceChunks);
+	for (const InstanceChunk &chunk : instanceChunks)
+	{
+		//Chunks fit one draw and the rings hold several, allocations only fail when the ring sizes
+		//are set below the draw limits. The chunk is not drawn then
+		size_t bindMatrixBase = 0;
+		bool discard = false;
+		if (chunk.numBindMatrix > 0)
+		{
+			if (!bindMatrixRing.Allocate(chunk.numBindMatrix, 1, bindMatrixBase, discard))
+				continue;
+			frameCommands.UpdateBuffer(animationMatrixBufferID, &bindMatrix[chunk.firstBindMatrix], sizeof(float[16])*chunk.numBindMatrix, sizeof(float[16])*bindMatrixBase, discard);
+		}
+
+		size_t instanceBase = 0;
+		if (!instanceRing.Allocate(chunk.numInstances, 1, instanceBase, discard))
+			continue;
+		chunkInstanceData.resize(chunk.numInstances);
+		RebaseInstanceChunk(&instanceData[0], chunk, bindMatrixBase, &chunkInstanceData[0]);
+		frameCommands.UpdateBuffer(instanceBufferID, &chunkInstanceData[0], sizeof(InstanceData)*chunk.numInstances, sizeof(InstanceData)*instanceBase, discard);
 
-	//Update instance buffer and bindMatrix buffer
-	if(instanceData.size() > 0)
-		PipeLine::Resources().UpdateResourceData(instanceBufferID, &instanceData[0], sizeof(InstanceData)*instanceData.size());
-	if(bindMatrix.size() > 0)
-		PipeLine::Resources().UpdateResourceData(animationMatrixBufferID, &bindMatrix[0], sizeof(float[16])*bindMatrix.size());
-	//Draw
-	PipeLine::Draw(rpair.pMeshResource->indexCount, instanceData.size());
+		drawData.instanceBase = instanceBase;
+		size_t drawOffset;
+		if (drawConstantRingID != -1 && drawConstantRing.Allocate(256, 256, drawOffset, discard))
+		{
+			frameCommands.UpdateBuffer(drawConstantRingID, &drawData, sizeof(drawData), drawOffset, discard);
+			frameCommands.BindConstantRange(Stage_Vertex_Shader, Slot_CBuffer_Object, drawConstantRingID, drawOffset, 256);
+		}
+		else
+		{
+			frameCommands.UpdateBuffer(drawBufferID, &drawData, sizeof(drawData), 0, true);
+		}
+
+		//Draw
+		frameCommands.Draw(rpair.pMeshResource->indexCount, chunk.numInstances);
+		stats.drawCalls++;
+	}
+}
+
+void GEngine::BindRenderPair(const RenderPair & rpair)
+{
+	//Skip bindings the previous draw of the pass already made
+	if (rpair.pMeshResource != boundMesh)
+	{
+		if (rpair.pMeshResource) rpair.pMeshResource->Record(frameCommands);
+		boundMesh = rpair.pMeshResource;
+		stats.meshBinds++;
+	}
+	if (rpair.pMaterialResource != boundMaterial)
+	{
+		if (rpair.pMaterialResource) rpair.pMaterialResource->Record(frameCommands);
+		boundMaterial = rpair.pMaterialResource;
+		stats.materialBinds++;
+	}
+}
+
+void GEngine::BuildDrawList(UINT numPasses)
+{
+	drawList.clear();
+	UINT unsortedChanges = 0;
+	for (UINT pass = 0; pass < numPasses; pass++)
+	{
+		for (size_t i = 0; i < numBatches; i++)
+		{
+			const DrawBatch &batch = batches[i];
+			UINT materialID = batch.key.pMaterialResource ? batch.key.pMaterialResource->sortID : 0;
+			UINT meshID = batch.key.pMeshResource ? batch.key.pMeshResource->sortID : 0;
+			SortItem item;
+			item.key = DrawKey::Make(pass, batch.translucent, batch.depth, materialID, meshID);
+			item.value = (UINT)i;
+			drawList.push_back(item);
+
+			//Changes the unsorted order would make, for stats
+			const RenderPair* previous = i > 0 ? &batches[i - 1].key : NULL;
+			unsortedChanges += !previous || previous->pMeshResource != batch.key.pMeshResource;
+			unsortedChanges += !previous || previous->pMaterialResource != batch.key.pMaterialResource;
+		}
+	}
+	RadixSort(drawList, drawListScratch);
+
+	UINT sortedChanges = 0;
+	for (size_t i = 0; i < drawList.size(); i++)
+	{
+		bool passStart = i == 0 || DrawKey::GetPass(drawList[i - 1].key) != DrawKey::GetPass(drawList[i].key);
+		const RenderPair &current = batches[drawList[i].value].key;
+		const RenderPair* previous = passStart ? NULL : &batches[drawList[i - 1].value].key;
+		sortedChanges += !previous || previous->pMeshResource != current.pMeshResource;
+		sortedChanges += !previous || previous->pMaterialResource != current.pMaterialResource;
+	}
+	stats.bindsAvoided = unsortedChanges > sortedChanges ? unsortedChanges - sortedChanges : 0;
+	stats.batches = (UINT)numBatches;
+}
+
+void GEngine::DrawPass(UINT passIndex, size_t & cursor, float minCoverage, UINT viewBit)
+{
+	//Pass bindings may have replaced what was bound before
+	boundMesh = NULL;
+	boundMaterial = NULL;
+	for (; cursor < drawList.size() && DrawKey::GetPass(drawList[cursor].key) == passIndex; cursor++)
+	{
+		const DrawBatch &batch = batches[drawList[cursor].value];
+		size_t numInstances = batch.instanceData.size();
+		size_t numCulled = 0;
+		for (size_t i = 0; i < numInstances; i++)
+		{
+			bool inView = (batch.viewMask[i] & viewBit) != 0;
+			viewCulled[passIndex] += !inView;
+			coverageCulled[passIndex] += inView && batch.coverage[i] < minCoverage;
+			numCulled += !inView || batch.coverage[i] < minCoverage;
+		}
+		if (numCulled == 0)
+		{
+			Instancing(batch.key, batch.instanceData, batch.bindMatrix);
+			continue;
+		}
+		if (numCulled == numInstances)
+			continue;
+
+		passInstanceData.clear();
+		passBindMatrix.clear();
+		for (size_t i = 0; i < numInstances; i++)
+		{
+			if (!(batch.viewMask[i] & viewBit) || batch.coverage[i] < minCoverage)
+				continue;
+			//Bind matrices of an instance run up to the next instance's offset
+			UINT begin = batch.instanceData[i].bindMatrixOffset;
+			UINT end = i + 1 < numInstances ? batch.instanceData[i + 1].bindMatrixOffset : batch.bindMatrix.size();
+			passInstanceData.push_back(batch.instanceData[i]);
+			passInstanceData.back().bindMatrixOffset = passBindMatrix.size();
+			passBindMatrix.insert(passBindMatrix.end(), batch.bindMatrix.begin() + begin, batch.bindMatrix.begin() + end);
+		}
+		Instancing(batch.key, passInstanceData, passBindMatrix);
+	}
 }
 
 void GEngine::LoadPostMesh(string file)
 {
-	auto p = LoadAsset(file);
-	postMesh = p->meshs[0];
+	UsePostMesh(LoadAsset(file));
+}
+
+void GEngine::LoadPostMesh(Model & model, const string & name)
+{
+	UsePostMesh(LoadAsset(model, name));
+}
+
+void GEngine::UsePostMesh(AssetPack * pack)
+{
+	//The reference is kept while the mesh is in use
+	AssetPack* previous = postMeshPack;
+	postMeshPack = pack;
+	postMesh = postMeshPack->meshs[0];
+	if (previous)
+		UnloadModel(previous);
 }
 
 bool GEngine::UpdateFrameBuffer()
@@ -293,20 +844,155 @@ bool GEngine::UpdateLightBuffer()
 	return PipeLine::Resources().UpdateResourceData(lightBufferID, &lightList[0], sizeof(Light)*lightList.size());
 }
 
-ModelInstance * GEngine::CreateInstance(const ModelInstance &bluePrint)
+//Tree user data is handle + 1, so that no live instance is stored as NULL
+static void* ToUserData(InstanceHandle handle)
+{
+	return (void*)((uintptr_t)handle + 1);
+}
+
+static InstanceHandle FromUserData(void* userData)
 {
-	ModelInstance * instance = new ModelInstance(bluePrint);
-	instances.insert(instance);
-	return instance;
+	return (InstanceHandle)((uintptr_t)userData - 1);
 }
 
+InstanceHandle GEngine::CreateInstance(const ModelInstance &bluePrint)
+{
+	InstanceHandle handle = instances.Create(bluePrint);
+	if (handle == InstancePool::INVALID_HANDLE)
+		return handle;
+	assets.AddInstance(bluePrint.pack);
+	UINT slot = instances.GetSlot(handle);
+	UpdateWorldBound(slot);
+	instances.boundProxies[slot] = sceneTree.Insert(instances.worldBounds[slot], ToUserData(handle));
+	return handle;
+}
+
+bool GEngine::DestroyInstance(InstanceHandle handle)
+{
+	int slot = instances.GetSlot(handle);
+	if (slot < 0)
+		return false;
+	sceneTree.Remove(instances.boundProxies[slot]);
+	AssetPack* pack = instances.cold[slot].pack;
+	instances.Destroy(handle);
+	if (assets.RemoveInstance(pack))
+		ForgetPack();
+	return true;
+}
+
+void GEngine::QueryFrustum(const Frustum & frustum, vector<InstanceHandle>& outInstances)
+{
+	queryResult.clear();
+	sceneTree.QueryFrustum(frustum, queryResult);
+	for (void* p : queryResult)
+	{
+		//Tree leaves are fat, recheck the tight bound
+		InstanceHandle handle = FromUserData(p);
+		if (frustum.Overlaps(instances.worldBounds[instances.GetSlot(handle)]))
+			outInstances.push_back(handle);
+	}
+}
+
+void GEngine::QueryBox(const AABB & box, vector<InstanceHandle>& outInstances)
+{
+	queryResult.clear();
+	sceneTree.QueryBox(box, queryResult);
+	for (void* p : queryResult)
+	{
+		InstanceHandle handle = FromUserData(p);
+		if (box.Overlaps(instances.worldBounds[instances.GetSlot(handle)]))
+			outInstances.push_back(handle);
+	}
+}
+
+void GEngine::QuerySphere(const BoundingSphere & sphere, vector<InstanceHandle>& outInstances)
+{
+	queryResult.clear();
+	sceneTree.QuerySphere(sphere, queryResult);
+	for (void* p : queryResult)
+	{
+		InstanceHandle handle = FromUserData(p);
+		if (sphere.Overlaps(instances.worldBounds[instances.GetSlot(handle)]))
+			outInstances.push_back(handle);
+	}
+}
+
+static bool PickTest(void* context, void* userData, const Ray &ray, float maxDistance, float &outDistance)
+{
+	//Tree leaves are fat, test against the tight world bound
+	InstancePool* pool = (InstancePool*)context;
+	UINT slot = pool->GetSlot(FromUserData(userData));
+	return pool->visible[slot] && ray.Intersects(pool->worldBounds[slot], maxDistance, outDistance);
+}
+
+InstanceHandle GEngine::Pick(const Ray & ray, float maxDistance, float * outDistance)
+{
+	void* hit = sceneTree.RayCast(ray, maxDistance, outDistance, PickTest, &instances);
+	return hit ? FromUserData(hit) : InstancePool::INVALID_HANDLE;
+}
+
+
+//The texture data holds every mip level, the resource is created with all of them
+static int CreateMaterialTexture(ResourceDesc desc, TextureData &texture)
+{
+	desc.size[0] = texture.width;
+	desc.size[1] = texture.height;
+	desc.mipLevel = texture.mipLevels;
+	switch (texture.codec)
+	{
+	case Codec_BC1: desc.format = Format_BC1_UNORM; break;
+	case Codec_BC3: desc.format = Format_BC3_UNORM; break;
+	case Codec_BC5: desc.format = Format_BC5_UNORM; break;
+	default: desc.format = Format_R8G8B8A8_UNORM; break;
+	}
+	return PipeLine::Resources().Create(desc, texture.GetImageDataPtr(), texture.imageSize);
+}
+
+string GEngine::MakeAssetKey(const string & name) const
+{
+	//Everything LoadAsset does with the model depends on these
+	char options[64];
+	sprintf_s(options, "bones=%u;occluders=%u;bc=%u;mips=%u", numBonePerVertex, occluderTriangleLimit, compressTextures ? 1 : 0, (UINT)textureMipFilter);
+	return AssetRegistry::MakeKey(name, options);
+}
 
 AssetPack * GEngine::LoadAsset(string file)
 {
-	AssetPack* assetPack = new AssetPack();
+	string key = MakeAssetKey(file);
+	AssetPack* assetPack = assets.Acquire(key);
+	if (assetPack)
+		return assetPack;
+
+	assetPack = new AssetPack();
+	assets.Add(key, assetPack);
+	assetPack->memoryOwner = "asset:" + key;
+	MemoryOwnerScope memoryScope(assetPack->memoryOwner);
 	Model model;
+	model.compressTextures = compressTextures;
+	model.mipFilter = textureMipFilter;
+	model.textureThreads = &threadPool;
 	model.LoadFileD3D(file);
+	FillAssetPack(*assetPack, model);
+	return assetPack;
+}
 
+AssetPack * GEngine::LoadAsset(Model & model, const string & name)
+{
+	string key = MakeAssetKey(name);
+	AssetPack* assetPack = assets.Acquire(key);
+	if (assetPack)
+		return assetPack;
+
+	assetPack = new AssetPack();
+	assets.Add(key, assetPack);
+	assetPack->memoryOwner = "asset:" + key;
+	MemoryOwnerScope memoryScope(assetPack->memoryOwner);
+	FillAssetPack(*assetPack, model);
+	return assetPack;
+}
+
+void GEngine::FillAssetPack(AssetPack & pack, Model & model)
+{
 	ResourceDesc descVB, descIB, descTX;
 	descVB.name = "Vertex Buffer";
 	descVB.type = Resource_Buffer;
@@ -321,22 +1007,30 @@ AssetPack * GEngine::LoadAsset(string file)
 
 	descTX.name = "DiffuseMap";
 	descTX.type = Resource_Texture2D;
-	descTX.bindFlag = Bind_Shader_Resource | Bind_Render_Target;
+	descTX.bindFlag = Bind_Shader_Resource;
 	descTX.access = Access_Default;
-	descTX.format = DXGI_FORMAT_R8G8B8A8_UNORM;
-	descTX.mipLevel = 0;
 
-	assetPack->meshs.resize(model.meshList.size());
-	assetPack->animationList = model.animationList;
-	assetPack->nodeList = model.nodeList;
+	pack.meshs.resize(model.meshList.size());
+	pack.animationList = model.animationList;
+	pack.nodeList = model.nodeList;
 	
 	for (int i = 0; i < model.meshList.size(); i++)
 	{
-		MeshResource &dstMesh = assetPack->meshs[i];
+		MeshResource &dstMesh = pack.meshs[i];
 		Mesh &srcMesh = model.meshList[i];
 
 		dstMesh.boneList = srcMesh.boneList;
 		dstMesh.nodeID = srcMesh.nodeID;
+		dstMesh.sortID = meshSortCounter++;
+		for (const aiVector3D &position : srcMesh.vertexPositions)
+		{
+			dstMesh.bound.Expand(position);
+		}
+		//Skinned vertices can leave the bind pose bound, keep some slack
+		if (model.hasAnimation && !dstMesh.bound.IsEmpty())
+		{
+			dstMesh.bound.Inflate(0.25f * dstMesh.bound.Extent().Length());
+		}
 
 		unsigned int dataSize;
 		void* dataPtr;
@@ -399,51 +1093,50 @@ AssetPack * GEngine::LoadAsset(string file)
 			descIB.size[0] = dataSize;
 			dstMesh.indiceID = PipeLine::Resources().Create(descIB, dataPtr, dataSize);
 			dstMesh.indexCount = srcMesh.indices.size();
+			//Skinned meshes move away from their bind pose, only static ones are safe occluders
+			if (!model.hasAnimation && srcMesh.indices.size() / 3 <= occluderTriangleLimit)
+			{
+				dstMesh.occluderPositions = srcMesh.vertexPositions;
+				dstMesh.occluderIndices = srcMesh.indices;
+			}
 		}
 	}
 	
-	assetPack->materials.resize(model.materialList.size());
+	pack.materials.resize(model.materialList.size());
 	for (int i = 0; i < model.materialList.size(); i++)
 	{
-		MaterialResource &dstMaterial = assetPack->materials[i];
+		MaterialResource &dstMaterial = pack.materials[i];
 		Material &srcMaterial = model.materialList[i];
+		dstMaterial.sortID = materialSortCounter++;
 
 		if (srcMaterial.hasDiffuseMap)
 		{
-			descTX.size[0] = srcMaterial.diffuseMap.width;
-			descTX.size[1] = srcMaterial.diffuseMap.height;
-			dstMaterial.diffuseMap = PipeLine::Resources().Create(descTX, srcMaterial.diffuseMap.GetImageDataPtr());
+			dstMaterial.diffuseMap = CreateMaterialTexture(descTX, srcMaterial.diffuseMap);
 		}
 
 		if (srcMaterial.hasSpecularMap)
 		{
-			descTX.size[0] = srcMaterial.specularMap.width;
-			descTX.size[1] = srcMaterial.specularMap.height;
-			dstMaterial.specularMap = PipeLine::Resources().Create(descTX, srcMaterial.specularMap.GetImageDataPtr());
+			dstMaterial.specularMap = CreateMaterialTexture(descTX, srcMaterial.specularMap);
 		}
 
 		if (srcMaterial.hasNormalMap)
 		{
-			descTX.size[0] = srcMaterial.normalMap.width;
-			descTX.size[1] = srcMaterial.normalMap.height;
-			dstMaterial.normalMap = PipeLine::Resources().Create(descTX, srcMaterial.normalMap.GetImageDataPtr());
+			dstMaterial.normalMap = CreateMaterialTexture(descTX, srcMaterial.normalMap);
 		}
 
 		if (srcMaterial.hasAmbientMap)
 		{
-			descTX.size[0] = srcMaterial.ambientMap.width;
-			descTX.size[1] = srcMaterial.ambientMap.height;
-			dstMaterial.ambientMap = PipeLine::Resources().Create(descTX, srcMaterial.ambientMap.GetImageDataPtr());
+			dstMaterial.ambientMap = CreateMaterialTexture(descTX, srcMaterial.ambientMap);
 		}
 	}
-	vector<GraphicInstance> &components = assetPack->defaultInstance.components;
+	vector<GraphicInstance> &components = pack.defaultInstance.components;
 	components.resize(model.meshList.size());
 	for (int i = 0; i < model.meshList.size(); i++)
 	{
 		Mesh &srcMesh = model.meshList[i];
 		Material &srcMaterial = model.materialList[srcMesh.materialID];
-		components[i].meshInstance = MeshInstance(&assetPack->meshs[i]);
-		components[i].materialInstance.pResource = &assetPack->materials[srcMesh.materialID];
+		components[i].meshInstance = MeshInstance(&pack.meshs[i]);
+		components[i].materialInstance.pResource = &pack.materials[srcMesh.materialID];
 		components[i].materialInstance.opacity = srcMaterial.opacity;
 		components[i].materialInstance.diffusePower = srcMaterial.diffusePower;
 
@@ -455,13 +1148,21 @@ AssetPack * GEngine::LoadAsset(string file)
 		memcpy(components[i].materialInstance.specularColor, srcMaterial.specular, sizeof(float[3]));
 		memcpy(components[i].materialInstance.emissiveColor, srcMaterial.ambient, sizeof(float[3]));
 	}
-
-	return assetPack;
 }
 
-void GEngine::UnloadModel(UINT modelID)
+bool GEngine::UnloadModel(AssetPack * pack)
 {
+	if (!assets.GetReferenceCount(pack))
+		return false;
+	if (assets.Release(pack))
+		ForgetPack();
+	return true;
+}
 
+void GEngine::ForgetPack()
+{
+	boundMesh = NULL;
+	boundMaterial = NULL;
 }
 
 void GEngine::Render(const PassOperation & cfg)
@@ -501,25 +1202,78 @@ void GEngine::Render(const PassOperation & cfg)
 
 void GEngine::Render(const string &renderer)
 {
+	ZeroMemory(&stats, sizeof(stats));
+	PipeLine::ResetBindingStats();
+	//Data written before the last Swap becomes part of the in-flight frames
+	if (PipeLine::GetFrameIndex() != ringFrame)
+	{
+		ringFrame = PipeLine::GetFrameIndex();
+		bindMatrixRing.BeginFrame();
+		instanceRing.BeginFrame();
+		drawConstantRing.BeginFrame();
+	}
+	size_t ringDiscards = RingDiscardCount();
 	ApplyAnimation();
-	UpdateBuckets();
 	auto &operations = effect->renderer[renderer];
+
+	UINT numPasses = 0;
+	UINT requiredViews = 0;
 	for (auto& op : operations)
 	{
-		op->Execute();
 		if (op->type == Operation_Pass)
 		{
-			for (auto& e : instanceBuckets)
-			{
-				Instancing(e.first, e.second, bindMatrixBuckets[e.first]);
-			}
+			numPasses++;
+			requiredViews |= GetViewBit(*((PassOperation*)op)->GetPass());
+		}
+	}
+	UpdateBuckets(requiredViews);
+	BuildDrawList(numPasses);
+	coverageCulled.assign(numPasses, 0);
+	viewCulled.assign(numPasses, 0);
+
+	frameCommands.Clear();
+	UINT passIndex = 0;
+	size_t cursor = 0;
+	for (auto& op : operations)
+	{
+		op->Record(frameCommands);
+		if (op->type == Operation_Pass)
+		{
+			const Pass* pass = ((PassOperation*)op)->GetPass();
+			//Coverage is computed from the main camera, shadow and voxel views see other sizes
+			float minCoverage = pass->view == View_Camera ? pass->minCoverage : 0;
+			DrawPass(passIndex++, cursor, minCoverage, multiViewCulling ? GetViewBit(*pass) : ~0u);
 		}
 		else if (op->type == Operation_Post_Proc)
 		{
-			postMesh.Render();
-			PipeLine::Draw(6, 1);
+			postMesh.Record(frameCommands);
+			boundMesh = NULL;
+			frameCommands.Draw(6, 1);
 		}
 	}
+	frameCommands.Replay(commandTarget ? *commandTarget : pipelineTarget);
+	BindingStats binding = PipeLine::GetBindingStats();
+	stats.stateCalls = binding.issued;
+	stats.stateCallsSkipped = binding.skipped;
+	stats.uploadDiscards = (UINT)(RingDiscardCount() - ringDiscards);
+	//Logged when the count changes, not every frame
+	if (stats.instancesSkipped != loggedSkips)
+	{
+		char message[128];
+		sprintf_s(message, "GEngine: %u instances skipped, they need more than %u bind matrices\n", stats.instancesSkipped, numBonePerBatch);
+		OutputDebugStringA(message);
+		loggedSkips = stats.instancesSkipped;
+	}
+}
+
+size_t GEngine::RingDiscardCount() const
+{
+	return bindMatrixRing.GetDiscardCount() + instanceRing.GetDiscardCount() + drawConstantRing.GetDiscardCount();
+}
+
+const CommandBuffer & GEngine::GetFrameCommands() const
+{
+	return frameCommands;
 }
 
 bool GEngine::LoadEffect(const string & filePath)
@@ -1,21 +1,33 @@
 #pragma once
-#include <windows.h>
+#include "Platform.h"
 #include <vector>
 #include <map>
 #include <unordered_set>
 using namespace std;
 
 #include"ResourcePack.h"
+#include"InstancePool.h"
+#include"AssetRegistry.h"
 #include"BufferStructure.h"
 #include"pipeline/Pass.h"
 #include"pipeline/Pipeline.h"
+#include"pipeline/CommandBuffer.h"
 #include"asset/Model.h"
+#include"scene/AABBTree.h"
+#include"scene/MaskedOcclusion.h"
+#include"scene/ViewSet.h"
+#include"ThreadPool.h"
+#include"RingAllocator.h"
+#include"InstanceChunk.h"
+#include"RadixSort.h"
+#include"DrawKey.h"
+#include"SIMDMath.h"
 
 
 class GEngine
 {
 public:
-	HWND hwnd;
+	void* window; //HWND, NULL when headless
 	int resolutionX, resolutionY;
 	Effect* effect;
 
@@ -26,17 +38,28 @@ public:
 	Camera mainLight;
 	vector<Light> lightList;
 
-	bool Init(HWND window, bool fullscreen);
+	bool Init(void* window, bool fullscreen);
+	//Same frames on a NullDevice, for CI and CPU profiling. Effects read their shader files, nothing is compiled
+	bool InitHeadless(int width, int height);
 	bool LoadEffect(const string &file);
 	void CloseEffect();
 	void Shutdown();
+	//Files already loaded with the same options are shared, each call adds a reference to the pack
 	AssetPack* LoadAsset(string file);
-	void UnloadModel(UINT modelID);
+	//A model built in memory, shared under name like a file. Material textures must already be loaded
+	AssetPack* LoadAsset(Model &model, const string &name);
+	//Drops a reference from LoadAsset, false if there is none. The pack is deleted once no reference
+	//or instance is left, its resources are released FRAMES_IN_FLIGHT frames later
+	bool UnloadModel(AssetPack* pack);
 	void UpdateLight(vector<Light> lights);
 
 	void Render(const PassOperation &cfg);
 
 	void Render(const string &renderer);
+	//Render records the frame into a command buffer and replays it here, NULL replays on the PipeLine.
+	//Point it at a ValidationTarget to count and check a frame without a device
+	CommandTarget* commandTarget;
+	const CommandBuffer& GetFrameCommands() const;
 	
 	bool Tiling();
 	unsigned int depthStencilBufferID;
@@ -45,18 +68,170 @@ public:
 
 	bool UpdateFrameBuffer();
 	bool UpdateLightBuffer();
-	unordered_set<AssetPack*> resourcePacks;
-	unordered_set<ModelInstance*> instances;
-	ModelInstance* CreateInstance(const ModelInstance &bluePrint);
+	//Packs from LoadAsset with their reference and instance counts, and memory per asset
+	AssetRegistry assets;
+	InstancePool instances;
+	//Returns InstancePool::INVALID_HANDLE when the pool is full
+	InstanceHandle CreateInstance(const ModelInstance &bluePrint);
+	bool DestroyInstance(InstanceHandle handle);
+
+	//Scene queries on the instance bound tree
+	//Camera frustum culling is off by default: voxelization and shadow passes need off-screen geometry
+	bool frustumCulling;
+	//Hide instances behind occluder instances (ModelInstance::occluder) from the main camera.
+	//Off by default for the same reason as frustum culling
+	bool occlusionCulling;
+	//Classify every instance against the camera, the voxel volume and each light in one pass over
+	//the pool bounds, passes then draw only what their "view" sees. Replaces frustumCulling when on
+	bool multiViewCulling;
+	//Occlusion buffer width in pixels, height follows the screen aspect
+	UINT occlusionWidth;
+	//Meshes above this are not kept on the CPU and can't occlude
+	UINT occluderTriangleLimit;
+	//LoadAsset block compresses material textures on the thread pool. On by default, textures
+	//with a side that isn't a multiple of 4 stay RGBA8. Either way they are kept in .ctex
+	//containers next to the images and mapped by later loads
+	bool compressTextures;
+	//Kernel of the mip chains LoadAsset builds on the CPU for material textures, Mip_Box by default
+	MipFilter textureMipFilter;
+
+	//Components per bucket building task, tasks run on the thread pool
+	UINT bucketTaskSize;
+	//Milliseconds spent in the last UpdateBuckets, and in its batched wVP stage
+	double bucketUpdateTime;
+	double wvpUpdateTime;
+	//Milliseconds and world matrices recomputed by the scene graph propagation of the last UpdateBuckets
+	double hierarchyUpdateTime;
+	UINT hierarchyUpdateCount;
+
+	//Per frame counters of the last Render call
+	struct RenderStats
+	{
+		UINT batches;
+		UINT drawCalls;
+		UINT meshBinds;
+		UINT materialBinds;
+		UINT bindsAvoided; //Mesh and material changes saved against drawing batches unsorted
+		UINT stateCalls; //Binding and state calls reaching the context
+		UINT stateCallsSkipped; //Dropped by the pipeline's shadow state as redundant
+		UINT uploadDiscards; //Ring allocations that had to discard data still in flight
+		UINT instancesSkipped; //Need more bind matrices than one draw holds (numBonePerBatch), not drawn
+	};
+	RenderStats stats;
+	//Instances dropped by their pass' min_coverage in the last Render, one entry per pass operation
+	vector<UINT> coverageCulled;
+	//Instances dropped by their pass' view in the last Render, one entry per pass operation
+	vector<UINT> viewCulled;
+	//Counters of the last UpdateBuckets with occlusion culling on, occluded / tested is the culled ratio
+	struct OcclusionStats
+	{
+		UINT occluderTriangles;
+		UINT tested;
+		UINT occluded;
+		double time; //Milliseconds for rasterization and tests
+	};
+	OcclusionStats occlusionStats;
+	void QueryFrustum(const Frustum &frustum, vector<InstanceHandle> &outInstances);
+	void QueryBox(const AABB &box, vector<InstanceHandle> &outInstances);
+	void QuerySphere(const BoundingSphere &sphere, vector<InstanceHandle> &outInstances);
+	//INVALID_HANDLE on a miss
+	InstanceHandle Pick(const Ray &ray, float maxDistance, float* outDistance = NULL);
 	void Instancing(const RenderPair &rpair, const vector<InstanceData> &instanceData, const vector<aiMatrix4x4> &bindMatrix);
 	void LoadPostMesh(string file);
+	void LoadPostMesh(Model &model, const string &name);
 private:
 	MeshResource postMesh;
+	AssetPack* postMeshPack;
+	//Takes over a reference from LoadAsset
+	void UsePostMesh(AssetPack* pack);
+	//Drops pointers into a pack that was just deleted
+	void ForgetPack();
+	//Registry key of a model loaded with the current options
+	string MakeAssetKey(const string &name) const;
+	//Device resources and default instance of a loaded model
+	void FillAssetPack(AssetPack &pack, Model &model);
 	
-	void UpdateBuckets();
+	//requiredViews is the union of the view bits of the passes about to be drawn
+	void UpdateBuckets(UINT requiredViews);
+	//Views of the multi-view stage, lights that don't fit a bit fall back to viewAllBit
+	static const UINT viewCameraBit = 1u << 0;
+	static const UINT viewVoxelBit = 1u << 1;
+	static const UINT viewFirstLightBit = 2;
+	static const UINT viewAllBit = 1u << 31;
+	UINT GetViewBit(const Pass &pass) const;
+	ViewSet viewSet;
+	void BuildViewSet();
+	void UpdateBounds();
+	void UpdateWorldBound(UINT slot);
+	void OcclusionCull(const aiMatrix4x4 &viewProjection, UINT requiredViews);
+	MaskedOcclusion occlusionBuffer;
+	vector<UINT8> candidateVisible;
 	void ApplyAnimation();
-	unordered_map<RenderPair, vector<InstanceData>> instanceBuckets;
-	unordered_map<RenderPair, vector<aiMatrix4x4>> bindMatrixBuckets;
+	AABBTree sceneTree;
+	vector<void*> queryResult;
+	//Draw batches of the frame: one per RenderPair for opaque components, one per translucent component
+	struct DrawBatch
+	{
+		RenderPair key;
+		bool translucent;
+		float depth; //Normalized view depth, nearest instance for opaque batches
+		vector<InstanceData> instanceData;
+		vector<aiMatrix4x4> bindMatrix;
+		vector<float> coverage; //Projected bounding sphere area in pixels, per instance
+		vector<UINT> viewMask; //Views the instance is visible from, per instance
+	};
+	vector<DrawBatch> batches; //Reused between frames, only the first numBatches are valid
+	size_t numBatches;
+	unordered_map<RenderPair, size_t> batchSlots;
+
+	//Partial batches filled by one task, merged in task order so the result does not depend on scheduling
+	struct PartialBucket
+	{
+		RenderPair key;
+		bool translucent;
+		float depth;
+		vector<InstanceData> instanceData;
+		vector<aiMatrix4x4> bindMatrix; //bindMatrixOffset in instanceData is local to this array
+		vector<float> coverage;
+		vector<UINT> viewMask;
+		size_t batch;
+		size_t instanceBase;
+		size_t bindMatrixBase;
+	};
+	struct BucketTask
+	{
+		unordered_map<RenderPair, size_t> slots;
+		vector<PartialBucket> buckets; //Reused between frames, only the first numUsed are valid
+		size_t numUsed;
+		PartialBucket& Get(const RenderPair &key);
+		PartialBucket& Add(const RenderPair &key); //Not shared with other components
+	};
+	ThreadPool threadPool;
+	vector<UINT> bucketCandidates; //Pool slots
+	vector<UINT> candidateMasks; //View bits of each candidate, all set without multi-view culling
+	vector<InstanceHandle> candidateHandles;
+	vector<size_t> componentStart; //Prefix sum of component counts over bucketCandidates
+	vector<const aiMatrix4x4*> candidateWorld;
+	vector<aiMatrix4x4> candidateWVP;
+	vector<BucketTask> bucketTasks;
+	void FillBucketTask(BucketTask &task, size_t begin, size_t end, const aiMatrix4x4 &view, float pixelScale);
+	void MergeBucketTasks(size_t numTasks);
+
+	//Sorted draw list of the frame, value is the batch index
+	vector<SortItem> drawList;
+	vector<SortItem> drawListScratch;
+	void BuildDrawList(UINT numPasses);
+	void DrawPass(UINT passIndex, size_t &cursor, float minCoverage, UINT viewBit);
+	//Instances of a batch left after view and coverage culling, bind matrices compacted to match
+	vector<InstanceData> passInstanceData;
+	vector<aiMatrix4x4> passBindMatrix;
+	void BindRenderPair(const RenderPair &rpair);
+	CommandBuffer frameCommands;
+	PipelineTarget pipelineTarget;
+	const MeshResource* boundMesh;
+	const MaterialResource* boundMaterial;
+	UINT meshSortCounter;
+	UINT materialSortCounter;
 	
 	bool vsync_enabled;
 	bool fullscreen;
@@ -64,8 +239,24 @@ private:
 	float oldProjection[16];
 
 	UINT numBonePerVertex;
+	//Limits of a single draw, buckets are split into chunks that fit
 	UINT numBonePerBatch;
 	UINT maxInstances;
+	//Ring buffer sizes in elements, chunks of a frame are sub-allocated from them.
+	//Each ring keeps the data of FRAMES_IN_FLIGHT frames, a frame outgrowing its share discards
+	UINT bindMatrixRingSize;
+	UINT instanceRingSize;
+	RingAllocator bindMatrixRing;
+	RingAllocator instanceRing;
+	//Per draw constants in bytes, one 256 byte range per chunk. Only with PipeLine::SupportsConstantBufferRanges,
+	//otherwise drawBuffer is discarded for every chunk
+	UINT drawConstantRingSize;
+	RingAllocator drawConstantRing;
+	UINT64 ringFrame; //PipeLine frame the rings were last fenced at
+	size_t RingDiscardCount() const;
+	vector<InstanceChunk> instanceChunks;
+	UINT loggedSkips; //instancesSkipped of the last frame that logged a change
+	vector<InstanceData> chunkInstanceData;
 
 	//Light list
 	UINT MaxLightNumber;
@@ -75,13 +266,18 @@ private:
 
 	//Buffers ID
 	 int frameBufferID;
+	 int drawBufferID;
+	 int drawConstantRingID;
 	 int animationMatrixBufferID;
 	 int instanceBufferID;
 	 int lightBufferID;
 
 	//Data for Buffers
 	FrameBufferData frameData;
+	DrawBufferData drawData;
 
 	bool InitBuffers();
+	//Buffers and default state shared by Init and InitHeadless
+	bool InitDefaults();
 };
 
@@ -0,0 +1,57 @@
+#include "InstanceChunk.h"
+
+UINT SplitInstanceChunks(const vector<InstanceData>& instances, UINT numBindMatrix, UINT maxInstances, UINT maxBindMatrix, vector<InstanceChunk>& outChunks)
+{
+	outChunks.clear();
+	UINT skipped = 0;
+	if (maxInstances == 0)
+		return (UINT)instances.size();
+
+	InstanceChunk chunk;
+	chunk.firstInstance = 0;
+	chunk.numInstances = 0;
+	chunk.firstBindMatrix = 0;
+	chunk.numBindMatrix = 0;
+
+	for (UINT i = 0; i < instances.size(); i++)
+	{
+		//Bind matrices of an instance run up to the next instance's offset
+		UINT begin = instances[i].bindMatrixOffset;
+		UINT end = i + 1 < instances.size() ? instances[i + 1].bindMatrixOffset : numBindMatrix;
+		UINT count = end > begin ? end - begin : 0;
+
+		if (count > maxBindMatrix)
+		{
+			if (chunk.numInstances) outChunks.push_back(chunk);
+			chunk.numInstances = 0;
+			skipped++;
+			continue;
+		}
+
+		if (chunk.numInstances && (chunk.numInstances == maxInstances || chunk.numBindMatrix + count > maxBindMatrix))
+		{
+			outChunks.push_back(chunk);
+			chunk.numInstances = 0;
+		}
+		if (chunk.numInstances == 0)
+		{
+			chunk.firstInstance = i;
+			chunk.firstBindMatrix = begin;
+			chunk.numBindMatrix = 0;
+		}
+		chunk.numInstances++;
+		chunk.numBindMatrix += count;
+	}
+	if (chunk.numInstances) outChunks.push_back(chunk);
+	return skipped;
+}
+
+void RebaseInstanceChunk(const InstanceData * bucketInstances, const InstanceChunk & chunk, UINT bindMatrixBase, InstanceData * dst)
+{
+	const InstanceData* src = bucketInstances + chunk.firstInstance;
+	for (UINT i = 0; i < chunk.numInstances; i++)
+	{
+		dst[i] = src[i];
+		dst[i].bindMatrixOffset = src[i].bindMatrixOffset - chunk.firstBindMatrix + bindMatrixBase;
+	}
+}
@@ -0,0 +1,24 @@
+//Splitting instance buckets into draws that fit the GPU instance and bind matrix buffers
+//Pure CPU, no device access
+#pragma once
+#include <vector>
+#include "BufferStructure.h"
+using namespace std;
+
+//A run of consecutive instances of a bucket drawn with one call
+struct InstanceChunk
+{
+	UINT firstInstance;
+	UINT numInstances;
+	UINT firstBindMatrix; //Index into the bucket's bind matrix array
+	UINT numBindMatrix;
+};
+
+//Split a bucket into chunks of at most maxInstances instances and maxBindMatrix bind matrices.
+//bindMatrixOffset of each instance indexes the bucket's bind matrix array of numBindMatrix elements.
+//An instance that alone needs more than maxBindMatrix matrices can not be drawn and is skipped,
+//returns the number of skipped instances.
+UINT SplitInstanceChunks(const vector<InstanceData> &instances, UINT numBindMatrix, UINT maxInstances, UINT maxBindMatrix, vector<InstanceChunk> &outChunks);
+
+//Copy the instances of a chunk, moving bindMatrixOffset to where the chunk's bind matrices were placed
+void RebaseInstanceChunk(const InstanceData* bucketInstances, const InstanceChunk &chunk, UINT bindMatrixBase, InstanceData* dst);
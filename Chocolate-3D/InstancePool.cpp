@@ -0,0 +1,377 @@
+#include "InstancePool.h"
+#include "SIMDMath.h"
+
+//Indices stop below maxInstances, so no generation of a live index can form INVALID_HANDLE
+static_assert((InstancePool::INVALID_HANDLE & InstancePool::maxInstances) == InstancePool::maxInstances,
+	"The top index is reserved for INVALID_HANDLE");
+//Bound to references by push_back, so it needs a definition outside MSVC
+const InstanceHandle InstancePool::INVALID_HANDLE;
+
+InstancePool::InstancePool()
+{
+	orderDirty = false;
+}
+
+UINT InstancePool::IndexOf(InstanceHandle handle)
+{
+	return handle & ((1 << indexBits) - 1);
+}
+
+UINT InstancePool::GenerationOf(InstanceHandle handle)
+{
+	return handle >> indexBits;
+}
+
+InstanceHandle InstancePool::Create(const ModelInstance & blueprint)
+{
+	UINT index;
+	if (!freeIndices.empty())
+	{
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else
+	{
+		if (slotOfIndex.size() >= maxInstances)
+			return INVALID_HANDLE;
+		index = (UINT)slotOfIndex.size();
+		slotOfIndex.push_back(0);
+		generations.push_back(0);
+	}
+
+	UINT slot = (UINT)handles.size();
+	InstanceHandle handle = (generations[index] << indexBits) | index;
+	slotOfIndex[index] = slot;
+	handles.push_back(handle);
+
+	transforms.push_back(blueprint.transform);
+	visible.push_back(blueprint.visible ? 1 : 0);
+	occluders.push_back(blueprint.occluder ? 1 : 0);
+	animationIDs.push_back(blueprint.animationID);
+	animationTimes.push_back(blueprint.animationTime);
+	worldBounds.push_back(AABB());
+	boundProxies.push_back(-1);
+	worldMatrices.push_back(blueprint.transform.GetMatrix());
+	worldChanged.push_back(1);
+	localVersions.push_back(blueprint.transform.GetVersion());
+	parents.push_back(INVALID_HANDLE);
+	parentNodes.push_back(-1);
+	//A root can go anywhere in the order
+	parentSlots.push_back(-1);
+	if (!orderDirty)
+		updateOrder.push_back(slot);
+
+	cold.push_back(ColdData());
+	ColdData &data = cold.back();
+	data.pack = blueprint.pack;
+	data.nodesChanged = false;
+	//Poses are per instance and rebuilt by animation, don't copy the blueprint's
+	data.components.resize(blueprint.components.size());
+	for (size_t i = 0; i < blueprint.components.size(); i++)
+	{
+		data.components[i].meshInstance.pResource = blueprint.components[i].meshInstance.pResource;
+		data.components[i].materialInstance = blueprint.components[i].materialInstance;
+	}
+	return handle;
+}
+
+bool InstancePool::Destroy(InstanceHandle handle)
+{
+	if (!IsValid(handle))
+		return false;
+	UINT index = IndexOf(handle);
+	UINT slot = slotOfIndex[index];
+	UINT last = (UINT)handles.size() - 1;
+	if (slot != last)
+		MoveSlot(last, slot);
+	PopSlot();
+	orderDirty = true;
+
+	generations[index] = (generations[index] + 1) & ((1 << generationBits) - 1);
+	freeIndices.push_back(index);
+	return true;
+}
+
+bool InstancePool::IsValid(InstanceHandle handle) const
+{
+	UINT index = IndexOf(handle);
+	if (handle == INVALID_HANDLE || index >= slotOfIndex.size())
+		return false;
+	UINT slot = slotOfIndex[index];
+	return generations[index] == GenerationOf(handle) && slot < handles.size() && handles[slot] == handle;
+}
+
+void InstancePool::Clear()
+{
+	while (!handles.empty())
+	{
+		Destroy(handles.back());
+	}
+}
+
+UINT InstancePool::GetCount() const
+{
+	return (UINT)handles.size();
+}
+
+int InstancePool::GetSlot(InstanceHandle handle) const
+{
+	if (!IsValid(handle))
+		return -1;
+	return (int)slotOfIndex[IndexOf(handle)];
+}
+
+InstanceHandle InstancePool::GetHandle(UINT slot) const
+{
+	return handles[slot];
+}
+
+void InstancePool::MoveSlot(UINT from, UINT to)
+{
+	handles[to] = handles[from];
+	transforms[to] = transforms[from];
+	visible[to] = visible[from];
+	occluders[to] = occluders[from];
+	animationIDs[to] = animationIDs[from];
+	animationTimes[to] = animationTimes[from];
+	worldBounds[to] = worldBounds[from];
+	boundProxies[to] = boundProxies[from];
+	worldMatrices[to] = worldMatrices[from];
+	worldChanged[to] = worldChanged[from];
+	localVersions[to] = localVersions[from];
+	parents[to] = parents[from];
+	parentNodes[to] = parentNodes[from];
+	cold[to].pack = cold[from].pack;
+	cold[to].components.swap(cold[from].components);
+	cold[to].nodeGlobals.swap(cold[from].nodeGlobals);
+	cold[to].nodesChanged = cold[from].nodesChanged;
+	slotOfIndex[IndexOf(handles[to])] = to;
+}
+
+void InstancePool::PopSlot()
+{
+	handles.pop_back();
+	transforms.pop_back();
+	visible.pop_back();
+	occluders.pop_back();
+	animationIDs.pop_back();
+	animationTimes.pop_back();
+	worldBounds.pop_back();
+	boundProxies.pop_back();
+	worldMatrices.pop_back();
+	worldChanged.pop_back();
+	localVersions.pop_back();
+	parents.pop_back();
+	parentNodes.pop_back();
+	parentSlots.pop_back();
+	cold.pop_back();
+}
+
+Transform & InstancePool::GetTransform(InstanceHandle handle)
+{
+	return transforms[slotOfIndex[IndexOf(handle)]];
+}
+
+vector<GraphicInstance>& InstancePool::GetComponents(InstanceHandle handle)
+{
+	return cold[slotOfIndex[IndexOf(handle)]].components;
+}
+
+AssetPack * InstancePool::GetPack(InstanceHandle handle) const
+{
+	return cold[slotOfIndex[IndexOf(handle)]].pack;
+}
+
+bool InstancePool::IsVisible(InstanceHandle handle) const
+{
+	return visible[slotOfIndex[IndexOf(handle)]] != 0;
+}
+
+void InstancePool::SetVisible(InstanceHandle handle, bool visible)
+{
+	if (IsValid(handle))
+		this->visible[slotOfIndex[IndexOf(handle)]] = visible ? 1 : 0;
+}
+
+bool InstancePool::IsOccluder(InstanceHandle handle) const
+{
+	return occluders[slotOfIndex[IndexOf(handle)]] != 0;
+}
+
+void InstancePool::SetOccluder(InstanceHandle handle, bool occluder)
+{
+	if (IsValid(handle))
+		occluders[slotOfIndex[IndexOf(handle)]] = occluder ? 1 : 0;
+}
+
+int InstancePool::GetAnimationID(InstanceHandle handle) const
+{
+	return animationIDs[slotOfIndex[IndexOf(handle)]];
+}
+
+void InstancePool::SetAnimationID(InstanceHandle handle, int animationID)
+{
+	if (IsValid(handle))
+		animationIDs[slotOfIndex[IndexOf(handle)]] = animationID;
+}
+
+float InstancePool::GetAnimationTime(InstanceHandle handle) const
+{
+	return animationTimes[slotOfIndex[IndexOf(handle)]];
+}
+
+void InstancePool::SetAnimationTime(InstanceHandle handle, float time)
+{
+	if (IsValid(handle))
+		animationTimes[slotOfIndex[IndexOf(handle)]] = time;
+}
+
+bool InstancePool::Attach(InstanceHandle child, InstanceHandle parent, int parentNode)
+{
+	int childSlot = GetSlot(child);
+	int parentSlot = GetSlot(parent);
+	if (childSlot < 0 || parentSlot < 0)
+		return false;
+	//Walk up from the parent, meeting the child means a cycle
+	for (InstanceHandle h = parent; IsValid(h); h = parents[slotOfIndex[IndexOf(h)]])
+	{
+		if (h == child)
+			return false;
+	}
+
+	parents[childSlot] = parent;
+	parentNodes[childSlot] = parentNode;
+	//Static packs are never posed, their node globals come from the bind hierarchy once
+	ColdData &parentData = cold[parentSlot];
+	if (parentNode >= 0 && parentData.nodeGlobals.empty() && parentData.pack && !parentData.pack->nodeList.empty())
+		parentData.pack->nodeList.GetGlobalMatrix(parentData.nodeGlobals);
+	ForceUpdate(childSlot);
+	orderDirty = true;
+	return true;
+}
+
+void InstancePool::Detach(InstanceHandle child)
+{
+	int slot = GetSlot(child);
+	if (slot < 0 || parents[slot] == INVALID_HANDLE)
+		return;
+	parents[slot] = INVALID_HANDLE;
+	parentNodes[slot] = -1;
+	ForceUpdate(slot);
+	orderDirty = true;
+}
+
+InstanceHandle InstancePool::GetParent(InstanceHandle handle) const
+{
+	if (!IsValid(handle))
+		return INVALID_HANDLE;
+	InstanceHandle parent = parents[slotOfIndex[IndexOf(handle)]];
+	return IsValid(parent) ? parent : INVALID_HANDLE;
+}
+
+const aiMatrix4x4 & InstancePool::GetWorldMatrix(InstanceHandle handle) const
+{
+	static const aiMatrix4x4 identity;
+	if (!IsValid(handle))
+		return identity;
+	return worldMatrices[slotOfIndex[IndexOf(handle)]];
+}
+
+void InstancePool::ForceUpdate(UINT slot)
+{
+	//Any version but the current one rebuilds the world matrix
+	localVersions[slot] = transforms[slot].GetVersion() - 1;
+}
+
+void InstancePool::BuildUpdateOrder()
+{
+	UINT count = GetCount();
+	const UINT unknown = 0xffffffff;
+	parentSlots.resize(count);
+	depths.assign(count, unknown);
+	for (UINT slot = 0; slot < count; slot++)
+	{
+		int parentSlot = GetSlot(parents[slot]);
+		if (parentSlot < 0 && parents[slot] != INVALID_HANDLE)
+		{
+			//Parent was destroyed
+			parents[slot] = INVALID_HANDLE;
+			parentNodes[slot] = -1;
+			ForceUpdate(slot);
+		}
+		parentSlots[slot] = parentSlot;
+	}
+
+	//Depth of each slot, walking up to the first known ancestor
+	UINT maxDepth = 0;
+	for (UINT slot = 0; slot < count; slot++)
+	{
+		UINT top = slot, steps = 0;
+		while (depths[top] == unknown && parentSlots[top] >= 0)
+		{
+			top = parentSlots[top];
+			steps++;
+		}
+		UINT depth = (depths[top] == unknown ? 0 : depths[top]) + steps;
+		for (UINT s = slot; depths[s] == unknown; s = parentSlots[s], depth--)
+		{
+			depths[s] = depth;
+			maxDepth = max(maxDepth, depth);
+			if (parentSlots[s] < 0)
+				break;
+		}
+	}
+
+	//Counting sort by depth keeps pool order inside a level
+	vector<UINT> levelStart(maxDepth + 2, 0);
+	for (UINT slot = 0; slot < count; slot++)
+	{
+		levelStart[depths[slot] + 1]++;
+	}
+	for (UINT d = 0; d <= maxDepth; d++)
+	{
+		levelStart[d + 1] += levelStart[d];
+	}
+	updateOrder.resize(count);
+	for (UINT slot = 0; slot < count; slot++)
+	{
+		updateOrder[levelStart[depths[slot]]++] = slot;
+	}
+	orderDirty = false;
+}
+
+UINT InstancePool::UpdateWorldMatrices()
+{
+	if (orderDirty)
+		BuildUpdateOrder();
+
+	UINT numUpdated = 0;
+	for (UINT slot : updateOrder)
+	{
+		int parentSlot = parentSlots[slot];
+		const Transform &transform = transforms[slot];
+		bool changed = localVersions[slot] != transform.GetVersion();
+		if (parentSlot >= 0)
+			changed = changed || worldChanged[parentSlot] || (parentNodes[slot] >= 0 && cold[parentSlot].nodesChanged);
+		worldChanged[slot] = changed ? 1 : 0;
+		if (!changed)
+			continue;
+
+		localVersions[slot] = transform.GetVersion();
+		if (parentSlot < 0)
+		{
+			worldMatrices[slot] = transform.GetMatrix();
+		}
+		else
+		{
+			AffineMatrix parentWorld = LoadAffine(worldMatrices[parentSlot]);
+			const vector<aiMatrix4x4> &nodeGlobals = cold[parentSlot].nodeGlobals;
+			int node = parentNodes[slot];
+			if (node >= 0 && node < (int)nodeGlobals.size())
+				parentWorld = MultiplyAffine(parentWorld, LoadAffine(nodeGlobals[node]));
+			StoreAffine(MultiplyAffine(parentWorld, LoadAffine(transform.GetMatrix())), worldMatrices[slot]);
+		}
+		numUpdated++;
+	}
+	return numUpdated;
+}
@@ -0,0 +1,114 @@
+//-------------------------------Instance Pool----------------------------------
+//Storage for the model instances of a scene.
+//Instances are addressed by 32-bit generational handles: the low 20 bits index a
+//sparse table, the high 12 bits must match that entry's generation, so handles to
+//destroyed instances are rejected until the generation wraps.
+//Live instances are packed in dense slots [0, GetCount()): per frame data lives in
+//parallel arrays, data only touched on edits (components) lives in a separate array.
+//Destroy moves the last slot into the hole, so slots change but handles do not.
+//Instances can be attached to a parent instance, or to a node of its skeleton:
+//transforms are then local, world matrices are propagated parents first in a
+//depth sorted order that is only rebuilt when the hierarchy changes.
+//------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "Platform.h"
+#include "ResourcePack.h"
+#include "scene/BoundingVolume.h"
+using namespace std;
+
+typedef UINT InstanceHandle;
+
+class InstancePool
+{
+public:
+	static const UINT indexBits = 20;
+	static const UINT generationBits = 12;
+	static const UINT maxInstances = (1 << indexBits) - 1;
+	static const InstanceHandle INVALID_HANDLE = 0xffffffff;
+
+	InstancePool();
+
+	//O(1) apart from copying the blueprint's components, INVALID_HANDLE when full
+	InstanceHandle Create(const ModelInstance &blueprint);
+	//O(1), returns false for stale handles
+	bool Destroy(InstanceHandle handle);
+	bool IsValid(InstanceHandle handle) const;
+	void Clear();
+
+	UINT GetCount() const;
+	//Dense slot of a live handle, -1 for stale handles. Slots change when instances are destroyed
+	int GetSlot(InstanceHandle handle) const;
+	InstanceHandle GetHandle(UINT slot) const;
+
+	//Accessors by handle, the handle must be valid
+	Transform& GetTransform(InstanceHandle handle);
+	vector<GraphicInstance>& GetComponents(InstanceHandle handle);
+	AssetPack* GetPack(InstanceHandle handle) const;
+	bool IsVisible(InstanceHandle handle) const;
+	void SetVisible(InstanceHandle handle, bool visible);
+	bool IsOccluder(InstanceHandle handle) const;
+	void SetOccluder(InstanceHandle handle, bool occluder);
+	int GetAnimationID(InstanceHandle handle) const;
+	void SetAnimationID(InstanceHandle handle, int animationID);
+	float GetAnimationTime(InstanceHandle handle) const;
+	void SetAnimationTime(InstanceHandle handle, float time);
+
+	//The child's transform becomes local to the parent, or to node parentNode of the parent's
+	//NodeList when >= 0. False for invalid handles or when it would make a cycle.
+	//Children of a destroyed instance are detached
+	bool Attach(InstanceHandle child, InstanceHandle parent, int parentNode = -1);
+	//The transform is the world transform again
+	void Detach(InstanceHandle child);
+	//INVALID_HANDLE for roots and stale handles
+	InstanceHandle GetParent(InstanceHandle handle) const;
+	//Identity for stale handles
+	const aiMatrix4x4& GetWorldMatrix(InstanceHandle handle) const;
+	//Recompute the world matrices of changed transforms and of everything below them.
+	//worldChanged tells which slots were recomputed, returns their number
+	UINT UpdateWorldMatrices();
+
+	//Hot data, indexed by slot
+	vector<Transform> transforms;
+	vector<UINT8> visible;
+	vector<UINT8> occluders; //Rasterized into GEngine's occlusion buffer, never occlusion culled
+	vector<int> animationIDs;
+	vector<float> animationTimes;
+	vector<AABB> worldBounds;
+	vector<int> boundProxies; //Leaf in GEngine's scene tree
+	vector<aiMatrix4x4> worldMatrices;
+	vector<UINT8> worldChanged; //Set by the last UpdateWorldMatrices
+	vector<UINT> localVersions; //Transform version the world matrix was built from
+	vector<InstanceHandle> parents;
+	vector<int> parentNodes;
+
+	//Cold data, indexed by slot
+	struct ColdData
+	{
+		AssetPack* pack;
+		vector<GraphicInstance> components;
+		vector<aiMatrix4x4> nodeGlobals; //Pose of the pack's nodes, for children attached to them
+		bool nodesChanged; //Posed this frame, children attached to a node follow
+	};
+	vector<ColdData> cold;
+
+private:
+	vector<InstanceHandle> handles; //Slot to handle
+	vector<UINT> slotOfIndex; //Sparse index to slot
+	vector<UINT16> generations; //Sparse index to current generation
+	vector<UINT> freeIndices;
+
+	//Slots sorted by depth in the hierarchy, pool order inside a level
+	vector<UINT> updateOrder;
+	vector<int> parentSlots;
+	vector<UINT> depths;
+	bool orderDirty;
+	void BuildUpdateOrder();
+	void ForceUpdate(UINT slot);
+
+	static UINT IndexOf(InstanceHandle handle);
+	static UINT GenerationOf(InstanceHandle handle);
+	void MoveSlot(UINT from, UINT to);
+	void PopSlot();
+};
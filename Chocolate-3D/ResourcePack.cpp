@@ -1,5 +1,6 @@
 #include "ResourcePack.h"
 #include "pipeline/Pipeline.h"
+#include "SIMDMath.h"
 
 MeshResource::MeshResource()
 {
@@ -14,6 +15,7 @@ MeshResource::MeshResource()
 	boneWeightID = -1;
 	indexCount = 0;
 	nodeID = -1;
+	sortID = 0;
 }
 
 void MeshResource::Render() const
@@ -28,12 +30,20 @@ void MeshResource::Render() const
 	PipeLine::Resources().SetBinding(Stage_Input_Assembler, Bind_Index_Buffer, 0, indiceID);
 }
 
+void MeshResource::Record(CommandBuffer & commands) const
+{
+	//Stream order of meshStreamSlots
+	int streams[numMeshStreams] = { positionID, normalID, tangentID, bitangentID, texCoordID, boneIndexID, boneWeightID };
+	commands.BindMesh(streams, indiceID);
+}
+
 MaterialResource::MaterialResource()
 {
 	diffuseMap = -1;
 	specularMap = -1;
 	ambientMap = -1;
 	normalMap = -1;
+	sortID = 0;
 }
 
 void MaterialResource::Render() const
@@ -44,18 +54,32 @@ void MaterialResource::Render() const
 	PipeLine::Resources().SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, Slot_Texture_Specular, specularMap);
 }
 
+void MaterialResource::Record(CommandBuffer & commands) const
+{
+	commands.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, Slot_Texture_Diffuse, diffuseMap);
+	commands.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, Slot_Texture_Normal, normalMap);
+	commands.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, Slot_Texture_Ambient, ambientMap);
+	commands.SetBinding(Stage_Pixel_Shader, Bind_Shader_Resource, Slot_Texture_Specular, specularMap);
+}
+
 ModelInstance::ModelInstance()
 {
 	visible = true;
+	occluder = false;
 	animationID = -1;
 	animationTime = 0;
 	pack = NULL;
-	isDestroied = false;
 }
 
 void ModelInstance::ApplyAnimation()
 {
-	if (animationID >= pack->animationList.size() || animationID < 0 || animationTime < 0) return;
+	vector<aiMatrix4x4> nodeGlobals;
+	ApplyAnimation(pack, animationID, animationTime, components, nodeGlobals);
+}
+
+bool ModelInstance::ApplyAnimation(AssetPack * pack, int animationID, float animationTime, vector<GraphicInstance>& components, vector<aiMatrix4x4> &nodeGlobals)
+{
+	if (!pack || animationID >= pack->animationList.size() || animationID < 0 || animationTime < 0) return false;
 	Animation &animation = pack->animationList[animationID];
 	NodeList &nodeList = pack->nodeList;
 	double tick = animationTime * animation.ticksPerSecond;
@@ -68,8 +92,7 @@ void ModelInstance::ApplyAnimation()
 		aiMatrix4x4 &localTransformMatrix = nodeList[nodeAnimation.nodeID].localTransformMatrix;
 		localTransformMatrix = nodeAnimation.Evaluate(tick).ToMatrix();
 	}
-	vector<aiMatrix4x4> nodeGlobals;
-	nodeList.GetGlobalMatrix(nodeGlobals); 
+	nodeList.GetGlobalMatrix(nodeGlobals);
 
 	//Calculate bind matrix for each mesh instance
 	for (GraphicInstance &unit : components)
@@ -79,25 +102,31 @@ void ModelInstance::ApplyAnimation()
 		if (meshInstance.bindMatrix.size() != mesh.boneList.size())
 			meshInstance.bindMatrix.resize(mesh.boneList.size());
 
-		aiMatrix4x4 globalInverse = nodeGlobals[mesh.nodeID];
-		globalInverse.Inverse();
+		AffineMatrix globalInverse = InverseAffine(LoadAffine(nodeGlobals[mesh.nodeID]));
 		for (size_t i = 0; i < mesh.boneList.size(); i++)
 		{
 			const int &boneNodeID = mesh.boneList[i].nodeID;
-			aiMatrix4x4 &boneNodeMatrix = nodeGlobals[boneNodeID];
-			meshInstance.bindMatrix[i] = globalInverse * boneNodeMatrix*mesh.boneList[i].offset;
+			AffineMatrix boneMatrix = MultiplyAffine(LoadAffine(nodeGlobals[boneNodeID]), LoadAffine(mesh.boneList[i].offset));
+			StoreAffine(MultiplyAffine(globalInverse, boneMatrix), meshInstance.bindMatrix[i]);
 		}
 	}
+	return true;
 }
 
-void ModelInstance::Destroy()
+AABB ModelInstance::GetLocalBound() const
 {
-	isDestroied = true;
+	return GetLocalBound(components);
 }
 
-bool ModelInstance::IsDestroied()
+AABB ModelInstance::GetLocalBound(const vector<GraphicInstance>& components)
 {
-	return isDestroied;
+	AABB bound;
+	for (const GraphicInstance &unit : components)
+	{
+		if (unit.meshInstance.pResource)
+			bound.Expand(unit.meshInstance.pResource->bound);
+	}
+	return bound;
 }
 
 RenderPair::RenderPair()
@@ -171,3 +200,30 @@ AssetPack::AssetPack()
 {
 	defaultInstance.pack = this;
 }
+
+AssetPack::~AssetPack()
+{
+	//Retired by the resource manager, frames in flight keep drawing with them
+	ResourceManager &resources = PipeLine::Resources();
+	for (const MeshResource &mesh : meshs)
+	{
+		int ids[] = { mesh.positionID, mesh.normalID, mesh.tangentID, mesh.bitangentID, mesh.colorID, mesh.texCoordID, mesh.indiceID, mesh.boneIndexID, mesh.boneWeightID };
+		for (int id : ids)
+		{
+			if (id >= 0) resources.Delete(id);
+		}
+	}
+	for (const MaterialResource &material : materials)
+	{
+		int ids[] = { material.diffuseMap, material.specularMap, material.ambientMap, material.normalMap };
+		for (int id : ids)
+		{
+			if (id >= 0) resources.Delete(id);
+		}
+	}
+}
+
+size_t AssetPack::GetMemoryUsage() const
+{
+	return PipeLine::Resources().GetMemoryUsage(memoryOwner);
+}
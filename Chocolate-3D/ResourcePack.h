@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
-#include <windows.h>
+#include "Platform.h"
 #include"asset/Model.h"
+#include"scene/BoundingVolume.h"
+#include"pipeline/CommandBuffer.h"
 using namespace std;
 
 //A pre-combined mesh resource in graphics memory, shared by all it's instance
@@ -21,8 +23,14 @@ public:
 	UINT indexCount;
 	vector<BindingBone> boneList;
 	int nodeID;
+	AABB bound; //Bind pose bound in mesh space
+	UINT sortID; //Dense id for draw sort keys, set on load
+	//CPU copy for occlusion rasterization, only kept for small static meshes
+	vector<aiVector3D> occluderPositions;
+	vector<UINT> occluderIndices;
 	MeshResource();
 	void Render() const;
+	void Record(CommandBuffer &commands) const;
 };
 
 
@@ -35,8 +43,10 @@ public:
 	int specularMap;
 	int ambientMap;
 	int normalMap;
+	UINT sortID; //Dense id for draw sort keys, set on load
 	MaterialResource();
 	void Render() const;
+	void Record(CommandBuffer &commands) const;
 };
 
 //RenderPair: used as keys to classify instances according to meshs and materials, accelerate instancing.
@@ -113,6 +123,7 @@ class ModelInstance
 {
 public:
 	bool visible;
+	bool occluder; //Hides other instances when GEngine::occlusionCulling is on
 	vector<GraphicInstance> components;
 	Transform transform;
 	int animationID;
@@ -120,10 +131,11 @@ public:
 	AssetPack* pack;
 	ModelInstance();
 	void ApplyAnimation();
-	void Destroy();
-	bool IsDestroied();
-private:
-	bool isDestroied;
+	AABB GetLocalBound() const;
+	//Shared with InstancePool, which stores the same fields split by slot.
+	//nodeGlobals receives the pose of every node, false when there is nothing to pose
+	static bool ApplyAnimation(AssetPack* pack, int animationID, float animationTime, vector<GraphicInstance> &components, vector<aiMatrix4x4> &nodeGlobals);
+	static AABB GetLocalBound(const vector<GraphicInstance> &components);
 };
 
 //A combined Graphics ResourcePack typically created from model files
@@ -135,5 +147,13 @@ public:
 	NodeList nodeList;
 	vector<Animation> animationList;
 	ModelInstance defaultInstance;
+	//Owner the pack's resources are counted for, "asset:" and the file path
+	string memoryOwner;
+	size_t GetMemoryUsage() const;
 	AssetPack();
+	//Deletes the meshes' and materials' resources, see GEngine::UnloadModel
+	~AssetPack();
+private:
+	AssetPack(AssetPack const&);
+	AssetPack& operator=(AssetPack const&);
 };
\ No newline at end of file
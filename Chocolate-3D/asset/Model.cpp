@@ -1,6 +1,9 @@
 #pragma once
 #include"Model.h"
 #include"Usefull.h"
+#include"SIMDMath.h"
+#include"ThreadPool.h"
+#include <unordered_set>
 using namespace std;
 #define PI 3.1415926f
 
@@ -27,7 +30,8 @@ Node::Node()
 void NodeList::GetGlobalMatrixRecur(const aiMatrix4x4 & parentGlobal, int nodeID, vector<aiMatrix4x4>& outNodeGlobals)
 {
 	Node &node = (*this)[nodeID];
-	outNodeGlobals[nodeID] = parentGlobal*node.localTransformMatrix;
+	//Node transforms are affine
+	StoreAffine(MultiplyAffine(LoadAffine(parentGlobal), LoadAffine(node.localTransformMatrix)), outNodeGlobals[nodeID]);
 	for (size_t i = 0; i < node.childrenID.size(); i++)
 	{
 		int &childID = node.childrenID[i];
@@ -86,19 +90,8 @@ QuatKey::QuatKey()
 
 aiMatrix4x4 NodeFrame::ToMatrix()
 {
-	aiMatrix4x4 matrix = aiMatrix4x4(rotation.GetMatrix());
-	matrix.a1 *= scaling.x;
-	matrix.b1 *= scaling.x;
-	matrix.c1 *= scaling.x;
-	matrix.a2 *= scaling.y;
-	matrix.b2 *= scaling.y;
-	matrix.c2 *= scaling.y;
-	matrix.a3 *= scaling.z;
-	matrix.b3 *= scaling.z;
-	matrix.c3 *= scaling.z;
-	matrix.a4 = position.x;
-	matrix.b4 = position.y;
-	matrix.c4 = position.z;
+	aiMatrix4x4 matrix;
+	StoreAffine(ComposeAffine(LoadVector(position, 1), LoadQuaternion(rotation), LoadVector(scaling, 0)), matrix);
 	return matrix;
 }
 
@@ -448,6 +441,7 @@ void Model::LoadMaterial(const aiScene * source)
 	aiString textureFileName;
 	aiColor3D color;
 	float fl;
+	vector<TextureLoad> textureLoads;
 	for (size_t i = 0; i < source->mNumMaterials; i++)
 	{
 		Material &material = materialList[i];
@@ -486,37 +480,88 @@ void Model::LoadMaterial(const aiScene * source)
 		srcMaterial->GetTexture(aiTextureType_DIFFUSE, 0, &textureFileName);
 		if (textureFileName.length)
 		{
-			if (material.diffuseMap.LoadFromFile(folderPath + textureFileName.C_Str()))
-				material.hasDiffuseMap = true;
+			TextureLoad load = { &material.diffuseMap, folderPath + textureFileName.C_Str(), false, &material.hasDiffuseMap };
+			textureLoads.push_back(load);
 		}
 		textureFileName.Clear();
 		srcMaterial->GetTexture(aiTextureType_SPECULAR, 0, &textureFileName);
 		if (textureFileName.length)
 		{
-			if (material.specularMap.LoadFromFile(folderPath + textureFileName.C_Str()))
-				material.hasSpecularMap = true;
+			TextureLoad load = { &material.specularMap, folderPath + textureFileName.C_Str(), false, &material.hasSpecularMap };
+			textureLoads.push_back(load);
 		}
 		textureFileName.Clear();
 		srcMaterial->GetTexture(aiTextureType_AMBIENT, 0, &textureFileName);
 		if (textureFileName.length)
 		{
-			if (material.ambientMap.LoadFromFile(folderPath + textureFileName.C_Str()))
-				material.hasAmbientMap = true;
+			TextureLoad load = { &material.ambientMap, folderPath + textureFileName.C_Str(), false, &material.hasAmbientMap };
+			textureLoads.push_back(load);
 		}
 		textureFileName.Clear();
 		srcMaterial->GetTexture(aiTextureType_NORMALS, 0, &textureFileName);
 		if (textureFileName.length)
 		{
-			if (material.normalMap.LoadFromFile(folderPath + textureFileName.C_Str()))
-				material.hasNormalMap = true;
+			TextureLoad load = { &material.normalMap, folderPath + textureFileName.C_Str(), true, &material.hasNormalMap };
+			textureLoads.push_back(load);
 		}
 	}
+	LoadTextures(textureLoads);
+}
+
+void Model::LoadTextures(const vector<TextureLoad>& loads)
+{
+	//Materials often share an image. Its first load runs with the others, the repeats run after it
+	//and map the container it wrote instead of decoding, and never race it writing that container
+	vector<size_t> firstLoads, repeatLoads;
+	unordered_set<string> resolved;
+	for (size_t i = 0; i < loads.size(); i++)
+	{
+		string path = loads[i].texture->FindFile(loads[i].filePath);
+		if (path.empty())
+			*loads[i].loaded = false;
+		else if (resolved.insert(path).second)
+			firstLoads.push_back(i);
+		else
+			repeatLoads.push_back(i);
+	}
+
+	//With a texture per worker or more each task loads whole textures, otherwise textures go one
+	//by one with their mip levels and blocks spread over the pool
+	if (textureThreads && firstLoads.size() >= textureThreads->GetWorkerCount())
+	{
+		textureThreads->ParallelFor(firstLoads.size(), 1, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const TextureLoad &load = loads[firstLoads[i]];
+				*load.loaded = LoadTexture(*load.texture, load.filePath, load.normalMap, NULL);
+			}
+		});
+	}
+	else
+	{
+		for (size_t i : firstLoads)
+		{
+			*loads[i].loaded = LoadTexture(*loads[i].texture, loads[i].filePath, loads[i].normalMap, textureThreads);
+		}
+	}
+	for (size_t i : repeatLoads)
+	{
+		*loads[i].loaded = LoadTexture(*loads[i].texture, loads[i].filePath, loads[i].normalMap, textureThreads);
+	}
+}
 
+bool Model::LoadTexture(TextureData & texture, const string & filePath, bool normalMap, ThreadPool* threads)
+{
+	return texture.LoadCached(filePath, normalMap, compressTextures, mipFilter, threads);
 }
 
 Model::Model()
 {
 	hasAnimation = false;
+	compressTextures = false;
+	mipFilter = Mip_Box;
+	textureThreads = NULL;
 	maxBonePerVertex = 4;
 }
 
@@ -680,9 +725,26 @@ Transform::Transform()
 	front = initFront;
 	right = initRight;
 
+	version = 0;
 	UpdateTransform();
 }
 
+const aiMatrix4x4 & Transform::GetMatrix() const
+{
+	if (matrixDirty)
+	{
+		//Column vector matrix
+		StoreAffine(ComposeAffine(LoadVector(position, 1), LoadQuaternion(rotation), _mm_set1_ps(scaling)), transformMatrix);
+		matrixDirty = false;
+	}
+	return transformMatrix;
+}
+
+unsigned int Transform::GetVersion() const
+{
+	return version;
+}
+
 float Transform::DegToRad(float degree)
 {
 	while (degree > 360)
@@ -701,6 +763,7 @@ float Transform::DegToRad(float degree)
 
 void Transform::SpinYaw(float degree)
 {
+	UpdateBasis();
 	float rad;
 	rad = leftHanded ? -DegToRad(degree) : DegToRad(degree);
 	aiVector3D axis;
@@ -710,6 +773,7 @@ void Transform::SpinYaw(float degree)
 
 void Transform::SpinPitch(float degree)
 {
+	UpdateBasis();
 	float rad;
 	rad =DegToRad(degree);
 	if (verticalLock)
@@ -727,6 +791,7 @@ void Transform::SpinRoll(float degree)
 {
 	if (verticalLock)
 		return;
+	UpdateBasis();
 	float rad;
 	rad = leftHanded ? -DegToRad(degree) : DegToRad(degree);
 	Spin(aiQuaternion(front, rad));
@@ -734,36 +799,31 @@ void Transform::SpinRoll(float degree)
 
 void Transform::Spin(aiQuaternion q)
 {
-	rotation = q*rotation;
+	rotation = StoreQuaternion(MultiplyQuaternion(LoadQuaternion(q), LoadQuaternion(rotation)));
 	UpdateTransform();
 }
 
 void Transform::UpdateTransform()
 {
-	up = rotation.Rotate(initUp);
-	right = rotation.Rotate(initRight);
-	front = rotation.Rotate(initFront);
-
-	transformMatrix = aiMatrix4x4(rotation.GetMatrix());
-	transformMatrix.a1 *= scaling;
-	transformMatrix.b1 *= scaling;
-	transformMatrix.c1 *= scaling;
-	transformMatrix.a2 *= scaling;
-	transformMatrix.b2 *= scaling;
-	transformMatrix.c2 *= scaling;
-	transformMatrix.a3 *= scaling;
-	transformMatrix.b3 *= scaling;
-	transformMatrix.c3 *= scaling;
-
-	//Column vector matrix
-	transformMatrix.a4 = position.x;
-	transformMatrix.b4 = position.y;
-	transformMatrix.c4 = position.z;
+	matrixDirty = true;
+	basisDirty = true;
+	version++;
+}
 
+void Transform::UpdateBasis()
+{
+	if (!basisDirty)
+		return;
+	Vector4 q = LoadQuaternion(rotation);
+	up = StoreVector(RotateVector(q, LoadVector(initUp, 0)));
+	right = StoreVector(RotateVector(q, LoadVector(initRight, 0)));
+	front = StoreVector(RotateVector(q, LoadVector(initFront, 0)));
+	basisDirty = false;
 }
 
 void Transform::DirectTurnTo(aiVector3D vec)
 {
+	UpdateBasis();
 	vec.Normalize();
 	float dot = vec*front;
 
@@ -785,6 +845,7 @@ void Transform::DirectTurnTo(aiVector3D vec)
 
 void Transform::LockedTurnTo(aiVector3D vec)
 {
+	UpdateBasis();
 	//Calculate Target Right Vector
 	float dot = lockedUp*vec;
 	if (dot > 0.999999)
@@ -866,18 +927,21 @@ void Transform::Move(aiVector3D GlobalVec)
 
 void Transform::MoveFront(float distance)
 {
+	UpdateBasis();
 	position = position + front*distance;
 	UpdateTransform();
 }
 
 void Transform::MoveRight(float distance)
 {
+	UpdateBasis();
 	position = position + right*distance;
 	UpdateTransform();
 }
 
 void Transform::MoveUp(float distance)
 {
+	UpdateBasis();
 	position = position + up*distance;
 	UpdateTransform();
 }
@@ -917,6 +981,9 @@ Camera::Camera()
 	screenAspect = 4.0f / 3.0f;
 	zNear = 0.1f;
 	zFar = 1000;
+	viewDirty = true;
+	viewProjectionDirty = true;
+	viewVersion = 0;
 	UpdateProjectionMatrix();
 }
 
@@ -935,6 +1002,7 @@ void Camera::UpdateProjectionMatrix()
 	projectionMatrix.d3 = 1;
 	projectionMatrix.c4 = -zNear*zFar / (zFar - zNear);
 	projectionMatrix.d4 = 0;
+	viewProjectionDirty = true;
 }
 
 aiMatrix4x4 Camera::GetProjectionMatrix()
@@ -944,7 +1012,28 @@ aiMatrix4x4 Camera::GetProjectionMatrix()
 
 aiMatrix4x4 Camera::GetViewMatrix()
 {
-	aiMatrix4x4 vm = transformMatrix;
-	vm.Inverse();
-	return vm;
+	UpdateViewCache();
+	return viewMatrix;
+}
+
+aiMatrix4x4 Camera::GetViewProjectionMatrix()
+{
+	UpdateViewCache();
+	if (viewProjectionDirty)
+	{
+		viewProjectionMatrix = projectionMatrix * viewMatrix;
+		viewProjectionDirty = false;
+	}
+	return viewProjectionMatrix;
+}
+
+void Camera::UpdateViewCache()
+{
+	if (!viewDirty && viewVersion == GetVersion())
+		return;
+	viewVersion = GetVersion();
+	//Camera transforms are affine, no need for the general 4x4 inverse
+	StoreAffine(InverseAffine(LoadAffine(GetMatrix())), viewMatrix);
+	viewDirty = false;
+	viewProjectionDirty = true;
 }
\ No newline at end of file
@@ -143,6 +143,11 @@ public:
 	vector<Material> materialList;
 	unordered_map<int, Instance*> instances;
 	bool hasAnimation;
+	//Material textures load through TextureData::LoadCached with a mip chain built with mipFilter,
+	//block compressed when compressTextures is set. The work goes on textureThreads when set
+	bool compressTextures;
+	MipFilter mipFilter;
+	ThreadPool* textureThreads;
 
 	Instance* CreateInstance();
 	void DeletInstance(unsigned int instanceID);
@@ -164,6 +169,15 @@ protected:
 	void LoadMesh(const aiScene *source);
 	void LoadNodeListRecur(int parentID, aiNode *ainode);
 	void LoadMaterial(const aiScene *source);
+	struct TextureLoad
+	{
+		TextureData* texture;
+		string filePath;
+		bool normalMap;
+		bool* loaded; //The has...Map flag of the material
+	};
+	void LoadTextures(const vector<TextureLoad> &loads);
+	bool LoadTexture(TextureData &texture, const string &filePath, bool normalMap, ThreadPool* threads);
 };
 
 class Transform
@@ -171,12 +185,16 @@ class Transform
 public:
 
 	static const bool leftHanded = true;
-	aiMatrix4x4 transformMatrix;
 	//For Object On Ground
 	bool verticalLock;
 
 	Transform();
 
+	//Rebuilt on read after a change, edits in between cost nothing
+	const aiMatrix4x4& GetMatrix() const;
+	//Bumped by every change, caches keep the version they were built from
+	unsigned int GetVersion() const;
+
 	void SetPosition(float x, float y, float z);
 	void SetScaling(float size);
 	void SetRotation(aiQuaternion q);
@@ -215,7 +233,7 @@ protected:
 	//Rotaion quaternion against  initial orientation
 	aiQuaternion rotation;
 
-	//Current orientation
+	//Current orientation, call UpdateBasis before reading
 	aiVector3D up;
 	aiVector3D front;
 	aiVector3D right;
@@ -228,7 +246,15 @@ protected:
 	//Turn to a direction with feet still on the ground.
 	void LockedTurnTo(aiVector3D vec);
 
+	//Mark the matrix and the basis as stale
 	void UpdateTransform();
+	void UpdateBasis();
+
+private:
+	mutable aiMatrix4x4 transformMatrix;
+	mutable bool matrixDirty;
+	bool basisDirty;
+	unsigned int version;
 };
 
 struct InstanceMaterial
@@ -292,7 +318,17 @@ public:
 	void UpdateProjectionMatrix();
 	aiMatrix4x4 GetProjectionMatrix();
 	aiMatrix4x4 GetViewMatrix();
+	//Projection * View
+	aiMatrix4x4 GetViewProjectionMatrix();
 
 private:
 	aiMatrix4x4 projectionMatrix;
+
+	//View and ViewProjection are cached, rebuilt only when the transform or the projection changed
+	aiMatrix4x4 viewMatrix;
+	aiMatrix4x4 viewProjectionMatrix;
+	unsigned int viewVersion; //Transform version the cached view was built from
+	bool viewDirty;
+	bool viewProjectionDirty;
+	void UpdateViewCache();
 };
\ No newline at end of file
@@ -9,6 +9,9 @@ using namespace std;
 TextureData::TextureData()
 {
 	data = NULL;
+	mapping = NULL;
+	mappedView = NULL;
+	mappedLevels = NULL;
 	supportedType.push_back("png");
 	supportedType.push_back("jpg");
 	supportedType.push_back("tga");
@@ -33,28 +36,24 @@ void TextureData::Clear()
 		stbi_image_free(data);
 		data = NULL;
 	}
+	vector<unsigned char>().swap(mipChain);
+	ReleaseMapping();
 
 	width = 0;
 	height = 0;
 	imageSize = 0;
+	codec = Codec_None;
+	mipLevels = 1;
 
 }
 bool TextureData::LoadFromFile(string filePath)
 {
 	Clear();
 
-	data = stbi_load(filePath.c_str(), &width, &height, &bpp, 4);
-	if (!data&&GetFileExtention(filePath) == "")//Some model files do not include file extention in texture file name
-	{
-		string tryPath;
-		for (size_t i = 0; i < supportedType.size(); i++)
-		{
-			tryPath = filePath + "." + supportedType[i];
-			data = stbi_load(tryPath.c_str(), &width, &height, &bpp, 4);
-			if (data)
-				break;
-		}
-	}
+	string sourcePath = FindFile(filePath);//Some model files do not include file extention in texture file name
+	if (sourcePath.empty())
+		return false;
+	data = stbi_load(sourcePath.c_str(), &width, &height, &bpp, 4);
 
 	if (!data)
 		return false;
@@ -64,5 +63,9 @@ bool TextureData::LoadFromFile(string filePath)
 }
 unsigned char * TextureData::GetImageDataPtr()
 {
+	if (mappedLevels)
+		return mappedLevels;
+	if (!mipChain.empty())
+		return &mipChain[0];
 	return data;
 }
\ No newline at end of file
@@ -1,9 +1,28 @@
 #pragma once
 #include<vector>
-//Need STB_image lib
+#include<string>
+//Need STB_image lib, and stb_dxt for block compression
 
 using namespace std;
 
+class ThreadPool;
+
+//Block compression of a loaded texture, see TextureData::LoadCompressed
+enum TextureCodec
+{
+	Codec_None, //RGBA8
+	Codec_BC1, //Opaque colour
+	Codec_BC3, //Colour with alpha
+	Codec_BC5 //Normal maps, x and y only
+};
+
+//Downsampling kernel of TextureData::GenerateMips
+enum MipFilter
+{
+	Mip_Box, //2x2 average
+	Mip_Kaiser //6x6 windowed sinc, sharper distant mips at 9 times the taps
+};
+
 class TextureData
 {
 public:
@@ -12,16 +31,48 @@ public:
 	int height;
 	int bpp;
 	int imageSize;
+	TextureCodec codec;
+	int mipLevels; //Levels in the data, 1 until GenerateMips
 	vector<string> supportedType;
+	//Every level top first, tightly packed: RGBA8 rows without a codec, blocks otherwise.
+	//imageSize is the size of the whole chain. Points into the file mapping for a mapped container
 	unsigned char* GetImageDataPtr();
+	//Bytes of a level, RGBA8 rows or 4x4 blocks
+	static size_t GetLevelSize(TextureCodec codec, int width, int height);
+	//Levels down to 1x1
+	static int GetFullMipLevels(int width, int height);
 
 	bool LoadFromFile(string filePath);
+	//Builds every level down to 1x1 from the loaded image. Colour is filtered in linear light,
+	//normal maps are renormalized per texel. Rows of each level are spread over threads, which may be NULL
+	bool GenerateMips(bool normalMap, MipFilter filter, ThreadPool* threads);
+	//Maps the container filePath + ".ctex" while it is newer than the image and made with the same
+	//options, the levels are used in place: no decode and no copy. Otherwise loads the image, builds
+	//its mips, block compresses them when compress is set and both sides are multiples of 4, then
+	//writes the container next to the image. threads may be NULL
+	bool LoadCached(string filePath, bool normalMap, bool compress, MipFilter filter, ThreadPool* threads);
+	//Encodes the RGBA8 levels, 4x4 blocks of all levels are spread over threads.
+	//BC5 for normal maps, BC3 when any texel isn't opaque, BC1 otherwise
+	bool Compress(bool normalMap, ThreadPool* threads);
 	void Clear();
+	//Folder listings FindFile resolves names with are kept for the process, drop them when images are added
+	static void ClearFileIndex();
+	//filePath, or filePath with a supported extension when it has none. Empty if no file exists.
+	//Looks in the cached listing of the folder instead of probing every extension
+	string FindFile(const string &filePath);
 
 	TextureData();
 	~TextureData();
 protected:
 
-	unsigned char *data;
+	unsigned char *data; //Top level from stb_image, until GenerateMips
+	vector<unsigned char> mipChain;
+	//Container mapped by LoadCached, its view, and the top level in the view
+	void* mapping;
+	void* mappedView;
+	unsigned char* mappedLevels;
+	bool MapContainer(const string &containerPath, bool normalMap, bool compress, MipFilter filter);
+	bool WriteContainer(const string &containerPath, MipFilter filter, bool compress);
+	void ReleaseMapping();
 };
 
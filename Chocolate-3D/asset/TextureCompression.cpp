@@ -0,0 +1,131 @@
+//-------------------------------Texture Compression----------------------------------
+//Offline BCn encoding of TextureData mip chains with stb_dxt. The result is kept in
+//the texture container next to the image, see TextureContainer.cpp.
+//----------------------------------------------------------------------------------
+
+#include"Texture.h"
+#include"ThreadPool.h"
+#include<cstring>
+#include<algorithm>
+using namespace std;
+
+#include"stb-master/stb_image.h"
+#define STB_DXT_IMPLEMENTATION
+#define STBD_MEMSET memset //The bundled default takes one argument
+#include"stb-master/stb_dxt.h"
+
+//Blocks per ParallelFor task
+static const size_t BLOCK_GRAIN = 64;
+
+static size_t BlockBytes(TextureCodec codec)
+{
+	return codec == Codec_BC1 ? 8 : 16;
+}
+
+static size_t BlockCount(int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4);
+}
+
+//Blocks of each level down to 1x1, the last entry is the total
+static vector<size_t> FirstBlocks(int width, int height, int mipLevels)
+{
+	vector<size_t> first(mipLevels + 1, 0);
+	for (int i = 0; i < mipLevels; i++)
+	{
+		first[i + 1] = first[i] + BlockCount(max(width >> i, 1), max(height >> i, 1));
+	}
+	return first;
+}
+
+static bool HasAlpha(const unsigned char* rgba, size_t texels)
+{
+	for (size_t i = 0; i < texels; i++)
+	{
+		if (rgba[i * 4 + 3] != 255)
+			return true;
+	}
+	return false;
+}
+
+bool TextureData::Compress(bool normalMap, ThreadPool * threads)
+{
+	//D3D needs whole blocks on the top level
+	const unsigned char* rgba = GetImageDataPtr();
+	if (!rgba || codec != Codec_None || width % 4 || height % 4)
+		return false;
+
+	TextureCodec target = normalMap ? Codec_BC5 : HasAlpha(rgba, (size_t)width * height) ? Codec_BC3 : Codec_BC1;
+	int levels = mipLevels;
+	vector<const unsigned char*> levelData(levels);
+	levelData[0] = rgba;
+	for (int i = 1; i < levels; i++)
+	{
+		levelData[i] = levelData[i - 1] + (size_t)max(width >> (i - 1), 1) * max(height >> (i - 1), 1) * 4;
+	}
+
+	//Blocks of all levels are one range, a task may cross levels
+	vector<size_t> first = FirstBlocks(width, height, levels);
+	size_t blockBytes = BlockBytes(target);
+	vector<unsigned char> blocks(first[levels] * blockBytes);
+	auto encode = [&](size_t, size_t begin, size_t end)
+	{
+		int level = (int)(upper_bound(first.begin(), first.end(), begin) - first.begin()) - 1;
+		for (size_t b = begin; b < end; b++)
+		{
+			while (b >= first[level + 1]) level++;
+			int w = max(width >> level, 1), h = max(height >> level, 1);
+			size_t index = b - first[level];
+			int blocksX = (w + 3) / 4;
+			int bx = (int)(index % blocksX) * 4, by = (int)(index / blocksX) * 4;
+
+			//Edge blocks of small levels repeat the last row and column
+			unsigned char rgba[64], rg[32];
+			for (int y = 0; y < 4; y++)
+			{
+				for (int x = 0; x < 4; x++)
+				{
+					const unsigned char* t = levelData[level] + ((size_t)min(by + y, h - 1) * w + min(bx + x, w - 1)) * 4;
+					int i = y * 4 + x;
+					memcpy(rgba + i * 4, t, 4);
+					rg[i * 2] = t[0];
+					rg[i * 2 + 1] = t[1];
+				}
+			}
+			unsigned char* out = &blocks[b * blockBytes];
+			if (target == Codec_BC5)
+				stb_compress_bc5_block(out, rg);
+			else
+				stb_compress_dxt_block(out, rgba, target == Codec_BC3, STB_DXT_HIGHQUAL);
+		}
+	};
+	if (threads)
+		threads->ParallelFor(first[levels], BLOCK_GRAIN, encode);
+	else
+		encode(0, 0, first[levels]);
+
+	if (data)
+	{
+		stbi_image_free(data);
+		data = NULL;
+	}
+	ReleaseMapping();
+	mipChain.swap(blocks);
+	codec = target;
+	imageSize = (int)mipChain.size();
+	return true;
+}
+
+size_t TextureData::GetLevelSize(TextureCodec codec, int width, int height)
+{
+	if (codec == Codec_None)
+		return (size_t)width * height * 4;
+	return BlockCount(width, height) * BlockBytes(codec);
+}
+
+int TextureData::GetFullMipLevels(int width, int height)
+{
+	int levels = 1;
+	while ((max(width, height) >> levels) > 0) levels++;
+	return levels;
+}
@@ -0,0 +1,359 @@
+//-------------------------------Texture Container----------------------------------
+//TextureData in a ready to upload form, written next to the image as <image>.ctex.
+//Layout: TextureContainerHeader, then every mip level top first, tightly packed as
+//ResourceManager expects them: RGBA8 rows, or 4x4 blocks for BC codecs.
+//A valid container is memory-mapped and its levels go to resource creation in place,
+//the image is only decoded when the container is missing, older than the image or
+//made with other options.
+//Image names are resolved against a listing of their folder made once per process,
+//so names without an extension don't probe every supported type on disk.
+//----------------------------------------------------------------------------------
+
+#include"Texture.h"
+#include"Usefull.h"
+#include<fstream>
+#include<mutex>
+#include<thread>
+#include<cstdio>
+#ifndef _WIN32
+#include<dirent.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#endif
+#include<unordered_map>
+#include<unordered_set>
+using namespace std;
+
+//Bump when the layout or the encoded output changes, older containers are then rebuilt
+static const UINT CONTAINER_VERSION = 1;
+//Enough for 32768 texels a side
+static const int CONTAINER_MAX_MIPS = 16;
+
+//304 bytes, levels start 16 byte aligned
+struct TextureContainerHeader
+{
+	char magic[4]; //"CTEX"
+	UINT version;
+	UINT codec; //TextureCodec
+	UINT filter; //MipFilter of the levels
+	UINT width;
+	UINT height;
+	UINT mipLevels;
+	UINT compressRequested; //LoadCached compress, the codec may still be Codec_None
+	UINT64 mipOffset[CONTAINER_MAX_MIPS]; //From the start of the file
+	UINT64 mipSize[CONTAINER_MAX_MIPS];
+	UINT64 fileSize;
+	UINT64 reserved;
+};
+
+//Lower case names in each folder listed so far, keyed by the folder as given. LoadCached runs on several threads
+static mutex fileIndexMutex;
+static unordered_map<string, unordered_set<string>> fileIndex;
+
+static string ToLower(string s)
+{
+	for (char &c : s)
+	{
+		c = (char)tolower((unsigned char)c);
+	}
+	return s;
+}
+
+//----File system----
+//Last write time in the platform's own units, only compared with each other
+static bool GetWriteTime(const string &filePath, UINT64 &time)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &attributes))
+		return false;
+	time = ((UINT64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat attributes;
+	if (stat(filePath.c_str(), &attributes))
+		return false;
+	time = (UINT64)attributes.st_mtim.tv_sec * 1000000000ull + (UINT64)attributes.st_mtim.tv_nsec;
+#endif
+	return true;
+}
+
+//Names of the files in folder, which is empty or ends with a separator
+static void ListFiles(const string &folder, unordered_set<string> &files)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE search = FindFirstFileA((folder + "*").c_str(), &found);
+	if (search == INVALID_HANDLE_VALUE)
+		return;
+	do
+	{
+		if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			files.insert(found.cFileName);
+	} while (FindNextFileA(search, &found));
+	FindClose(search);
+#else
+	DIR* search = opendir(folder.empty() ? "." : folder.c_str());
+	if (!search)
+		return;
+	while (dirent* found = readdir(search))
+	{
+		struct stat attributes;
+		if (found->d_type == DT_DIR)
+			continue;
+		if (found->d_type == DT_UNKNOWN && (stat((folder + found->d_name).c_str(), &attributes) || S_ISDIR(attributes.st_mode)))
+			continue;
+		files.insert(found->d_name);
+	}
+	closedir(search);
+#endif
+}
+
+//Read only view of a whole file, NULL if it can't be mapped. mapping is what UnmapFile needs besides the view
+static unsigned char* MapFile(const string &filePath, UINT64 &size, void* &mapping)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return NULL;
+	LARGE_INTEGER fileSize;
+	HANDLE fileMapping = NULL;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	//The mapping keeps the file open
+	CloseHandle(file);
+	if (!fileMapping)
+		return NULL;
+	unsigned char* view = (unsigned char*)MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(fileMapping);
+		return NULL;
+	}
+	size = (UINT64)fileSize.QuadPart;
+	mapping = fileMapping;
+	return view;
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+		return NULL;
+	struct stat attributes;
+	void* view = MAP_FAILED;
+	if (!fstat(file, &attributes) && attributes.st_size > 0)
+		view = mmap(NULL, (size_t)attributes.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	//The mapping keeps the file open
+	close(file);
+	if (view == MAP_FAILED)
+		return NULL;
+	size = (UINT64)attributes.st_size;
+	//munmap wants the length, there is no handle
+	mapping = (void*)(size_t)attributes.st_size;
+	return (unsigned char*)view;
+#endif
+}
+
+static void UnmapFile(void* mapping, void* view)
+{
+#ifdef _WIN32
+	if (view)
+		UnmapViewOfFile(view);
+	if (mapping)
+		CloseHandle(mapping);
+#else
+	if (view)
+		munmap(view, (size_t)mapping);
+#endif
+}
+
+//Replaces target if it exists
+static bool MoveFileOver(const string &source, const string &target)
+{
+#ifdef _WIN32
+	return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return !rename(source.c_str(), target.c_str());
+#endif
+}
+
+//Needs fileIndexMutex
+static const unordered_set<string>& ListFolder(const string &folder)
+{
+	auto it = fileIndex.find(folder);
+	if (it != fileIndex.end())
+		return it->second;
+
+	unordered_set<string> names;
+	ListFiles(folder, names);
+	unordered_set<string> &files = fileIndex[folder];
+	for (const string &name : names)
+	{
+		files.insert(ToLower(name));
+	}
+	return files;
+}
+
+void TextureData::ClearFileIndex()
+{
+	lock_guard<mutex> lock(fileIndexMutex);
+	fileIndex.clear();
+}
+
+string TextureData::FindFile(const string & filePath)
+{
+	//Model texture names may use either separator
+	size_t split = filePath.find_last_of("\\/");
+	string folder = split == string::npos ? "" : filePath.substr(0, split + 1);
+	string name = ToLower(split == string::npos ? filePath : filePath.substr(split + 1));
+
+	lock_guard<mutex> lock(fileIndexMutex);
+	const unordered_set<string> &files = ListFolder(folder);
+	if (files.count(name))
+		return filePath;
+	if (GetFileExtention(name) == "")
+	{
+		for (size_t i = 0; i < supportedType.size(); i++)
+		{
+			if (files.count(name + "." + supportedType[i]))
+				return filePath + "." + supportedType[i];
+		}
+	}
+	return "";
+}
+
+bool TextureData::LoadCached(string filePath, bool normalMap, bool compress, MipFilter filter, ThreadPool * threads)
+{
+	Clear();
+	string sourcePath = FindFile(filePath);
+	if (sourcePath.empty())
+		return false;
+
+	string containerPath = sourcePath + ".ctex";
+	UINT64 sourceTime, containerTime;
+	if (GetWriteTime(sourcePath, sourceTime) && GetWriteTime(containerPath, containerTime) &&
+		containerTime >= sourceTime && MapContainer(containerPath, normalMap, compress, filter))
+		return true;
+
+	if (!LoadFromFile(sourcePath) || !GenerateMips(normalMap, filter, threads))
+		return false;
+	if (compress)
+		Compress(normalMap, threads);
+	if (!WriteContainer(containerPath, filter, compress))
+	{
+		char msg[MAX_PATH + 64];
+		sprintf_s(msg, "TextureData: could not write %s\n", containerPath.c_str());
+		OutputDebugStringA(msg);
+	}
+	return true;
+}
+
+bool TextureData::MapContainer(const string & containerPath, bool normalMap, bool compress, MipFilter filter)
+{
+	UINT64 fileSize;
+	void* fileMapping = NULL;
+	unsigned char* view = MapFile(containerPath, fileSize, fileMapping);
+	if (!view)
+		return false;
+	mapping = fileMapping;
+	mappedView = view;
+	if (fileSize < sizeof(TextureContainerHeader))
+	{
+		ReleaseMapping();
+		return false;
+	}
+
+	const TextureContainerHeader &header = *(const TextureContainerHeader*)view;
+	TextureCodec stored = (TextureCodec)header.codec;
+	bool valid = !memcmp(header.magic, "CTEX", 4) && header.version == CONTAINER_VERSION &&
+		header.filter == (UINT)filter && header.compressRequested == (compress ? 1u : 0u) &&
+		header.fileSize == fileSize && header.width && header.height &&
+		header.mipLevels == (UINT)GetFullMipLevels(header.width, header.height) && header.mipLevels <= CONTAINER_MAX_MIPS;
+	//Same codec LoadCached would pick now
+	if (valid)
+	{
+		bool blocks = compress && header.width % 4 == 0 && header.height % 4 == 0;
+		if (!blocks)
+			valid = stored == Codec_None;
+		else if (normalMap)
+			valid = stored == Codec_BC5;
+		else
+			valid = stored == Codec_BC1 || stored == Codec_BC3;
+	}
+	//Levels must be packed back to back inside the file
+	UINT64 offset = valid ? header.mipOffset[0] : 0;
+	for (UINT i = 0; valid && i < header.mipLevels; i++)
+	{
+		int w = max((int)header.width >> i, 1), h = max((int)header.height >> i, 1);
+		valid = header.mipOffset[i] == offset && header.mipSize[i] == GetLevelSize(stored, w, h);
+		offset += header.mipSize[i];
+	}
+	if (!valid || offset > header.fileSize || header.mipOffset[0] < sizeof(TextureContainerHeader))
+	{
+		ReleaseMapping();
+		return false;
+	}
+
+	width = header.width;
+	height = header.height;
+	bpp = 32;
+	codec = stored;
+	mipLevels = header.mipLevels;
+	imageSize = (int)(offset - header.mipOffset[0]);
+	mappedLevels = view + header.mipOffset[0];
+	return true;
+}
+
+bool TextureData::WriteContainer(const string & containerPath, MipFilter filter, bool compress)
+{
+	const unsigned char* levels = GetImageDataPtr();
+	if (!levels || mipLevels > CONTAINER_MAX_MIPS)
+		return false;
+	TextureContainerHeader header;
+	ZeroMemory(&header, sizeof(header));
+	memcpy(header.magic, "CTEX", 4);
+	header.version = CONTAINER_VERSION;
+	header.codec = codec;
+	header.filter = filter;
+	header.width = width;
+	header.height = height;
+	header.mipLevels = mipLevels;
+	header.compressRequested = compress ? 1 : 0;
+	UINT64 offset = sizeof(header);
+	for (int i = 0; i < mipLevels; i++)
+	{
+		header.mipOffset[i] = offset;
+		header.mipSize[i] = GetLevelSize(codec, max(width >> i, 1), max(height >> i, 1));
+		offset += header.mipSize[i];
+	}
+	header.fileSize = offset;
+
+	//Written aside and moved in place, so a container being written is never mapped
+	char suffix[32];
+	sprintf_s(suffix, ".%u.tmp", (UINT)hash<thread::id>()(this_thread::get_id()));
+	string tempPath = containerPath + suffix;
+	{
+		ofstream file(tempPath, ios::binary | ios::trunc);
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)levels, (streamsize)(offset - sizeof(header)));
+		if (!file.good())
+		{
+			file.close();
+			remove(tempPath.c_str());
+			return false;
+		}
+	}
+	if (!MoveFileOver(tempPath, containerPath))
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+void TextureData::ReleaseMapping()
+{
+	UnmapFile(mapping, mappedView);
+	mapping = NULL;
+	mappedView = NULL;
+	mappedLevels = NULL;
+}
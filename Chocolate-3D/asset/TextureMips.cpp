@@ -0,0 +1,261 @@
+//-------------------------------Texture Mips----------------------------------
+//CPU mip chains for TextureData, so textures are created with every level at once
+//and need no render target view for GPU GenerateMips.
+//Texels are filtered as float4 in SSE registers. Colour goes to linear light through
+//a table first and back to sRGB when the level is written, alpha stays linear. Normal
+//maps are decoded to [-1, 1] and renormalized when written.
+//Each level is filtered from the float copy of the level above it, not from its RGBA8,
+//so rounding doesn't add up down the chain.
+//------------------------------------------------------------------------------
+
+#include"Texture.h"
+#include"ThreadPool.h"
+#include<emmintrin.h>
+#include<cmath>
+#include<cstring>
+#include<algorithm>
+using namespace std;
+
+#include"stb-master/stb_image.h"
+
+static const int MAX_TAPS = 6;
+//Output texels per ParallelFor task
+static const size_t TEXEL_GRAIN = 16384;
+
+//Taps along one axis, the same both ways. Output texel x reads source texels 2x + first + i
+struct MipKernel
+{
+	int first;
+	int taps;
+	float weights[MAX_TAPS];
+};
+
+//sRGB to linear per byte, and linear quantized to 12 bits back to sRGB
+struct ColourTables
+{
+	float toLinear[256];
+	unsigned char toSRGB[4097];
+	ColourTables()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			float c = i / 255.0f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i <= 4096; i++)
+		{
+			float c = i / 4096.0f;
+			float s = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1 / 2.4f) - 0.055f;
+			toSRGB[i] = (unsigned char)(s * 255 + 0.5f);
+		}
+	}
+};
+
+static const ColourTables& GetTables()
+{
+	static ColourTables tables;
+	return tables;
+}
+
+static double BesselI0(double x)
+{
+	double sum = 1, term = 1;
+	for (int k = 1; k < 32; k++)
+	{
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static MipKernel GetKernel(MipFilter filter)
+{
+	MipKernel kernel;
+	if (filter == Mip_Kaiser)
+	{
+		//Sinc under a Kaiser window 3 output texels wide, alpha 4. Distances are in output
+		//texels from the output texel center to the source texel centers, never 0
+		const double pi = 3.14159265358979, alpha = 4, halfWidth = 1.5;
+		kernel.first = -2;
+		kernel.taps = 6;
+		double weights[MAX_TAPS], sum = 0;
+		for (int i = 0; i < kernel.taps; i++)
+		{
+			double d = (kernel.first + i - 0.5) / 2;
+			double r = d / halfWidth;
+			weights[i] = sin(pi * d) / (pi * d) * BesselI0(alpha * sqrt(1 - r * r)) / BesselI0(alpha);
+			sum += weights[i];
+		}
+		for (int i = 0; i < kernel.taps; i++)
+		{
+			kernel.weights[i] = (float)(weights[i] / sum);
+		}
+	}
+	else
+	{
+		kernel.first = 0;
+		kernel.taps = 2;
+		kernel.weights[0] = kernel.weights[1] = 0.5f;
+	}
+	return kernel;
+}
+
+//RGBA8 row of the top level to float4 texels
+static void DecodeRow(const unsigned char* src, int width, bool normalMap, float* out)
+{
+	if (normalMap)
+	{
+		const __m128 scale = _mm_setr_ps(2 / 255.0f, 2 / 255.0f, 2 / 255.0f, 1 / 255.0f);
+		const __m128 bias = _mm_setr_ps(-1, -1, -1, 0);
+		const __m128i zero = _mm_setzero_si128();
+		for (int x = 0; x < width; x++)
+		{
+			__m128i bytes = _mm_cvtsi32_si128(*(const int*)(src + x * 4));
+			__m128i ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+			_mm_storeu_ps(out + x * 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(ints), scale), bias));
+		}
+		return;
+	}
+	const ColourTables &tables = GetTables();
+	for (int x = 0; x < width; x++)
+	{
+		const unsigned char* t = src + x * 4;
+		_mm_storeu_ps(out + x * 4, _mm_setr_ps(tables.toLinear[t[0]], tables.toLinear[t[1]], tables.toLinear[t[2]], t[3] / 255.0f));
+	}
+}
+
+//float4 texels back to RGBA8
+static void EncodeRow(const float* in, int width, bool normalMap, unsigned char* dst)
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1), half = _mm_set1_ps(0.5f);
+	if (normalMap)
+	{
+		const __m128 xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+		for (int x = 0; x < width; x++)
+		{
+			__m128 v = _mm_loadu_ps(in + x * 4);
+			__m128 n = _mm_and_ps(v, xyz);
+			__m128 squares = _mm_mul_ps(n, n);
+			__m128 length = _mm_add_ps(_mm_add_ps(_mm_shuffle_ps(squares, squares, _MM_SHUFFLE(0, 0, 0, 0)),
+				_mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 1, 1, 1))), _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 2, 2, 2)));
+			length = _mm_sqrt_ps(length);
+			//Texels averaging to nothing keep their direction unnormalized
+			__m128 valid = _mm_cmpgt_ps(length, _mm_set1_ps(1e-6f));
+			n = _mm_or_ps(_mm_and_ps(valid, _mm_div_ps(n, length)), _mm_andnot_ps(valid, n));
+			//x, y, z from [-1, 1], alpha from [0, 1]
+			__m128 unorm = _mm_or_ps(_mm_and_ps(xyz, _mm_add_ps(_mm_mul_ps(n, half), half)), _mm_andnot_ps(xyz, v));
+			unorm = _mm_min_ps(_mm_max_ps(unorm, zero), one);
+			__m128i ints = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(unorm, _mm_set1_ps(255)), half));
+			ints = _mm_packs_epi32(ints, ints);
+			*(int*)(dst + x * 4) = _mm_cvtsi128_si32(_mm_packus_epi16(ints, ints));
+		}
+		return;
+	}
+	const ColourTables &tables = GetTables();
+	const __m128 scale = _mm_setr_ps(4096, 4096, 4096, 255);
+	for (int x = 0; x < width; x++)
+	{
+		//Negative lobes of the Kaiser kernel can leave [0, 1]
+		__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + x * 4), zero), one);
+		int index[4];
+		_mm_storeu_si128((__m128i*)index, _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+		unsigned char* t = dst + x * 4;
+		t[0] = tables.toSRGB[index[0]];
+		t[1] = tables.toSRGB[index[1]];
+		t[2] = tables.toSRGB[index[2]];
+		t[3] = (unsigned char)index[3];
+	}
+}
+
+//One output row from the source rows under the vertical taps
+static void FilterRow(const MipKernel &kernel, const float* const* rows, int srcWidth, int width, float* out)
+{
+	__m128 weights[MAX_TAPS];
+	for (int i = 0; i < kernel.taps; i++)
+	{
+		weights[i] = _mm_set1_ps(kernel.weights[i]);
+	}
+	for (int x = 0; x < width; x++)
+	{
+		int first = x * 2 + kernel.first;
+		int columns[MAX_TAPS];
+		for (int i = 0; i < kernel.taps; i++)
+		{
+			columns[i] = min(max(first + i, 0), srcWidth - 1) * 4;
+		}
+		__m128 sum = _mm_setzero_ps();
+		for (int v = 0; v < kernel.taps; v++)
+		{
+			__m128 row = _mm_setzero_ps();
+			for (int h = 0; h < kernel.taps; h++)
+			{
+				row = _mm_add_ps(row, _mm_mul_ps(weights[h], _mm_loadu_ps(rows[v] + columns[h])));
+			}
+			sum = _mm_add_ps(sum, _mm_mul_ps(weights[v], row));
+		}
+		_mm_storeu_ps(out + x * 4, sum);
+	}
+}
+
+bool TextureData::GenerateMips(bool normalMap, MipFilter filter, ThreadPool * threads)
+{
+	if (!data || codec != Codec_None)
+		return false;
+
+	int levels = GetFullMipLevels(width, height);
+	vector<size_t> offsets(levels + 1, 0);
+	for (int i = 0; i < levels; i++)
+	{
+		offsets[i + 1] = offsets[i] + (size_t)max(width >> i, 1) * max(height >> i, 1) * 4;
+	}
+	mipChain.resize(offsets[levels]);
+	memcpy(&mipChain[0], data, offsets[1]);
+
+	MipKernel kernel = GetKernel(filter);
+	GetTables();
+	//float4 texels of the level above and of the one being filtered. The top level is decoded per row
+	vector<float> source, target;
+	for (int level = 1; level < levels; level++)
+	{
+		int srcWidth = max(width >> (level - 1), 1), srcHeight = max(height >> (level - 1), 1);
+		int w = max(width >> level, 1), h = max(height >> level, 1);
+		target.resize((size_t)w * h * 4);
+		auto filterRows = [&](size_t, size_t begin, size_t end)
+		{
+			vector<float> decoded(level == 1 ? (size_t)srcWidth * 4 * kernel.taps : 0);
+			const float* rows[MAX_TAPS];
+			for (size_t y = begin; y < end; y++)
+			{
+				for (int v = 0; v < kernel.taps; v++)
+				{
+					int sy = min(max((int)y * 2 + kernel.first + v, 0), srcHeight - 1);
+					if (level == 1)
+					{
+						float* row = &decoded[(size_t)v * srcWidth * 4];
+						DecodeRow(data + (size_t)sy * srcWidth * 4, srcWidth, normalMap, row);
+						rows[v] = row;
+					}
+					else
+					{
+						rows[v] = &source[(size_t)sy * srcWidth * 4];
+					}
+				}
+				float* out = &target[y * w * 4];
+				FilterRow(kernel, rows, srcWidth, w, out);
+				EncodeRow(out, w, normalMap, &mipChain[offsets[level] + y * w * 4]);
+			}
+		};
+		size_t grain = max(TEXEL_GRAIN / w, (size_t)1);
+		if (threads)
+			threads->ParallelFor(h, grain, filterRows);
+		else
+			filterRows(0, 0, h);
+		source.swap(target);
+	}
+
+	stbi_image_free(data);
+	data = NULL;
+	mipLevels = levels;
+	imageSize = (int)mipChain.size();
+	return true;
+}
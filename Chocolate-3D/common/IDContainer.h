@@ -1,14 +1,159 @@
 #pragma once
-#include<unordered_map>
-#include<Windows.h>
+#include<vector>
+#include "Platform.h"
 using namespace std;
 
+//-------------------------------Slot Map----------------------------------
+//IDs are (generation << indexBits) | index: the index picks an entry of a sparse
+//table pointing into a dense array, the generation must match that entry, so IDs
+//of erased elements are rejected until the generation wraps.
+//Live elements are packed in the dense array, erasing moves the last one into the hole.
+//IDs stay positive ints, the first ones handed out are 0, 1, 2...
+//-------------------------------------------------------------------------
+template<class T>
+class SlotMap
+{
+public:
+	static const UINT indexBits = 20;
+	static const UINT generationBits = 11;
+	static const UINT capacity = (1 << indexBits) - 1;
+
+	//-1 when full
+	int Insert(const T &element);
+	//O(1), false for stale IDs
+	bool Erase(UINT id);
+	bool Contains(UINT id) const;
+	void Clear();
+	size_t Size() const;
+	bool IsFull() const;
+
+	//The ID must be live
+	T& operator[](UINT id);
+	const T& operator[](UINT id) const;
+
+	//Live elements, contiguous
+	typename vector<T>::iterator begin() { return elements.begin(); }
+	typename vector<T>::iterator end() { return elements.end(); }
+	typename vector<T>::const_iterator begin() const { return elements.begin(); }
+	typename vector<T>::const_iterator end() const { return elements.end(); }
+	//ID of the element at position i of the iteration
+	UINT IDAt(size_t i) const { return ids[i]; }
+
+private:
+	static const UINT freeSlot = 0xffffffff;
+	vector<T> elements;
+	vector<UINT> ids; //Dense slot to ID
+	vector<UINT> slotOfIndex; //Sparse index to dense slot, freeSlot when unused
+	vector<UINT16> generations;
+	vector<UINT> freeIndices;
+
+	static UINT IndexOf(UINT id) { return id & ((1 << indexBits) - 1); }
+	static UINT GenerationOf(UINT id) { return id >> indexBits; }
+	void Release(UINT index);
+};
+
+template<class T>
+int SlotMap<T>::Insert(const T & element)
+{
+	UINT index;
+	if (!freeIndices.empty())
+	{
+		index = freeIndices.back();
+		freeIndices.pop_back();
+	}
+	else
+	{
+		if (IsFull())
+			return -1;
+		index = (UINT)slotOfIndex.size();
+		slotOfIndex.push_back(0);
+		generations.push_back(0);
+	}
+	UINT id = (generations[index] << indexBits) | index;
+	slotOfIndex[index] = (UINT)elements.size();
+	elements.push_back(element);
+	ids.push_back(id);
+	return (int)id;
+}
+
+template<class T>
+bool SlotMap<T>::Erase(UINT id)
+{
+	if (!Contains(id))
+		return false;
+	UINT index = IndexOf(id);
+	UINT slot = slotOfIndex[index];
+	UINT last = (UINT)elements.size() - 1;
+	if (slot != last)
+	{
+		swap(elements[slot], elements[last]);
+		ids[slot] = ids[last];
+		slotOfIndex[IndexOf(ids[slot])] = slot;
+	}
+	elements.pop_back();
+	ids.pop_back();
+	Release(index);
+	return true;
+}
+
+template<class T>
+void SlotMap<T>::Release(UINT index)
+{
+	slotOfIndex[index] = freeSlot;
+	generations[index] = (generations[index] + 1) & ((1 << generationBits) - 1);
+	freeIndices.push_back(index);
+}
+
+template<class T>
+bool SlotMap<T>::Contains(UINT id) const
+{
+	UINT index = IndexOf(id);
+	return index < slotOfIndex.size() && slotOfIndex[index] != freeSlot && generations[index] == GenerationOf(id);
+}
+
+template<class T>
+void SlotMap<T>::Clear()
+{
+	//Generations still move on, IDs from before stay stale
+	for (UINT id : ids)
+	{
+		Release(IndexOf(id));
+	}
+	elements.clear();
+	ids.clear();
+}
+
+template<class T>
+size_t SlotMap<T>::Size() const
+{
+	return elements.size();
+}
+
+template<class T>
+bool SlotMap<T>::IsFull() const
+{
+	return freeIndices.empty() && slotOfIndex.size() >= capacity;
+}
+
+template<class T>
+T & SlotMap<T>::operator[](UINT id)
+{
+	return elements[slotOfIndex[IndexOf(id)]];
+}
+
+template<class T>
+const T & SlotMap<T>::operator[](UINT id) const
+{
+	return elements[slotOfIndex[IndexOf(id)]];
+}
 
 template<class T>
 class IDContainer {
 protected:
-	unordered_map<UINT, T> pool;
-	int GenerateID() const;
+	SlotMap<T> pool;
+	//Returns INVALID when full
+	int Insert(const T &element);
+	bool IsFull() const;
 	virtual void Release(T &element);
 public:
 	IDContainer();
@@ -21,21 +166,21 @@ public:
 
 
 template<class T>
-int IDContainer<T>::GenerateID() const
+int IDContainer<T>::Insert(const T & element)
 {
-	int i;
-	for (i = 0; i < INT_MAX; i++)
-	{
-		if (!Exist(i))
-			return i;
-	}
-	return INVALID;
+	return pool.Insert(element);
+}
+
+template<class T>
+bool IDContainer<T>::IsFull() const
+{
+	return pool.IsFull();
 }
 
 template<class T>
 bool IDContainer<T>::Exist(UINT id) const
 {
-	return pool.find(id) != pool.end();
+	return pool.Contains(id);
 }
 
 template<class T>
@@ -55,7 +200,7 @@ void IDContainer<T>::Delete(UINT id)
 	if (Exist(id))
 	{
 		Release(pool[id]);
-		pool.erase(id);
+		pool.Erase(id);
 	}
 }
 
@@ -64,9 +209,9 @@ void IDContainer<T>::Clear()
 {
 	for (auto& e : pool)
 	{
-		Release(e.second);
+		Release(e);
 	}
-	pool.clear();
+	pool.Clear();
 }
 
 template<class T>
@@ -88,4 +233,4 @@ public:
 private:
 	Singleton() {};
 	~Singleton() {};
-};
\ No newline at end of file
+};
@@ -0,0 +1,58 @@
+//-------------------------------------------------------------------------
+//-------------------Platform----------------------------------------------
+//windows.h on Windows. Elsewhere the few types and calls the CPU side of the
+//engine takes from it, so it builds headless without the Windows SDK.
+//-------------------------------------------------------------------------
+
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+typedef unsigned char BYTE;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef unsigned int UINT;
+typedef uint64_t UINT64;
+typedef int64_t INT64;
+typedef uint32_t DWORD;
+typedef float FLOAT;
+typedef const char* LPCSTR;
+
+#define MAX_PATH 260
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+
+//Debug output and message boxes go to stderr
+inline void OutputDebugStringA(const char* text)
+{
+	fputs(text, stderr);
+}
+
+inline int MessageBoxA(void*, const char* text, const char* caption, UINT)
+{
+	fprintf(stderr, "%s: %s\n", caption ? caption : "Error", text);
+	return 0;
+}
+
+template <size_t size, typename... Args>
+inline int sprintf_s(char (&buffer)[size], const char* format, Args... args)
+{
+	return snprintf(buffer, size, format, args...);
+}
+#endif
+
+#include <string>
+//Effect files name their shaders and states with Windows separators
+inline std::string NativePath(std::string path)
+{
+#ifndef _WIN32
+	for (char &c : path)
+	{
+		if (c == '\\') c = '/';
+	}
+#endif
+	return path;
+}
@@ -0,0 +1,50 @@
+#include "RadixSort.h"
+#include <cstring>
+
+void RadixSort(vector<SortItem>& items, vector<SortItem>& scratch)
+{
+	const size_t count = items.size();
+	if (count < 2) return;
+	scratch.resize(count);
+
+	//All 8 histograms in one read of the keys
+	size_t histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+	for (size_t i = 0; i < count; i++)
+	{
+		unsigned long long key = items[i].key;
+		for (int pass = 0; pass < 8; pass++)
+		{
+			histogram[pass][(key >> (pass * 8)) & 0xff]++;
+		}
+	}
+
+	SortItem* src = &items[0];
+	SortItem* dst = &scratch[0];
+	for (int pass = 0; pass < 8; pass++)
+	{
+		size_t* bucket = histogram[pass];
+		const int shift = pass * 8;
+		//Skip the pass if one digit holds every key
+		if (bucket[(src[0].key >> shift) & 0xff] == count)
+			continue;
+
+		size_t offset = 0;
+		for (int d = 0; d < 256; d++)
+		{
+			size_t n = bucket[d];
+			bucket[d] = offset;
+			offset += n;
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			dst[bucket[(src[i].key >> shift) & 0xff]++] = src[i];
+		}
+		SortItem* t = src;
+		src = dst;
+		dst = t;
+	}
+
+	if (src != &items[0])
+		items.swap(scratch);
+}
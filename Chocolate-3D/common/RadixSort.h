@@ -0,0 +1,18 @@
+//-------------------------------Radix Sort----------------------------------
+//LSD radix sort on 64-bit keys, 8 bits per pass.
+//Stable, and passes where every key has the same digit are skipped, so keys
+//that only use a few bits cost only a few passes.
+//---------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+using namespace std;
+
+struct SortItem
+{
+	unsigned long long key;
+	unsigned int value;
+};
+
+//Sort items by key ascending, scratch is resized and used as the ping-pong buffer
+void RadixSort(vector<SortItem> &items, vector<SortItem> &scratch);
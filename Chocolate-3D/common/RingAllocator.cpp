@@ -0,0 +1,99 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(size_t capacity, size_t framesInFlight)
+{
+	Reset(capacity, framesInFlight);
+}
+
+void RingAllocator::Reset(size_t capacity, size_t framesInFlight)
+{
+	this->capacity = capacity;
+	this->framesInFlight = framesInFlight;
+	head = 0;
+	tail = 0;
+	frameStarts.clear();
+	discardNext = true; //The buffer starts with a discard
+	wrapCount = 0;
+	discardCount = 0;
+}
+
+void RingAllocator::BeginFrame()
+{
+	if (!framesInFlight)
+		return;
+	frameStarts.push_back(head);
+	while (frameStarts.size() > framesInFlight)
+	{
+		frameStarts.pop_front();
+	}
+	tail = frameStarts.front();
+}
+
+bool RingAllocator::Allocate(size_t size, size_t alignment, size_t & outOffset, bool & outDiscard)
+{
+	if (size == 0 || size > capacity)
+		return false;
+	if (alignment == 0) alignment = 1;
+
+	size_t offset = head % capacity;
+	size_t position = head + (offset + alignment - 1) / alignment * alignment - offset;
+	offset = position % capacity;
+	if (offset + size > capacity)
+	{
+		//Skip the end of the buffer
+		position += capacity - offset;
+		offset = 0;
+		wrapCount++;
+	}
+	else if (offset == 0 && position != head)
+	{
+		//Alignment reached the end exactly
+		wrapCount++;
+	}
+	outDiscard = discardNext || position + size - tail > capacity;
+	if (outDiscard)
+	{
+		//Everything written before lives in the renamed buffer now
+		if (offset != 0)
+		{
+			position += capacity - offset;
+			offset = 0;
+			wrapCount++;
+		}
+		tail = position;
+		for (size_t &start : frameStarts)
+		{
+			start = position;
+		}
+		discardNext = false;
+		discardCount++;
+	}
+	outOffset = offset;
+	head = position + size;
+	return true;
+}
+
+size_t RingAllocator::GetCapacity() const
+{
+	return capacity;
+}
+
+size_t RingAllocator::GetHead() const
+{
+	return capacity ? head % capacity : 0;
+}
+
+size_t RingAllocator::GetWrapCount() const
+{
+	return wrapCount;
+}
+
+size_t RingAllocator::GetDiscardCount() const
+{
+	return discardCount;
+}
+
+size_t RingAllocator::GetLiveSize() const
+{
+	return head - tail;
+}
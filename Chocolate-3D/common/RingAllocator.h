@@ -0,0 +1,44 @@
+//-------------------------------Ring Allocator----------------------------------
+//CPU side bookkeeping for a dynamic buffer that is filled front to back.
+//Every frame BeginFrame fences the data written so far; the fence of a frame lifts
+//framesInFlight frames later, when the GPU is done reading it. Space that only
+//overlaps lifted frames can be written with Map(NO_OVERWRITE), wrapping included.
+//An allocation that would reach data still in flight restarts at the front and must
+//be written with Map(DISCARD), so the driver renames the buffer under in-flight draws.
+//With framesInFlight 0 nothing is fenced and every wrap discards.
+//No device access: units are whatever the caller uses (bytes or elements).
+//-------------------------------------------------------------------------------
+
+#pragma once
+#include <cstddef>
+#include <deque>
+
+class RingAllocator
+{
+public:
+	RingAllocator(size_t capacity = 0, size_t framesInFlight = 0);
+	void Reset(size_t capacity, size_t framesInFlight = 0);
+
+	//Starts a frame, the oldest in-flight frame is assumed done
+	void BeginFrame();
+	//False if size can never fit. outDiscard is set when the allocation restarted at
+	//offset 0 over data still in flight, the write has to discard
+	bool Allocate(size_t size, size_t alignment, size_t &outOffset, bool &outDiscard);
+
+	size_t GetCapacity() const;
+	size_t GetHead() const; //Offset the next allocation starts from, before alignment
+	size_t GetWrapCount() const;
+	size_t GetDiscardCount() const;
+	size_t GetLiveSize() const; //Units written by frames still in flight, alignment gaps included
+
+private:
+	size_t capacity;
+	size_t framesInFlight;
+	//Positions count every unit ever passed, offsets are positions modulo capacity
+	size_t head;
+	size_t tail; //Start of the oldest frame in flight
+	std::deque<size_t> frameStarts;
+	bool discardNext;
+	size_t wrapCount;
+	size_t discardCount;
+};
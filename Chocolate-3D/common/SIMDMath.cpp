@@ -0,0 +1,273 @@
+#include "SIMDMath.h"
+#include <emmintrin.h>
+#include <cstring>
+
+#define SHUFFLE(v, x, y, z, w) _mm_shuffle_ps(v, v, _MM_SHUFFLE(w, z, y, x))
+
+static const __m128 maskXYZ = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+static const __m128 maskW = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+Vector4 LoadVector(const aiVector3D & v, float w)
+{
+	return _mm_set_ps(w, v.z, v.y, v.x);
+}
+
+aiVector3D StoreVector(Vector4 v)
+{
+	float f[4];
+	_mm_storeu_ps(f, v);
+	return aiVector3D(f[0], f[1], f[2]);
+}
+
+Vector4 LoadQuaternion(const aiQuaternion & q)
+{
+	return _mm_set_ps(q.w, q.z, q.y, q.x);
+}
+
+aiQuaternion StoreQuaternion(Vector4 q)
+{
+	float f[4];
+	_mm_storeu_ps(f, q);
+	return aiQuaternion(f[3], f[0], f[1], f[2]);
+}
+
+//aiMatrix4x4 is packed, its floats are copied through a local array instead of pointed at
+AffineMatrix LoadAffine(const aiMatrix4x4 & m)
+{
+	float f[12];
+	memcpy(f, &m, sizeof(f));
+	AffineMatrix result;
+	result.row[0] = _mm_loadu_ps(f);
+	result.row[1] = _mm_loadu_ps(f + 4);
+	result.row[2] = _mm_loadu_ps(f + 8);
+	return result;
+}
+
+void StoreAffine(const AffineMatrix & m, aiMatrix4x4 & out)
+{
+	float f[16];
+	_mm_storeu_ps(f, m.row[0]);
+	_mm_storeu_ps(f + 4, m.row[1]);
+	_mm_storeu_ps(f + 8, m.row[2]);
+	_mm_storeu_ps(f + 12, _mm_set_ps(1, 0, 0, 0));
+	memcpy(&out, f, sizeof(f));
+}
+
+Vector4 Cross(Vector4 a, Vector4 b)
+{
+	__m128 result = _mm_sub_ps(_mm_mul_ps(SHUFFLE(a, 1, 2, 0, 3), SHUFFLE(b, 2, 0, 1, 3)), _mm_mul_ps(SHUFFLE(a, 2, 0, 1, 3), SHUFFLE(b, 1, 2, 0, 3)));
+	return _mm_and_ps(result, maskXYZ);
+}
+
+Vector4 Dot3(Vector4 a, Vector4 b)
+{
+	__m128 p = _mm_mul_ps(a, b);
+	return _mm_add_ps(_mm_add_ps(SHUFFLE(p, 0, 0, 0, 0), SHUFFLE(p, 1, 1, 1, 1)), SHUFFLE(p, 2, 2, 2, 2));
+}
+
+Vector4 MultiplyQuaternion(Vector4 a, Vector4 b)
+{
+	//xyz = aw * b + bw * a + a x b, w = aw * bw - a . b
+	__m128 aw = SHUFFLE(a, 3, 3, 3, 3);
+	__m128 bw = SHUFFLE(b, 3, 3, 3, 3);
+	__m128 xyz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, b), _mm_mul_ps(bw, a)), Cross(a, b));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(aw, bw), Dot3(a, b));
+	return _mm_or_ps(_mm_and_ps(xyz, maskXYZ), _mm_and_ps(w, maskW));
+}
+
+Vector4 RotateVector(Vector4 q, Vector4 v)
+{
+	//v + w * t + q x t, with t = 2 * (q x v)
+	v = _mm_and_ps(v, maskXYZ);
+	__m128 t = Cross(q, v);
+	t = _mm_add_ps(t, t);
+	return _mm_add_ps(_mm_add_ps(v, _mm_mul_ps(SHUFFLE(q, 3, 3, 3, 3), t)), Cross(q, t));
+}
+
+AffineMatrix ComposeAffine(Vector4 translation, Vector4 rotation, Vector4 scaling)
+{
+	//Products of the quaternion terms, same layout as aiQuaternion::GetMatrix
+	__m128 q2 = _mm_add_ps(rotation, rotation);
+	__m128 square = _mm_mul_ps(rotation, q2);															//2xx 2yy 2zz
+	__m128 mixed = _mm_mul_ps(SHUFFLE(rotation, 0, 0, 1, 3), SHUFFLE(q2, 1, 2, 2, 3));					//2xy 2xz 2yz
+	__m128 byW = _mm_mul_ps(SHUFFLE(rotation, 3, 3, 3, 3), SHUFFLE(q2, 2, 1, 0, 3));						//2wz 2wy 2wx
+	__m128 diagonal = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1), SHUFFLE(square, 1, 0, 0, 3)), SHUFFLE(square, 2, 2, 1, 3));
+	__m128 sum = _mm_add_ps(mixed, byW);
+	__m128 difference = _mm_sub_ps(mixed, byW);
+
+	float d[4], s[4], f[4], t[4];
+	_mm_storeu_ps(d, diagonal);
+	_mm_storeu_ps(s, sum);
+	_mm_storeu_ps(f, difference);
+	_mm_storeu_ps(t, translation);
+	//Columns are scaled, translation goes to the last lane
+	__m128 scale = _mm_and_ps(scaling, maskXYZ);
+	AffineMatrix result;
+	result.row[0] = _mm_add_ps(_mm_mul_ps(_mm_set_ps(0, s[1], f[0], d[0]), scale), _mm_set_ps(t[0], 0, 0, 0));
+	result.row[1] = _mm_add_ps(_mm_mul_ps(_mm_set_ps(0, f[2], d[1], s[0]), scale), _mm_set_ps(t[1], 0, 0, 0));
+	result.row[2] = _mm_add_ps(_mm_mul_ps(_mm_set_ps(0, d[2], s[2], f[1]), scale), _mm_set_ps(t[2], 0, 0, 0));
+	return result;
+}
+
+static inline __m128 MultiplyAffineRow(__m128 left, const __m128 right[3])
+{
+	__m128 row = _mm_mul_ps(SHUFFLE(left, 0, 0, 0, 0), right[0]);
+	row = _mm_add_ps(row, _mm_mul_ps(SHUFFLE(left, 1, 1, 1, 1), right[1]));
+	row = _mm_add_ps(row, _mm_mul_ps(SHUFFLE(left, 2, 2, 2, 2), right[2]));
+	//Last row of right is 0 0 0 1
+	return _mm_add_ps(row, _mm_and_ps(left, maskW));
+}
+
+AffineMatrix MultiplyAffine(const AffineMatrix & left, const AffineMatrix & right)
+{
+	AffineMatrix result;
+	for (int i = 0; i < 3; i++)
+	{
+		result.row[i] = MultiplyAffineRow(left.row[i], right.row);
+	}
+	return result;
+}
+
+AffineMatrix InverseAffine(const AffineMatrix & m)
+{
+	__m128 r0 = _mm_and_ps(m.row[0], maskXYZ);
+	__m128 r1 = _mm_and_ps(m.row[1], maskXYZ);
+	__m128 r2 = _mm_and_ps(m.row[2], maskXYZ);
+	//Cross products of the rows are the columns of the inverse times the determinant
+	__m128 c0 = Cross(r1, r2);
+	__m128 c1 = Cross(r2, r0);
+	__m128 c2 = Cross(r0, r1);
+	__m128 invDet = _mm_div_ps(_mm_set1_ps(1), Dot3(r0, c0));
+	c0 = _mm_mul_ps(c0, invDet);
+	c1 = _mm_mul_ps(c1, invDet);
+	c2 = _mm_mul_ps(c2, invDet);
+
+	//-(inverse * translation)
+	__m128 t = _mm_mul_ps(c0, SHUFFLE(m.row[0], 3, 3, 3, 3));
+	t = _mm_add_ps(t, _mm_mul_ps(c1, SHUFFLE(m.row[1], 3, 3, 3, 3)));
+	t = _mm_add_ps(t, _mm_mul_ps(c2, SHUFFLE(m.row[2], 3, 3, 3, 3)));
+	t = _mm_sub_ps(_mm_setzero_ps(), t);
+
+	_MM_TRANSPOSE4_PS(c0, c1, c2, t);
+	AffineMatrix result;
+	result.row[0] = c0;
+	result.row[1] = c1;
+	result.row[2] = c2;
+	return result;
+}
+
+//Columns of the 3x3 part and the translation, for point transforms
+struct AffineColumns
+{
+	__m128 c[4];
+	AffineColumns(const AffineMatrix &m)
+	{
+		c[0] = m.row[0];
+		c[1] = m.row[1];
+		c[2] = m.row[2];
+		c[3] = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+	}
+	__m128 Transform(__m128 p) const
+	{
+		__m128 result = _mm_add_ps(c[3], _mm_mul_ps(c[0], SHUFFLE(p, 0, 0, 0, 0)));
+		result = _mm_add_ps(result, _mm_mul_ps(c[1], SHUFFLE(p, 1, 1, 1, 1)));
+		return _mm_add_ps(result, _mm_mul_ps(c[2], SHUFFLE(p, 2, 2, 2, 2)));
+	}
+};
+
+Vector4 TransformPoint(const AffineMatrix & m, Vector4 p)
+{
+	return AffineColumns(m).Transform(p);
+}
+
+void TransformBound(const AffineMatrix & m, aiVector3D & min, aiVector3D & max)
+{
+	//New center through m, new extent through |m|
+	AffineColumns columns(m);
+	__m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 lo = LoadVector(min, 0);
+	__m128 hi = LoadVector(max, 0);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 center = _mm_mul_ps(_mm_add_ps(lo, hi), half);
+	__m128 extent = _mm_mul_ps(_mm_sub_ps(hi, lo), half);
+
+	__m128 newCenter = columns.Transform(center);
+	__m128 newExtent = _mm_mul_ps(_mm_andnot_ps(signMask, columns.c[0]), SHUFFLE(extent, 0, 0, 0, 0));
+	newExtent = _mm_add_ps(newExtent, _mm_mul_ps(_mm_andnot_ps(signMask, columns.c[1]), SHUFFLE(extent, 1, 1, 1, 1)));
+	newExtent = _mm_add_ps(newExtent, _mm_mul_ps(_mm_andnot_ps(signMask, columns.c[2]), SHUFFLE(extent, 2, 2, 2, 2)));
+	min = StoreVector(_mm_sub_ps(newCenter, newExtent));
+	max = StoreVector(_mm_add_ps(newCenter, newExtent));
+}
+
+//Row i of left * right is sum over k of left[i][k] * row k of right.
+//The 16 broadcasts of left are shared by the whole batch.
+struct BroadcastMatrix
+{
+	__m128 e[4][4];
+	BroadcastMatrix(const aiMatrix4x4 &m)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				e[i][k] = _mm_set1_ps(m[i][k]);
+			}
+		}
+	}
+};
+
+static inline void MultiplyRows(const BroadcastMatrix &left, const aiMatrix4x4 &right, aiMatrix4x4 &out)
+{
+	float r[16];
+	memcpy(r, &right, sizeof(r));
+	__m128 r0 = _mm_loadu_ps(r);
+	__m128 r1 = _mm_loadu_ps(r + 4);
+	__m128 r2 = _mm_loadu_ps(r + 8);
+	__m128 r3 = _mm_loadu_ps(r + 12);
+	float o[16];
+	for (int i = 0; i < 4; i++)
+	{
+		__m128 row = _mm_mul_ps(left.e[i][0], r0);
+		row = _mm_add_ps(row, _mm_mul_ps(left.e[i][1], r1));
+		row = _mm_add_ps(row, _mm_mul_ps(left.e[i][2], r2));
+		row = _mm_add_ps(row, _mm_mul_ps(left.e[i][3], r3));
+		_mm_storeu_ps(o + 4 * i, row);
+	}
+	memcpy(&out, o, sizeof(o));
+}
+
+void MultiplyMatrixBatch(const aiMatrix4x4 & left, const aiMatrix4x4 * right, size_t count, aiMatrix4x4 * out)
+{
+	BroadcastMatrix l(left);
+	for (size_t i = 0; i < count; i++)
+	{
+		MultiplyRows(l, right[i], out[i]);
+	}
+}
+
+void MultiplyMatrixBatch(const aiMatrix4x4 & left, const aiMatrix4x4 * const * right, size_t count, aiMatrix4x4 * out)
+{
+	BroadcastMatrix l(left);
+	for (size_t i = 0; i < count; i++)
+	{
+		MultiplyRows(l, *right[i], out[i]);
+	}
+}
+
+void MultiplyAffineBatch(const AffineMatrix & left, const aiMatrix4x4 * right, size_t count, aiMatrix4x4 * out)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		StoreAffine(MultiplyAffine(left, LoadAffine(right[i])), out[i]);
+	}
+}
+
+void TransformPointBatch(const AffineMatrix & m, const aiVector3D * points, size_t count, aiVector3D * out)
+{
+	AffineColumns columns(m);
+	for (size_t i = 0; i < count; i++)
+	{
+		out[i] = StoreVector(columns.Transform(LoadVector(points[i], 1)));
+	}
+}
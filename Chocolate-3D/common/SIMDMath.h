@@ -0,0 +1,60 @@
+//-------------------------------SIMD Math----------------------------------
+//SSE kernels for the per frame matrix work.
+//Matrices are aiMatrix4x4: row-major storage, column vectors (translation in a4, b4, c4).
+//Vectors and quaternions live in one register as (x, y, z, w), w is the scalar part of a quaternion.
+//AffineMatrix keeps the first three rows of such a matrix, the last row is always 0 0 0 1.
+//Load/Store convert at the Assimp boundary, everything in between stays in registers.
+//--------------------------------------------------------------------------
+
+#pragma once
+#include <cstddef>
+#include <xmmintrin.h>
+#include <assimp/types.h>
+
+typedef __m128 Vector4;
+
+struct AffineMatrix
+{
+	__m128 row[3];
+};
+
+//----------------------------Assimp conversion-----------------------------
+Vector4 LoadVector(const aiVector3D &v, float w);
+aiVector3D StoreVector(Vector4 v);
+Vector4 LoadQuaternion(const aiQuaternion &q);
+aiQuaternion StoreQuaternion(Vector4 q);
+//The last row of m is ignored
+AffineMatrix LoadAffine(const aiMatrix4x4 &m);
+void StoreAffine(const AffineMatrix &m, aiMatrix4x4 &out);
+
+//----------------------------Vector / Quaternion---------------------------
+//w of the result is 0
+Vector4 Cross(Vector4 a, Vector4 b);
+//Dot product of x, y, z in every lane
+Vector4 Dot3(Vector4 a, Vector4 b);
+//Hamilton product, same as aiQuaternion::operator*
+Vector4 MultiplyQuaternion(Vector4 a, Vector4 b);
+//Rotate v by the unit quaternion q, w of the result is 0
+Vector4 RotateVector(Vector4 q, Vector4 v);
+
+//----------------------------Affine matrix---------------------------------
+//Translation * Rotation * Scaling, rotation is a unit quaternion
+AffineMatrix ComposeAffine(Vector4 translation, Vector4 rotation, Vector4 scaling);
+AffineMatrix MultiplyAffine(const AffineMatrix &left, const AffineMatrix &right);
+//Inverse of the 3x3 part from its cofactors, translation follows without touching the last row.
+//A singular matrix gives non finite values, like aiMatrix4x4::Inverse
+AffineMatrix InverseAffine(const AffineMatrix &m);
+//m * (p, 1)
+Vector4 TransformPoint(const AffineMatrix &m, Vector4 p);
+//World bound of a local box through m, min and max are written back
+void TransformBound(const AffineMatrix &m, aiVector3D &min, aiVector3D &max);
+
+//----------------------------Batched---------------------------------------
+//out[i] = left * right[i]
+void MultiplyMatrixBatch(const aiMatrix4x4 &left, const aiMatrix4x4* right, size_t count, aiMatrix4x4* out);
+//Same with the right hand matrices gathered through pointers
+void MultiplyMatrixBatch(const aiMatrix4x4 &left, const aiMatrix4x4* const* right, size_t count, aiMatrix4x4* out);
+//out[i] = left * right[i], for affine matrices kept as aiMatrix4x4. out may alias right
+void MultiplyAffineBatch(const AffineMatrix &left, const aiMatrix4x4* right, size_t count, aiMatrix4x4* out);
+//out[i] = m * (points[i], 1), out may alias points
+void TransformPointBatch(const AffineMatrix &m, const aiVector3D* points, size_t count, aiVector3D* out);
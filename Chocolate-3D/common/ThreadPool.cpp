@@ -0,0 +1,125 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	stop = false;
+	jobTask = NULL;
+	jobCount = 0;
+	jobGrain = 1;
+	jobTasks = 0;
+	generation = 0;
+	activeWorkers = 0;
+	nextTask = 0;
+	pendingTasks = 0;
+
+	if (numThreads == 0)
+	{
+		unsigned int hardware = thread::hardware_concurrency();
+		numThreads = hardware > 1 ? hardware - 1 : 0;
+	}
+	for (unsigned int i = 0; i < numThreads; i++)
+	{
+		workers.push_back(thread(&ThreadPool::WorkerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(jobMutex);
+		stop = true;
+	}
+	jobStart.notify_all();
+	for (thread &t : workers)
+	{
+		t.join();
+	}
+}
+
+unsigned int ThreadPool::GetWorkerCount() const
+{
+	return (unsigned int)workers.size() + 1;
+}
+
+size_t ThreadPool::GetTaskCount(size_t count, size_t grainSize)
+{
+	if (grainSize == 0) grainSize = 1;
+	return (count + grainSize - 1) / grainSize;
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const RangeTask & task)
+{
+	if (count == 0) return;
+	if (grainSize == 0) grainSize = 1;
+	size_t numTasks = GetTaskCount(count, grainSize);
+
+	if (numTasks == 1 || workers.empty())
+	{
+		for (size_t i = 0; i < numTasks; i++)
+		{
+			task(i, i * grainSize, min(count, (i + 1) * grainSize));
+		}
+		return;
+	}
+
+	lock_guard<mutex> submit(submitMutex);
+	{
+		//Workers still leaving the previous job would otherwise pick up indices of this one
+		unique_lock<mutex> lock(jobMutex);
+		jobDone.wait(lock, [this] { return activeWorkers == 0; });
+		jobTask = &task;
+		jobCount = count;
+		jobGrain = grainSize;
+		jobTasks = numTasks;
+		nextTask = 0;
+		pendingTasks = numTasks;
+		generation++;
+	}
+	jobStart.notify_all();
+
+	RunTasks();
+
+	unique_lock<mutex> lock(jobMutex);
+	jobDone.wait(lock, [this] { return pendingTasks == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	unsigned long long seen = 0;
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(jobMutex);
+			jobStart.wait(lock, [&] { return stop || generation != seen; });
+			if (stop) return;
+			seen = generation;
+			activeWorkers++;
+		}
+
+		RunTasks();
+
+		{
+			lock_guard<mutex> lock(jobMutex);
+			activeWorkers--;
+		}
+		jobDone.notify_all();
+	}
+}
+
+void ThreadPool::RunTasks()
+{
+	while (true)
+	{
+		size_t index = nextTask.fetch_add(1);
+		if (index >= jobTasks) return;
+		size_t begin = index * jobGrain;
+		size_t end = min(jobCount, begin + jobGrain);
+		(*jobTask)(index, begin, end);
+		if (pendingTasks.fetch_sub(1) == 1)
+		{
+			lock_guard<mutex> lock(jobMutex);
+			jobDone.notify_all();
+		}
+	}
+}
@@ -0,0 +1,53 @@
+//-------------------------------Thread Pool----------------------------------
+//Fixed set of worker threads for data parallel loops.
+//The calling thread takes part in the work, so a pool of N workers runs N+1 wide.
+//----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+using namespace std;
+
+class ThreadPool
+{
+public:
+	//taskIndex is the position of [begin, end) in the split, use it to address per-task storage
+	typedef function<void(size_t taskIndex, size_t begin, size_t end)> RangeTask;
+
+	//numThreads = 0 picks hardware concurrency - 1
+	explicit ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	//Threads that run tasks, including the caller
+	unsigned int GetWorkerCount() const;
+	//Number of tasks ParallelFor will split count items into
+	static size_t GetTaskCount(size_t count, size_t grainSize);
+	//Split [0, count) into ranges of grainSize and block until all of them are done.
+	//Not reentrant: tasks must not call ParallelFor on the same pool.
+	void ParallelFor(size_t count, size_t grainSize, const RangeTask &task);
+
+private:
+	vector<thread> workers;
+	mutex submitMutex;
+	mutex jobMutex;
+	condition_variable jobStart;
+	condition_variable jobDone;
+	bool stop;
+
+	//Current job, written under jobMutex while no worker is active
+	const RangeTask* jobTask;
+	size_t jobCount;
+	size_t jobGrain;
+	size_t jobTasks;
+	unsigned long long generation;
+	unsigned int activeWorkers;
+	atomic<size_t> nextTask;
+	atomic<size_t> pendingTasks;
+
+	void WorkerLoop();
+	void RunTasks();
+};
@@ -1,6 +1,6 @@
 #pragma once
 #include<string>
-#include<windows.h>
+#include "Platform.h"
 using namespace std;
 
 void Message(LPCSTR title, int in);
@@ -0,0 +1,446 @@
+#include "CommandBuffer.h"
+#include "Pipeline.h"
+#include "Pass.h"
+#include <cstring>
+using namespace std;
+
+struct BindPassPacket
+{
+	const Pass* pass;
+	unsigned int numResourcePorts;
+	unsigned int numSamplerPorts;
+	unsigned int numResources;
+	unsigned int numSamplers;
+	//Followed by numResources + numSamplers ints
+};
+
+struct BindMeshPacket
+{
+	int vertexBufferIDs[numMeshStreams];
+	int indexBufferID;
+};
+
+struct SetBindingPacket
+{
+	unsigned int stages;
+	unsigned int bindFlag;
+	unsigned int slot;
+	int resourceID;
+};
+
+struct UpdateBufferPacket
+{
+	int resourceID;
+	unsigned int size;
+	unsigned int offset;
+	unsigned int discard;
+	//Followed by size bytes
+};
+
+struct DrawPacket
+{
+	unsigned int indexCount;
+	unsigned int instanceCount;
+};
+
+struct ComputePacket
+{
+	unsigned int x, y, z;
+};
+
+struct ResetPacket
+{
+	int resourceID;
+	unsigned int value[4];
+};
+
+struct GenMipPacket
+{
+	int resourceID;
+};
+
+struct BindConstantRangePacket
+{
+	unsigned int stages;
+	unsigned int slot;
+	int resourceID;
+	unsigned int offset;
+	unsigned int size;
+};
+
+CommandBuffer::CommandBuffer()
+{
+	numCommands = 0;
+}
+
+void CommandBuffer::Clear()
+{
+	//Keeps the capacity for the next frame
+	data.clear();
+	numCommands = 0;
+}
+
+bool CommandBuffer::IsEmpty() const
+{
+	return numCommands == 0;
+}
+
+size_t CommandBuffer::GetByteSize() const
+{
+	return data.size();
+}
+
+size_t CommandBuffer::GetCommandCount() const
+{
+	return numCommands;
+}
+
+void * CommandBuffer::Push(CommandType type, size_t payloadSize)
+{
+	size_t size = sizeof(Header) + payloadSize;
+	size = (size + packetAlignment - 1) / packetAlignment * packetAlignment;
+	size_t offset = data.size();
+	data.resize(offset + size);
+	Header header;
+	header.type = type;
+	header.size = (unsigned int)size;
+	memcpy(&data[offset], &header, sizeof(header));
+	numCommands++;
+	return &data[offset + sizeof(Header)];
+}
+
+void CommandBuffer::BindPass(const Pass * pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const vector<int>& resourceIDs, const vector<int>& samplerIDs)
+{
+	BindPassPacket packet;
+	packet.pass = pass;
+	packet.numResourcePorts = numResourcePorts;
+	packet.numSamplerPorts = numSamplerPorts;
+	packet.numResources = (unsigned int)resourceIDs.size();
+	packet.numSamplers = (unsigned int)samplerIDs.size();
+	char* p = (char*)Push(Command_Bind_Pass, sizeof(packet) + sizeof(int) * (resourceIDs.size() + samplerIDs.size()));
+	memcpy(p, &packet, sizeof(packet));
+	p += sizeof(packet);
+	if (!resourceIDs.empty())
+		memcpy(p, &resourceIDs[0], sizeof(int) * resourceIDs.size());
+	p += sizeof(int) * resourceIDs.size();
+	if (!samplerIDs.empty())
+		memcpy(p, &samplerIDs[0], sizeof(int) * samplerIDs.size());
+}
+
+void CommandBuffer::BindMesh(const int vertexBufferIDs[numMeshStreams], int indexBufferID)
+{
+	BindMeshPacket packet;
+	memcpy(packet.vertexBufferIDs, vertexBufferIDs, sizeof(packet.vertexBufferIDs));
+	packet.indexBufferID = indexBufferID;
+	memcpy(Push(Command_Bind_Mesh, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID)
+{
+	SetBindingPacket packet = { stages, bindFlag, slot, resourceID };
+	memcpy(Push(Command_Set_Binding, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::UpdateBuffer(int resourceID, const void * pData, unsigned int size, unsigned int offset, bool discard)
+{
+	UpdateBufferPacket packet = { resourceID, size, offset, discard ? 1u : 0u };
+	char* p = (char*)Push(Command_Update_Buffer, sizeof(packet) + size);
+	memcpy(p, &packet, sizeof(packet));
+	if (size)
+		memcpy(p + sizeof(packet), pData, size);
+}
+
+void CommandBuffer::Draw(unsigned int indexCount, unsigned int instanceCount)
+{
+	DrawPacket packet = { indexCount, instanceCount };
+	memcpy(Push(Command_Draw, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::Compute(unsigned int x, unsigned int y, unsigned int z)
+{
+	ComputePacket packet = { x, y, z };
+	memcpy(Push(Command_Compute, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::Reset(int resourceID, const unsigned int value[4])
+{
+	ResetPacket packet;
+	packet.resourceID = resourceID;
+	memcpy(packet.value, value, sizeof(packet.value));
+	memcpy(Push(Command_Reset, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::GenerateMipMap(int resourceID)
+{
+	GenMipPacket packet = { resourceID };
+	memcpy(Push(Command_Gen_Mip, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size)
+{
+	BindConstantRangePacket packet = { stages, slot, resourceID, offset, size };
+	memcpy(Push(Command_Bind_Constant_Range, sizeof(packet)), &packet, sizeof(packet));
+}
+
+void CommandBuffer::Append(const CommandBuffer & other)
+{
+	data.insert(data.end(), other.data.begin(), other.data.end());
+	numCommands += other.numCommands;
+}
+
+void CommandBuffer::Replay(CommandTarget & target) const
+{
+	size_t offset = 0;
+	while (offset < data.size())
+	{
+		Header header;
+		memcpy(&header, &data[offset], sizeof(header));
+		const char* p = &data[offset + sizeof(Header)];
+		switch (header.type)
+		{
+		case Command_Bind_Pass:
+		{
+			BindPassPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			const int* ids = (const int*)(p + sizeof(packet));
+			target.BindPass(packet.pass, packet.numResourcePorts, packet.numSamplerPorts, ids, packet.numResources, ids + packet.numResources, packet.numSamplers);
+			break;
+		}
+		case Command_Bind_Mesh:
+		{
+			BindMeshPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.BindMesh(packet.vertexBufferIDs, packet.indexBufferID);
+			break;
+		}
+		case Command_Set_Binding:
+		{
+			SetBindingPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.SetBinding(packet.stages, packet.bindFlag, packet.slot, packet.resourceID);
+			break;
+		}
+		case Command_Update_Buffer:
+		{
+			UpdateBufferPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.UpdateBuffer(packet.resourceID, p + sizeof(packet), packet.size, packet.offset, packet.discard != 0);
+			break;
+		}
+		case Command_Draw:
+		{
+			DrawPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.Draw(packet.indexCount, packet.instanceCount);
+			break;
+		}
+		case Command_Compute:
+		{
+			ComputePacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.Compute(packet.x, packet.y, packet.z);
+			break;
+		}
+		case Command_Reset:
+		{
+			ResetPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.Reset(packet.resourceID, packet.value);
+			break;
+		}
+		case Command_Gen_Mip:
+		{
+			GenMipPacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.GenerateMipMap(packet.resourceID);
+			break;
+		}
+		case Command_Bind_Constant_Range:
+		{
+			BindConstantRangePacket packet;
+			memcpy(&packet, p, sizeof(packet));
+			target.BindConstantRange(packet.stages, packet.slot, packet.resourceID, packet.offset, packet.size);
+			break;
+		}
+		}
+		offset += header.size;
+	}
+}
+
+ValidationTarget::ValidationTarget()
+{
+	Clear();
+}
+
+void ValidationTarget::Clear()
+{
+	for (int i = 0; i < Command_Type_Count; i++)
+	{
+		commandCount[i] = 0;
+	}
+	uploadedBytes = 0;
+	drawnInstances = 0;
+	errorCount = 0;
+	firstError.clear();
+	passBound = false;
+	meshBound = false;
+}
+
+void ValidationTarget::Error(const string & message)
+{
+	if (errorCount == 0)
+		firstError = message;
+	errorCount++;
+}
+
+bool ValidationTarget::CheckResource(const char * command, int resourceID, unsigned int bindFlag)
+{
+	const ResourceDesc* desc = PipeLine::Resources().GetDesc(resourceID);
+	if (desc == NULL)
+	{
+		Error(string(command) + ": resource " + to_string(resourceID) + " does not exist");
+		return false;
+	}
+	if (bindFlag && !(desc->bindFlag & bindFlag))
+	{
+		Error(string(command) + ": " + desc->name + " can't be bound that way");
+		return false;
+	}
+	return true;
+}
+
+void ValidationTarget::BindPass(const Pass * pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const int * resourceIDs, unsigned int numResources, const int * samplerIDs, unsigned int numSamplers)
+{
+	commandCount[Command_Bind_Pass]++;
+	passBound = true;
+	if (pass == NULL)
+	{
+		Error("BindPass: no pass");
+		return;
+	}
+	if (numResources != numResourcePorts || numSamplers != numSamplerPorts ||
+		numResourcePorts != pass->resourceBinding.size() || numSamplerPorts != pass->samplerBinding.size())
+	{
+		Error("BindPass: binding count does not match the pass");
+		return;
+	}
+	//-1 leaves a port unbound
+	for (unsigned int i = 0; i < numResources; i++)
+	{
+		if (resourceIDs[i] >= 0)
+			CheckResource("BindPass", resourceIDs[i], pass->resourceBinding[i].flag);
+	}
+	for (unsigned int i = 0; i < numSamplers; i++)
+	{
+		if (samplerIDs[i] >= 0 && !PipeLine::SamplerState().Exist(samplerIDs[i]))
+			Error("BindPass: sampler " + to_string(samplerIDs[i]) + " does not exist");
+	}
+}
+
+void ValidationTarget::BindMesh(const int * vertexBufferIDs, int indexBufferID)
+{
+	commandCount[Command_Bind_Mesh]++;
+	meshBound = true;
+	if (vertexBufferIDs[0] < 0)
+		Error("BindMesh: no position stream");
+	if (indexBufferID < 0)
+		Error("BindMesh: no index buffer");
+	else
+		CheckResource("BindMesh", indexBufferID, Bind_Index_Buffer);
+	//Streams other than the position are optional
+	for (unsigned int i = 0; i < numMeshStreams; i++)
+	{
+		if (vertexBufferIDs[i] >= 0)
+			CheckResource("BindMesh", vertexBufferIDs[i], Bind_Vertex_Buffer);
+	}
+}
+
+void ValidationTarget::SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID)
+{
+	commandCount[Command_Set_Binding]++;
+	if (slot >= MAX_SLOT_NUMBER)
+		Error("SetBinding: slot out of range");
+	if (stages == 0)
+		Error("SetBinding: no stage");
+	//One kind of view per call
+	if (bindFlag == 0 || (bindFlag & (bindFlag - 1)))
+		Error("SetBinding: not a single bind flag");
+	else if (resourceID >= 0)
+		CheckResource("SetBinding", resourceID, bindFlag);
+}
+
+void ValidationTarget::UpdateBuffer(int resourceID, const void * data, unsigned int size, unsigned int offset, bool discard)
+{
+	commandCount[Command_Update_Buffer]++;
+	uploadedBytes += size;
+	if (size == 0)
+		Error("UpdateBuffer: empty upload");
+	if (data == NULL)
+		Error("UpdateBuffer: no data");
+	if (!CheckResource("UpdateBuffer", resourceID, 0))
+		return;
+	const ResourceDesc* desc = PipeLine::Resources().GetDesc(resourceID);
+	//Same limits as Resource::UpdateData
+	if (desc->type != Resource_Buffer)
+		Error("UpdateBuffer: " + desc->name + " is not a buffer");
+	else if (desc->access != Access_Default && desc->access != Access_Dynamic)
+		Error("UpdateBuffer: " + desc->name + " is not writable");
+	else if ((unsigned long long)offset + size > desc->size[0])
+		Error("UpdateBuffer: " + desc->name + " written past its end");
+	//A discard leaves the whole dynamic buffer undefined, RingAllocator only discards at offset 0
+	else if (discard && offset != 0 && desc->access == Access_Dynamic)
+		Error("UpdateBuffer: " + desc->name + " discarded at a non-zero offset");
+}
+
+void ValidationTarget::Draw(unsigned int indexCount, unsigned int instanceCount)
+{
+	commandCount[Command_Draw]++;
+	drawnInstances += instanceCount;
+	if (!passBound)
+		Error("Draw: no pass bound");
+	if (!meshBound)
+		Error("Draw: no mesh bound");
+	if (indexCount == 0 || instanceCount == 0)
+		Error("Draw: empty draw");
+}
+
+void ValidationTarget::Compute(unsigned int x, unsigned int y, unsigned int z)
+{
+	commandCount[Command_Compute]++;
+	if (x == 0 || y == 0 || z == 0)
+		Error("Compute: empty dispatch");
+}
+
+void ValidationTarget::Reset(int resourceID, const unsigned int value[4])
+{
+	commandCount[Command_Reset]++;
+	if (value == NULL)
+		Error("Reset: no value");
+	CheckResource("Reset", resourceID, Bind_Render_Target | Bind_Depth_Stencil | Bind_Unordered_Access);
+}
+
+void ValidationTarget::GenerateMipMap(int resourceID)
+{
+	commandCount[Command_Gen_Mip]++;
+	if (!CheckResource("GenerateMipMap", resourceID, 0))
+		return;
+	//Same condition as Resource::GenerateMips
+	const ResourceDesc* desc = PipeLine::Resources().GetDesc(resourceID);
+	if (desc->mipLevel == 1 || !(desc->bindFlag & Bind_Shader_Resource) || !(desc->bindFlag & Bind_Render_Target))
+		Error("GenerateMipMap: " + desc->name + " has no mips to generate");
+}
+
+void ValidationTarget::BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size)
+{
+	commandCount[Command_Bind_Constant_Range]++;
+	if (stages == 0)
+		Error("BindConstantRange: no stage");
+	if (slot >= MAX_SLOT_NUMBER)
+		Error("BindConstantRange: slot out of range");
+	if (offset % 256 || size == 0 || size % 256)
+		Error("BindConstantRange: range not aligned to 256 bytes");
+	if (!CheckResource("BindConstantRange", resourceID, Bind_Constant_Buffer))
+		return;
+	if ((unsigned long long)offset + size > PipeLine::Resources().GetDesc(resourceID)->size[0])
+		Error("BindConstantRange: range past the end of the buffer");
+}
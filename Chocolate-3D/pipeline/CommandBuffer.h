@@ -0,0 +1,148 @@
+//-------------------------------------------------------------------------
+//-------------------Recorded Command Buffer------------------------------
+//Linear packet stream of pipeline commands, recorded first and replayed later.
+//Buffers have no shared state: record on any thread, stitch them in order with
+//Append, then replay once on the thread that owns the device.
+//Packets only hold resource IDs and copies of uploaded data, no D3D types, so
+//recording and the validating target also build without the D3D headers.
+//-------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include "D3Def.h"
+using namespace std;
+
+class Pass;
+
+enum CommandType
+{
+	Command_Bind_Pass,
+	Command_Bind_Mesh,
+	Command_Set_Binding,
+	Command_Update_Buffer,
+	Command_Draw,
+	Command_Compute,
+	Command_Reset,
+	Command_Gen_Mip,
+	Command_Bind_Constant_Range,
+	Command_Type_Count
+};
+
+//Vertex streams a mesh binds, in the order of BindMesh's vertexBufferIDs
+static const unsigned int numMeshStreams = 7;
+static const unsigned int meshStreamSlots[numMeshStreams] =
+{
+	Slot_Input_Position,
+	Slot_Input_Normal,
+	Slot_Input_Tangent,
+	Slot_Input_Binormal,
+	Slot_Input_TexCoord,
+	Slot_Input_BlendIndices,
+	Slot_Input_BlendWeight
+};
+
+//Receives the decoded packets of a replay
+class CommandTarget
+{
+public:
+	virtual ~CommandTarget() {}
+	//numResourcePorts and numSamplerPorts are the pass layout at record time
+	virtual void BindPass(const Pass* pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const int* resourceIDs, unsigned int numResources, const int* samplerIDs, unsigned int numSamplers) = 0;
+	virtual void BindMesh(const int* vertexBufferIDs, int indexBufferID) = 0;
+	virtual void SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID) = 0;
+	virtual void UpdateBuffer(int resourceID, const void* data, unsigned int size, unsigned int offset, bool discard) = 0;
+	virtual void Draw(unsigned int indexCount, unsigned int instanceCount) = 0;
+	virtual void Compute(unsigned int x, unsigned int y, unsigned int z) = 0;
+	virtual void Reset(int resourceID, const unsigned int value[4]) = 0;
+	virtual void GenerateMipMap(int resourceID) = 0;
+	virtual void BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size) = 0;
+};
+
+class CommandBuffer
+{
+public:
+	CommandBuffer();
+
+	void Clear();
+	bool IsEmpty() const;
+	size_t GetByteSize() const;
+	size_t GetCommandCount() const;
+
+	void BindPass(const Pass* pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const vector<int> &resourceIDs, const vector<int> &samplerIDs);
+	void BindMesh(const int vertexBufferIDs[numMeshStreams], int indexBufferID);
+	void SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID);
+	//Data is copied into the buffer
+	void UpdateBuffer(int resourceID, const void* data, unsigned int size, unsigned int offset, bool discard);
+	void Draw(unsigned int indexCount, unsigned int instanceCount);
+	void Compute(unsigned int x, unsigned int y, unsigned int z);
+	void Reset(int resourceID, const unsigned int value[4]);
+	void GenerateMipMap(int resourceID);
+	//Binds size bytes of a constant buffer from offset, both multiples of 256
+	void BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size);
+
+	//Copy the packets of other after the ones already recorded
+	void Append(const CommandBuffer &other);
+	void Replay(CommandTarget &target) const;
+
+private:
+	struct Header
+	{
+		unsigned int type;
+		unsigned int size; //Whole packet including the header, multiple of packetAlignment
+	};
+	static const unsigned int packetAlignment = 8;
+
+	vector<char> data;
+	size_t numCommands;
+
+	void* Push(CommandType type, size_t payloadSize);
+};
+
+//Replays against the D3D11 PipeLine
+class PipelineTarget : public CommandTarget
+{
+public:
+	void BindPass(const Pass* pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const int* resourceIDs, unsigned int numResources, const int* samplerIDs, unsigned int numSamplers) override;
+	void BindMesh(const int* vertexBufferIDs, int indexBufferID) override;
+	void SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID) override;
+	void UpdateBuffer(int resourceID, const void* data, unsigned int size, unsigned int offset, bool discard) override;
+	void Draw(unsigned int indexCount, unsigned int instanceCount) override;
+	void Compute(unsigned int x, unsigned int y, unsigned int z) override;
+	void Reset(int resourceID, const unsigned int value[4]) override;
+	void GenerateMipMap(int resourceID) override;
+	void BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size) override;
+private:
+	vector<int> resourceScratch;
+	vector<int> samplerScratch;
+};
+
+//Counts commands and checks them against the resource and sampler managers, without touching a device
+class ValidationTarget : public CommandTarget
+{
+public:
+	size_t commandCount[Command_Type_Count];
+	size_t uploadedBytes;
+	size_t drawnInstances;
+	size_t errorCount;
+	string firstError;
+
+	ValidationTarget();
+	void Clear();
+
+	void BindPass(const Pass* pass, unsigned int numResourcePorts, unsigned int numSamplerPorts, const int* resourceIDs, unsigned int numResources, const int* samplerIDs, unsigned int numSamplers) override;
+	void BindMesh(const int* vertexBufferIDs, int indexBufferID) override;
+	void SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID) override;
+	void UpdateBuffer(int resourceID, const void* data, unsigned int size, unsigned int offset, bool discard) override;
+	void Draw(unsigned int indexCount, unsigned int instanceCount) override;
+	void Compute(unsigned int x, unsigned int y, unsigned int z) override;
+	void Reset(int resourceID, const unsigned int value[4]) override;
+	void GenerateMipMap(int resourceID) override;
+	void BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size) override;
+private:
+	bool passBound;
+	bool meshBound;
+	void Error(const string &message);
+	//Logs an error unless resourceID names a resource with one of bindFlag's flags, any flag if 0
+	bool CheckResource(const char* command, int resourceID, unsigned int bindFlag);
+};
@@ -0,0 +1,54 @@
+#include "CommandBuffer.h"
+#include "Pipeline.h"
+#include "Pass.h"
+
+void PipelineTarget::BindPass(const Pass * pass, unsigned int /*numResourcePorts*/, unsigned int /*numSamplerPorts*/, const int * resourceIDs, unsigned int numResources, const int * samplerIDs, unsigned int numSamplers)
+{
+	resourceScratch.assign(resourceIDs, resourceIDs + numResources);
+	samplerScratch.assign(samplerIDs, samplerIDs + numSamplers);
+	pass->Bind(resourceScratch, samplerScratch);
+}
+
+void PipelineTarget::BindMesh(const int * vertexBufferIDs, int indexBufferID)
+{
+	for (unsigned int i = 0; i < numMeshStreams; i++)
+	{
+		PipeLine::Resources().SetBinding(Stage_Input_Assembler, Bind_Vertex_Buffer, meshStreamSlots[i], vertexBufferIDs[i]);
+	}
+	PipeLine::Resources().SetBinding(Stage_Input_Assembler, Bind_Index_Buffer, 0, indexBufferID);
+}
+
+void PipelineTarget::SetBinding(unsigned int stages, unsigned int bindFlag, unsigned int slot, int resourceID)
+{
+	PipeLine::Resources().SetBinding((PipelineStage)stages, (BindFlag)bindFlag, slot, resourceID);
+}
+
+void PipelineTarget::UpdateBuffer(int resourceID, const void * data, unsigned int size, unsigned int offset, bool discard)
+{
+	PipeLine::Resources().UpdateResourceData(resourceID, data, size, offset, discard);
+}
+
+void PipelineTarget::Draw(unsigned int indexCount, unsigned int instanceCount)
+{
+	PipeLine::Draw(indexCount, instanceCount);
+}
+
+void PipelineTarget::Compute(unsigned int x, unsigned int y, unsigned int z)
+{
+	PipeLine::Compute(x, y, z);
+}
+
+void PipelineTarget::Reset(int resourceID, const unsigned int value[4])
+{
+	PipeLine::Resources().Reset(resourceID, value);
+}
+
+void PipelineTarget::GenerateMipMap(int resourceID)
+{
+	PipeLine::Resources().GenerateMipMap(resourceID);
+}
+
+void PipelineTarget::BindConstantRange(unsigned int stages, unsigned int slot, int resourceID, unsigned int offset, unsigned int size)
+{
+	PipeLine::Resources().SetConstantBufferRange((PipelineStage)stages, slot, resourceID, offset, size);
+}
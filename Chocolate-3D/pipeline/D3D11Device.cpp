@@ -0,0 +1,727 @@
+//-------------------------------------------------------------------------
+//-------------------D3D11 Device------------------------------------------
+//Device on D3D11 and a DXGI swap chain. Handles are the D3D11 interfaces
+//themselves, descriptions are converted here and nowhere else.
+//-------------------------------------------------------------------------
+
+#include <windows.h>
+#include <d3d11_1.h>
+#include <d3dcompiler.h>
+#include <assert.h>
+#include <locale>
+#include <codecvt>
+#include "Device.h"
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "D3DCompiler.lib")
+#pragma comment(lib, "dxguid.lib")
+
+#ifdef _DEBUG
+static const DWORD shaderFlag = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+static const DWORD shaderFlag = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif // DEBUG
+
+//The engine's enums carry D3D11's values and are passed through as they are
+static_assert(Format_R8G8B8A8_UNORM == DXGI_FORMAT_R8G8B8A8_UNORM && Format_BC7_UNORM_SRGB == DXGI_FORMAT_BC7_UNORM_SRGB && Format_V408 == DXGI_FORMAT_V408, "Format");
+static_assert(Access_Staging == D3D11_USAGE_STAGING && Access_Dynamic == D3D11_USAGE_DYNAMIC, "AccessType");
+static_assert(Bind_Unordered_Access == D3D11_BIND_UNORDERED_ACCESS && Bind_Video_Encoder == D3D11_BIND_VIDEO_ENCODER, "BindFlag");
+static_assert(Misc_Generate_Mips == D3D11_RESOURCE_MISC_GENERATE_MIPS && Misc_Buffer_Structured == D3D11_RESOURCE_MISC_BUFFER_STRUCTURED, "ResourceMisc");
+static_assert(Map_Write_Discard == D3D11_MAP_WRITE_DISCARD && Map_Write_No_Overwrite == D3D11_MAP_WRITE_NO_OVERWRITE, "MapType");
+static_assert(Clear_Depth == D3D11_CLEAR_DEPTH && Clear_Stencil == D3D11_CLEAR_STENCIL, "ClearFlag");
+static_assert(Topology_Triangle_Strip_Adj == D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP_ADJ && Topology_Patch_List + 1 == D3D_PRIMITIVE_TOPOLOGY_1_CONTROL_POINT_PATCHLIST, "PrimitiveTopology");
+static_assert(Comparison_Always == D3D11_COMPARISON_ALWAYS && Stencil_Decr == D3D11_STENCIL_OP_DECR, "ComparisonFunc, StencilOp");
+static_assert(Blend_Inv_Src1_Alpha == D3D11_BLEND_INV_SRC1_ALPHA && Blend_Op_Max == D3D11_BLEND_OP_MAX, "BlendFactor, BlendOp");
+static_assert(Fill_Solid == D3D11_FILL_SOLID && Cull_Back == D3D11_CULL_BACK, "FillMode, CullMode");
+static_assert(Filter_Anisotropic == D3D11_FILTER_ANISOTROPIC && (Filter_Comparison | Filter_Min_Mag_Mip_Linear) == D3D11_FILTER_COMPARISON_MIN_MAG_MIP_LINEAR && (Filter_Maximum | Filter_Anisotropic) == D3D11_FILTER_MAXIMUM_ANISOTROPIC, "SamplerFilter");
+static_assert(Address_Mirror_Once == D3D11_TEXTURE_ADDRESS_MIRROR_ONCE, "TextureAddressMode");
+static_assert(Component_Float32 == D3D_REGISTER_COMPONENT_FLOAT32, "ShaderComponentType");
+static_assert(RENDER_TARGET_SLOT_COUNT == D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT && KEEP_BOUND_OUTPUTS == D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, "D3Def.h");
+static_assert(sizeof(ViewPortDesc) == sizeof(D3D11_VIEWPORT) && sizeof(Box) == sizeof(D3D11_BOX) && sizeof(SubresourceData) == sizeof(D3D11_SUBRESOURCE_DATA), "Layouts");
+
+class D3D11Device : public Device
+{
+public:
+	D3D11Device();
+	~D3D11Device();
+	//Hardware device with a swap chain on hwnd, false if either can't be created
+	bool Init(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen);
+
+	DeviceBuffer* CreateBuffer(const BufferDesc& desc, const SubresourceData* data) override;
+	DeviceTexture* CreateTexture(const TextureDesc& desc, const SubresourceData* data) override;
+	DeviceShaderResourceView* CreateShaderResourceView(DeviceResource* resource) override;
+	DeviceUnorderedAccessView* CreateUnorderedAccessView(DeviceResource* resource) override;
+	DeviceRenderTargetView* CreateRenderTargetView(DeviceResource* resource) override;
+	DeviceDepthStencilView* CreateDepthStencilView(DeviceResource* resource) override;
+	DeviceInputLayout* CreateInputLayout(const InputElementDesc* elements, UINT numElements, const void* byteCode, size_t byteCodeLength) override;
+	DeviceShader* CreateShader(PipelineStage stage, const void* byteCode, size_t byteCodeLength) override;
+	DeviceDepthStencilState* CreateDepthStencilState(const DepthStencilDesc& desc) override;
+	DeviceBlendState* CreateBlendState(const BlendDesc& desc) override;
+	DeviceRasterizerState* CreateRasterizerState(const RasterizerDesc& desc) override;
+	DeviceSamplerState* CreateSamplerState(const SamplerDesc& desc) override;
+	DeviceTexture* GetBackBuffer(TextureDesc& desc) override;
+	void Release(DeviceObject* object) override;
+
+	bool LoadShader(const string& fileName, const string& entryPoint, PipelineStage stage, vector<BYTE>& byteCode) override;
+	bool ReflectInputs(const void* byteCode, size_t byteCodeLength, vector<ShaderInputParameter>& inputs) override;
+
+	void SetInputLayout(DeviceInputLayout* layout) override;
+	void SetPrimitiveTopology(PrimitiveTopology topology) override;
+	void SetVertexBuffers(UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* strides, const UINT* offsets) override;
+	void SetIndexBuffer(DeviceBuffer* buffer, Format format, UINT offset) override;
+	void SetStreamOutTargets(UINT num, DeviceBuffer* const* buffers, const UINT* offsets) override;
+	void SetShader(PipelineStage stage, DeviceShader* shader) override;
+	void SetConstantBuffers(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers) override;
+	void SetConstantBufferRanges(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) override;
+	void SetShaderResources(UINT stage, UINT startSlot, UINT num, DeviceShaderResourceView* const* views) override;
+	void SetSamplers(UINT stage, UINT startSlot, UINT num, DeviceSamplerState* const* samplers) override;
+	void SetComputeUnorderedAccessViews(UINT startSlot, UINT num, DeviceUnorderedAccessView* const* views) override;
+	void SetOutputs(UINT numRTVs, DeviceRenderTargetView* const* rtvs, DeviceDepthStencilView* dsv, UINT uavStartSlot, UINT numUAVs, DeviceUnorderedAccessView* const* uavs) override;
+	void SetDepthStencilState(DeviceDepthStencilState* state, UINT stencilRef) override;
+	void SetBlendState(DeviceBlendState* state, const FLOAT blendFactor[4], UINT sampleMask) override;
+	void SetRasterizerState(DeviceRasterizerState* state) override;
+	void SetViewports(UINT num, const ViewPortDesc* viewports) override;
+	void ClearRenderTargetView(DeviceRenderTargetView* view, const FLOAT color[4]) override;
+	void ClearDepthStencilView(DeviceDepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil) override;
+	void ClearUnorderedAccessViewUint(DeviceUnorderedAccessView* view, const UINT value[4]) override;
+	bool Map(DeviceResource* resource, UINT subresource, MapType type, MappedSubresource& mapped) override;
+	void Unmap(DeviceResource* resource, UINT subresource) override;
+	void UpdateSubresource(DeviceResource* resource, UINT subresource, const Box* box, const void* data, UINT rowPitch, UINT depthPitch) override;
+	void GenerateMips(DeviceShaderResourceView* view) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount) override;
+	void Dispatch(UINT x, UINT y, UINT z) override;
+	void Present() override;
+
+private:
+	ID3D11Device* pDevice;
+	ID3D11DeviceContext* pContext;
+	ID3D11DeviceContext1* pContext1; //NULL below the 11.1 runtime
+	IDXGISwapChain* pSwapChain;
+	bool CreateSwapChain(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen);
+	D3D11Device(D3D11Device const&);
+	D3D11Device& operator=(D3D11Device const&);
+};
+
+Device* CreateD3D11Device(UINT resolutionX, UINT resolutionY, void* window, bool fullScreen)
+{
+	D3D11Device* device = new D3D11Device();
+	if (!device->Init(resolutionX, resolutionY, (HWND)window, fullScreen))
+	{
+		delete device;
+		return NULL;
+	}
+	return device;
+}
+
+//Handles are the D3D11 interfaces, arrays of them are passed as they are
+#define D3D(type, handle) ((type*)(handle))
+#define D3D_ARRAY(type, handles) ((type* const*)(handles))
+
+static D3D11_USAGE GetUsage(AccessType access, UINT& cpuAccess)
+{
+	cpuAccess = 0;
+	if (access == Access_Dynamic) cpuAccess = D3D11_CPU_ACCESS_WRITE;
+	if (access == Access_Staging) cpuAccess = D3D11_CPU_ACCESS_READ;
+	return (D3D11_USAGE)access;
+}
+
+static D3D11_DEPTH_STENCILOP_DESC GetStencilOpDesc(const StencilOpDesc& desc)
+{
+	D3D11_DEPTH_STENCILOP_DESC res;
+	res.StencilFailOp = (D3D11_STENCIL_OP)desc.failOp;
+	res.StencilDepthFailOp = (D3D11_STENCIL_OP)desc.depthFailOp;
+	res.StencilPassOp = (D3D11_STENCIL_OP)desc.passOp;
+	res.StencilFunc = (D3D11_COMPARISON_FUNC)desc.func;
+	return res;
+}
+
+
+D3D11Device::D3D11Device()
+{
+	pDevice = NULL;
+	pContext = NULL;
+	pContext1 = NULL;
+	pSwapChain = NULL;
+}
+
+D3D11Device::~D3D11Device()
+{
+	if (pSwapChain)
+		pSwapChain->Release();
+	if (pContext1)
+		pContext1->Release();
+	if (pContext)
+		pContext->Release();
+	if (pDevice)
+		pDevice->Release();
+}
+
+bool D3D11Device::Init(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen)
+{
+	D3D_FEATURE_LEVEL featureLevels[] =
+	{
+		D3D_FEATURE_LEVEL_11_1,
+		D3D_FEATURE_LEVEL_11_0,
+		D3D_FEATURE_LEVEL_10_1,
+		D3D_FEATURE_LEVEL_10_0,
+	};
+	UINT numFeatureLevels = ARRAYSIZE(featureLevels);
+
+	HRESULT result;
+	result = D3D11CreateDevice(0, D3D_DRIVER_TYPE_HARDWARE, NULL, D3D11_CREATE_DEVICE_BGRA_SUPPORT, featureLevels, numFeatureLevels, D3D11_SDK_VERSION, &pDevice, NULL, &pContext);
+	if (FAILED(result)) return false;
+
+	//Keep the CPU at most FRAMES_IN_FLIGHT frames ahead, the upload rings are sized by it
+	IDXGIDevice1* dxgiDevice;
+	if (SUCCEEDED(pDevice->QueryInterface(__uuidof(IDXGIDevice1), (void**)&dxgiDevice)))
+	{
+		dxgiDevice->SetMaximumFrameLatency(FRAMES_IN_FLIGHT - 1);
+		dxgiDevice->Release();
+	}
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+	ZeroMemory(&options, sizeof(options));
+	if (SUCCEEDED(pContext->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&pContext1)))
+	{
+		caps.constantBufferBoxes = true;
+		if (SUCCEEDED(pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+			caps.constantBufferRanges = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+	return CreateSwapChain(resolutionX, resolutionY, hwnd, fullScreen);
+}
+
+bool D3D11Device::CreateSwapChain(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen)
+{
+	if (pSwapChain)
+	{
+		pSwapChain->Release();
+		pSwapChain = NULL;
+	}
+
+	DXGI_SWAP_CHAIN_DESC desc;
+	ZeroMemory(&desc, sizeof(desc));
+	desc.Windowed = !fullScreen;
+
+	// Set to a single back buffer.
+	desc.BufferCount = 1;
+	desc.BufferDesc.Width = resolutionX;
+	desc.BufferDesc.Height = resolutionY;
+
+	// Set regular 32-bit surface for the back buffer.
+	desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	// Set the usage of the back buffer.
+	desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+
+	// Set the handle for the window to render to.
+	desc.OutputWindow = hwnd;
+
+	// Turn multisampling off.
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+
+	// Set the scan line ordering and scaling to unspecified.
+	desc.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
+	desc.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
+
+	// Discard the back buffer contents after presenting.
+	desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+	// Don't set the advanced flags.
+	desc.Flags = 0;
+
+	HRESULT result;
+	IDXGIFactory *factory;
+	result = CreateDXGIFactory(__uuidof(IDXGIFactory), (void**)&factory);
+	if (FAILED(result)) return false;
+
+	result = factory->CreateSwapChain(pDevice, &desc, &pSwapChain);
+	if (FAILED(result))
+	{
+		factory->Release();
+		return false;
+	}
+	factory->Release();
+	return true;
+}
+
+DeviceBuffer* D3D11Device::CreateBuffer(const BufferDesc& desc, const SubresourceData* data)
+{
+	D3D11_BUFFER_DESC d3dDesc;
+	d3dDesc.ByteWidth = desc.byteWidth;
+	d3dDesc.Usage = GetUsage(desc.access, d3dDesc.CPUAccessFlags);
+	d3dDesc.BindFlags = desc.bindFlags;
+	d3dDesc.MiscFlags = desc.miscFlags;
+	d3dDesc.StructureByteStride = desc.structureByteStride;
+
+	ID3D11Buffer* buffer = NULL;
+	if (FAILED(pDevice->CreateBuffer(&d3dDesc, (const D3D11_SUBRESOURCE_DATA*)data, &buffer))) return NULL;
+	return D3D(DeviceBuffer, buffer);
+}
+
+DeviceTexture* D3D11Device::CreateTexture(const TextureDesc& desc, const SubresourceData* data)
+{
+	HRESULT hr = E_INVALIDARG;
+	ID3D11Resource* texture = NULL;
+	if (desc.type == Resource_Texture2D)
+	{
+		D3D11_TEXTURE2D_DESC d3dDesc;
+		d3dDesc.Width = desc.width;
+		d3dDesc.Height = desc.height;
+		d3dDesc.MipLevels = desc.mipLevels;
+		d3dDesc.ArraySize = desc.arraySize;
+		d3dDesc.Format = (DXGI_FORMAT)desc.format;
+		d3dDesc.SampleDesc.Count = desc.sampleCount;
+		d3dDesc.SampleDesc.Quality = desc.sampleQuality;
+		d3dDesc.Usage = GetUsage(desc.access, d3dDesc.CPUAccessFlags);
+		d3dDesc.BindFlags = desc.bindFlags;
+		d3dDesc.MiscFlags = desc.miscFlags;
+		hr = pDevice->CreateTexture2D(&d3dDesc, (const D3D11_SUBRESOURCE_DATA*)data, (ID3D11Texture2D**)&texture);
+	}
+	else if (desc.type == Resource_Texture3D)
+	{
+		D3D11_TEXTURE3D_DESC d3dDesc;
+		d3dDesc.Width = desc.width;
+		d3dDesc.Height = desc.height;
+		d3dDesc.Depth = desc.depth;
+		d3dDesc.MipLevels = desc.mipLevels;
+		d3dDesc.Format = (DXGI_FORMAT)desc.format;
+		d3dDesc.Usage = GetUsage(desc.access, d3dDesc.CPUAccessFlags);
+		d3dDesc.BindFlags = desc.bindFlags;
+		d3dDesc.MiscFlags = desc.miscFlags;
+		hr = pDevice->CreateTexture3D(&d3dDesc, (const D3D11_SUBRESOURCE_DATA*)data, (ID3D11Texture3D**)&texture);
+	}
+	if (FAILED(hr)) return NULL;
+	return D3D(DeviceTexture, texture);
+}
+
+DeviceShaderResourceView* D3D11Device::CreateShaderResourceView(DeviceResource* resource)
+{
+	ID3D11ShaderResourceView* view = NULL;
+	if (FAILED(pDevice->CreateShaderResourceView(D3D(ID3D11Resource, resource), NULL, &view))) return NULL;
+	return D3D(DeviceShaderResourceView, view);
+}
+
+DeviceUnorderedAccessView* D3D11Device::CreateUnorderedAccessView(DeviceResource* resource)
+{
+	ID3D11UnorderedAccessView* view = NULL;
+	if (FAILED(pDevice->CreateUnorderedAccessView(D3D(ID3D11Resource, resource), NULL, &view))) return NULL;
+	return D3D(DeviceUnorderedAccessView, view);
+}
+
+DeviceRenderTargetView* D3D11Device::CreateRenderTargetView(DeviceResource* resource)
+{
+	ID3D11RenderTargetView* view = NULL;
+	if (FAILED(pDevice->CreateRenderTargetView(D3D(ID3D11Resource, resource), NULL, &view))) return NULL;
+	return D3D(DeviceRenderTargetView, view);
+}
+
+DeviceDepthStencilView* D3D11Device::CreateDepthStencilView(DeviceResource* resource)
+{
+	ID3D11DepthStencilView* view = NULL;
+	if (FAILED(pDevice->CreateDepthStencilView(D3D(ID3D11Resource, resource), NULL, &view))) return NULL;
+	return D3D(DeviceDepthStencilView, view);
+}
+
+DeviceInputLayout* D3D11Device::CreateInputLayout(const InputElementDesc* elements, UINT numElements, const void* byteCode, size_t byteCodeLength)
+{
+	vector<D3D11_INPUT_ELEMENT_DESC> d3dElements(numElements);
+	for (UINT i = 0; i < numElements; i++)
+	{
+		d3dElements[i].SemanticName = elements[i].semanticName;
+		d3dElements[i].SemanticIndex = elements[i].semanticIndex;
+		d3dElements[i].Format = (DXGI_FORMAT)elements[i].format;
+		d3dElements[i].InputSlot = elements[i].inputSlot;
+		d3dElements[i].AlignedByteOffset = elements[i].alignedByteOffset;
+		d3dElements[i].InputSlotClass = elements[i].perInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+		d3dElements[i].InstanceDataStepRate = elements[i].instanceDataStepRate;
+	}
+	ID3D11InputLayout* layout = NULL;
+	if (FAILED(pDevice->CreateInputLayout(numElements ? &d3dElements[0] : NULL, numElements, byteCode, byteCodeLength, &layout))) return NULL;
+	return D3D(DeviceInputLayout, layout);
+}
+
+DeviceShader* D3D11Device::CreateShader(PipelineStage stage, const void* byteCode, size_t byteCodeLength)
+{
+	HRESULT hr = E_INVALIDARG;
+	ID3D11DeviceChild* shader = NULL;
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: hr = pDevice->CreateVertexShader(byteCode, byteCodeLength, NULL, (ID3D11VertexShader**)&shader); break;
+	case Stage_Pixel_Shader: hr = pDevice->CreatePixelShader(byteCode, byteCodeLength, NULL, (ID3D11PixelShader**)&shader); break;
+	case Stage_Geometry_Shader: hr = pDevice->CreateGeometryShader(byteCode, byteCodeLength, NULL, (ID3D11GeometryShader**)&shader); break;
+	case Stage_Compute_Shader: hr = pDevice->CreateComputeShader(byteCode, byteCodeLength, NULL, (ID3D11ComputeShader**)&shader); break;
+	}
+	if (FAILED(hr)) return NULL;
+	return D3D(DeviceShader, shader);
+}
+
+DeviceDepthStencilState* D3D11Device::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+	D3D11_DEPTH_STENCIL_DESC d3dDesc;
+	d3dDesc.DepthEnable = desc.depthEnable;
+	d3dDesc.DepthWriteMask = desc.depthWrite ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+	d3dDesc.DepthFunc = (D3D11_COMPARISON_FUNC)desc.depthFunc;
+	d3dDesc.StencilEnable = desc.stencilEnable;
+	d3dDesc.StencilReadMask = desc.stencilReadMask;
+	d3dDesc.StencilWriteMask = desc.stencilWriteMask;
+	d3dDesc.FrontFace = GetStencilOpDesc(desc.frontFace);
+	d3dDesc.BackFace = GetStencilOpDesc(desc.backFace);
+
+	ID3D11DepthStencilState* state = NULL;
+	if (FAILED(pDevice->CreateDepthStencilState(&d3dDesc, &state))) return NULL;
+	return D3D(DeviceDepthStencilState, state);
+}
+
+DeviceBlendState* D3D11Device::CreateBlendState(const BlendDesc& desc)
+{
+	D3D11_BLEND_DESC d3dDesc;
+	d3dDesc.AlphaToCoverageEnable = desc.alphaToCoverageEnable;
+	d3dDesc.IndependentBlendEnable = desc.independentBlendEnable;
+	for (UINT i = 0; i < RENDER_TARGET_SLOT_COUNT; i++)
+	{
+		const RenderTargetBlendDesc& target = desc.renderTarget[i];
+		d3dDesc.RenderTarget[i].BlendEnable = target.blendEnable;
+		d3dDesc.RenderTarget[i].SrcBlend = (D3D11_BLEND)target.srcBlend;
+		d3dDesc.RenderTarget[i].DestBlend = (D3D11_BLEND)target.destBlend;
+		d3dDesc.RenderTarget[i].BlendOp = (D3D11_BLEND_OP)target.blendOp;
+		d3dDesc.RenderTarget[i].SrcBlendAlpha = (D3D11_BLEND)target.srcBlendAlpha;
+		d3dDesc.RenderTarget[i].DestBlendAlpha = (D3D11_BLEND)target.destBlendAlpha;
+		d3dDesc.RenderTarget[i].BlendOpAlpha = (D3D11_BLEND_OP)target.blendOpAlpha;
+		d3dDesc.RenderTarget[i].RenderTargetWriteMask = target.writeMask;
+	}
+
+	ID3D11BlendState* state = NULL;
+	if (FAILED(pDevice->CreateBlendState(&d3dDesc, &state))) return NULL;
+	return D3D(DeviceBlendState, state);
+}
+
+DeviceRasterizerState* D3D11Device::CreateRasterizerState(const RasterizerDesc& desc)
+{
+	D3D11_RASTERIZER_DESC d3dDesc;
+	d3dDesc.FillMode = (D3D11_FILL_MODE)desc.fillMode;
+	d3dDesc.CullMode = (D3D11_CULL_MODE)desc.cullMode;
+	d3dDesc.FrontCounterClockwise = desc.frontCounterClockwise;
+	d3dDesc.DepthBias = desc.depthBias;
+	d3dDesc.DepthBiasClamp = desc.depthBiasClamp;
+	d3dDesc.SlopeScaledDepthBias = desc.slopeScaledDepthBias;
+	d3dDesc.DepthClipEnable = desc.depthClipEnable;
+	d3dDesc.ScissorEnable = desc.scissorEnable;
+	d3dDesc.MultisampleEnable = desc.multisampleEnable;
+	d3dDesc.AntialiasedLineEnable = desc.antialiasedLineEnable;
+
+	ID3D11RasterizerState* state = NULL;
+	if (FAILED(pDevice->CreateRasterizerState(&d3dDesc, &state))) return NULL;
+	return D3D(DeviceRasterizerState, state);
+}
+
+DeviceSamplerState* D3D11Device::CreateSamplerState(const SamplerDesc& desc)
+{
+	D3D11_SAMPLER_DESC d3dDesc;
+	d3dDesc.Filter = (D3D11_FILTER)desc.filter;
+	d3dDesc.AddressU = (D3D11_TEXTURE_ADDRESS_MODE)desc.addressU;
+	d3dDesc.AddressV = (D3D11_TEXTURE_ADDRESS_MODE)desc.addressV;
+	d3dDesc.AddressW = (D3D11_TEXTURE_ADDRESS_MODE)desc.addressW;
+	d3dDesc.MipLODBias = desc.mipLODBias;
+	d3dDesc.MaxAnisotropy = desc.maxAnisotropy;
+	d3dDesc.ComparisonFunc = (D3D11_COMPARISON_FUNC)desc.comparisonFunc;
+	memcpy(d3dDesc.BorderColor, desc.borderColor, sizeof(d3dDesc.BorderColor));
+	d3dDesc.MinLOD = desc.minLOD;
+	d3dDesc.MaxLOD = desc.maxLOD;
+
+	ID3D11SamplerState* state = NULL;
+	if (FAILED(pDevice->CreateSamplerState(&d3dDesc, &state))) return NULL;
+	return D3D(DeviceSamplerState, state);
+}
+
+DeviceTexture* D3D11Device::GetBackBuffer(TextureDesc& desc)
+{
+	ID3D11Texture2D* texture = NULL;
+	if (FAILED(pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&texture))) return NULL;
+	D3D11_TEXTURE2D_DESC d3dDesc;
+	texture->GetDesc(&d3dDesc);
+	desc.type = Resource_Texture2D;
+	desc.width = d3dDesc.Width;
+	desc.height = d3dDesc.Height;
+	desc.depth = 1;
+	desc.mipLevels = d3dDesc.MipLevels;
+	desc.arraySize = d3dDesc.ArraySize;
+	desc.format = (Format)d3dDesc.Format;
+	desc.sampleCount = d3dDesc.SampleDesc.Count;
+	desc.sampleQuality = d3dDesc.SampleDesc.Quality;
+	desc.access = (AccessType)d3dDesc.Usage;
+	desc.bindFlags = d3dDesc.BindFlags;
+	desc.miscFlags = d3dDesc.MiscFlags;
+	return D3D(DeviceTexture, texture);
+}
+
+void D3D11Device::Release(DeviceObject* object)
+{
+	if (object) D3D(IUnknown, object)->Release();
+}
+
+static wstring Widen(const string& fileName)
+{
+	wstring_convert<codecvt_utf8_utf16<wchar_t>> converter;
+	return converter.from_bytes(fileName);
+}
+
+//Modification time of a file, false if it doesn't exist
+static bool GetWriteTime(const string& fileName, FILETIME& time)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(fileName.c_str(), GetFileExInfoStandard, &data)) return false;
+	time = data.ftLastWriteTime;
+	return true;
+}
+
+bool D3D11Device::LoadShader(const string& fileName, const string& entryPoint, PipelineStage stage, vector<BYTE>& byteCode)
+{
+	//Precompiled bytecode, unless the source was edited after it was built
+	string csoName = fileName + "." + entryPoint + ".cso";
+	FILETIME csoTime, sourceTime;
+	if (GetWriteTime(csoName, csoTime) && (!GetWriteTime(fileName, sourceTime) || CompareFileTime(&csoTime, &sourceTime) >= 0))
+	{
+		ID3DBlob* blob = NULL;
+		if (SUCCEEDED(D3DReadFileToBlob(Widen(csoName).c_str(), &blob)))
+		{
+			byteCode.assign((BYTE*)blob->GetBufferPointer(), (BYTE*)blob->GetBufferPointer() + blob->GetBufferSize());
+			blob->Release();
+			return true;
+		}
+	}
+
+	string target;
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: target = "vs_5_0"; break;
+	case Stage_Pixel_Shader: target = "ps_5_0"; break;
+	case Stage_Geometry_Shader: target = "gs_5_0"; break;
+	case Stage_Compute_Shader: target = "cs_5_0"; break;
+	default: return false;
+	}
+
+	ID3DBlob *compiledShader = NULL;
+	ID3DBlob *compilationMsgs = NULL;
+	HRESULT hr = D3DCompileFromFile(Widen(fileName).c_str(), 0, D3D_COMPILE_STANDARD_FILE_INCLUDE, entryPoint.c_str(), target.c_str(), shaderFlag, 0, &compiledShader, &compilationMsgs);
+
+	if (compilationMsgs != 0)
+	{
+		OutputDebugStringA((char*)compilationMsgs->GetBufferPointer());
+		MessageBoxA(0, (char*)compilationMsgs->GetBufferPointer(), 0, 0);
+		compilationMsgs->Release();
+		if (compiledShader) compiledShader->Release();
+		assert(0);
+		return false;
+	}
+
+	if (FAILED(hr))
+	{
+		char msg[MAX_PATH + 64];
+		sprintf_s(msg, "Shader compile failed: %s %s\n", fileName.c_str(), entryPoint.c_str());
+		OutputDebugStringA(msg);
+		MessageBoxA(0, msg, 0, 0);
+		if (compiledShader) compiledShader->Release();
+		return false;
+	}
+	byteCode.assign((BYTE*)compiledShader->GetBufferPointer(), (BYTE*)compiledShader->GetBufferPointer() + compiledShader->GetBufferSize());
+	compiledShader->Release();
+	return true;
+}
+
+bool D3D11Device::ReflectInputs(const void* byteCode, size_t byteCodeLength, vector<ShaderInputParameter>& inputs)
+{
+	inputs.clear();
+	ID3D11ShaderReflection *reflectPtr = NULL;
+	if (FAILED(D3DReflect(byteCode, byteCodeLength, IID_ID3D11ShaderReflection, (void**)&reflectPtr))) return false;
+
+	D3D11_SHADER_DESC shaderDesc;
+	reflectPtr->GetDesc(&shaderDesc);
+	inputs.resize(shaderDesc.InputParameters);
+
+	D3D11_SIGNATURE_PARAMETER_DESC sPDesc;
+	for (UINT i = 0; i != shaderDesc.InputParameters; ++i)
+	{
+		reflectPtr->GetInputParameterDesc(i, &sPDesc);
+		inputs[i].semanticName = sPDesc.SemanticName;
+		inputs[i].semanticIndex = sPDesc.SemanticIndex;
+		inputs[i].componentType = (ShaderComponentType)sPDesc.ComponentType;
+		inputs[i].mask = sPDesc.Mask;
+	}
+	reflectPtr->Release();
+	return true;
+}
+
+void D3D11Device::SetInputLayout(DeviceInputLayout* layout)
+{
+	pContext->IASetInputLayout(D3D(ID3D11InputLayout, layout));
+}
+
+void D3D11Device::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+	pContext->IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)topology);
+}
+
+void D3D11Device::SetVertexBuffers(UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	pContext->IASetVertexBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), strides, offsets);
+}
+
+void D3D11Device::SetIndexBuffer(DeviceBuffer* buffer, Format format, UINT offset)
+{
+	pContext->IASetIndexBuffer(D3D(ID3D11Buffer, buffer), (DXGI_FORMAT)format, offset);
+}
+
+void D3D11Device::SetStreamOutTargets(UINT num, DeviceBuffer* const* buffers, const UINT* offsets)
+{
+	pContext->SOSetTargets(num, D3D_ARRAY(ID3D11Buffer, buffers), offsets);
+}
+
+void D3D11Device::SetShader(PipelineStage stage, DeviceShader* shader)
+{
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: pContext->VSSetShader(D3D(ID3D11VertexShader, shader), NULL, 0); break;
+	case Stage_Pixel_Shader: pContext->PSSetShader(D3D(ID3D11PixelShader, shader), NULL, 0); break;
+	case Stage_Geometry_Shader: pContext->GSSetShader(D3D(ID3D11GeometryShader, shader), NULL, 0); break;
+	case Stage_Compute_Shader: pContext->CSSetShader(D3D(ID3D11ComputeShader, shader), NULL, 0); break;
+	}
+}
+
+void D3D11Device::SetConstantBuffers(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers)
+{
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: pContext->VSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	case Stage_Hull_Shader: pContext->HSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	case Stage_Domain_Shader: pContext->DSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	case Stage_Geometry_Shader: pContext->GSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	case Stage_Pixel_Shader: pContext->PSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	case Stage_Compute_Shader: pContext->CSSetConstantBuffers(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers)); break;
+	}
+}
+
+void D3D11Device::SetConstantBufferRanges(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT * firstConstant, const UINT * numConstants)
+{
+	if (!pContext1) return;
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: pContext1->VSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	case Stage_Hull_Shader: pContext1->HSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	case Stage_Domain_Shader: pContext1->DSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	case Stage_Geometry_Shader: pContext1->GSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	case Stage_Pixel_Shader: pContext1->PSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	case Stage_Compute_Shader: pContext1->CSSetConstantBuffers1(startSlot, num, D3D_ARRAY(ID3D11Buffer, buffers), firstConstant, numConstants); break;
+	}
+}
+
+void D3D11Device::SetShaderResources(UINT stage, UINT startSlot, UINT num, DeviceShaderResourceView* const* views)
+{
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: pContext->VSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	case Stage_Hull_Shader: pContext->HSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	case Stage_Domain_Shader: pContext->DSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	case Stage_Geometry_Shader: pContext->GSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	case Stage_Pixel_Shader: pContext->PSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	case Stage_Compute_Shader: pContext->CSSetShaderResources(startSlot, num, D3D_ARRAY(ID3D11ShaderResourceView, views)); break;
+	}
+}
+
+void D3D11Device::SetSamplers(UINT stage, UINT startSlot, UINT num, DeviceSamplerState* const* samplers)
+{
+	switch (stage)
+	{
+	case Stage_Vertex_Shader: pContext->VSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	case Stage_Hull_Shader: pContext->HSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	case Stage_Domain_Shader: pContext->DSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	case Stage_Geometry_Shader: pContext->GSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	case Stage_Pixel_Shader: pContext->PSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	case Stage_Compute_Shader: pContext->CSSetSamplers(startSlot, num, D3D_ARRAY(ID3D11SamplerState, samplers)); break;
+	}
+}
+
+void D3D11Device::SetComputeUnorderedAccessViews(UINT startSlot, UINT num, DeviceUnorderedAccessView* const* views)
+{
+	pContext->CSSetUnorderedAccessViews(startSlot, num, D3D_ARRAY(ID3D11UnorderedAccessView, views), NULL);
+}
+
+void D3D11Device::SetOutputs(UINT numRTVs, DeviceRenderTargetView* const* rtvs, DeviceDepthStencilView* dsv, UINT uavStartSlot, UINT numUAVs, DeviceUnorderedAccessView* const* uavs)
+{
+	pContext->OMSetRenderTargetsAndUnorderedAccessViews(numRTVs, D3D_ARRAY(ID3D11RenderTargetView, rtvs), D3D(ID3D11DepthStencilView, dsv), uavStartSlot, numUAVs, D3D_ARRAY(ID3D11UnorderedAccessView, uavs), NULL);
+}
+
+void D3D11Device::SetDepthStencilState(DeviceDepthStencilState* state, UINT stencilRef)
+{
+	pContext->OMSetDepthStencilState(D3D(ID3D11DepthStencilState, state), stencilRef);
+}
+
+void D3D11Device::SetBlendState(DeviceBlendState* state, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	pContext->OMSetBlendState(D3D(ID3D11BlendState, state), blendFactor, sampleMask);
+}
+
+void D3D11Device::SetRasterizerState(DeviceRasterizerState* state)
+{
+	pContext->RSSetState(D3D(ID3D11RasterizerState, state));
+}
+
+void D3D11Device::SetViewports(UINT num, const ViewPortDesc* viewports)
+{
+	pContext->RSSetViewports(num, (const D3D11_VIEWPORT*)viewports);
+}
+
+void D3D11Device::ClearRenderTargetView(DeviceRenderTargetView* view, const FLOAT color[4])
+{
+	pContext->ClearRenderTargetView(D3D(ID3D11RenderTargetView, view), color);
+}
+
+void D3D11Device::ClearDepthStencilView(DeviceDepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+	pContext->ClearDepthStencilView(D3D(ID3D11DepthStencilView, view), flags, depth, stencil);
+}
+
+void D3D11Device::ClearUnorderedAccessViewUint(DeviceUnorderedAccessView* view, const UINT value[4])
+{
+	pContext->ClearUnorderedAccessViewUint(D3D(ID3D11UnorderedAccessView, view), value);
+}
+
+bool D3D11Device::Map(DeviceResource* resource, UINT subresource, MapType type, MappedSubresource& mapped)
+{
+	D3D11_MAPPED_SUBRESOURCE d3dMapped;
+	if (FAILED(pContext->Map(D3D(ID3D11Resource, resource), subresource, (D3D11_MAP)type, 0, &d3dMapped))) return false;
+	mapped.data = d3dMapped.pData;
+	mapped.rowPitch = d3dMapped.RowPitch;
+	mapped.depthPitch = d3dMapped.DepthPitch;
+	return true;
+}
+
+void D3D11Device::Unmap(DeviceResource* resource, UINT subresource)
+{
+	pContext->Unmap(D3D(ID3D11Resource, resource), subresource);
+}
+
+void D3D11Device::UpdateSubresource(DeviceResource* resource, UINT subresource, const Box* box, const void * data, UINT rowPitch, UINT depthPitch)
+{
+	pContext->UpdateSubresource(D3D(ID3D11Resource, resource), subresource, (const D3D11_BOX*)box, data, rowPitch, depthPitch);
+}
+
+void D3D11Device::GenerateMips(DeviceShaderResourceView* view)
+{
+	pContext->GenerateMips(D3D(ID3D11ShaderResourceView, view));
+}
+
+void D3D11Device::DrawIndexedInstanced(UINT indexCount, UINT instanceCount)
+{
+	pContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
+}
+
+void D3D11Device::Dispatch(UINT x, UINT y, UINT z)
+{
+	pContext->Dispatch(x, y, z);
+}
+
+void D3D11Device::Present()
+{
+	pSwapChain->Present(0, 0);
+}
@@ -1,6 +1,16 @@
 #pragma once
 
 #define MAX_SLOT_NUMBER 64
+//Frames the CPU may run ahead of the GPU, dynamic rings keep this many frames of data alive
+#define FRAMES_IN_FLIGHT 3
+//Slots D3D11 has per stage or pipeline
+#define CONSTANT_BUFFER_SLOT_COUNT 14
+#define SAMPLER_SLOT_COUNT 16
+#define RENDER_TARGET_SLOT_COUNT 8
+#define STREAM_OUT_SLOT_COUNT 4
+#define VIEWPORT_SLOT_COUNT 16
+//Count for Device::SetOutputs leaving the render targets and depth stencil, or the UAVs, as they are
+#define KEEP_BOUND_OUTPUTS 0xffffffff
 
 enum InputSlotDef
 {
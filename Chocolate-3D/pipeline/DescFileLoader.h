@@ -1,5 +1,6 @@
 #pragma once
 #include"ResourceManager.h"
+#include"StateManager.h"
 using namespace std;
 
 namespace FileLoader {
@@ -12,25 +13,25 @@ namespace FileLoader {
 
 	PipelineStage parsePipelineStage(const string& str);
 
-	DXGI_FORMAT parseFormat(const string& str);
+	Format parseFormat(const string& str);
 
-	D3D11_COMPARISON_FUNC parseComparisionFunc(const string& str);
+	ComparisonFunc parseComparisionFunc(const string& str);
 
-	D3D11_STENCIL_OP parseStencilOp(const string& str);
+	StencilOp parseStencilOp(const string& str);
 
-	D3D11_BLEND parseBlend(const string& str);
+	BlendFactor parseBlend(const string& str);
 
-	D3D11_BLEND_OP parseBlendOp(const string& str);
+	BlendOp parseBlendOp(const string& str);
 
-	D3D11_FILL_MODE parseFillMode(const string& str);
+	FillMode parseFillMode(const string& str);
 
-	D3D11_CULL_MODE parseCullMode(const string& str);
+	CullMode parseCullMode(const string& str);
 
-	D3D11_FILTER parseFilter(const string& str);
+	SamplerFilter parseFilter(const string& str);
 
-	D3D11_TEXTURE_ADDRESS_MODE parseTextureAddressMode(const string& str);
+	TextureAddressMode parseTextureAddressMode(const string& str);
 
-	D3D11_PRIMITIVE_TOPOLOGY parseTopology(const string& str);
+	PrimitiveTopology parseTopology(const string& str);
 
 	ResourceDesc LoadResourceDesc(const string &filePath);
 
@@ -0,0 +1,182 @@
+//-------------------------------------------------------------------------
+//-------------------Device------------------------------------------------
+//The device and context calls the pipeline makes, behind one interface.
+//D3D11Device forwards them to D3D11. NullDevice runs without a GPU or a window:
+//resources are host memory, everything else is counted, so the CPU side of
+//the engine (loading, effects, animation, bucketing, submission) runs headless.
+//Objects created by a device are only handed back to that device, see DeviceTypes.h.
+//-------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "DeviceTypes.h"
+using namespace std;
+
+struct DeviceCaps
+{
+	bool constantBufferRanges; //*SetConstantBuffers1 and NO_OVERWRITE maps of dynamic constant buffers
+	bool constantBufferBoxes; //UpdateSubresource with a box on constant buffers
+};
+
+class Device
+{
+public:
+	virtual ~Device() {}
+	const DeviceCaps& GetCaps() const { return caps; }
+
+	//----Creation----
+	//NULL on failure. data is NULL or one entry per subresource: the mips of each array slice in turn
+	virtual DeviceBuffer* CreateBuffer(const BufferDesc& desc, const SubresourceData* data) = 0;
+	virtual DeviceTexture* CreateTexture(const TextureDesc& desc, const SubresourceData* data) = 0;
+	//Views cover the whole resource in its own format
+	virtual DeviceShaderResourceView* CreateShaderResourceView(DeviceResource* resource) = 0;
+	virtual DeviceUnorderedAccessView* CreateUnorderedAccessView(DeviceResource* resource) = 0;
+	virtual DeviceRenderTargetView* CreateRenderTargetView(DeviceResource* resource) = 0;
+	virtual DeviceDepthStencilView* CreateDepthStencilView(DeviceResource* resource) = 0;
+	//byteCode is the vertex shader the layout is checked against
+	virtual DeviceInputLayout* CreateInputLayout(const InputElementDesc* elements, UINT numElements, const void* byteCode, size_t byteCodeLength) = 0;
+	//stage is a single PipelineStage bit, byteCode from LoadShader
+	virtual DeviceShader* CreateShader(PipelineStage stage, const void* byteCode, size_t byteCodeLength) = 0;
+	virtual DeviceDepthStencilState* CreateDepthStencilState(const DepthStencilDesc& desc) = 0;
+	virtual DeviceBlendState* CreateBlendState(const BlendDesc& desc) = 0;
+	virtual DeviceRasterizerState* CreateRasterizerState(const RasterizerDesc& desc) = 0;
+	virtual DeviceSamplerState* CreateSamplerState(const SamplerDesc& desc) = 0;
+	//New reference to the swap chain's buffer
+	virtual DeviceTexture* GetBackBuffer(TextureDesc& desc) = 0;
+	virtual void Release(DeviceObject* object) = 0;
+
+	//----Shaders----
+	//Bytecode of entryPoint in fileName for stage, a single PipelineStage bit. A precompiled
+	//<fileName>.<entryPoint>.cso at least as new as the source is loaded instead of compiling.
+	//False with the errors logged when neither works
+	virtual bool LoadShader(const string& fileName, const string& entryPoint, PipelineStage stage, vector<BYTE>& byteCode) = 0;
+	//Input signature of vertex shader bytecode, empty where the device can't read it
+	virtual bool ReflectInputs(const void* byteCode, size_t byteCodeLength, vector<ShaderInputParameter>& inputs) = 0;
+
+	//----Context----
+	//Stage arguments are a single PipelineStage bit
+	virtual void SetInputLayout(DeviceInputLayout* layout) = 0;
+	virtual void SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+	virtual void SetVertexBuffers(UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* strides, const UINT* offsets) = 0;
+	virtual void SetIndexBuffer(DeviceBuffer* buffer, Format format, UINT offset) = 0;
+	virtual void SetStreamOutTargets(UINT num, DeviceBuffer* const* buffers, const UINT* offsets) = 0;
+	//Vertex, pixel, geometry or compute shader, NULL to unbind the stage
+	virtual void SetShader(PipelineStage stage, DeviceShader* shader) = 0;
+	virtual void SetConstantBuffers(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers) = 0;
+	//Needs caps.constantBufferRanges, first and count are in 16 byte constants
+	virtual void SetConstantBufferRanges(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) = 0;
+	virtual void SetShaderResources(UINT stage, UINT startSlot, UINT num, DeviceShaderResourceView* const* views) = 0;
+	virtual void SetSamplers(UINT stage, UINT startSlot, UINT num, DeviceSamplerState* const* samplers) = 0;
+	virtual void SetComputeUnorderedAccessViews(UINT startSlot, UINT num, DeviceUnorderedAccessView* const* views) = 0;
+	//Render targets, depth stencil and UAVs of the output merger. KEEP_BOUND_OUTPUTS as numRTVs or numUAVs leaves those as they are
+	virtual void SetOutputs(UINT numRTVs, DeviceRenderTargetView* const* rtvs, DeviceDepthStencilView* dsv, UINT uavStartSlot, UINT numUAVs, DeviceUnorderedAccessView* const* uavs) = 0;
+	virtual void SetDepthStencilState(DeviceDepthStencilState* state, UINT stencilRef) = 0;
+	virtual void SetBlendState(DeviceBlendState* state, const FLOAT blendFactor[4], UINT sampleMask) = 0;
+	virtual void SetRasterizerState(DeviceRasterizerState* state) = 0;
+	virtual void SetViewports(UINT num, const ViewPortDesc* viewports) = 0;
+	virtual void ClearRenderTargetView(DeviceRenderTargetView* view, const FLOAT color[4]) = 0;
+	//flags are ClearFlag bits
+	virtual void ClearDepthStencilView(DeviceDepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil) = 0;
+	virtual void ClearUnorderedAccessViewUint(DeviceUnorderedAccessView* view, const UINT value[4]) = 0;
+	virtual bool Map(DeviceResource* resource, UINT subresource, MapType type, MappedSubresource& mapped) = 0;
+	virtual void Unmap(DeviceResource* resource, UINT subresource) = 0;
+	//A NULL box is the whole subresource
+	virtual void UpdateSubresource(DeviceResource* resource, UINT subresource, const Box* box, const void* data, UINT rowPitch, UINT depthPitch) = 0;
+	virtual void GenerateMips(DeviceShaderResourceView* view) = 0;
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount) = 0;
+	virtual void Dispatch(UINT x, UINT y, UINT z) = 0;
+	virtual void Present() = 0;
+
+protected:
+	DeviceCaps caps;
+	Device() { caps.constantBufferRanges = caps.constantBufferBoxes = false; }
+};
+
+//Hardware device with a swap chain on window, an HWND. NULL if either can't be created.
+//Defined in D3D11Device.cpp, the only file built against D3D11, on Windows only
+Device* CreateD3D11Device(UINT resolutionX, UINT resolutionY, void* window, bool fullScreen);
+
+//Calls counted by NullDevice, by what they do
+enum NullCallType
+{
+	NullCall_Create,
+	NullCall_Release,
+	NullCall_Bind, //Shaders, inputs, outputs and states
+	NullCall_Clear,
+	NullCall_Upload, //Map and UpdateSubresource
+	NullCall_Draw,
+	NullCall_Dispatch,
+	NullCall_Present,
+	NullCall_Other,
+	NullCall_Type_Count
+};
+
+class NullDevice : public Device
+{
+public:
+	//Size of the back buffer, caps all on so the same paths as on 11.1 hardware run
+	NullDevice(UINT resolutionX, UINT resolutionY);
+	~NullDevice();
+
+	UINT64 callCount[NullCall_Type_Count];
+	UINT64 uploadedBytes;
+	UINT64 drawnInstances;
+	size_t liveObjects;
+	size_t hostBytes; //Held by live buffers and textures
+	void ResetCounters();
+
+	DeviceBuffer* CreateBuffer(const BufferDesc& desc, const SubresourceData* data) override;
+	DeviceTexture* CreateTexture(const TextureDesc& desc, const SubresourceData* data) override;
+	DeviceShaderResourceView* CreateShaderResourceView(DeviceResource* resource) override;
+	DeviceUnorderedAccessView* CreateUnorderedAccessView(DeviceResource* resource) override;
+	DeviceRenderTargetView* CreateRenderTargetView(DeviceResource* resource) override;
+	DeviceDepthStencilView* CreateDepthStencilView(DeviceResource* resource) override;
+	DeviceInputLayout* CreateInputLayout(const InputElementDesc* elements, UINT numElements, const void* byteCode, size_t byteCodeLength) override;
+	DeviceShader* CreateShader(PipelineStage stage, const void* byteCode, size_t byteCodeLength) override;
+	DeviceDepthStencilState* CreateDepthStencilState(const DepthStencilDesc& desc) override;
+	DeviceBlendState* CreateBlendState(const BlendDesc& desc) override;
+	DeviceRasterizerState* CreateRasterizerState(const RasterizerDesc& desc) override;
+	DeviceSamplerState* CreateSamplerState(const SamplerDesc& desc) override;
+	DeviceTexture* GetBackBuffer(TextureDesc& desc) override;
+	void Release(DeviceObject* object) override;
+
+	//Nothing is compiled: the .cso if there is one, else the source file's bytes stand for the bytecode
+	bool LoadShader(const string& fileName, const string& entryPoint, PipelineStage stage, vector<BYTE>& byteCode) override;
+	//No reflection, the signature comes back empty
+	bool ReflectInputs(const void* byteCode, size_t byteCodeLength, vector<ShaderInputParameter>& inputs) override;
+
+	void SetInputLayout(DeviceInputLayout* layout) override;
+	void SetPrimitiveTopology(PrimitiveTopology topology) override;
+	void SetVertexBuffers(UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* strides, const UINT* offsets) override;
+	void SetIndexBuffer(DeviceBuffer* buffer, Format format, UINT offset) override;
+	void SetStreamOutTargets(UINT num, DeviceBuffer* const* buffers, const UINT* offsets) override;
+	void SetShader(PipelineStage stage, DeviceShader* shader) override;
+	void SetConstantBuffers(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers) override;
+	void SetConstantBufferRanges(UINT stage, UINT startSlot, UINT num, DeviceBuffer* const* buffers, const UINT* firstConstant, const UINT* numConstants) override;
+	void SetShaderResources(UINT stage, UINT startSlot, UINT num, DeviceShaderResourceView* const* views) override;
+	void SetSamplers(UINT stage, UINT startSlot, UINT num, DeviceSamplerState* const* samplers) override;
+	void SetComputeUnorderedAccessViews(UINT startSlot, UINT num, DeviceUnorderedAccessView* const* views) override;
+	void SetOutputs(UINT numRTVs, DeviceRenderTargetView* const* rtvs, DeviceDepthStencilView* dsv, UINT uavStartSlot, UINT numUAVs, DeviceUnorderedAccessView* const* uavs) override;
+	void SetDepthStencilState(DeviceDepthStencilState* state, UINT stencilRef) override;
+	void SetBlendState(DeviceBlendState* state, const FLOAT blendFactor[4], UINT sampleMask) override;
+	void SetRasterizerState(DeviceRasterizerState* state) override;
+	void SetViewports(UINT num, const ViewPortDesc* viewports) override;
+	void ClearRenderTargetView(DeviceRenderTargetView* view, const FLOAT color[4]) override;
+	void ClearDepthStencilView(DeviceDepthStencilView* view, UINT flags, FLOAT depth, UINT8 stencil) override;
+	void ClearUnorderedAccessViewUint(DeviceUnorderedAccessView* view, const UINT value[4]) override;
+	bool Map(DeviceResource* resource, UINT subresource, MapType type, MappedSubresource& mapped) override;
+	void Unmap(DeviceResource* resource, UINT subresource) override;
+	void UpdateSubresource(DeviceResource* resource, UINT subresource, const Box* box, const void* data, UINT rowPitch, UINT depthPitch) override;
+	void GenerateMips(DeviceShaderResourceView* view) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount) override;
+	void Dispatch(UINT x, UINT y, UINT z) override;
+	void Present() override;
+
+private:
+	TextureDesc backBufferDesc;
+	void* NewObject(size_t bytes);
+	//Every subresource laid out as D3D11 numbers them, 0 mip levels for the full chain
+	void* NewTexture(Format format, UINT width, UINT height, UINT depth, UINT mipLevels, UINT arraySize, UINT sampleCount);
+	NullDevice(NullDevice const&);
+	NullDevice& operator=(NullDevice const&);
+};
@@ -0,0 +1,474 @@
+//-------------------------------------------------------------------------
+//-------------------Device Types------------------------------------------
+//Formats, descriptions and handles the pipeline hands to a Device. They are
+//the engine's own, so nothing above D3D11Device.cpp sees a D3D11 header.
+//Enum values are D3D11's, D3D11Device checks that and passes them through.
+//-------------------------------------------------------------------------
+
+#pragma once
+#include <string>
+#include "Platform.h"
+#include "D3Def.h"
+using namespace std;
+
+//----Handles----
+//Objects a device creates are only handed back to that device and never dereferenced:
+//D3D11Device hands out its D3D11 interfaces, NullDevice its own records.
+struct DeviceObject {};
+struct DeviceResource : DeviceObject {};
+struct DeviceBuffer : DeviceResource {};
+struct DeviceTexture : DeviceResource {}; //2D or 3D
+struct DeviceShaderResourceView : DeviceObject {};
+struct DeviceUnorderedAccessView : DeviceObject {};
+struct DeviceRenderTargetView : DeviceObject {};
+struct DeviceDepthStencilView : DeviceObject {};
+struct DeviceInputLayout : DeviceObject {};
+struct DeviceShader : DeviceObject {}; //Any stage
+struct DeviceDepthStencilState : DeviceObject {};
+struct DeviceBlendState : DeviceObject {};
+struct DeviceRasterizerState : DeviceObject {};
+struct DeviceSamplerState : DeviceObject {};
+
+//----Enums----
+//DXGI_FORMAT
+enum Format
+{
+	Format_UNKNOWN = 0,
+	Format_R32G32B32A32_TYPELESS = 1,
+	Format_R32G32B32A32_FLOAT = 2,
+	Format_R32G32B32A32_UINT = 3,
+	Format_R32G32B32A32_SINT = 4,
+	Format_R32G32B32_TYPELESS = 5,
+	Format_R32G32B32_FLOAT = 6,
+	Format_R32G32B32_UINT = 7,
+	Format_R32G32B32_SINT = 8,
+	Format_R16G16B16A16_TYPELESS = 9,
+	Format_R16G16B16A16_FLOAT = 10,
+	Format_R16G16B16A16_UNORM = 11,
+	Format_R16G16B16A16_UINT = 12,
+	Format_R16G16B16A16_SNORM = 13,
+	Format_R16G16B16A16_SINT = 14,
+	Format_R32G32_TYPELESS = 15,
+	Format_R32G32_FLOAT = 16,
+	Format_R32G32_UINT = 17,
+	Format_R32G32_SINT = 18,
+	Format_R32G8X24_TYPELESS = 19,
+	Format_D32_FLOAT_S8X24_UINT = 20,
+	Format_R32_FLOAT_X8X24_TYPELESS = 21,
+	Format_X32_TYPELESS_G8X24_UINT = 22,
+	Format_R10G10B10A2_TYPELESS = 23,
+	Format_R10G10B10A2_UNORM = 24,
+	Format_R10G10B10A2_UINT = 25,
+	Format_R11G11B10_FLOAT = 26,
+	Format_R8G8B8A8_TYPELESS = 27,
+	Format_R8G8B8A8_UNORM = 28,
+	Format_R8G8B8A8_UNORM_SRGB = 29,
+	Format_R8G8B8A8_UINT = 30,
+	Format_R8G8B8A8_SNORM = 31,
+	Format_R8G8B8A8_SINT = 32,
+	Format_R16G16_TYPELESS = 33,
+	Format_R16G16_FLOAT = 34,
+	Format_R16G16_UNORM = 35,
+	Format_R16G16_UINT = 36,
+	Format_R16G16_SNORM = 37,
+	Format_R16G16_SINT = 38,
+	Format_R32_TYPELESS = 39,
+	Format_D32_FLOAT = 40,
+	Format_R32_FLOAT = 41,
+	Format_R32_UINT = 42,
+	Format_R32_SINT = 43,
+	Format_R24G8_TYPELESS = 44,
+	Format_D24_UNORM_S8_UINT = 45,
+	Format_R24_UNORM_X8_TYPELESS = 46,
+	Format_X24_TYPELESS_G8_UINT = 47,
+	Format_R8G8_TYPELESS = 48,
+	Format_R8G8_UNORM = 49,
+	Format_R8G8_UINT = 50,
+	Format_R8G8_SNORM = 51,
+	Format_R8G8_SINT = 52,
+	Format_R16_TYPELESS = 53,
+	Format_R16_FLOAT = 54,
+	Format_D16_UNORM = 55,
+	Format_R16_UNORM = 56,
+	Format_R16_UINT = 57,
+	Format_R16_SNORM = 58,
+	Format_R16_SINT = 59,
+	Format_R8_TYPELESS = 60,
+	Format_R8_UNORM = 61,
+	Format_R8_UINT = 62,
+	Format_R8_SNORM = 63,
+	Format_R8_SINT = 64,
+	Format_A8_UNORM = 65,
+	Format_R1_UNORM = 66,
+	Format_R9G9B9E5_SHAREDEXP = 67,
+	Format_R8G8_B8G8_UNORM = 68,
+	Format_G8R8_G8B8_UNORM = 69,
+	Format_BC1_TYPELESS = 70,
+	Format_BC1_UNORM = 71,
+	Format_BC1_UNORM_SRGB = 72,
+	Format_BC2_TYPELESS = 73,
+	Format_BC2_UNORM = 74,
+	Format_BC2_UNORM_SRGB = 75,
+	Format_BC3_TYPELESS = 76,
+	Format_BC3_UNORM = 77,
+	Format_BC3_UNORM_SRGB = 78,
+	Format_BC4_TYPELESS = 79,
+	Format_BC4_UNORM = 80,
+	Format_BC4_SNORM = 81,
+	Format_BC5_TYPELESS = 82,
+	Format_BC5_UNORM = 83,
+	Format_BC5_SNORM = 84,
+	Format_B5G6R5_UNORM = 85,
+	Format_B5G5R5A1_UNORM = 86,
+	Format_B8G8R8A8_UNORM = 87,
+	Format_B8G8R8X8_UNORM = 88,
+	Format_R10G10B10_XR_BIAS_A2_UNORM = 89,
+	Format_B8G8R8A8_TYPELESS = 90,
+	Format_B8G8R8A8_UNORM_SRGB = 91,
+	Format_B8G8R8X8_TYPELESS = 92,
+	Format_B8G8R8X8_UNORM_SRGB = 93,
+	Format_BC6H_TYPELESS = 94,
+	Format_BC6H_UF16 = 95,
+	Format_BC6H_SF16 = 96,
+	Format_BC7_TYPELESS = 97,
+	Format_BC7_UNORM = 98,
+	Format_BC7_UNORM_SRGB = 99,
+	Format_AYUV = 100,
+	Format_Y410 = 101,
+	Format_Y416 = 102,
+	Format_NV12 = 103,
+	Format_P010 = 104,
+	Format_P016 = 105,
+	Format_420_OPAQUE = 106,
+	Format_YUY2 = 107,
+	Format_Y210 = 108,
+	Format_Y216 = 109,
+	Format_NV11 = 110,
+	Format_AI44 = 111,
+	Format_IA44 = 112,
+	Format_P8 = 113,
+	Format_A8P8 = 114,
+	Format_B4G4R4A4_UNORM = 115,
+	Format_P208 = 130,
+	Format_V208 = 131,
+	Format_V408 = 132,
+	Format_Force_UInt = 0xffffffff
+};
+
+enum ResourceType
+{
+	Resource_Buffer = 1,
+	Resource_Texture1D = 2,
+	Resource_Texture2D = 3,
+	Resource_Texture3D = 4
+};
+
+enum AccessType
+{
+	Access_Default = 0,
+	Access_Immutable = 1,
+	Access_Dynamic = 2, //CPU writes
+	Access_Staging = 3 //CPU reads
+};
+
+enum BindFlag
+{
+	Bind_Vertex_Buffer = 0x1,
+	Bind_Index_Buffer = 0x2,
+	Bind_Constant_Buffer = 0x4,
+	Bind_Shader_Resource = 0x8,
+	Bind_Stream_Out = 0x10,
+	Bind_Render_Target = 0x20,
+	Bind_Depth_Stencil = 0x40,
+	Bind_Unordered_Access = 0x80,
+	Bind_Decoder = 0x200,
+	Bind_Video_Encoder = 0x400
+};
+
+enum ResourceMisc
+{
+	Misc_Generate_Mips = 0x1,
+	Misc_Buffer_Structured = 0x40
+};
+
+enum MapType
+{
+	Map_Read = 1,
+	Map_Write = 2,
+	Map_Read_Write = 3,
+	Map_Write_Discard = 4,
+	Map_Write_No_Overwrite = 5
+};
+
+enum ClearFlag
+{
+	Clear_Depth = 0x1,
+	Clear_Stencil = 0x2
+};
+
+enum PrimitiveTopology
+{
+	Topology_Undefined = 0,
+	Topology_Point_List = 1,
+	Topology_Line_List = 2,
+	Topology_Line_Strip = 3,
+	Topology_Triangle_List = 4,
+	Topology_Triangle_Strip = 5,
+	Topology_Line_List_Adj = 10,
+	Topology_Line_Strip_Adj = 11,
+	Topology_Triangle_List_Adj = 12,
+	Topology_Triangle_Strip_Adj = 13,
+	Topology_Patch_List = 32 //Plus the control points, 1 to 32
+};
+
+enum ComparisonFunc
+{
+	Comparison_Never = 1,
+	Comparison_Less = 2,
+	Comparison_Equal = 3,
+	Comparison_Less_Equal = 4,
+	Comparison_Greater = 5,
+	Comparison_Not_Equal = 6,
+	Comparison_Greater_Equal = 7,
+	Comparison_Always = 8
+};
+
+enum StencilOp
+{
+	Stencil_Keep = 1,
+	Stencil_Zero = 2,
+	Stencil_Replace = 3,
+	Stencil_Incr_Sat = 4,
+	Stencil_Decr_Sat = 5,
+	Stencil_Invert = 6,
+	Stencil_Incr = 7,
+	Stencil_Decr = 8
+};
+
+enum BlendFactor
+{
+	Blend_Zero = 1,
+	Blend_One = 2,
+	Blend_Src_Color = 3,
+	Blend_Inv_Src_Color = 4,
+	Blend_Src_Alpha = 5,
+	Blend_Inv_Src_Alpha = 6,
+	Blend_Dest_Alpha = 7,
+	Blend_Inv_Dest_Alpha = 8,
+	Blend_Dest_Color = 9,
+	Blend_Inv_Dest_Color = 10,
+	Blend_Src_Alpha_Sat = 11,
+	Blend_Blend_Factor = 14,
+	Blend_Inv_Blend_Factor = 15,
+	Blend_Src1_Color = 16,
+	Blend_Inv_Src1_Color = 17,
+	Blend_Src1_Alpha = 18,
+	Blend_Inv_Src1_Alpha = 19
+};
+
+enum BlendOp
+{
+	Blend_Op_Add = 1,
+	Blend_Op_Subtract = 2,
+	Blend_Op_Rev_Subtract = 3,
+	Blend_Op_Min = 4,
+	Blend_Op_Max = 5
+};
+
+enum FillMode
+{
+	Fill_Wireframe = 2,
+	Fill_Solid = 3
+};
+
+enum CullMode
+{
+	Cull_None = 1,
+	Cull_Front = 2,
+	Cull_Back = 3
+};
+
+//Minification, magnification and mip filters. One of Filter_Comparison, Filter_Minimum
+//or Filter_Maximum may be added to change how the taps are reduced
+enum SamplerFilter
+{
+	Filter_Min_Mag_Mip_Point = 0x0,
+	Filter_Min_Mag_Point_Mip_Linear = 0x1,
+	Filter_Min_Point_Mag_Linear_Mip_Point = 0x4,
+	Filter_Min_Point_Mag_Mip_Linear = 0x5,
+	Filter_Min_Linear_Mag_Mip_Point = 0x10,
+	Filter_Min_Linear_Mag_Point_Mip_Linear = 0x11,
+	Filter_Min_Mag_Linear_Mip_Point = 0x14,
+	Filter_Min_Mag_Mip_Linear = 0x15,
+	Filter_Anisotropic = 0x55,
+	Filter_Comparison = 0x80,
+	Filter_Minimum = 0x100,
+	Filter_Maximum = 0x180
+};
+
+enum TextureAddressMode
+{
+	Address_Wrap = 1,
+	Address_Mirror = 2,
+	Address_Clamp = 3,
+	Address_Border = 4,
+	Address_Mirror_Once = 5
+};
+
+//Type of a shader input register
+enum ShaderComponentType
+{
+	Component_Unknown = 0,
+	Component_UInt32 = 1,
+	Component_SInt32 = 2,
+	Component_Float32 = 3
+};
+
+//----Descriptions----
+struct BufferDesc
+{
+	UINT byteWidth;
+	AccessType access;
+	UINT bindFlags;
+	UINT miscFlags; //ResourceMisc
+	UINT structureByteStride;
+};
+
+struct TextureDesc
+{
+	ResourceType type; //Resource_Texture2D or Resource_Texture3D
+	UINT width;
+	UINT height;
+	UINT depth; //1 for 2D
+	UINT mipLevels; //0 for the full chain
+	UINT arraySize; //1 for 3D
+	Format format;
+	UINT sampleCount;
+	UINT sampleQuality;
+	AccessType access;
+	UINT bindFlags;
+	UINT miscFlags;
+};
+
+//Initial data of a subresource. Pitches are in bytes, of a row of texels or 4x4 blocks and of a slice
+struct SubresourceData
+{
+	const void* data;
+	UINT rowPitch;
+	UINT depthPitch;
+};
+
+struct MappedSubresource
+{
+	void* data;
+	UINT rowPitch;
+	UINT depthPitch;
+};
+
+//Bytes for buffers, texels for textures. Right, bottom and back are one past the end
+struct Box
+{
+	UINT left;
+	UINT top;
+	UINT front;
+	UINT right;
+	UINT bottom;
+	UINT back;
+};
+
+struct ViewPortDesc
+{
+	FLOAT topLeftX;
+	FLOAT topLeftY;
+	FLOAT width;
+	FLOAT height;
+	FLOAT minDepth;
+	FLOAT maxDepth;
+};
+
+struct InputElementDesc
+{
+	const char* semanticName;
+	UINT semanticIndex;
+	Format format;
+	UINT inputSlot;
+	UINT alignedByteOffset;
+	bool perInstance;
+	UINT instanceDataStepRate;
+};
+
+//An input of a vertex shader's signature
+struct ShaderInputParameter
+{
+	string semanticName;
+	UINT semanticIndex;
+	ShaderComponentType componentType;
+	UINT mask; //Components used, 1 to 15
+};
+
+struct StencilOpDesc
+{
+	StencilOp failOp;
+	StencilOp depthFailOp;
+	StencilOp passOp;
+	ComparisonFunc func;
+};
+
+struct DepthStencilDesc
+{
+	bool depthEnable;
+	bool depthWrite;
+	ComparisonFunc depthFunc;
+	bool stencilEnable;
+	UINT8 stencilReadMask;
+	UINT8 stencilWriteMask;
+	StencilOpDesc frontFace;
+	StencilOpDesc backFace;
+};
+
+struct RenderTargetBlendDesc
+{
+	bool blendEnable;
+	BlendFactor srcBlend;
+	BlendFactor destBlend;
+	BlendOp blendOp;
+	BlendFactor srcBlendAlpha;
+	BlendFactor destBlendAlpha;
+	BlendOp blendOpAlpha;
+	UINT8 writeMask;
+};
+
+struct BlendDesc
+{
+	bool alphaToCoverageEnable;
+	bool independentBlendEnable;
+	RenderTargetBlendDesc renderTarget[RENDER_TARGET_SLOT_COUNT];
+};
+
+struct RasterizerDesc
+{
+	FillMode fillMode;
+	CullMode cullMode;
+	bool frontCounterClockwise;
+	int depthBias;
+	float depthBiasClamp;
+	float slopeScaledDepthBias;
+	bool depthClipEnable;
+	bool scissorEnable;
+	bool multisampleEnable;
+	bool antialiasedLineEnable;
+};
+
+struct SamplerDesc
+{
+	SamplerFilter filter;
+	TextureAddressMode addressU;
+	TextureAddressMode addressV;
+	TextureAddressMode addressW;
+	float mipLODBias;
+	UINT maxAnisotropy;
+	ComparisonFunc comparisonFunc;
+	float borderColor[4];
+	float minLOD;
+	float maxLOD;
+};
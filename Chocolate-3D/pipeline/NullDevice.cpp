@@ -0,0 +1,420 @@
+#include "Device.h"
+#include "ResourceManager.h"
+#include <vector>
+#include <fstream>
+#include <iterator>
+using namespace std;
+
+//Where a subresource lives in NullObject::memory, rows tightly packed
+struct NullSubresource
+{
+	size_t offset;
+	UINT rowPitch;
+	UINT depthPitch;
+	UINT rows; //Texel rows, block rows for block formats
+	UINT depth;
+};
+
+//What NullDevice hands out for every object, resources keep their memory in it
+struct NullObject
+{
+	vector<BYTE> memory; //Every subresource in D3D11 order: mips of the first array slice, then the next slice
+	vector<NullSubresource> subresources; //Empty for views, shaders and states
+	Format format; //Format_UNKNOWN for buffers
+};
+
+static NullObject* AsNull(DeviceObject* object)
+{
+	return (NullObject*)object;
+}
+
+//One subresource from data laid out with the pitches given, as SubresourceData and UpdateSubresource take it
+static size_t CopySubresource(NullObject* o, UINT subresource, const void* data, UINT rowPitch, UINT depthPitch)
+{
+	if (!data || subresource >= o->subresources.size())
+		return 0;
+	const NullSubresource &sub = o->subresources[subresource];
+	const BYTE* src = (const BYTE*)data;
+	BYTE* dst = &o->memory[sub.offset];
+	if (!rowPitch) rowPitch = sub.rowPitch;
+	if (!depthPitch) depthPitch = rowPitch * sub.rows;
+	for (UINT z = 0; z < sub.depth; z++)
+	{
+		for (UINT y = 0; y < sub.rows; y++)
+		{
+			memcpy(dst + (size_t)z * sub.depthPitch + (size_t)y * sub.rowPitch, src + (size_t)z * depthPitch + (size_t)y * rowPitch, sub.rowPitch);
+		}
+	}
+	return (size_t)sub.depthPitch * sub.depth;
+}
+
+NullDevice::NullDevice(UINT resolutionX, UINT resolutionY)
+{
+	caps.constantBufferRanges = true;
+	caps.constantBufferBoxes = true;
+	ZeroMemory(&backBufferDesc, sizeof(backBufferDesc));
+	backBufferDesc.type = Resource_Texture2D;
+	backBufferDesc.width = resolutionX;
+	backBufferDesc.height = resolutionY;
+	backBufferDesc.depth = 1;
+	backBufferDesc.mipLevels = 1;
+	backBufferDesc.arraySize = 1;
+	backBufferDesc.format = Format_R8G8B8A8_UNORM;
+	backBufferDesc.sampleCount = 1;
+	backBufferDesc.access = Access_Default;
+	backBufferDesc.bindFlags = Bind_Render_Target;
+	liveObjects = 0;
+	hostBytes = 0;
+	ResetCounters();
+}
+
+NullDevice::~NullDevice()
+{
+}
+
+void NullDevice::ResetCounters()
+{
+	ZeroMemory(callCount, sizeof(callCount));
+	uploadedBytes = 0;
+	drawnInstances = 0;
+}
+
+void* NullDevice::NewObject(size_t bytes)
+{
+	NullObject* object = new NullObject();
+	object->memory.resize(bytes);
+	object->format = Format_UNKNOWN;
+	liveObjects++;
+	hostBytes += bytes;
+	callCount[NullCall_Create]++;
+	return object;
+}
+
+void* NullDevice::NewTexture(Format format, UINT width, UINT height, UINT depth, UINT mipLevels, UINT arraySize, UINT sampleCount)
+{
+	//0 mip levels means the full chain
+	if (!mipLevels)
+	{
+		UINT largest = max(width, max(height, depth));
+		while (largest >> mipLevels) mipLevels++;
+	}
+	vector<NullSubresource> subresources;
+	size_t bytes = 0;
+	for (UINT slice = 0; slice < max(arraySize, 1u); slice++)
+	{
+		for (UINT i = 0; i < mipLevels; i++)
+		{
+			NullSubresource sub;
+			sub.offset = bytes;
+			sub.rowPitch = ResourceManager::GetRowPitch(format, max(width >> i, 1u));
+			sub.rows = ResourceManager::GetRowCount(format, max(height >> i, 1u));
+			sub.depthPitch = sub.rowPitch * sub.rows;
+			sub.depth = max(depth >> i, 1u);
+			subresources.push_back(sub);
+			bytes += (size_t)sub.depthPitch * sub.depth * max(sampleCount, 1u);
+		}
+	}
+	NullObject* texture = (NullObject*)NewObject(bytes);
+	texture->subresources.swap(subresources);
+	texture->format = format;
+	return texture;
+}
+
+DeviceBuffer* NullDevice::CreateBuffer(const BufferDesc & desc, const SubresourceData * data)
+{
+	NullObject* buffer = (NullObject*)NewObject(desc.byteWidth);
+	NullSubresource sub = { 0, desc.byteWidth, desc.byteWidth, 1, 1 };
+	buffer->subresources.push_back(sub);
+	if (data && data->data)
+		memcpy(&buffer->memory[0], data->data, desc.byteWidth);
+	return (DeviceBuffer*)buffer;
+}
+
+DeviceTexture* NullDevice::CreateTexture(const TextureDesc & desc, const SubresourceData * data)
+{
+	if (!ResourceManager::GetRowPitch(desc.format, desc.width))
+		return NULL;
+	bool volume = desc.type == Resource_Texture3D;
+	NullObject* texture = (NullObject*)NewTexture(desc.format, desc.width, desc.height, volume ? desc.depth : 1, desc.mipLevels, volume ? 1 : desc.arraySize, volume ? 1 : desc.sampleCount);
+	if (data)
+	{
+		//One entry per subresource
+		for (UINT i = 0; i < texture->subresources.size(); i++)
+		{
+			uploadedBytes += CopySubresource(texture, i, data[i].data, data[i].rowPitch, data[i].depthPitch);
+		}
+		callCount[NullCall_Upload]++;
+	}
+	return (DeviceTexture*)texture;
+}
+
+DeviceShaderResourceView* NullDevice::CreateShaderResourceView(DeviceResource * /*resource*/)
+{
+	return (DeviceShaderResourceView*)NewObject(0);
+}
+
+DeviceUnorderedAccessView* NullDevice::CreateUnorderedAccessView(DeviceResource * /*resource*/)
+{
+	return (DeviceUnorderedAccessView*)NewObject(0);
+}
+
+DeviceRenderTargetView* NullDevice::CreateRenderTargetView(DeviceResource * /*resource*/)
+{
+	return (DeviceRenderTargetView*)NewObject(0);
+}
+
+DeviceDepthStencilView* NullDevice::CreateDepthStencilView(DeviceResource * /*resource*/)
+{
+	return (DeviceDepthStencilView*)NewObject(0);
+}
+
+DeviceInputLayout* NullDevice::CreateInputLayout(const InputElementDesc * /*elements*/, UINT /*numElements*/, const void * /*byteCode*/, size_t /*byteCodeLength*/)
+{
+	return (DeviceInputLayout*)NewObject(0);
+}
+
+DeviceShader* NullDevice::CreateShader(PipelineStage /*stage*/, const void * /*byteCode*/, size_t /*byteCodeLength*/)
+{
+	return (DeviceShader*)NewObject(0);
+}
+
+DeviceDepthStencilState* NullDevice::CreateDepthStencilState(const DepthStencilDesc & /*desc*/)
+{
+	return (DeviceDepthStencilState*)NewObject(0);
+}
+
+DeviceBlendState* NullDevice::CreateBlendState(const BlendDesc & /*desc*/)
+{
+	return (DeviceBlendState*)NewObject(0);
+}
+
+DeviceRasterizerState* NullDevice::CreateRasterizerState(const RasterizerDesc & /*desc*/)
+{
+	return (DeviceRasterizerState*)NewObject(0);
+}
+
+DeviceSamplerState* NullDevice::CreateSamplerState(const SamplerDesc & /*desc*/)
+{
+	return (DeviceSamplerState*)NewObject(0);
+}
+
+DeviceTexture* NullDevice::GetBackBuffer(TextureDesc & desc)
+{
+	desc = backBufferDesc;
+	return CreateTexture(backBufferDesc, NULL);
+}
+
+void NullDevice::Release(DeviceObject * object)
+{
+	if (!object) return;
+	NullObject* o = AsNull(object);
+	hostBytes -= o->memory.size();
+	liveObjects--;
+	delete o;
+	callCount[NullCall_Release]++;
+}
+
+bool NullDevice::LoadShader(const string & fileName, const string & entryPoint, PipelineStage /*stage*/, vector<BYTE>& byteCode)
+{
+	ifstream file(fileName + "." + entryPoint + ".cso", ios::binary);
+	if (!file.is_open())
+		file.open(fileName, ios::binary);
+	if (!file.is_open())
+	{
+		char msg[MAX_PATH + 64];
+		sprintf_s(msg, "NullDevice: no shader file %s\n", fileName.c_str());
+		OutputDebugStringA(msg);
+		return false;
+	}
+	byteCode.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	//Callers take &byteCode[0]
+	if (byteCode.empty())
+		byteCode.push_back(0);
+	callCount[NullCall_Other]++;
+	return true;
+}
+
+bool NullDevice::ReflectInputs(const void * /*byteCode*/, size_t /*byteCodeLength*/, vector<ShaderInputParameter>& inputs)
+{
+	inputs.clear();
+	return true;
+}
+
+void NullDevice::SetInputLayout(DeviceInputLayout * /*layout*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetPrimitiveTopology(PrimitiveTopology /*topology*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetVertexBuffers(UINT /*startSlot*/, UINT /*num*/, DeviceBuffer * const * /*buffers*/, const UINT * /*strides*/, const UINT * /*offsets*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetIndexBuffer(DeviceBuffer * /*buffer*/, Format /*format*/, UINT /*offset*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetStreamOutTargets(UINT /*num*/, DeviceBuffer * const * /*buffers*/, const UINT * /*offsets*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetShader(PipelineStage /*stage*/, DeviceShader * /*shader*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetConstantBuffers(UINT /*stage*/, UINT /*startSlot*/, UINT /*num*/, DeviceBuffer * const * /*buffers*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetConstantBufferRanges(UINT /*stage*/, UINT /*startSlot*/, UINT /*num*/, DeviceBuffer * const * /*buffers*/, const UINT * /*firstConstant*/, const UINT * /*numConstants*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetShaderResources(UINT /*stage*/, UINT /*startSlot*/, UINT /*num*/, DeviceShaderResourceView * const * /*views*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetSamplers(UINT /*stage*/, UINT /*startSlot*/, UINT /*num*/, DeviceSamplerState * const * /*samplers*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetComputeUnorderedAccessViews(UINT /*startSlot*/, UINT /*num*/, DeviceUnorderedAccessView * const * /*views*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetOutputs(UINT /*numRTVs*/, DeviceRenderTargetView * const * /*rtvs*/, DeviceDepthStencilView * /*dsv*/, UINT /*uavStartSlot*/, UINT /*numUAVs*/, DeviceUnorderedAccessView * const * /*uavs*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetDepthStencilState(DeviceDepthStencilState * /*state*/, UINT /*stencilRef*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetBlendState(DeviceBlendState * /*state*/, const FLOAT /*blendFactor*/[4], UINT /*sampleMask*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetRasterizerState(DeviceRasterizerState * /*state*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::SetViewports(UINT /*num*/, const ViewPortDesc * /*viewports*/)
+{
+	callCount[NullCall_Bind]++;
+}
+
+void NullDevice::ClearRenderTargetView(DeviceRenderTargetView * /*view*/, const FLOAT /*color*/[4])
+{
+	callCount[NullCall_Clear]++;
+}
+
+void NullDevice::ClearDepthStencilView(DeviceDepthStencilView * /*view*/, UINT /*flags*/, FLOAT /*depth*/, UINT8 /*stencil*/)
+{
+	callCount[NullCall_Clear]++;
+}
+
+void NullDevice::ClearUnorderedAccessViewUint(DeviceUnorderedAccessView * /*view*/, const UINT /*value*/[4])
+{
+	callCount[NullCall_Clear]++;
+}
+
+bool NullDevice::Map(DeviceResource * resource, UINT subresource, MapType /*type*/, MappedSubresource & mapped)
+{
+	//The subresource is writable in place, there is nothing in flight to rename
+	NullObject* o = AsNull(resource);
+	callCount[NullCall_Upload]++;
+	if (subresource >= o->subresources.size())
+		return false;
+	const NullSubresource &sub = o->subresources[subresource];
+	mapped.data = o->memory.empty() ? NULL : &o->memory[sub.offset];
+	mapped.rowPitch = sub.rowPitch;
+	mapped.depthPitch = sub.depthPitch;
+	return true;
+}
+
+void NullDevice::Unmap(DeviceResource * /*resource*/, UINT /*subresource*/)
+{
+	callCount[NullCall_Other]++;
+}
+
+void NullDevice::UpdateSubresource(DeviceResource * resource, UINT subresource, const Box * box, const void * data, UINT rowPitch, UINT depthPitch)
+{
+	callCount[NullCall_Upload]++;
+	NullObject* o = AsNull(resource);
+	if (subresource >= o->subresources.size())
+		return;
+	if (!box)
+	{
+		uploadedBytes += CopySubresource(o, subresource, data, rowPitch, depthPitch);
+		return;
+	}
+	const NullSubresource &sub = o->subresources[subresource];
+	if (o->format == Format_UNKNOWN)
+	{
+		//Buffer boxes are in bytes
+		if (box->right <= sub.rowPitch && box->left < box->right)
+		{
+			memcpy(&o->memory[sub.offset + box->left], data, box->right - box->left);
+			uploadedBytes += box->right - box->left;
+		}
+		return;
+	}
+	//Texture boxes are in texels, on block boundaries for block formats
+	bool blocks = ResourceManager::IsBlockCompressed(o->format);
+	UINT left = box->left ? ResourceManager::GetRowPitch(o->format, box->left) : 0;
+	UINT width = box->right > box->left ? ResourceManager::GetRowPitch(o->format, box->right - box->left) : 0;
+	UINT top = blocks ? box->top / 4 : box->top;
+	UINT bottom = blocks ? (box->bottom + 3) / 4 : box->bottom;
+	if (!width || left + width > sub.rowPitch || top >= bottom || bottom > sub.rows || box->front >= box->back || box->back > sub.depth)
+		return;
+	if (!rowPitch) rowPitch = width;
+	if (!depthPitch) depthPitch = rowPitch * (bottom - top);
+	const BYTE* src = (const BYTE*)data;
+	for (UINT z = box->front; z < box->back; z++)
+	{
+		for (UINT y = top; y < bottom; y++)
+		{
+			memcpy(&o->memory[sub.offset + (size_t)z * sub.depthPitch + (size_t)y * sub.rowPitch + left],
+				src + (size_t)(z - box->front) * depthPitch + (size_t)(y - top) * rowPitch, width);
+		}
+	}
+	uploadedBytes += (size_t)width * (bottom - top) * (box->back - box->front);
+}
+
+void NullDevice::GenerateMips(DeviceShaderResourceView * /*view*/)
+{
+	callCount[NullCall_Other]++;
+}
+
+void NullDevice::DrawIndexedInstanced(UINT /*indexCount*/, UINT instanceCount)
+{
+	callCount[NullCall_Draw]++;
+	drawnInstances += instanceCount;
+}
+
+void NullDevice::Dispatch(UINT /*x*/, UINT /*y*/, UINT /*z*/)
+{
+	callCount[NullCall_Dispatch]++;
+}
+
+void NullDevice::Present()
+{
+	callCount[NullCall_Present]++;
+}
@@ -1,9 +1,12 @@
 #include"Pass.h"
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include"Pipeline.h"
 #include"DescFileLoader.h"
 #include <unordered_map>
+#include <algorithm>
+#include <numeric>
 using namespace std;
 using namespace json11;
 
@@ -22,7 +25,10 @@ Pass::Pass()
 	viewPortID = -1;
 	type = Pass_Default;
 	//Defualt Topology
-	topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+	topology = Topology_Triangle_List;
+	minCoverage = 0;
+	view = View_All;
+	viewLight = 0;
 }
 
 void Pass::Load(const string& key, const int& id)
@@ -34,7 +40,7 @@ void Pass::Load(const string& key, const int& id)
 	else if (key == "blend_state") blendStateID = id;
 	else if (key == "rasterizer_state") rasterizorStateID = id;
 	else if (key == "view_port") viewPortID = id;
-	else throw exception(("Can not parse : " + key).c_str());
+	else throw runtime_error(("Can not parse : " + key).c_str());
 }
 
 
@@ -47,7 +53,7 @@ void Pass::Bind(const vector<int> & resourceID, const vector<int> & samplerID) c
 {
 	if(resourceID.size() != resourceBinding.size() ||
 		samplerID.size() != samplerBinding.size())
-		throw exception("Pass Cfg mismach!");
+		throw runtime_error("Pass Cfg mismach!");
 
 	if(currentPass != NULL) currentPass->Unbind();
 
@@ -85,13 +91,13 @@ void Pass::Unbind() const
 	}
 
 	if (currentPass == this)
-		currentPass == NULL;
+		currentPass = NULL;
 }
 
 Pass::Pass(const json11::Json & jpass, const unordered_map<string, unordered_map<string, int>>& resourceMap):Pass()
 {
 	if (!jpass.is_object())
-		throw exception("Pass creation faild");
+		throw runtime_error("Pass creation faild");
 	auto& passData = jpass.object_items();
 	for (auto& item : passData)
 	{
@@ -100,12 +106,33 @@ Pass::Pass(const json11::Json & jpass, const unordered_map<string, unordered_map
 			if(item.second.string_value() == "post")
 				type = Pass_PostProcessing;
 		}
+		else if (item.first == "min_coverage")
+		{
+			if (!item.second.is_number() || item.second.number_value() < 0)
+				throw runtime_error("Pass creation faild");
+			minCoverage = (float)item.second.number_value();
+		}
+		else if (item.first == "view")
+		{
+			string v = item.second.is_string() ? item.second.string_value() : "";
+			if (v == "all") view = View_All;
+			else if (v == "camera") view = View_Camera;
+			else if (v == "light") view = View_Light;
+			else if (v == "voxel") view = View_Voxel;
+			else throw runtime_error("Pass creation faild");
+		}
+		else if (item.first == "view_light")
+		{
+			if (!item.second.is_number() || item.second.int_value() < 0)
+				throw runtime_error("Pass creation faild");
+			viewLight = item.second.int_value();
+		}
 		else if (resourceMap.count(item.first))
 		{
 			const auto& subRes = resourceMap.find(item.first)->second;
 			if (item.first == "sampler_state")
 			{
-				if (!item.second.is_array()) throw exception("Pass creation faild");
+				if (!item.second.is_array()) throw runtime_error("Pass creation faild");
 				for (auto& bind : item.second.array_items())
 				{
 					samplerBinding.push_back(move(SamplerPort(bind)));
@@ -113,7 +140,7 @@ Pass::Pass(const json11::Json & jpass, const unordered_map<string, unordered_map
 			}
 			else if (item.first == "resource")
 			{
-				if (!item.second.is_array()) throw exception("Pass creation faild");
+				if (!item.second.is_array()) throw runtime_error("Pass creation faild");
 				for (auto& bind : item.second.array_items())
 				{
 					resourceBinding.push_back(move(ResourcePort(bind)));
@@ -122,12 +149,15 @@ Pass::Pass(const json11::Json & jpass, const unordered_map<string, unordered_map
 			else
 			{
 				if (!item.second.is_string() || !subRes.count(item.second.string_value()))
-					throw exception("Pass creation faild");
+					throw runtime_error("Pass creation faild");
 				Load(item.first, subRes.find(item.second.string_value())->second);
 			}
 		}
 
 	}
+	//Coverage is measured on the main camera, it means nothing to other views
+	if (minCoverage > 0 && view != View_Camera)
+		throw runtime_error("Pass creation faild: min_coverage needs \"view\": \"camera\"");
 }
 
 
@@ -156,7 +186,132 @@ void Effect::DeleteResource(const string& type, const int& id)
 	else if (type == "sampler_state")  PipeLine::SamplerState().Delete(id);
 	else if (type == "view_port")  PipeLine::ViewPort().Delete(id);
 	else if (type == "resource")  PipeLine::Resources().Delete(id);
-	else throw exception("Unknow Resource Type");
+	else throw runtime_error("Unknow Resource Type");
+}
+
+//Names of the resources an operation of a renderer uses
+static void OperationResources(const Json & op, vector<string> & names)
+{
+	if (op["pass"].is_string())
+	{
+		for (const auto& r : op["resource"].array_items())
+		{
+			if (r.is_string()) names.push_back(r.string_value());
+		}
+	}
+	if (op["reset"].is_string()) names.push_back(op["reset"].string_value());
+	if (op["gen_mip"].is_string()) names.push_back(op["gen_mip"].string_value());
+}
+
+//Descs that can be served by the same resource, names aside
+static bool SameLayout(const ResourceDesc & a, const ResourceDesc & b)
+{
+	return a.type == b.type && a.access == b.access && a.bindFlag == b.bindFlag && a.format == b.format &&
+		a.size[0] == b.size[0] && a.size[1] == b.size[1] && a.size[2] == b.size[2] &&
+		a.mipLevel == b.mipLevel && a.elementStride == b.elementStride && a.miscFlag == b.miscFlag &&
+		a.sampleCount == b.sampleCount && a.sampleQuality == b.sampleQuality;
+}
+
+void Effect::CreateTransientResources(const vector<pair<string, string>>& transient, const Json & jrenderer)
+{
+	const auto& renderers = jrenderer.object_items();
+	size_t numResources = transient.size();
+	size_t numRenderers = renderers.size();
+	unordered_map<string, size_t> index;
+	for (size_t i = 0; i < numResources; i++)
+	{
+		index[transient[i].first] = i;
+	}
+
+	//First and last operation using each resource in each renderer, -1 when unused
+	vector<vector<pair<int, int>>> life(numResources, vector<pair<int, int>>(numRenderers, make_pair(-1, -1)));
+	size_t r = 0;
+	for (const auto& e : renderers)
+	{
+		const auto& ops = e.second.array_items();
+		for (int op = 0; op < (int)ops.size(); op++)
+		{
+			vector<string> names;
+			OperationResources(ops[op], names);
+			for (const auto& name : names)
+			{
+				auto it = index.find(name);
+				if (it == index.end()) continue;
+				auto& span = life[it->second][r];
+				if (span.first < 0) span.first = op;
+				span.second = op;
+			}
+		}
+		r++;
+	}
+	//Renderers run one at a time, resources only clash within one
+	auto overlap = [&](size_t a, size_t b)
+	{
+		for (size_t i = 0; i < numRenderers; i++)
+		{
+			const auto& sa = life[a][i];
+			const auto& sb = life[b][i];
+			if (sa.first >= 0 && sb.first >= 0 && sa.first <= sb.second && sb.first <= sa.second)
+				return true;
+		}
+		return false;
+	};
+	auto firstUse = [&](size_t a)
+	{
+		for (size_t i = 0; i < numRenderers; i++)
+		{
+			if (life[a][i].first >= 0) return make_pair(i, life[a][i].first);
+		}
+		return make_pair(numRenderers, 0);
+	};
+
+	vector<ResourceDesc> descs;
+	for (const auto& t : transient)
+	{
+		descs.push_back(FileLoader::LoadResourceDesc(t.second));
+	}
+
+	//Interval packing: by order of first use, each resource joins the first group
+	//of the same layout it never overlaps, which is optimal within one renderer
+	vector<size_t> order(numResources);
+	iota(order.begin(), order.end(), 0);
+	stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return firstUse(a) < firstUse(b); });
+	vector<vector<size_t>> groups;
+	for (size_t i : order)
+	{
+		size_t g = 0;
+		for (; g < groups.size(); g++)
+		{
+			if (!SameLayout(descs[groups[g][0]], descs[i])) continue;
+			bool clash = false;
+			for (size_t member : groups[g])
+			{
+				if (overlap(member, i))
+				{
+					clash = true;
+					break;
+				}
+			}
+			if (!clash) break;
+		}
+		if (g == groups.size()) groups.push_back(vector<size_t>());
+		groups[g].push_back(i);
+	}
+
+	for (const auto& group : groups)
+	{
+		const ResourceDesc& desc = descs[group[0]];
+		int id = PipeLine::Resources().Create(desc);
+		if (id < 0) throw runtime_error(("resource Creation Failed : Name: " + transient[group[0]].second).c_str());
+		for (size_t member : group)
+		{
+			resourceMap["resource"][transient[member].first] = id;
+		}
+		size_t bytes = ResourceManager::GetByteSize(desc);
+		transientBytes += bytes * group.size();
+		aliasedBytes += bytes * (group.size() - 1);
+	}
+	transientCount = (UINT)numResources;
 }
 
 PassOperation Effect::LoadPassConfig(const json11::Json & json) const
@@ -167,7 +322,7 @@ PassOperation Effect::LoadPassConfig(const json11::Json & json) const
 		(!json["sampler"].is_null() && !json["sampler"].is_array()) ||
 		(!json["resource"].is_null() && !json["resource"].is_array())
 		) 
-		throw exception("LoadPassConfig error");
+		throw runtime_error("LoadPassConfig error");
 
 	
 	int passID = passNameTable.at(json["pass"].string_value());
@@ -177,7 +332,7 @@ PassOperation Effect::LoadPassConfig(const json11::Json & json) const
 	{
 		for (const auto& s : json["sampler"].array_items())
 		{
-			if(!s.is_string() || !resourceMap.at("sampler").count(s.string_value())) 	throw exception("LoadPassConfig error");
+			if(!s.is_string() || !resourceMap.at("sampler").count(s.string_value())) 	throw runtime_error("LoadPassConfig error");
 			cfg.passSamplerID.push_back(resourceMap.at("sampler").at(s.string_value()));
 		}
 	}
@@ -186,7 +341,7 @@ PassOperation Effect::LoadPassConfig(const json11::Json & json) const
 	{
 		for (const auto& s : json["resource"].array_items())
 		{
-			if (!s.is_string() || !resourceMap.at("resource").count(s.string_value())) 	throw exception("LoadPassConfig Error");
+			if (!s.is_string() || !resourceMap.at("resource").count(s.string_value())) 	throw runtime_error("LoadPassConfig Error");
 			cfg.passResourceID.push_back(resourceMap.at("resource").at(s.string_value()));
 		}
 	}
@@ -196,9 +351,9 @@ PassOperation Effect::LoadPassConfig(const json11::Json & json) const
 
 ResetOperation Effect::LoadResetOp(const json11::Json & json) const
 {
-	if (!json.is_object() || !json["reset"].is_string() || !json["value_type"].is_string() || !json["value"].is_array()) throw exception("Parse Operation Error");
+	if (!json.is_object() || !json["reset"].is_string() || !json["value_type"].is_string() || !json["value"].is_array()) throw runtime_error("Parse Operation Error");
 	string key = json["reset"].string_value();
-	if (!resourceMap.at("resource").count(key))  throw exception("Parse Operation Error");
+	if (!resourceMap.at("resource").count(key))  throw runtime_error("Parse Operation Error");
 
 	ResetOperation op;
 	op.targetID = resourceMap.at("resource").at(key);
@@ -206,7 +361,7 @@ ResetOperation Effect::LoadResetOp(const json11::Json & json) const
 	const auto& arr = json["value"].array_items();
 	if (json["value_type"].string_value() == "float")
 	{
-		if (arr.size() != 4) throw exception("Parse ResetOperation Error");
+		if (arr.size() != 4) throw runtime_error("Parse ResetOperation Error");
 		for (int i = 0; i < 4; i++)
 		{
 			float v = arr[i].number_value();
@@ -215,7 +370,7 @@ ResetOperation Effect::LoadResetOp(const json11::Json & json) const
 	}
 	else if (json["value_type"].string_value() == "uint")
 	{
-		if (arr.size() != 4) throw exception("Parse ResetOperation Error");
+		if (arr.size() != 4) throw runtime_error("Parse ResetOperation Error");
 		for (int i = 0; i < 4; i++)
 		{
 			UINT v = arr[i].int_value();
@@ -224,32 +379,32 @@ ResetOperation Effect::LoadResetOp(const json11::Json & json) const
 	}
 	else if (json["value_type"].string_value() == "depth")
 	{
-		if (arr.size() != 1) throw exception("Parse ResetOperation Error");
+		if (arr.size() != 1) throw runtime_error("Parse ResetOperation Error");
 		op.value[0] = 1;
 		float v = arr[0].number_value();
 		op.value[1] = *((UINT*)&v);
 	}
 	else if (json["value_type"].string_value() == "stencil")
 	{
-		if (arr.size() != 1) throw exception("Parse ResetOperation Error");
+		if (arr.size() != 1) throw runtime_error("Parse ResetOperation Error");
 		op.value[0] = 2;
 		op.value[2] = arr[0].int_value();
 	}
 	else if (json["value_type"].string_value() == "depth_stencil") {
-		if (arr.size() != 2) throw exception("Parse ResetOperation Error");
+		if (arr.size() != 2) throw runtime_error("Parse ResetOperation Error");
 		op.value[0] = 3;
 		float v = arr[0].number_value();
 		op.value[1] = *((UINT*)&v);
 		op.value[2] = arr[1].int_value();
 	}
-	else throw exception("Parse ResetOperation Error");
+	else throw runtime_error("Parse ResetOperation Error");
 
 	return op;
 }
 
 GenMipOperation Effect::LoadGenMipOp(const json11::Json & json) const
 {
-	if(!json.is_object() || !json["gen_mip"].is_string() || !resourceMap.at("resource").count(json["gen_mip"].string_value()))  throw exception("Load GenMip Error");
+	if(!json.is_object() || !json["gen_mip"].is_string() || !resourceMap.at("resource").count(json["gen_mip"].string_value()))  throw runtime_error("Load GenMip Error");
 	GenMipOperation op;
 	op.targetID = resourceMap.at("resource").at(json["gen_mip"].string_value());
 	return op;
@@ -258,12 +413,12 @@ GenMipOperation Effect::LoadGenMipOp(const json11::Json & json) const
 
 vector<Operation*> Effect::LoadRenderer(const json11::Json & json)
 {
-	if(!json.is_array()) throw exception("Load Renderer Error");
+	if(!json.is_array()) throw runtime_error("Load Renderer Error");
 	vector<Operation*> result;
 	for (const auto& e : json.array_items())
 	{
 		if (!e.is_object()) 
-			throw exception("Load Operation Error");
+			throw runtime_error("Load Operation Error");
 		if (e["pass"].is_string())
 		{
 			result.push_back(new PassOperation(LoadPassConfig(e)));
@@ -276,7 +431,7 @@ vector<Operation*> Effect::LoadRenderer(const json11::Json & json)
 		{
 			result.push_back(new GenMipOperation(LoadGenMipOp(e)));
 		}
-		else  throw exception("Load Operation Error");
+		else  throw runtime_error("Load Operation Error");
 	}
 	return move(result);
 }
@@ -297,6 +452,8 @@ void Effect::Apply()
 Effect* Effect::Create(const string & filePath)
 {
 	Effect* effect = new Effect();
+	effect->memoryOwner = "effect:" + filePath;
+	MemoryOwnerScope memoryScope(effect->memoryOwner);
 	try 
 	{
 		ifstream file(filePath);
@@ -311,49 +468,75 @@ Effect* Effect::Create(const string & filePath)
 
 		string err;
 		Json json = Json::parse(input, err, json11::COMMENTS);
-		if (err != "") throw exception(("Json Format Error: " + filePath + ". " + err).c_str());
-		string workingFolder = filePath;
-		int upper = workingFolder.size() - 1;
-		while (upper > 0 && workingFolder[upper] != '\\') upper--;
-		workingFolder.resize(upper + 1);
+		if (err != "") throw runtime_error(("Json Format Error: " + filePath + ". " + err).c_str());
+		string workingFolder = NativePath(filePath);
+		size_t upper = workingFolder.find_last_of("\\/");
+		workingFolder.resize(upper == string::npos ? 0 : upper + 1);
 
 		//Check
-		if (!json["resource"].is_object()) throw exception(("Error: can not read \"resource\". " + filePath).c_str());
-		if (!json["pass"].is_object()) throw exception(("Error: can not read \"pass\". " + filePath).c_str());
-		if (!json["renderer"].is_object()) throw exception(("Error: can not read \"renderer\". " + filePath).c_str());
-		if (!json["config"].is_object()) throw exception(("Error: can not read \"config\". " + filePath).c_str());
-		if (!json["static_sampler"].is_null() && !json["static_sampler"].is_array()) throw exception(("Error: can not read \"static_sampler\". " + filePath).c_str());
-		if (!json["static_resource"].is_null() && !json["static_resource"].is_array()) throw exception(("Error: can not read \"static_resource\". " + filePath).c_str());
+		if (!json["resource"].is_object()) throw runtime_error(("Error: can not read \"resource\". " + filePath).c_str());
+		if (!json["pass"].is_object()) throw runtime_error(("Error: can not read \"pass\". " + filePath).c_str());
+		if (!json["renderer"].is_object()) throw runtime_error(("Error: can not read \"renderer\". " + filePath).c_str());
+		if (!json["config"].is_object()) throw runtime_error(("Error: can not read \"config\". " + filePath).c_str());
+		if (!json["static_sampler"].is_null() && !json["static_sampler"].is_array()) throw runtime_error(("Error: can not read \"static_sampler\". " + filePath).c_str());
+		if (!json["static_resource"].is_null() && !json["static_resource"].is_array()) throw runtime_error(("Error: can not read \"static_resource\". " + filePath).c_str());
+		if (!json["transient_resource"].is_null() && !json["transient_resource"].is_array()) throw runtime_error(("Error: can not read \"transient_resource\". " + filePath).c_str());
+
+		//Transient resources hold nothing across renderer operations that don't use them, they may share memory
+		unordered_map<string, bool> transientNames;
+		for (auto& t : json["transient_resource"].array_items())
+		{
+			if (!t.is_string() || !json["resource"]["resource"][t.string_value()].is_string()) throw runtime_error(("Error: can not parse transient_resource, in " + filePath).c_str());
+			transientNames[t.string_value()] = true;
+		}
+		for (auto& s : json["static_resource"].array_items())
+		{
+			if (transientNames.count(s["name"].string_value())) throw runtime_error(("Error: static_resource can't be transient, in " + filePath).c_str());
+		}
+		vector<pair<string, string>> transient;
 
 		//Load InputLayout:
-		if (!json["config"]["input_layout"].is_string()) throw exception(("Error: can not read \"input_layout\". " + filePath).c_str());
-		effect->inputLayout = PipeLine::InputLayout().Create(workingFolder + json["config"]["input_layout"].string_value(),"main");
-		if(effect->inputLayout < 0) throw exception(("Error: can not create \"input_layout\" : " + workingFolder + json["config"]["input_layout"].string_value()).c_str());
+		if (!json["config"]["input_layout"].is_string()) throw runtime_error(("Error: can not read \"input_layout\". " + filePath).c_str());
+		effect->inputLayout = PipeLine::InputLayout().Create(workingFolder + NativePath(json["config"]["input_layout"].string_value()),"main");
+		if(effect->inputLayout < 0) throw runtime_error(("Error: can not create \"input_layout\" : " + workingFolder + json["config"]["input_layout"].string_value()).c_str());
 
 		//Load Resources:
 		auto& resource = json["resource"].object_items();
 		effect->resourceMap["resource"]["back_buffer"] = PipeLine::Resources().GetBackBuffer();
 		for (auto& e : resource)//for each kind of resources;
 		{
-			if (!e.second.is_object()) throw exception(("Error: can not parse " + e.first + filePath).c_str());
+			if (!e.second.is_object()) throw runtime_error(("Error: can not parse " + e.first + filePath).c_str());
 
 			auto& item = e.second.object_items();
 
 			for (auto& res : item)//for each resource;
 			{
-				if (!res.second.is_string()) throw exception(("Error: can not parse " + res.first + ", in " + filePath).c_str());
-				int id = CreateResource(e.first, workingFolder + res.second.string_value());
-				if (id < 0) throw exception((effect, e.first + " Creation Failed : Name: " + workingFolder + res.second.string_value()).c_str());
+				if (!res.second.is_string()) throw runtime_error(("Error: can not parse " + res.first + ", in " + filePath).c_str());
+				if (e.first == "resource" && transientNames.count(res.first))
+				{
+					transient.push_back(make_pair(res.first, workingFolder + NativePath(res.second.string_value())));
+					continue;
+				}
+				int id = CreateResource(e.first, workingFolder + NativePath(res.second.string_value()));
+				if (id < 0) throw runtime_error((e.first + " Creation Failed : Name: " + workingFolder + res.second.string_value()).c_str());
 				effect->resourceMap[e.first][res.first] = id;
 			}
 		}
+		if (!transient.empty())
+		{
+			effect->CreateTransientResources(transient, json["renderer"]);
+			char log[512];
+			sprintf_s(log, "%s: %u transient resources, %zu of %zu bytes saved by aliasing\n",
+				filePath.c_str(), effect->transientCount, effect->aliasedBytes, effect->transientBytes);
+			OutputDebugStringA(log);
+		}
 
 		//Load Static Samplers
 		if (json["static_sampler"].is_array())
 		{
 			for (auto& s : json["static_sampler"].array_items())
 			{
-				if(!s["name"].is_string() || !effect->resourceMap["sampler_state"].count(s["name"].string_value())) throw exception(("Error: can not parse static_sampler, in " + filePath).c_str());
+				if(!s["name"].is_string() || !effect->resourceMap["sampler_state"].count(s["name"].string_value())) throw runtime_error(("Error: can not parse static_sampler, in " + filePath).c_str());
 				effect->staticSamplers.push_back(make_pair(SamplerPort(s), effect->resourceMap["sampler_state"][s["name"].string_value()]));
 			}
 		}
@@ -363,7 +546,7 @@ Effect* Effect::Create(const string & filePath)
 		{
 			for (auto& s : json["static_resource"].array_items())
 			{
-				if (!s["name"].is_string() || !effect->resourceMap["resource"].count(s["name"].string_value())) throw exception(("Error: can not parse static_resource, in " + filePath).c_str());
+				if (!s["name"].is_string() || !effect->resourceMap["resource"].count(s["name"].string_value())) throw runtime_error(("Error: can not parse static_resource, in " + filePath).c_str());
 
 				effect->staticResources.push_back(make_pair(ResourcePort(s), effect->resourceMap["resource"][s["name"].string_value()]));
 			}
@@ -381,21 +564,33 @@ Effect* Effect::Create(const string & filePath)
 		auto& jrenderer = json["renderer"].object_items();
 		for (auto& e : jrenderer)
 		{
-			if (!e.second.is_array()) throw exception(("Error: can not parse renderer: " + e.first + ", in " + filePath).c_str());
+			if (!e.second.is_array()) throw runtime_error(("Error: can not parse renderer: " + e.first + ", in " + filePath).c_str());
 			effect->renderer[e.first] = effect->LoadRenderer(e.second);
 		}
 	}
-	catch (exception ex)
+	catch (...)
 	{
 		delete effect;
-		throw ex;
+		throw;
 	}
 	return effect;
 }
 
+size_t Effect::GetMemoryUsage() const
+{
+	return PipeLine::Resources().GetMemoryUsage(memoryOwner);
+}
+
 Effect::~Effect()
 {
+	//The pass bound last may be one of ours, the next Bind must not unbind it
+	for (const Pass& pass : passes)
+	{
+		if (Pass::currentPass == &pass)
+			Pass::currentPass = NULL;
+	}
 	PipeLine::InputLayout().Delete(inputLayout);
+	//Aliased transient resources share an ID, deleting it again does nothing
 	for (auto& resType : resourceMap)
 	{
 		for (auto& res : resType.second)
@@ -428,6 +623,16 @@ void PassOperation::Execute()
 
 }
 
+const Pass * PassOperation::GetPass() const
+{
+	return pPass;
+}
+
+void PassOperation::Record(CommandBuffer & commands) const
+{
+	commands.BindPass(pPass, pPass->resourceBinding.size(), pPass->samplerBinding.size(), passResourceID, passSamplerID);
+}
+
 ResetOperation::ResetOperation()
 {
 	type = Operation_Reset;
@@ -444,6 +649,11 @@ void ResetOperation::Execute()
 	PipeLine::Resources().Reset(targetID, value);
 }
 
+void ResetOperation::Record(CommandBuffer & commands) const
+{
+	commands.Reset(targetID, value);
+}
+
 GenMipOperation::GenMipOperation()
 {
 	type = Operation_GenMip;
@@ -455,6 +665,11 @@ void GenMipOperation::Execute()
 	PipeLine::Resources().GenerateMipMap(targetID);
 }
 
+void GenMipOperation::Record(CommandBuffer & commands) const
+{
+	commands.GenerateMipMap(targetID);
+}
+
 ResourcePort::ResourcePort(const json11::Json & json)
 {
 	if (!json.is_object() ||
@@ -463,7 +678,7 @@ ResourcePort::ResourcePort(const json11::Json & json)
 		!json["stage"].is_string() ||
 		!json["binding_flag"].is_string()
 		)
-		throw exception("ResourceBinding creation faild");
+		throw runtime_error("ResourceBinding creation faild");
 
 	stages = FileLoader::parsePipelineStage(json["stage"].string_value());
 	flag = FileLoader::parseBindFlag(json["binding_flag"].string_value());
@@ -487,7 +702,7 @@ SamplerPort::SamplerPort(const json11::Json & json)
 		json["slot"].int_value() < 0 ||
 		!json["stage"].is_string()
 		)
-		throw exception("ResourceBinding creation faild");
+		throw runtime_error("ResourceBinding creation faild");
 
 	stages = FileLoader::parsePipelineStage(json["stage"].string_value());
 	slot = json["slot"].int_value();
@@ -6,12 +6,11 @@
 *-Author Sentao
 *///---------------------------------------------
 
-#include<windows.h>
 #include <vector>
 #include <unordered_map>
-#include <d3d11_1.h>
 #include "D3Def.h"
 #include "ResourceManager.h"
+#include "CommandBuffer.h"
 #include "json11/json11.hpp"
 using namespace std;
 
@@ -21,6 +20,15 @@ enum PassType
 	Pass_PostProcessing
 };
 
+//View whose visible instances a pass draws, "view" in the effect file
+enum PassView
+{
+	View_All,
+	View_Camera,
+	View_Light, //Light viewLight of the engine's light list
+	View_Voxel
+};
+
 class ResourcePort
 {
 public:
@@ -57,7 +65,12 @@ public:
 	int viewPortID;
 	vector<SamplerPort> samplerBinding;
 	vector<ResourcePort> resourceBinding;//Engine will unbind those resources from pipline after rendering
-	D3D_PRIMITIVE_TOPOLOGY topology;
+	PrimitiveTopology topology;
+	//Instances whose bounding sphere covers fewer pixels on the main camera are not drawn, "min_coverage" in the effect file.
+	//Only camera view passes take it, GEngine ignores it on any other view
+	float minCoverage;
+	PassView view;
+	UINT viewLight; //"view_light", index of the light when view is "light"
 
 	Pass();
 	Pass(const json11::Json& obj, const unordered_map<string, unordered_map<string, int>>& resourceMap);
@@ -69,6 +82,7 @@ private:
 	void Load(const string& key, const int& id);
 	void LoadTopology(const string& topology);
 	static Pass* currentPass;
+	friend class Effect;
 };
 
 
@@ -86,6 +100,10 @@ class Operation
 public:
 	OperationType type;
 	virtual void Execute() = 0;
+	//Same work as Execute, appended to a command buffer instead
+	virtual void Record(CommandBuffer &commands) const = 0;
+	//Effect deletes its operations through this base
+	virtual ~Operation() {}
 };
 
 class PassOperation : public Operation
@@ -96,6 +114,8 @@ public:
 	vector<int> passResourceID;
 	PassOperation(const Pass* pPass);
 	void Execute();
+	void Record(CommandBuffer &commands) const;
+	const Pass* GetPass() const;
 private:
 	const Pass* pPass;
 	
@@ -108,6 +128,7 @@ public:
 	UINT value[4];
 	ResetOperation();
 	void Execute();
+	void Record(CommandBuffer &commands) const;
 };
 
 class GenMipOperation : public Operation
@@ -116,6 +137,7 @@ public:
 	UINT targetID;
 	GenMipOperation();
 	void Execute();
+	void Record(CommandBuffer &commands) const;
 };
 
 
@@ -128,10 +150,20 @@ public:
 	static Effect* Create(const string & filePath); //User should delete effect to prevent memory leak.
 	void Apply();
 	int inputLayout;
+	//Resources named in "transient_resource" and the bytes they would take unshared,
+	//and the bytes saved by letting the ones never live together share one resource
+	UINT transientCount;
+	size_t transientBytes;
+	size_t aliasedBytes;
+	//Owner the effect's resources are counted for, "effect:" and the file path
+	string memoryOwner;
+	size_t GetMemoryUsage() const;
 	~Effect();
 private:
 	static int CreateResource(const string& type, const string& filePath);
 	static void DeleteResource(const string & type, const int& id);
+	//Places transient resources, given as name and desc file, into shared resources
+	void CreateTransientResources(const vector<pair<string, string>>& transient, const json11::Json & jrenderer);
 
 	unordered_map<string, int> passNameTable;
 	unordered_map<string, unordered_map<string, int>> resourceMap;
@@ -144,7 +176,7 @@ private:
 
 	vector<Operation*> LoadRenderer(const json11::Json & json);
 
-	Effect() {};
+	Effect() { transientCount = 0; transientBytes = aliasedBytes = 0; };
 	Effect(Effect const&) : Effect() {}
 	Effect& operator= (Effect const&) { return *this; }
 };
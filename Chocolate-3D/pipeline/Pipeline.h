@@ -1,34 +1,22 @@
 #pragma once
-#include<windows.h>
-#include <d3d11_1.h>
+#include "Platform.h"
 #include "ShaderManager.h"
 #include "StateManager.h"
 #include "ResourceManager.h"
+#include "Device.h"
 using namespace std;
 
-
-class GraphicDevice
-{
-public:
-	GraphicDevice();
-	~GraphicDevice();
-
-	int screenWidth, screenHeight;
-
-	IDXGIFactory* factory;
-	IDXGIAdapter* adapter;
-	IDXGIOutput* adapterOutput;
-	DXGI_MODE_DESC* displayModeList;
-	DXGI_ADAPTER_DESC adapterDesc;
-
-	unsigned int numModes, numerator, denominator;
-	int videoCardMemory;
-	char videoCardDescription[128];
-};
-
+//ShaderManager.h and ResourceManager.h include this header before declaring their classes
+class InputLayout;
+class VertexShader;
+class PixelShader;
+class GeometryShader;
+class ComputeShader;
+class ResourceManager;
 
 class PipeLine
 {
+	friend class ShaderManager;
 	friend class InputLayout;
 	friend class VertexShader;
 	friend class PixelShader;
@@ -42,39 +30,51 @@ class PipeLine
 	friend class ViewPort;
 	friend class Resource;
 public:
+	//Qualified, each accessor is named after the class it returns
+	static ::InputLayout& InputLayout();
+	static ::VertexShader& VertexShader();
+	static ::PixelShader& PixelShader();
+	static ::GeometryShader& GeometryShader();
+	static ::ComputeShader& ComputeShader();
 
-	static InputLayout& InputLayout();
-	static VertexShader& VertexShader();
-	static PixelShader& PixelShader();
-	static GeometryShader& GeometryShader();
-	static ComputeShader& ComputeShader();
-
-	static DepthStencilState& DepthStencilState();
-	static BlendState& BlendState();
-	static RasterizorState& RasterizorState();
-	static SamplerState& SamplerState();
-	static ViewPort& ViewPort();
+	static ::DepthStencilState& DepthStencilState();
+	static ::BlendState& BlendState();
+	static ::RasterizorState& RasterizorState();
+	static ::SamplerState& SamplerState();
+	static ::ViewPort& ViewPort();
 
 	static ResourceManager& Resources();
 
-	static bool Init(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen);
-	static void SetPrimitiveType(D3D11_PRIMITIVE_TOPOLOGY type);
+	//D3D11 with a swap chain on window, an HWND. False where there is no D3D11
+	static bool Init(UINT resolutionX, UINT resolutionY, void* window, bool fullScreen);
+	//NullDevice instead of D3D11: no GPU, no window, calls are counted
+	static bool InitHeadless(UINT resolutionX, UINT resolutionY);
+	//NULL before Init, cast to NullDevice for its counters after InitHeadless
+	static Device* GetDevice();
+	static void SetPrimitiveType(PrimitiveTopology type);
 	static void Draw(UINT indexCount, UINT instanceCount);
 	static void Compute(UINT threadCountX, UINT threadCountY, UINT threadCountZ);
 	static void Swap();
+	//Number of Swap calls so far
+	static UINT64 GetFrameIndex();
 	static void Shutdown();
+	//Sum of the resource and state managers' counters, reset once per frame
+	static BindingStats GetBindingStats();
+	static void ResetBindingStats();
+	//Drops every manager's shadow state, call after using the context directly
+	static void InvalidateBindings();
+	//D3D11.1: constant buffers bound by range, and mapped with NO_OVERWRITE
+	static bool SupportsConstantBufferRanges();
 private:
 	PipeLine();
 	~PipeLine();
 	PipeLine(PipeLine const&);
 	PipeLine& operator=(PipeLine const&) { return *this; };
 
-	static bool Init();
-	static bool CreateSwapChain(UINT resolutionX, UINT resolutionY, HWND hwnd, bool fullScreen);
-	static ID3D11Device* pDevice;
-	static ID3D11DeviceContext* pContext;
-	static IDXGISwapChain* pSwapChain;
-	static HWND hwnd;
+	static bool Init(Device* device, UINT resolutionX, UINT resolutionY, void* window);
+	static Device* device;
+	static void* window;
+	static UINT64 frameIndex;
 	static int resolutionX;
 	static int resolutionY;
 };
\ No newline at end of file
@@ -3,9 +3,12 @@
 //===========================================================
 #include"ResourceManager.h"
 #include"DescFileLoader.h"
+#include "json11/json11.hpp"
+#include <algorithm>
+#include <sstream>
 using namespace FileLoader;
 
-unordered_map<DXGI_FORMAT, UINT> Resource::FormatSizeTable;
+unordered_map<Format, UINT> Resource::FormatSizeTable;
 
 Resource* Resource::pBackBuffer = NULL;
 
@@ -13,126 +16,131 @@ void Resource::InitFormatTable()
 {
 	if (FormatSizeTable.size() == 0)
 	{
-		FormatSizeTable[DXGI_FORMAT_R32G32B32A32_TYPELESS] = 128;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32A32_FLOAT] = 128;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32A32_UINT] = 128;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32A32_SINT] = 128;
-
-		FormatSizeTable[DXGI_FORMAT_R32G32B32_TYPELESS] = 96;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32_FLOAT] = 96;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32_UINT] = 96;
-		FormatSizeTable[DXGI_FORMAT_R32G32B32_SINT] = 96;
-
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_TYPELESS] = 64;
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_FLOAT] = 64;
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_UNORM] = 64;
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_UINT] = 64;
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_SNORM] = 64;
-		FormatSizeTable[DXGI_FORMAT_R16G16B16A16_SINT] = 64;
-
-		FormatSizeTable[DXGI_FORMAT_R32G32_TYPELESS] = 64;
-		FormatSizeTable[DXGI_FORMAT_R32G32_FLOAT] = 64;
-		FormatSizeTable[DXGI_FORMAT_R32G32_UINT] = 64;
-		FormatSizeTable[DXGI_FORMAT_R32G32_SINT] = 64;
-
-		FormatSizeTable[DXGI_FORMAT_R32G8X24_TYPELESS] = 64;
-		FormatSizeTable[DXGI_FORMAT_D32_FLOAT_S8X24_UINT] = 64;
-		FormatSizeTable[DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS] = 64;
-		FormatSizeTable[DXGI_FORMAT_X32_TYPELESS_G8X24_UINT] = 64;
-
-		FormatSizeTable[DXGI_FORMAT_R10G10B10A2_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_R10G10B10A2_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R10G10B10A2_UINT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R11G11B10_FLOAT] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_UNORM_SRGB] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_UINT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_SNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8B8A8_SINT] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_R16G16_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_R16G16_FLOAT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R16G16_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R16G16_UINT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R16G16_SNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R16G16_SINT] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_R32_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_D32_FLOAT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R32_FLOAT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R32_UINT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R32_SINT] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_R24G8_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_D24_UNORM_S8_UINT] = 32;
-		FormatSizeTable[DXGI_FORMAT_R24_UNORM_X8_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_X24_TYPELESS_G8_UINT] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_R8G8_TYPELESS] = 16;
-		FormatSizeTable[DXGI_FORMAT_R8G8_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_R8G8_UINT] = 16;
-		FormatSizeTable[DXGI_FORMAT_R8G8_SNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_R8G8_SINT] = 16;
-
-		FormatSizeTable[DXGI_FORMAT_R16_TYPELESS] = 16;
-		FormatSizeTable[DXGI_FORMAT_R16_FLOAT] = 16;
-		FormatSizeTable[DXGI_FORMAT_D16_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_R16_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_R16_UINT] = 16;
-		FormatSizeTable[DXGI_FORMAT_R16_SNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_R16_SINT] = 16;
-
-		FormatSizeTable[DXGI_FORMAT_R8_TYPELESS] = 8;
-		FormatSizeTable[DXGI_FORMAT_R8_UNORM] = 8;
-		FormatSizeTable[DXGI_FORMAT_R8_UINT] = 8;
-		FormatSizeTable[DXGI_FORMAT_R8_SNORM] = 8;
-		FormatSizeTable[DXGI_FORMAT_R8_SINT] = 8;
-		FormatSizeTable[DXGI_FORMAT_A8_UNORM] = 8;
-
-		FormatSizeTable[DXGI_FORMAT_R1_UNORM] = 1;
-
-		FormatSizeTable[DXGI_FORMAT_R9G9B9E5_SHAREDEXP] = 32;
-		FormatSizeTable[DXGI_FORMAT_R8G8_B8G8_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_G8R8_G8B8_UNORM] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_BC1_TYPELESS] = 16;
-		FormatSizeTable[DXGI_FORMAT_BC1_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_BC1_UNORM_SRGB] = 16;
-
-		FormatSizeTable[DXGI_FORMAT_BC2_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC2_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC2_UNORM_SRGB] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_BC3_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC3_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC3_UNORM_SRGB] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_BC4_TYPELESS] = 16;
-		FormatSizeTable[DXGI_FORMAT_BC4_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_BC4_SNORM] = 16;
-
-		FormatSizeTable[DXGI_FORMAT_B5G6R5_UNORM] = 16;
-		FormatSizeTable[DXGI_FORMAT_B5G5R5A1_UNORM] = 16;
-
-		FormatSizeTable[DXGI_FORMAT_B8G8R8A8_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_B8G8R8X8_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_B8G8R8A8_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_B8G8R8A8_UNORM_SRGB] = 32;
-		FormatSizeTable[DXGI_FORMAT_B8G8R8X8_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_B8G8R8X8_UNORM_SRGB] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_BC6H_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC6H_UF16] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC6H_SF16] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_BC7_TYPELESS] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC7_UNORM] = 32;
-		FormatSizeTable[DXGI_FORMAT_BC7_UNORM_SRGB] = 32;
-
-		FormatSizeTable[DXGI_FORMAT_B4G4R4A4_UNORM] = 16;
+		FormatSizeTable[Format_R32G32B32A32_TYPELESS] = 128;
+		FormatSizeTable[Format_R32G32B32A32_FLOAT] = 128;
+		FormatSizeTable[Format_R32G32B32A32_UINT] = 128;
+		FormatSizeTable[Format_R32G32B32A32_SINT] = 128;
+
+		FormatSizeTable[Format_R32G32B32_TYPELESS] = 96;
+		FormatSizeTable[Format_R32G32B32_FLOAT] = 96;
+		FormatSizeTable[Format_R32G32B32_UINT] = 96;
+		FormatSizeTable[Format_R32G32B32_SINT] = 96;
+
+		FormatSizeTable[Format_R16G16B16A16_TYPELESS] = 64;
+		FormatSizeTable[Format_R16G16B16A16_FLOAT] = 64;
+		FormatSizeTable[Format_R16G16B16A16_UNORM] = 64;
+		FormatSizeTable[Format_R16G16B16A16_UINT] = 64;
+		FormatSizeTable[Format_R16G16B16A16_SNORM] = 64;
+		FormatSizeTable[Format_R16G16B16A16_SINT] = 64;
+
+		FormatSizeTable[Format_R32G32_TYPELESS] = 64;
+		FormatSizeTable[Format_R32G32_FLOAT] = 64;
+		FormatSizeTable[Format_R32G32_UINT] = 64;
+		FormatSizeTable[Format_R32G32_SINT] = 64;
+
+		FormatSizeTable[Format_R32G8X24_TYPELESS] = 64;
+		FormatSizeTable[Format_D32_FLOAT_S8X24_UINT] = 64;
+		FormatSizeTable[Format_R32_FLOAT_X8X24_TYPELESS] = 64;
+		FormatSizeTable[Format_X32_TYPELESS_G8X24_UINT] = 64;
+
+		FormatSizeTable[Format_R10G10B10A2_TYPELESS] = 32;
+		FormatSizeTable[Format_R10G10B10A2_UNORM] = 32;
+		FormatSizeTable[Format_R10G10B10A2_UINT] = 32;
+		FormatSizeTable[Format_R11G11B10_FLOAT] = 32;
+
+		FormatSizeTable[Format_R8G8B8A8_TYPELESS] = 32;
+		FormatSizeTable[Format_R8G8B8A8_UNORM] = 32;
+		FormatSizeTable[Format_R8G8B8A8_UNORM_SRGB] = 32;
+		FormatSizeTable[Format_R8G8B8A8_UINT] = 32;
+		FormatSizeTable[Format_R8G8B8A8_SNORM] = 32;
+		FormatSizeTable[Format_R8G8B8A8_SINT] = 32;
+
+		FormatSizeTable[Format_R16G16_TYPELESS] = 32;
+		FormatSizeTable[Format_R16G16_FLOAT] = 32;
+		FormatSizeTable[Format_R16G16_UNORM] = 32;
+		FormatSizeTable[Format_R16G16_UINT] = 32;
+		FormatSizeTable[Format_R16G16_SNORM] = 32;
+		FormatSizeTable[Format_R16G16_SINT] = 32;
+
+		FormatSizeTable[Format_R32_TYPELESS] = 32;
+		FormatSizeTable[Format_D32_FLOAT] = 32;
+		FormatSizeTable[Format_R32_FLOAT] = 32;
+		FormatSizeTable[Format_R32_UINT] = 32;
+		FormatSizeTable[Format_R32_SINT] = 32;
+
+		FormatSizeTable[Format_R24G8_TYPELESS] = 32;
+		FormatSizeTable[Format_D24_UNORM_S8_UINT] = 32;
+		FormatSizeTable[Format_R24_UNORM_X8_TYPELESS] = 32;
+		FormatSizeTable[Format_X24_TYPELESS_G8_UINT] = 32;
+
+		FormatSizeTable[Format_R8G8_TYPELESS] = 16;
+		FormatSizeTable[Format_R8G8_UNORM] = 16;
+		FormatSizeTable[Format_R8G8_UINT] = 16;
+		FormatSizeTable[Format_R8G8_SNORM] = 16;
+		FormatSizeTable[Format_R8G8_SINT] = 16;
+
+		FormatSizeTable[Format_R16_TYPELESS] = 16;
+		FormatSizeTable[Format_R16_FLOAT] = 16;
+		FormatSizeTable[Format_D16_UNORM] = 16;
+		FormatSizeTable[Format_R16_UNORM] = 16;
+		FormatSizeTable[Format_R16_UINT] = 16;
+		FormatSizeTable[Format_R16_SNORM] = 16;
+		FormatSizeTable[Format_R16_SINT] = 16;
+
+		FormatSizeTable[Format_R8_TYPELESS] = 8;
+		FormatSizeTable[Format_R8_UNORM] = 8;
+		FormatSizeTable[Format_R8_UINT] = 8;
+		FormatSizeTable[Format_R8_SNORM] = 8;
+		FormatSizeTable[Format_R8_SINT] = 8;
+		FormatSizeTable[Format_A8_UNORM] = 8;
+
+		FormatSizeTable[Format_R1_UNORM] = 1;
+
+		FormatSizeTable[Format_R9G9B9E5_SHAREDEXP] = 32;
+		FormatSizeTable[Format_R8G8_B8G8_UNORM] = 32;
+		FormatSizeTable[Format_G8R8_G8B8_UNORM] = 32;
+
+		//Block formats count the bits of a 4x4 block per texel
+		FormatSizeTable[Format_BC1_TYPELESS] = 4;
+		FormatSizeTable[Format_BC1_UNORM] = 4;
+		FormatSizeTable[Format_BC1_UNORM_SRGB] = 4;
+
+		FormatSizeTable[Format_BC2_TYPELESS] = 8;
+		FormatSizeTable[Format_BC2_UNORM] = 8;
+		FormatSizeTable[Format_BC2_UNORM_SRGB] = 8;
+
+		FormatSizeTable[Format_BC3_TYPELESS] = 8;
+		FormatSizeTable[Format_BC3_UNORM] = 8;
+		FormatSizeTable[Format_BC3_UNORM_SRGB] = 8;
+
+		FormatSizeTable[Format_BC4_TYPELESS] = 4;
+		FormatSizeTable[Format_BC4_UNORM] = 4;
+		FormatSizeTable[Format_BC4_SNORM] = 4;
+
+		FormatSizeTable[Format_BC5_TYPELESS] = 8;
+		FormatSizeTable[Format_BC5_UNORM] = 8;
+		FormatSizeTable[Format_BC5_SNORM] = 8;
+
+		FormatSizeTable[Format_B5G6R5_UNORM] = 16;
+		FormatSizeTable[Format_B5G5R5A1_UNORM] = 16;
+
+		FormatSizeTable[Format_B8G8R8A8_UNORM] = 32;
+		FormatSizeTable[Format_B8G8R8X8_UNORM] = 32;
+		FormatSizeTable[Format_R10G10B10_XR_BIAS_A2_UNORM] = 32;
+		FormatSizeTable[Format_B8G8R8A8_TYPELESS] = 32;
+		FormatSizeTable[Format_B8G8R8A8_UNORM_SRGB] = 32;
+		FormatSizeTable[Format_B8G8R8X8_TYPELESS] = 32;
+		FormatSizeTable[Format_B8G8R8X8_UNORM_SRGB] = 32;
+
+		FormatSizeTable[Format_BC6H_TYPELESS] = 8;
+		FormatSizeTable[Format_BC6H_UF16] = 8;
+		FormatSizeTable[Format_BC6H_SF16] = 8;
+
+		FormatSizeTable[Format_BC7_TYPELESS] = 8;
+		FormatSizeTable[Format_BC7_UNORM] = 8;
+		FormatSizeTable[Format_BC7_UNORM_SRGB] = 8;
+
+		FormatSizeTable[Format_B4G4R4A4_UNORM] = 16;
 	}
 }
 
@@ -140,6 +148,9 @@ Resource::Resource()
 {
 	InitFormatTable();
 	ptr = NULL;
+	byteSize = 0;
+	everBound = false;
+	ZeroMemory(views, sizeof(views));
 }
 
 Resource::Resource(ResourceDesc desc, void* pData, size_t dataSize)
@@ -147,6 +158,9 @@ Resource::Resource(ResourceDesc desc, void* pData, size_t dataSize)
 	InitFormatTable();
 	this->desc = desc;
 	ptr = NULL;
+	byteSize = 0;
+	everBound = false;
+	ZeroMemory(views, sizeof(views));
 	if (desc.type == Resource_Buffer) 
 	{
 		if (!CreateBuffer(pData, dataSize)) return;
@@ -170,7 +184,7 @@ void Resource:: Release()
 	ClearViews();
 	if (ptr) 
 	{
-		ptr->Release();
+		PipeLine::device->Release(ptr);
 		ptr = NULL;
 	}
 }
@@ -178,111 +192,103 @@ void Resource:: Release()
 Resource::~Resource() 
 {
 	Release();
+	//Released with the device's back buffer, the next engine asks the new device for it
+	if (this == pBackBuffer)
+		pBackBuffer = NULL;
 }
 
 void Resource::ClearViews()
 {
-	unordered_map<D3D11_BIND_FLAG, IUnknown*>::iterator it = viewPool.begin();
-	while (it != viewPool.end())
+	for (int kind = 0; kind < View_Kind_Count; kind++)
 	{
-		if (it->first == D3D11_BIND_SHADER_RESOURCE ||
-			it->first == D3D11_BIND_UNORDERED_ACCESS ||
-			it->first == D3D11_BIND_RENDER_TARGET ||
-			it->first == D3D11_BIND_DEPTH_STENCIL
+		//Buffer kinds point at the resource itself
+		if (views[kind] && (kind == View_Shader_Resource ||
+			kind == View_Unordered_Access ||
+			kind == View_Render_Target ||
+			kind == View_Depth_Stencil)
 			)
 		{
-			it->second->Release();
+			PipeLine::device->Release(views[kind]);
 		}
-		it->second = NULL;
-		it++;
+		views[kind] = NULL;
 	}
-	viewPool.clear();
 }
 
 bool Resource::GenerateViews()
 {
-	HRESULT hr;
 	//Views
-	if (desc.bindFlag&D3D11_BIND_UNORDERED_ACCESS)
+	if (desc.bindFlag&Bind_Unordered_Access)
 	{
-		ID3D11UnorderedAccessView* uav = NULL;
-		hr = PipeLine::pDevice->CreateUnorderedAccessView(ptr, NULL, &uav);
-		if (FAILED(hr))
+		views[View_Unordered_Access] = PipeLine::device->CreateUnorderedAccessView(ptr);
+		if (!views[View_Unordered_Access])
 		{
 			ClearViews();
 			return false;
 		}
-		viewPool[D3D11_BIND_UNORDERED_ACCESS] = uav;
 	}
-	if (desc.bindFlag&D3D11_BIND_SHADER_RESOURCE)
+	if (desc.bindFlag&Bind_Shader_Resource)
 	{
-		ID3D11ShaderResourceView* srv = NULL;
-		hr = PipeLine::pDevice->CreateShaderResourceView(ptr, NULL, &srv);
-		if (FAILED(hr))
+		views[View_Shader_Resource] = PipeLine::device->CreateShaderResourceView(ptr);
+		if (!views[View_Shader_Resource])
 		{
 			ClearViews();
 			return false;
 		}
-		viewPool[D3D11_BIND_SHADER_RESOURCE] = srv;
 	}
-	if (desc.bindFlag&D3D11_BIND_RENDER_TARGET)
+	if (desc.bindFlag&Bind_Render_Target)
 	{
-		ID3D11RenderTargetView* rtv;
-		hr = PipeLine::pDevice->CreateRenderTargetView(ptr, NULL, &rtv);
-		if (FAILED(hr))
+		views[View_Render_Target] = PipeLine::device->CreateRenderTargetView(ptr);
+		if (!views[View_Render_Target])
 		{
 			ClearViews();
 			return false;
 		}
-		viewPool[D3D11_BIND_RENDER_TARGET] = rtv;
 	}
-	if (desc.bindFlag&D3D11_BIND_DEPTH_STENCIL)
+	if (desc.bindFlag&Bind_Depth_Stencil)
 	{
-		ID3D11DepthStencilView* dsv = NULL;
-		hr = PipeLine::pDevice->CreateDepthStencilView(ptr, NULL, &dsv);
-		if (FAILED(hr))
+		views[View_Depth_Stencil] = PipeLine::device->CreateDepthStencilView(ptr);
+		if (!views[View_Depth_Stencil])
 		{
 			ClearViews();
 			return false;
 		}
-		viewPool[D3D11_BIND_DEPTH_STENCIL] = dsv;
 	}
 	//Buffers
-	if (desc.bindFlag&D3D11_BIND_CONSTANT_BUFFER)
+	if (desc.bindFlag&Bind_Constant_Buffer)
 	{
-		viewPool[D3D11_BIND_CONSTANT_BUFFER] = ptr;
+		views[View_Constant_Buffer] = ptr;
 	}
-	if (desc.bindFlag&D3D11_BIND_INDEX_BUFFER)
+	if (desc.bindFlag&Bind_Index_Buffer)
 	{
-		viewPool[D3D11_BIND_INDEX_BUFFER] = ptr;
+		views[View_Index_Buffer] = ptr;
 	}
-	if (desc.bindFlag&D3D11_BIND_VERTEX_BUFFER)
+	if (desc.bindFlag&Bind_Vertex_Buffer)
 	{
-		viewPool[D3D11_BIND_VERTEX_BUFFER] = ptr;
+		views[View_Vertex_Buffer] = ptr;
 	}
-	if (desc.bindFlag&D3D11_BIND_STREAM_OUTPUT)
+	if (desc.bindFlag&Bind_Stream_Out)
 	{
-		viewPool[D3D11_BIND_STREAM_OUTPUT] = ptr;
+		views[View_Stream_Out] = ptr;
 	}
 	return true;
 }
 
 bool Resource::ResetData(const UINT value[4]) 
 {
-	if (viewPool.count(D3D11_BIND_UNORDERED_ACCESS))
+	if (views[View_Unordered_Access])
 	{
-		PipeLine::pContext->ClearUnorderedAccessViewUint((ID3D11UnorderedAccessView*)viewPool[D3D11_BIND_UNORDERED_ACCESS], value);
+		PipeLine::device->ClearUnorderedAccessViewUint((DeviceUnorderedAccessView*)views[View_Unordered_Access], value);
 	}
-	else if (viewPool.count(D3D11_BIND_RENDER_TARGET))
+	else if (views[View_Render_Target])
 	{
-		ID3D11RenderTargetView* rtv = (ID3D11RenderTargetView*)viewPool[D3D11_BIND_RENDER_TARGET];
-		PipeLine::pContext->ClearRenderTargetView(rtv, (float*)value);
+		DeviceRenderTargetView* rtv = (DeviceRenderTargetView*)views[View_Render_Target];
+		PipeLine::device->ClearRenderTargetView(rtv, (float*)value);
 	}
-	else 	if (viewPool.count(D3D11_BIND_DEPTH_STENCIL))
+	else 	if (views[View_Depth_Stencil])
 	{
-		ID3D11DepthStencilView* dsv = (ID3D11DepthStencilView*)viewPool[D3D11_BIND_DEPTH_STENCIL];
+		DeviceDepthStencilView* dsv = (DeviceDepthStencilView*)views[View_Depth_Stencil];
 		float a = *((float*)&value[1]);
-		PipeLine::pContext->ClearDepthStencilView(dsv, value[0], a, 0);
+		PipeLine::device->ClearDepthStencilView(dsv, value[0], a, 0);
 	}
 	else 
 	{
@@ -293,44 +299,155 @@ bool Resource::ResetData(const UINT value[4])
 
 bool Resource::UpdateData(const void * pData, size_t size)
 {
-	UINT rowPitch = 0;
-	if(desc.type==Resource_Texture2D)
-		rowPitch = desc.size[1]*(FormatSizeTable[desc.format] / 8);
-	if (rowPitch < 0)
+	//Pitches of the top mip, tightly packed rows
+	UINT rowPitch = 0, depthPitch = 0;
+	if (desc.type == Resource_Texture2D || desc.type == Resource_Texture3D)
+	{
+		rowPitch = RowPitch(desc.format, desc.size[0]);
+		depthPitch = rowPitch * RowCount(desc.format, desc.size[1]);
+	}
+	if (desc.access == Access_Dynamic)
+	{
+		MappedSubresource mappedResource;
+		if (!PipeLine::device->Map(ptr, 0, Map_Write_Discard, mappedResource))
+		{
+			return false;
+		}
+		memcpy(mappedResource.data, pData, size);
+		PipeLine::device->Unmap(ptr, 0);
+	}
+	else if (desc.access == Access_Default)
+	{
+		if (desc.type == Resource_Buffer)
+		{
+			//Only the bytes given are sent, not the whole buffer. Constant buffers can't take a box
+			if (size > desc.size[0])
+				return false;
+			Box box1D;
+			box1D.left = 0;
+			box1D.right = size;
+			box1D.top = 0;
+			box1D.bottom = 1;
+			box1D.front = 0;
+			box1D.back = 1;
+			bool whole = (desc.bindFlag & Bind_Constant_Buffer) || size == desc.size[0];
+			PipeLine::device->UpdateSubresource(ptr, 0, whole ? NULL : &box1D, pData, 0, 0);
+		}
+		else
+		{
+			PipeLine::device->UpdateSubresource(ptr, 0, NULL, pData, rowPitch, depthPitch);
+		}
+	}
+	return true;
+}
+
+bool Resource::UpdateData(const void * pData, size_t size, size_t offset, bool discard)
+{
+	//Partial writes are only supported for buffers
+	if (desc.type != Resource_Buffer || offset + size > desc.size[0])
 		return false;
 	if (desc.access == Access_Dynamic)
 	{
-		HRESULT result;
-		D3D11_MAPPED_SUBRESOURCE mappedResource;
-		result = PipeLine::pContext->Map(ptr, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-		if (FAILED(result))
+		//NO_OVERWRITE promises the range is not used by queued draws, the caller tracks that (see RingAllocator)
+		MappedSubresource mappedResource;
+		if (!PipeLine::device->Map(ptr, 0, discard ? Map_Write_Discard : Map_Write_No_Overwrite, mappedResource))
 		{
 			return false;
 		}
-		memcpy(mappedResource.pData, pData, size);
-		PipeLine::pContext->Unmap(ptr, 0);
+		memcpy((BYTE*)mappedResource.data + offset, pData, size);
+		PipeLine::device->Unmap(ptr, 0);
 	}
 	else if (desc.access == Access_Default)
 	{
-		static D3D11_BOX box1D;
-		box1D.left = 0;
-		box1D.right = 0;
+		//Boxes on constant buffers need the 11.1 runtime, below it they are written whole
+		if ((desc.bindFlag & Bind_Constant_Buffer) && (offset || size != desc.size[0]) && !PipeLine::device->GetCaps().constantBufferBoxes)
+			return false;
+		Box box1D;
+		box1D.left = offset;
+		box1D.right = offset + size;
 		box1D.top = 0;
 		box1D.bottom = 1;
 		box1D.front = 0;
 		box1D.back = 1;
-		box1D.right = size;
-		PipeLine::pContext->UpdateSubresource(ptr, 0, NULL, pData, rowPitch, 0);
+		PipeLine::device->UpdateSubresource(ptr, 0, &box1D, pData, 0, 0);
+	}
+	else
+	{
+		return false;
 	}
 	return true;
 }
 
+size_t Resource::ByteSize(const ResourceDesc & desc)
+{
+	if (desc.type == Resource_Buffer)
+		return desc.size[0];
+	InitFormatTable();
+	auto format = FormatSizeTable.find(desc.format);
+	if (format == FormatSizeTable.end())
+		return 0;
+	size_t width = max(desc.size[0], 1u), height = max(desc.size[1], 1u);
+	size_t depth = desc.type == Resource_Texture3D ? max(desc.size[2], 1u) : 1;
+	//0 mip levels means the full chain
+	UINT mipLevels = desc.mipLevel;
+	if (!mipLevels)
+	{
+		size_t largest = max(width, max(height, depth));
+		while (largest >> mipLevels) mipLevels++;
+	}
+	//Block formats store whole 4x4 blocks, down to the 1x1 mip
+	size_t align = IsBlockCompressed(desc.format) ? 4 : 1;
+	size_t texels = 0;
+	for (UINT i = 0; i < mipLevels; i++)
+	{
+		size_t w = (max(width >> i, (size_t)1) + align - 1) / align * align;
+		size_t h = (max(height >> i, (size_t)1) + align - 1) / align * align;
+		texels += w * h * max(depth >> i, (size_t)1);
+	}
+	return texels * format->second / 8 * max(desc.sampleCount, 1u);
+}
+
+bool Resource::IsBlockCompressed(Format format)
+{
+	switch (format)
+	{
+	case Format_BC1_TYPELESS: case Format_BC1_UNORM: case Format_BC1_UNORM_SRGB:
+	case Format_BC2_TYPELESS: case Format_BC2_UNORM: case Format_BC2_UNORM_SRGB:
+	case Format_BC3_TYPELESS: case Format_BC3_UNORM: case Format_BC3_UNORM_SRGB:
+	case Format_BC4_TYPELESS: case Format_BC4_UNORM: case Format_BC4_SNORM:
+	case Format_BC5_TYPELESS: case Format_BC5_UNORM: case Format_BC5_SNORM:
+	case Format_BC6H_TYPELESS: case Format_BC6H_UF16: case Format_BC6H_SF16:
+	case Format_BC7_TYPELESS: case Format_BC7_UNORM: case Format_BC7_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+UINT Resource::RowPitch(Format format, UINT width)
+{
+	InitFormatTable();
+	auto bits = FormatSizeTable.find(format);
+	if (bits == FormatSizeTable.end())
+		return 0;
+	width = max(width, 1u);
+	if (IsBlockCompressed(format))
+		return (width + 3) / 4 * 4 * 4 * bits->second / 8;
+	return width * bits->second / 8;
+}
+
+UINT Resource::RowCount(Format format, UINT height)
+{
+	height = max(height, 1u);
+	return IsBlockCompressed(format) ? (height + 3) / 4 : height;
+}
+
 bool Resource::GenerateMips()
 {
 	if (desc.mipLevel != 1 && (desc.bindFlag&Bind_Shader_Resource)&&(desc.bindFlag&Bind_Render_Target))
 	{
-		ID3D11ShaderResourceView* srv = (ID3D11ShaderResourceView*)viewPool[D3D11_BIND_SHADER_RESOURCE];
-		PipeLine::pContext->GenerateMips(srv);
+		DeviceShaderResourceView* srv = (DeviceShaderResourceView*)views[View_Shader_Resource];
+		PipeLine::device->GenerateMips(srv);
 		return true;
 	}
 	return false;
@@ -346,52 +463,32 @@ bool Resource::CreateBuffer(void* pData, size_t dataSize)
 	//----------------------Create description--------------------------
 	desc.mipLevel = 1;
 	desc.size[1] = desc.size[2] = 0;
-	D3D11_BUFFER_DESC bufDesc;
+	BufferDesc bufDesc;
 	ZeroMemory(&bufDesc, sizeof(bufDesc));
-	bufDesc.BindFlags = desc.bindFlag;
-	bufDesc.ByteWidth = desc.size[0];
-	if (desc.access == Access_Dynamic)
-	{
-		bufDesc.Usage = D3D11_USAGE_DYNAMIC;
-		bufDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	}
-	else if (desc.access == Access_Staging)
-	{
-		bufDesc.Usage = D3D11_USAGE_STAGING;
-		bufDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-	}
-	else if (desc.access == Access_Immutable)
-	{
-		bufDesc.Usage = D3D11_USAGE_IMMUTABLE;
-		bufDesc.CPUAccessFlags = 0;
-	}
-	else
-	{
-		bufDesc.Usage = D3D11_USAGE_DEFAULT;
-		bufDesc.CPUAccessFlags = 0;
-	}
+	bufDesc.bindFlags = desc.bindFlag;
+	bufDesc.byteWidth = desc.size[0];
+	bufDesc.access = desc.access;
 	if (desc.elementStride != 0 && !(desc.bindFlag & Bind_Vertex_Buffer) && !(desc.bindFlag & Bind_Index_Buffer))
 	{
-		bufDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
-		bufDesc.StructureByteStride = desc.elementStride;
+		bufDesc.miscFlags = Misc_Buffer_Structured;
+		bufDesc.structureByteStride = desc.elementStride;
 
 	}
 	//------------------------------Create Resource-----------------------
-	HRESULT hr;
-	ID3D11Buffer* buffer;
+	DeviceBuffer* buffer;
 	if (pData&&dataSize)
 	{
-		D3D11_SUBRESOURCE_DATA sbData;
-		sbData.pSysMem = pData;
-		sbData.SysMemPitch = dataSize;
-		sbData.SysMemSlicePitch = dataSize;//No need
-		hr = PipeLine::pDevice->CreateBuffer(&bufDesc, &sbData, &buffer);
+		SubresourceData sbData;
+		sbData.data = pData;
+		sbData.rowPitch = dataSize;
+		sbData.depthPitch = dataSize;//No need
+		buffer = PipeLine::device->CreateBuffer(bufDesc, &sbData);
 	}
 	else
 	{
-		hr = PipeLine::pDevice->CreateBuffer(&bufDesc, NULL, &buffer);
+		buffer = PipeLine::device->CreateBuffer(bufDesc, NULL);
 	}
-	if (FAILED(hr)) return false;
+	if (!buffer) return false;
 
 	ptr = buffer;
 	return true;
@@ -400,109 +497,93 @@ bool Resource::CreateBuffer(void* pData, size_t dataSize)
 bool Resource::CreateTexture2D(void * pData, size_t dataSize)
 {
 	if (ptr)  Release();
-	D3D11_TEXTURE2D_DESC texDesc;
+	TextureDesc texDesc;
 	ZeroMemory(&texDesc, sizeof(texDesc));
-	texDesc.MipLevels = desc.mipLevel;
-	texDesc.ArraySize = 1;
-	texDesc.Format = desc.format;
-	texDesc.SampleDesc.Count = desc.sampleCount;
-	texDesc.SampleDesc.Quality = desc.sampleQuality;
-	texDesc.Width = desc.size[0];
-	texDesc.Height = desc.size[1];
-	texDesc.BindFlags = desc.bindFlag;
-
-	if (desc.mipLevel!=1)
+	texDesc.type = Resource_Texture2D;
+	texDesc.mipLevels = desc.mipLevel;
+	texDesc.arraySize = 1;
+	texDesc.depth = 1;
+	texDesc.format = desc.format;
+	texDesc.sampleCount = desc.sampleCount;
+	texDesc.sampleQuality = desc.sampleQuality;
+	texDesc.width = desc.size[0];
+	texDesc.height = desc.size[1];
+	texDesc.bindFlags = desc.bindFlag;
+
+	//GenerateMips needs both views, block formats can't be render targets and bring their mips
+	if (desc.mipLevel != 1 && (desc.bindFlag&Bind_Shader_Resource) && (desc.bindFlag&Bind_Render_Target))
 	{
-		texDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		texDesc.miscFlags = Misc_Generate_Mips;
 	}
 
-	if (desc.access == Access_Dynamic)
-	{
-		texDesc.Usage = D3D11_USAGE_DYNAMIC;
-		texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	}
-	else if (desc.access == Access_Staging)
-	{
-		texDesc.Usage = D3D11_USAGE_STAGING;
-		texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-	}
-	//else if (desc.access == Immutable)
-	//{
-	//	texDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	//	texDesc.CPUAccessFlags = 0;
-	//}
-	else
+	//Immutable textures are created as default ones
+	texDesc.access = desc.access == Access_Immutable ? Access_Default : desc.access;
+	
+	if (!RowPitch(texDesc.format, texDesc.width)) return false;
+	DeviceTexture* texture;
+	//pData covering the whole desc is every mip one after the other, tightly packed.
+	//Otherwise it is the top level, the rest is left to GenerateMips
+	if (pData && desc.mipLevel > 1 && dataSize == ByteSize(desc))
 	{
-		texDesc.Usage = D3D11_USAGE_DEFAULT;
-		texDesc.CPUAccessFlags = 0;
+		vector<SubresourceData> mips(desc.mipLevel);
+		const BYTE* mip = (const BYTE*)pData;
+		for (UINT i = 0; i < desc.mipLevel; i++)
+		{
+			UINT width = max(texDesc.width >> i, 1u), height = max(texDesc.height >> i, 1u);
+			mips[i].data = mip;
+			mips[i].rowPitch = RowPitch(texDesc.format, width);
+			mips[i].depthPitch = 0;
+			mip += (size_t)mips[i].rowPitch * RowCount(texDesc.format, height);
+		}
+		texture = PipeLine::device->CreateTexture(texDesc, &mips[0]);
+		if (!texture) return false;
+		ptr = texture;
+		return true;
 	}
-	
-	UINT pixelByte = FormatSizeTable[texDesc.Format] / 8;
-	if (pixelByte <= 0) return false;
-	HRESULT hr;
-	ID3D11Texture2D* Texture;
-	hr = PipeLine::pDevice->CreateTexture2D(&texDesc, NULL, &Texture);
-	if (FAILED(hr)) return false;
+
+	texture = PipeLine::device->CreateTexture(texDesc, NULL);
+	if (!texture) return false;
 
 	if (pData)
 	{
-		PipeLine::pContext->UpdateSubresource(Texture, 0, NULL, pData, texDesc.Width* pixelByte, 0);
+		PipeLine::device->UpdateSubresource(texture, 0, NULL, pData, RowPitch(texDesc.format, texDesc.width), 0);
 		
 	}
-	ptr = Texture;
+	ptr = texture;
 	return true;
 }
 
 bool Resource::CreateTexture3D(void * pData, size_t dataSize)
 {
 	if (ptr)  Release();
-	D3D11_TEXTURE3D_DESC texDesc;
+	TextureDesc texDesc;
 	ZeroMemory(&texDesc, sizeof(texDesc));
-	texDesc.MipLevels = 0;
-	texDesc.Format = desc.format;
-	texDesc.Height = desc.size[0];
-	texDesc.Width = desc.size[1];
-	texDesc.Depth = desc.size[2];
-	texDesc.BindFlags = desc.bindFlag;
+	texDesc.type = Resource_Texture3D;
+	texDesc.mipLevels = 0;
+	texDesc.arraySize = 1;
+	texDesc.sampleCount = 1;
+	texDesc.format = desc.format;
+	texDesc.height = desc.size[0];
+	texDesc.width = desc.size[1];
+	texDesc.depth = desc.size[2];
+	texDesc.bindFlags = desc.bindFlag;
 
 	if (desc.mipLevel != 1)
 	{
-		texDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+		texDesc.miscFlags = Misc_Generate_Mips;
 	}
 
-	if (desc.access == Access_Dynamic)
-	{
-		texDesc.Usage = D3D11_USAGE_DYNAMIC;
-		texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-	}
-	else if (desc.access == Access_Staging)
-	{
-		texDesc.Usage = D3D11_USAGE_STAGING;
-		texDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-	}
-	//else if (desc.access == Immutable)
-	//{
-	//	texDesc.Usage = D3D11_USAGE_IMMUTABLE;
-	//	texDesc.CPUAccessFlags = 0;
-	//}
-	else
-	{
-		texDesc.Usage = D3D11_USAGE_DEFAULT;
-		texDesc.CPUAccessFlags = 0;
-	}
+	texDesc.access = desc.access == Access_Immutable ? Access_Default : desc.access;
 
-	UINT pixelByte = FormatSizeTable[texDesc.Format] / 8;
-	if (pixelByte <= 0) return false;
-	HRESULT hr;
-	ID3D11Texture3D* texture;
-	hr = PipeLine::pDevice->CreateTexture3D(&texDesc, NULL, &texture);
-	if (FAILED(hr)) return false;
+	UINT rowpitch = RowPitch(texDesc.format, texDesc.width);
+	if (!rowpitch) return false;
+	DeviceTexture* texture = PipeLine::device->CreateTexture(texDesc, NULL);
+	if (!texture) return false;
 
 	if (pData)
 	{
-		UINT rowpitch = texDesc.Width* pixelByte;
-		UINT depthpitch = rowpitch*texDesc.Height;
-		PipeLine::pContext->UpdateSubresource(texture, 0, NULL, pData, rowpitch, depthpitch);
+		UINT depthpitch = rowpitch*RowCount(texDesc.format, texDesc.height);
+		PipeLine::device->UpdateSubresource(texture, 0, NULL, pData, rowpitch, depthpitch);
 	}
 	ptr = texture;
 	return true;
@@ -518,53 +599,16 @@ Resource * Resource::Create(ResourceDesc desc, void * pData, size_t dataSize)
 	return r;
 }
 
-ResourceDesc Resource::GetDesc(ID3D11Resource * pD3DResource)
+ResourceDesc Resource::GetDesc(const TextureDesc & textureDesc)
 {
 	ResourceDesc desc;
-	D3D11_RESOURCE_DIMENSION type;
-	pD3DResource->GetType(&type);
-	bool hasUAV = false, hasSRV = false;
-	if (type == D3D11_RESOURCE_DIMENSION_BUFFER)
-	{
-		desc.type = Resource_Buffer;
-		D3D11_BUFFER_DESC bufferDesc;
-		ZeroMemory(&bufferDesc, sizeof(bufferDesc));
-		ID3D11Buffer * pBuffer = (ID3D11Buffer *)pD3DResource;
-		pBuffer->GetDesc(&bufferDesc);
-		desc.bindFlag = bufferDesc.BindFlags;
-		desc.access = (AccessType)bufferDesc.Usage;
-		desc.size[0] = bufferDesc.ByteWidth;
-		desc.elementStride = bufferDesc.StructureByteStride;
-	}
-	else if (type == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
-	{
-		desc.type = Resource_Texture2D;
-		D3D11_TEXTURE2D_DESC textureDesc;
-		ZeroMemory(&textureDesc, sizeof(textureDesc));
-		ID3D11Texture2D* pTexture = (ID3D11Texture2D*)pD3DResource;
-		pTexture->GetDesc(&textureDesc);
-		desc.bindFlag = textureDesc.BindFlags;
-		desc.access = (AccessType)textureDesc.Usage;
-		desc.size[0] = textureDesc.Width;
-		desc.size[1] = textureDesc.Height;
-		desc.format = textureDesc.Format;
-		desc.mipLevel = textureDesc.MipLevels;
-	}
-	else if (type == D3D11_RESOURCE_DIMENSION_TEXTURE3D)
-	{
-		desc.type = Resource_Texture3D;
-		D3D11_TEXTURE3D_DESC textureDesc;
-		ZeroMemory(&textureDesc, sizeof(textureDesc));
-		ID3D11Texture3D* pTexture = (ID3D11Texture3D*)pD3DResource;
-		pTexture->GetDesc(&textureDesc);
-		desc.bindFlag = textureDesc.BindFlags;
-		desc.access = (AccessType)textureDesc.Usage;
-		desc.size[0] = textureDesc.Width;
-		desc.size[1] = textureDesc.Height;
-		desc.size[2] = textureDesc.Depth;
-		desc.format = textureDesc.Format;
-		desc.mipLevel = textureDesc.MipLevels;
-	}
+	desc.type = Resource_Texture2D;
+	desc.bindFlag = textureDesc.bindFlags;
+	desc.access = textureDesc.access;
+	desc.size[0] = textureDesc.width;
+	desc.size[1] = textureDesc.height;
+	desc.format = textureDesc.format;
+	desc.mipLevel = textureDesc.mipLevels;
 	return desc;
 }
 
@@ -572,9 +616,11 @@ Resource * Resource::GetBackBuffer()
 {
 	if (pBackBuffer) return pBackBuffer;
 	pBackBuffer = new Resource();
-	HRESULT hr = PipeLine::pSwapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&(pBackBuffer->ptr));
-	if (FAILED(hr)) return NULL;
-	pBackBuffer->desc = GetDesc(pBackBuffer->ptr);
+	TextureDesc textureDesc;
+	DeviceTexture* texture = PipeLine::device->GetBackBuffer(textureDesc);
+	if (!texture) return NULL;
+	pBackBuffer->ptr = texture;
+	pBackBuffer->desc = GetDesc(textureDesc);
 	if (!pBackBuffer->GenerateViews()) {
 		delete pBackBuffer;
 		pBackBuffer = NULL;
@@ -584,68 +630,134 @@ Resource * Resource::GetBackBuffer()
 }
 
 
+int ViewKindOf(BindFlag bindFlag)
+{
+	switch (bindFlag)
+	{
+	case Bind_Vertex_Buffer: return View_Vertex_Buffer;
+	case Bind_Constant_Buffer: return View_Constant_Buffer;
+	case Bind_Shader_Resource: return View_Shader_Resource;
+	case Bind_Index_Buffer: return View_Index_Buffer;
+	case Bind_Stream_Out: return View_Stream_Out;
+	case Bind_Render_Target: return View_Render_Target;
+	case Bind_Depth_Stencil: return View_Depth_Stencil;
+	case Bind_Unordered_Access: return View_Unordered_Access;
+	default: return -1;
+	}
+}
+
+static const BindFlag bindFlagOfKind[View_Kind_Count] =
+{
+	Bind_Vertex_Buffer,
+	Bind_Constant_Buffer,
+	Bind_Shader_Resource,
+	Bind_Index_Buffer,
+	Bind_Stream_Out,
+	Bind_Render_Target,
+	Bind_Depth_Stencil,
+	Bind_Unordered_Access
+};
+
+static const UINT shaderStages = Stage_Vertex_Shader | Stage_Hull_Shader | Stage_Domain_Shader | Stage_Geometry_Shader | Stage_Pixel_Shader | Stage_Compute_Shader;
+
 ResourceManager::ResourceManager()
 {
 	currentDSV = NULL;
 	backBufferID = INVALID;
+	memoryBudget = 0;
+	memoryTotal = 0;
+	retiredBytes = 0;
+	//A context starts with nothing bound
+	int* entry = &shadow[0][0][0];
+	fill(entry, entry + View_Kind_Count * numShadowStages * MAX_SLOT_NUMBER, (int)INVALID);
+	entry = &pending[0][0][0];
+	fill(entry, entry + numDeferredKinds * numShadowStages * MAX_SLOT_NUMBER, (int)INVALID);
+	ZeroMemory(dirty, sizeof(dirty));
 }
 
 ResourceManager::~ResourceManager() {}
 
 void ResourceManager::Release(Resource *& element)
 {
+	memoryTotal -= element->byteSize;
+	auto owner = memoryByOwner.find(element->owner);
+	if (owner != memoryByOwner.end() && (owner->second -= element->byteSize) == 0)
+		memoryByOwner.erase(owner);
 	delete element;
 	element = NULL;
 }
 
-void ResourceManager::Bind(UINT stages, D3D11_BIND_FLAG bindFlag, UINT startSlot, UINT numViews, void ** ptr, UINT elementStride, UINT offset)
+int ResourceManager::Insert(Resource * r)
 {
-	if (bindFlag == D3D11_BIND_VERTEX_BUFFER)
+	int id = IDContainer::Insert(r);
+	if (id == INVALID)
 	{
-		ID3D11Buffer** buffer = (ID3D11Buffer**)ptr;
-		PipeLine::pContext->IASetVertexBuffers(startSlot, numViews, buffer, &elementStride, &offset);
+		delete r;
+		return INVALID;
 	}
-	else if (bindFlag == D3D11_BIND_INDEX_BUFFER)
+	r->owner = memoryOwner;
+	r->byteSize = Resource::ByteSize(r->desc);
+	memoryTotal += r->byteSize;
+	memoryByOwner[r->owner] += r->byteSize;
+	if (memoryBudget && memoryTotal > memoryBudget)
 	{
-		ID3D11Buffer** buffer = (ID3D11Buffer**)ptr;
-		PipeLine::pContext->IASetIndexBuffer(*buffer, DXGI_FORMAT_R32_UINT, offset);
+		char log[512];
+		sprintf_s(log, "ResourceManager: %s (%s, %s) takes %zu bytes, %zu in use exceed the budget of %zu\n",
+			r->desc.name.c_str(), r->owner.c_str(), MemoryCategoryName(GetMemoryCategory(r->desc)), r->byteSize, memoryTotal, memoryBudget);
+		OutputDebugStringA(log);
 	}
-	else if (bindFlag == D3D11_BIND_STREAM_OUTPUT)
+	return id;
+}
+
+void ResourceManager::Bind(UINT stages, BindFlag bindFlag, UINT startSlot, UINT numViews, DeviceObject ** ptr, const UINT* strides)
+{
+	static const UINT offsets[MAX_SLOT_NUMBER] = { 0 };
+	if (bindFlag == Bind_Vertex_Buffer)
 	{
-		ID3D11Buffer** buffer = (ID3D11Buffer**)ptr;
-		PipeLine::pContext->SOSetTargets(numViews, buffer, &offset);
+		DeviceBuffer** buffer = (DeviceBuffer**)ptr;
+		PipeLine::device->SetVertexBuffers(startSlot, numViews, buffer, strides, offsets);
 	}
-	else if (bindFlag == D3D11_BIND_UNORDERED_ACCESS)
+	else if (bindFlag == Bind_Index_Buffer)
 	{
-		ID3D11UnorderedAccessView** uav = (ID3D11UnorderedAccessView**)ptr;
+		DeviceBuffer** buffer = (DeviceBuffer**)ptr;
+		PipeLine::device->SetIndexBuffer(*buffer, Format_R32_UINT, 0);
+	}
+	else if (bindFlag == Bind_Stream_Out)
+	{
+		DeviceBuffer** buffer = (DeviceBuffer**)ptr;
+		PipeLine::device->SetStreamOutTargets(numViews, buffer, offsets);
+	}
+	else if (bindFlag == Bind_Unordered_Access)
+	{
+		DeviceUnorderedAccessView** uav = (DeviceUnorderedAccessView**)ptr;
 		if (stages & Stage_Compute_Shader)
 		{
-			PipeLine::pContext->CSSetUnorderedAccessViews(startSlot, numViews, uav, NULL);
+			PipeLine::device->SetComputeUnorderedAccessViews(startSlot, numViews, uav);
 		}
 		if (stages&Stage_Output_Merge)
 		{
-			PipeLine::pContext->OMSetRenderTargetsAndUnorderedAccessViews(D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL, NULL, NULL, startSlot, numViews, uav, NULL);
+			PipeLine::device->SetOutputs(KEEP_BOUND_OUTPUTS, NULL, NULL, startSlot, numViews, uav);
 		}
 	}
-	else if (bindFlag == D3D11_BIND_DEPTH_STENCIL)
+	else if (bindFlag == Bind_Depth_Stencil)
 	{
-		ID3D11DepthStencilView** dsv = (ID3D11DepthStencilView**)ptr;
+		DeviceDepthStencilView** dsv = (DeviceDepthStencilView**)ptr;
 
 		//Keep render targets unchanged
-		ID3D11RenderTargetView **rtvptr = NULL;
+		DeviceRenderTargetView **rtvptr = NULL;
 		if (currentRTVs.size())
 		{
 			rtvptr = &currentRTVs[0];
 		}
 		//Record new DSV
 		currentDSV = *dsv;
-		PipeLine::pContext->OMSetRenderTargetsAndUnorderedAccessViews(currentRTVs.size(), rtvptr, *dsv, 4, D3D11_KEEP_UNORDERED_ACCESS_VIEWS, NULL, NULL);
+		PipeLine::device->SetOutputs(currentRTVs.size(), rtvptr, *dsv, 4, KEEP_BOUND_OUTPUTS, NULL);
 	}
-	else if (bindFlag == D3D11_BIND_RENDER_TARGET)
+	else if (bindFlag == Bind_Render_Target)
 	{
 		numViews = numViews > 8 ? 8 : numViews;
-		ID3D11DepthStencilView* dsv = NULL;
-		ID3D11RenderTargetView** rtv = (ID3D11RenderTargetView**)ptr;
+		DeviceDepthStencilView* dsv = NULL;
+		DeviceRenderTargetView** rtv = (DeviceRenderTargetView**)ptr;
 		//Keep current DSV
 		if (currentDSV)
 		{
@@ -657,141 +769,469 @@ void ResourceManager::Bind(UINT stages, D3D11_BIND_FLAG bindFlag, UINT startSlot
 		{
 			currentRTVs.push_back(rtv[i]);
 		}
-		PipeLine::pContext->OMSetRenderTargetsAndUnorderedAccessViews(numViews, rtv, dsv, 4, D3D11_KEEP_UNORDERED_ACCESS_VIEWS, NULL, NULL);
+		PipeLine::device->SetOutputs(numViews, rtv, dsv, 4, KEEP_BOUND_OUTPUTS, NULL);
 	}
-	else if (bindFlag == D3D11_BIND_CONSTANT_BUFFER)
+	else if (bindFlag == Bind_Constant_Buffer)
 	{
-		ID3D11Buffer** buffer = (ID3D11Buffer**)ptr;
-		if (stages & Stage_Vertex_Shader)
-		{
-			PipeLine::pContext->VSSetConstantBuffers(startSlot, numViews, buffer);
-		}
-		if (stages & Stage_Hull_Shader)
-		{
-			PipeLine::pContext->HSSetConstantBuffers(startSlot, numViews, buffer);
-		}
-		if (stages & Stage_Domain_Shader)
-		{
-			PipeLine::pContext->DSSetConstantBuffers(startSlot, numViews, buffer);
-		}
-		if (stages & Stage_Geometry_Shader)
+		DeviceBuffer** buffer = (DeviceBuffer**)ptr;
+		for (UINT bit = Stage_Vertex_Shader; bit <= Stage_Compute_Shader; bit <<= 1)
 		{
-			PipeLine::pContext->GSSetConstantBuffers(startSlot, numViews, buffer);
-		}
-		if (stages & Stage_Pixel_Shader)
-		{
-			PipeLine::pContext->PSSetConstantBuffers(startSlot, numViews, buffer);
-		}
-		if (stages & Stage_Compute_Shader)
-		{
-			PipeLine::pContext->CSSetConstantBuffers(startSlot, numViews, buffer);
+			if (stages & bit & shaderStages)
+				PipeLine::device->SetConstantBuffers(bit, startSlot, numViews, buffer);
 		}
 	}
-	else if (bindFlag == D3D11_BIND_SHADER_RESOURCE)
+	else if (bindFlag == Bind_Shader_Resource)
 	{
-		ID3D11ShaderResourceView** srv = (ID3D11ShaderResourceView**)ptr;
-		if (stages & Stage_Vertex_Shader)
-		{
-			PipeLine::pContext->VSSetShaderResources(startSlot, numViews, srv);
-		}
-		if (stages & Stage_Hull_Shader)
-		{
-			PipeLine::pContext->HSSetShaderResources(startSlot, numViews, srv);
-		}
-		if (stages & Stage_Domain_Shader)
-		{
-			PipeLine::pContext->DSSetShaderResources(startSlot, numViews, srv);
-		}
-		if (stages & Stage_Geometry_Shader)
-		{
-			PipeLine::pContext->GSSetShaderResources(startSlot, numViews, srv);
-		}
-		if (stages & Stage_Pixel_Shader)
-		{
-			PipeLine::pContext->PSSetShaderResources(startSlot, numViews, srv);
-		}
-		if (stages & Stage_Compute_Shader)
+		DeviceShaderResourceView** srv = (DeviceShaderResourceView**)ptr;
+		for (UINT bit = Stage_Vertex_Shader; bit <= Stage_Compute_Shader; bit <<= 1)
 		{
-			PipeLine::pContext->CSSetShaderResources(startSlot, numViews, srv);
+			if (stages & bit & shaderStages)
+				PipeLine::device->SetShaderResources(bit, startSlot, numViews, srv);
 		}
 	}
 }
 
-bool ResourceManager::SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, vector< int>& idList)
+
+bool ResourceManager::SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, const int* idList, UINT count)
 {
-	D3D11_BIND_FLAG d3dbindFlag = (D3D11_BIND_FLAG)bindFlag;
-	if (startSlot < 0 || startSlot >= MAX_SLOT_NUMBER || !idList.size())
+	if (startSlot >= MAX_SLOT_NUMBER || !count)
 	{
 		return false;
 	}
-	if (d3dbindFlag == D3D11_BIND_DEPTH_STENCIL)
+	if (bindFlag == Bind_Depth_Stencil)
 	{
 		stage = Stage_Output_Merge;
 		startSlot = 0;
-		if (idList.size() > 1)
+		if (count > 1)
 			return false;
 	}
-	else if (d3dbindFlag == D3D11_BIND_RENDER_TARGET)
+	else if (bindFlag == Bind_Render_Target)
 	{
 		stage = Stage_Output_Merge;
 		startSlot = 0;
 	}
-	else if (d3dbindFlag == D3D11_BIND_INDEX_BUFFER)
+	else if (bindFlag == Bind_Index_Buffer)
 	{
 		stage = Stage_Input_Assembler;
 		startSlot = 0;
-		if (idList.size() > 1)
+		if (count > 1)
 			return false;
 	}
-	else if (d3dbindFlag == D3D11_BIND_VERTEX_BUFFER)
+	else if (bindFlag == Bind_Vertex_Buffer)
 	{
 		stage = Stage_Input_Assembler;
 	}
-	else if (d3dbindFlag == D3D11_BIND_STREAM_OUTPUT)
+	else if (bindFlag == Bind_Stream_Out)
 	{
 		stage = Stage_Stream_Out;
 		startSlot = 0;
 	}
-	vector<void*> newView;
-	newView.resize(idList.size());
-	int stride=-1;
-	for (UINT i = 0; i < idList.size(); i++)
+	int kind = ViewKindOf(bindFlag);
+	if (kind == INVALID)
+	{
+		return false;
+	}
+	UINT setSize = SetSize(kind);
+	if (setSize)
 	{
-		int &id = idList[i];
+		count = count > setSize ? setSize : count;
+	}
+	else if (startSlot + count > MAX_SLOT_NUMBER)
+	{
+		return false;
+	}
+	DeviceObject* newView[MAX_SLOT_NUMBER];
+	for (UINT i = 0; i < count; i++)
+	{
+		int id = idList[i];
 		if (id == INVALID)
 		{
 			newView[i] = NULL;
 		}
-		else if (Exist(id) && pool[id]->viewPool.count(d3dbindFlag))
+		else if (Exist(id) && pool[id]->views[kind])
 		{
-			newView[i] = pool[id]->viewPool[d3dbindFlag];
-			stride = pool[id]->desc.elementStride;
+			newView[i] = pool[id]->views[kind];
+			pool[id]->everBound = true;
 		}
 		else
 		{
 			return false;
 		}
 	}
-	Bind(stage, d3dbindFlag, startSlot, newView.size(), &newView[0], stride);
+	if (kind < (int)numDeferredKinds)
+	{
+		Record(kind, stage & StagesOf(kind), startSlot, idList, count);
+		return true;
+	}
+
+	//Only the stages whose slots differ from the shadow are bound
+	UINT compareCount = setSize ? setSize : count;
+	UINT changedStages = 0;
+	UINT numCalls = 0, numChanged = 0;
+	for (UINT bit = Stage_Input_Assembler; bit <= Stage_Compute_Shader; bit <<= 1)
+	{
+		if (!(stage & bit)) continue;
+		numCalls++;
+		const int* bound = shadow[kind][StageIndex(bit)] + startSlot;
+		for (UINT i = 0; i < compareCount; i++)
+		{
+			if (bound[i] != (i < count ? idList[i] : (int)INVALID))
+			{
+				changedStages |= bit;
+				numChanged++;
+				break;
+			}
+		}
+	}
+	stats.skipped += numCalls - numChanged;
+	if (!changedStages) return true;
+	Bind(changedStages, bindFlag, startSlot, count, newView);
+	stats.issued += numChanged;
+
+	bool output = IsOutput(kind);
+	if (output)
+	{
+		for (UINT i = 0; i < count; i++)
+		{
+			if (idList[i] != INVALID) Forget(idList[i]);
+		}
+	}
+	for (UINT bit = Stage_Input_Assembler; bit <= Stage_Compute_Shader; bit <<= 1)
+	{
+		if (!(changedStages & bit)) continue;
+		int* bound = shadow[kind][StageIndex(bit)];
+		if (kind == View_Unordered_Access && bit == Stage_Output_Merge)
+		{
+			//The OM call resets the UAV slots outside its range
+			for (UINT i = 0; i < MAX_SLOT_NUMBER; i++) bound[i] = UNKNOWN;
+		}
+		for (UINT i = 0; i < compareCount; i++)
+		{
+			int id = i < count ? idList[i] : (int)INVALID;
+			//The runtime drops inputs that are bound as output
+			if (!output && id != INVALID && find(boundOutputs.begin(), boundOutputs.end(), id) != boundOutputs.end())
+				id = UNKNOWN;
+			bound[startSlot + i] = id;
+		}
+	}
+	if (output) CollectOutputs();
 	return true;
 }
 
+bool ResourceManager::SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, const vector<int>& idList)
+{
+	if (idList.empty()) return false;
+	return SetBinding(stage, bindFlag, startSlot, &idList[0], (UINT)idList.size());
+}
+
 bool ResourceManager::SetBinding(PipelineStage stage, BindFlag bindFlag, UINT slot, int id)
 {
-	vector<int> temp;
-	temp.push_back(id);
+	return SetBinding(stage, bindFlag, slot, &id, 1);
+}
 
-	return  SetBinding(stage, bindFlag, slot, temp);
+bool ResourceManager::SetConstantBufferRange(PipelineStage stage, UINT slot, int id, UINT offset, UINT size)
+{
+	if (!PipeLine::SupportsConstantBufferRanges() || slot >= CONSTANT_BUFFER_SLOT_COUNT)
+		return false;
+	if (!Exist(id) || !pool[id]->views[View_Constant_Buffer] || offset % 256 || !size || size % 256 || offset + size > pool[id]->desc.size[0])
+		return false;
+	DeviceBuffer* buffer = (DeviceBuffer*)pool[id]->views[View_Constant_Buffer];
+	//Offsets and sizes are counted in 16 byte constants
+	UINT first = offset / 16, num = size / 16;
+	for (UINT bit = Stage_Vertex_Shader; bit <= Stage_Compute_Shader; bit <<= 1)
+	{
+		if (!(stage & bit & shaderStages)) continue;
+		PipeLine::device->SetConstantBufferRanges(bit, slot, 1, &buffer, &first, &num);
+		//The range is not part of the shadow, a later whole buffer bind of the slot always goes out
+		UINT s = StageIndex(bit);
+		shadow[View_Constant_Buffer][s][slot] = UNKNOWN;
+		pending[View_Constant_Buffer][s][slot] = UNKNOWN;
+		dirty[View_Constant_Buffer][s] &= ~(1ull << slot);
+		stats.issued++;
+	}
+	return true;
+}
+
+void ResourceManager::Record(int kind, UINT stages, UINT startSlot, const int * idList, UINT count)
+{
+	for (UINT bit = Stage_Input_Assembler; bit <= Stage_Compute_Shader; bit <<= 1)
+	{
+		if (!(stages & bit)) continue;
+		UINT s = StageIndex(bit);
+		int* want = pending[kind][s];
+		const int* bound = shadow[kind][s];
+		bool changed = false;
+		for (UINT i = 0; i < count; i++)
+		{
+			UINT slot = startSlot + i;
+			if (want[slot] == idList[i]) continue;
+			changed = true;
+			want[slot] = idList[i];
+			if (idList[i] == bound[slot])
+				dirty[kind][s] &= ~(1ull << slot);
+			else
+				dirty[kind][s] |= 1ull << slot;
+		}
+		if (!changed) stats.skipped++;
+	}
+}
+
+void ResourceManager::CommitBindings()
+{
+	for (UINT kind = 0; kind < numDeferredKinds; kind++)
+	{
+		for (UINT s = 0; s < numShadowStages; s++)
+		{
+			UINT64 bits = dirty[kind][s];
+			if (!bits) continue;
+			dirty[kind][s] = 0;
+			const int* want = pending[kind][s];
+			UINT slot = 0;
+			while (bits)
+			{
+				while (!((bits >> slot) & 1)) slot++;
+				//Grow the run over clean slots too, rebinding what they hold is harmless,
+				//unless the context may hold something else there
+				UINT begin = slot, end = slot + 1;
+				for (slot = end; slot < MAX_SLOT_NUMBER && (bits >> slot); slot++)
+				{
+					if ((bits >> slot) & 1) end = slot + 1;
+					else if (want[slot] == UNKNOWN) break;
+				}
+				UINT64 run = (end == 64 ? ~0ull : (1ull << end) - 1) & ~((1ull << begin) - 1);
+				bits &= ~run;
+				Commit(kind, 1u << s, begin, end);
+				slot = end;
+			}
+		}
+	}
+}
+
+void ResourceManager::Commit(int kind, UINT stageBit, UINT begin, UINT end)
+{
+	const int* want = pending[kind][StageIndex(stageBit)];
+	int* bound = shadow[kind][StageIndex(stageBit)];
+	DeviceObject* newView[MAX_SLOT_NUMBER];
+	UINT strides[MAX_SLOT_NUMBER];
+	for (UINT slot = begin; slot < end; slot++)
+	{
+		int id = want[slot];
+		UINT i = slot - begin;
+		//Resources deleted since they were recorded are bound as NULL
+		if (id >= 0 && Exist(id) && pool[id]->views[kind])
+		{
+			newView[i] = pool[id]->views[kind];
+			strides[i] = pool[id]->desc.elementStride;
+			//The runtime drops inputs that are bound as output
+			bound[slot] = find(boundOutputs.begin(), boundOutputs.end(), id) == boundOutputs.end() ? id : (int)UNKNOWN;
+		}
+		else
+		{
+			newView[i] = NULL;
+			strides[i] = 0;
+			bound[slot] = INVALID;
+		}
+	}
+	Bind(stageBit, bindFlagOfKind[kind], begin, end - begin, newView, strides);
+	stats.issued++;
+}
+
+UINT ResourceManager::StageIndex(UINT stageBit)
+{
+	UINT index = 0;
+	while (stageBit > 1)
+	{
+		stageBit >>= 1;
+		index++;
+	}
+	return index;
+}
+
+bool ResourceManager::IsOutput(int kind)
+{
+	return kind == View_Stream_Out || kind == View_Render_Target || kind == View_Depth_Stencil || kind == View_Unordered_Access;
+}
+
+UINT ResourceManager::StagesOf(int kind)
+{
+	if (kind == View_Vertex_Buffer || kind == View_Index_Buffer) return Stage_Input_Assembler;
+	if (kind == View_Constant_Buffer || kind == View_Shader_Resource) return shaderStages;
+	if (kind == View_Stream_Out) return Stage_Stream_Out;
+	if (kind == View_Unordered_Access) return Stage_Compute_Shader | Stage_Output_Merge;
+	return Stage_Output_Merge;
+}
+
+UINT ResourceManager::SetSize(int kind)
+{
+	if (kind == View_Render_Target) return RENDER_TARGET_SLOT_COUNT;
+	if (kind == View_Stream_Out) return STREAM_OUT_SLOT_COUNT;
+	return 0;
+}
+
+void ResourceManager::Forget(int id)
+{
+	int* entry = &shadow[0][0][0];
+	int* end = entry + View_Kind_Count * numShadowStages * MAX_SLOT_NUMBER;
+	for (; entry != end; entry++)
+	{
+		if (*entry == id) *entry = UNKNOWN;
+	}
+	boundOutputs.erase(remove(boundOutputs.begin(), boundOutputs.end(), id), boundOutputs.end());
+}
+
+void ResourceManager::CollectOutputs()
+{
+	boundOutputs.clear();
+	for (int kind = numDeferredKinds; kind < View_Kind_Count; kind++)
+	{
+		if (!IsOutput(kind)) continue;
+		for (UINT s = 0; s < numShadowStages; s++)
+		{
+			for (UINT i = 0; i < MAX_SLOT_NUMBER; i++)
+			{
+				int id = shadow[kind][s][i];
+				if (id >= 0 && find(boundOutputs.begin(), boundOutputs.end(), id) == boundOutputs.end())
+					boundOutputs.push_back(id);
+			}
+		}
+	}
+}
+
+void ResourceManager::Delete(UINT id)
+{
+	if (!Exist(id)) return;
+	//Effects delete the back buffer with their resources, the next GetBackBuffer wraps it again
+	if ((int)id == backBufferID)
+		backBufferID = INVALID;
+	//The kept views are sent again with the next RTV or DSV bind
+	DeviceObject** views = pool[id]->views;
+	if (views[View_Depth_Stencil] && views[View_Depth_Stencil] == currentDSV)
+		currentDSV = NULL;
+	if (views[View_Render_Target])
+	{
+		for (auto &v : currentRTVs)
+		{
+			if (v == views[View_Render_Target]) v = NULL;
+		}
+	}
+	//Recorded inputs of it become NULL, so the context lets go of it at the next commit.
+	//Resources never bound can't be in the tables, which saves scanning them
+	if (pool[id]->everBound)
+	{
+		for (UINT kind = 0; kind < numDeferredKinds; kind++)
+		{
+			for (UINT s = 0; s < numShadowStages; s++)
+			{
+				for (UINT i = 0; i < MAX_SLOT_NUMBER; i++)
+				{
+					if (pending[kind][s][i] == (int)id)
+					{
+						pending[kind][s][i] = INVALID;
+						dirty[kind][s] |= 1ull << i;
+					}
+				}
+			}
+		}
+		Forget((int)id);
+	}
+	//Draws recorded this frame or still queued may read it, the D3D11 runtime would keep the
+	//objects alive but not the ID or the memory accounting. Both go once the frame is fenced
+	RetiredResource entry = { pool[id], PipeLine::GetFrameIndex() };
+	retired.push_back(entry);
+	retiredBytes += entry.resource->byteSize;
+	pool.Erase(id);
+}
+
+void ResourceManager::ReleaseRetired(bool all)
+{
+	UINT64 frame = PipeLine::GetFrameIndex();
+	while (!retired.empty() && (all || retired.front().frame + FRAMES_IN_FLIGHT <= frame))
+	{
+		retiredBytes -= retired.front().resource->byteSize;
+		Release(retired.front().resource);
+		retired.pop_front();
+	}
+}
+
+size_t ResourceManager::GetRetiredCount() const
+{
+	return retired.size();
+}
+
+size_t ResourceManager::GetRetiredBytes() const
+{
+	return retiredBytes;
+}
+
+const ResourceDesc * ResourceManager::GetDesc(int id) const
+{
+	if (id < 0 || !Exist(id)) return NULL;
+	return &pool[id]->desc;
+}
+
+void ResourceManager::Clear()
+{
+	currentDSV = NULL;
+	currentRTVs.clear();
+	//Same as deleting every resource
+	for (UINT kind = 0; kind < numDeferredKinds; kind++)
+	{
+		for (UINT s = 0; s < numShadowStages; s++)
+		{
+			for (UINT i = 0; i < MAX_SLOT_NUMBER; i++)
+			{
+				if (pending[kind][s][i] >= 0)
+				{
+					pending[kind][s][i] = INVALID;
+					dirty[kind][s] |= 1ull << i;
+				}
+			}
+		}
+	}
+	for (int kind = numDeferredKinds; kind < View_Kind_Count; kind++)
+	{
+		int* entry = &shadow[kind][0][0];
+		for (UINT i = 0; i < numShadowStages * MAX_SLOT_NUMBER; i++)
+		{
+			if (entry[i] >= 0) entry[i] = UNKNOWN;
+		}
+	}
+	boundOutputs.clear();
+	IDContainer::Clear();
+	backBufferID = INVALID;
+	//Only called with the device going away or idle
+	ReleaseRetired(true);
+}
+
+void ResourceManager::Invalidate()
+{
+	int* entry = &shadow[0][0][0];
+	fill(entry, entry + View_Kind_Count * numShadowStages * MAX_SLOT_NUMBER, (int)UNKNOWN);
+	boundOutputs.clear();
+	//Recorded resources are sent again at the next commit, recorded NULLs are no longer known
+	for (UINT kind = 0; kind < numDeferredKinds; kind++)
+	{
+		for (UINT s = 0; s < numShadowStages; s++)
+		{
+			dirty[kind][s] = 0;
+			for (UINT i = 0; i < MAX_SLOT_NUMBER; i++)
+			{
+				int &want = pending[kind][s][i];
+				if (want >= 0)
+					dirty[kind][s] |= 1ull << i;
+				else
+					want = UNKNOWN;
+			}
+		}
+	}
 }
 
 int ResourceManager::Create(ResourceDesc desc, void * pData, size_t dataSize)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
+	if (IsFull()) return INVALID;
 	Resource* r = Resource::Create(desc, pData, dataSize);
 	if (!r) return INVALID;
-	pool[id] = r;
-	return id;
+	return Insert(r);
 }
 
 int ResourceManager::CreateFromFile(const string & filePath)
@@ -802,12 +1242,12 @@ int ResourceManager::CreateFromFile(const string & filePath)
 int ResourceManager::GetBackBuffer()
 {
 	if (backBufferID != INVALID) return backBufferID;
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
+	if (IsFull()) return INVALID;
 	Resource* r = Resource::GetBackBuffer();
 	if (!r) return INVALID;
-	pool[id] = r;
-	backBufferID = id;
+	string owner = SetMemoryOwner("swap_chain");
+	backBufferID = Insert(r);
+	SetMemoryOwner(owner);
 	return backBufferID;
 }
 
@@ -817,6 +1257,12 @@ bool ResourceManager::UpdateResourceData(UINT resourceID, const void * pData, UI
 	return pool[resourceID]->UpdateData(pData, size);
 }
 
+bool ResourceManager::UpdateResourceData(UINT resourceID, const void * pData, UINT size, UINT offset, bool discard)
+{
+	if (!Exist(resourceID)) return false;
+	return pool[resourceID]->UpdateData(pData, size, offset, discard);
+}
+
 void ResourceManager::CopyResourceData(UINT srcID, UINT dstID)
 {
 	if (!Exist(srcID) || !Exist(dstID))
@@ -845,6 +1291,40 @@ void ResourceManager::Reset(UINT id, UINT flag, float depth, UINT8 stencil)
 	}
 }
 
+MemoryCategory ResourceManager::GetMemoryCategory(const ResourceDesc & desc)
+{
+	//Textures that are render targets only so their mips can be generated stay textures
+	bool mipSource = (desc.bindFlag & Bind_Shader_Resource) && desc.mipLevel != 1;
+	if ((desc.bindFlag & Bind_Depth_Stencil) || ((desc.bindFlag & Bind_Render_Target) && !mipSource))
+		return Memory_Target;
+	if (desc.bindFlag & Bind_Unordered_Access) return Memory_Unordered_Access;
+	if (desc.type != Resource_Buffer) return Memory_Texture;
+	if (desc.bindFlag & Bind_Vertex_Buffer) return Memory_Vertex;
+	if (desc.bindFlag & Bind_Index_Buffer) return Memory_Index;
+	if (desc.bindFlag & Bind_Constant_Buffer) return Memory_Constant;
+	return Memory_Buffer;
+}
+
+size_t ResourceManager::GetByteSize(const ResourceDesc & desc)
+{
+	return Resource::ByteSize(desc);
+}
+
+bool ResourceManager::IsBlockCompressed(Format format)
+{
+	return Resource::IsBlockCompressed(format);
+}
+
+UINT ResourceManager::GetRowPitch(Format format, UINT width)
+{
+	return Resource::RowPitch(format, width);
+}
+
+UINT ResourceManager::GetRowCount(Format format, UINT height)
+{
+	return Resource::RowCount(format, height);
+}
+
 bool ResourceManager::GenerateMipMap(UINT id)
 {
 	//**
@@ -854,3 +1334,136 @@ bool ResourceManager::GenerateMipMap(UINT id)
 	}
 	return false;
 }
+
+const char* MemoryCategoryName(int category)
+{
+	static const char* names[Memory_Category_Count] = { "texture", "vertex", "index", "constant", "buffer", "target", "unordered_access" };
+	return category >= 0 && category < Memory_Category_Count ? names[category] : "unknown";
+}
+
+string ResourceManager::SetMemoryOwner(const string & owner)
+{
+	string previous = memoryOwner;
+	memoryOwner = owner;
+	return previous;
+}
+
+const string & ResourceManager::GetMemoryOwner() const
+{
+	return memoryOwner;
+}
+
+void ResourceManager::SetMemoryBudget(size_t bytes)
+{
+	memoryBudget = bytes;
+}
+
+size_t ResourceManager::GetMemoryUsage() const
+{
+	return memoryTotal;
+}
+
+size_t ResourceManager::GetMemoryUsage(const string & owner) const
+{
+	auto it = memoryByOwner.find(owner);
+	return it == memoryByOwner.end() ? 0 : it->second;
+}
+
+MemorySnapshot ResourceManager::GetMemorySnapshot() const
+{
+	MemorySnapshot snapshot;
+	snapshot.totalBytes = memoryTotal;
+	snapshot.budgetBytes = memoryBudget;
+	ZeroMemory(snapshot.categoryBytes, sizeof(snapshot.categoryBytes));
+	snapshot.retiredBytes = retiredBytes;
+	for (const RetiredResource &r : retired)
+	{
+		snapshot.categoryBytes[GetMemoryCategory(r.resource->desc)] += r.resource->byteSize;
+	}
+	snapshot.ownerBytes.insert(memoryByOwner.begin(), memoryByOwner.end());
+	snapshot.resources.reserve(pool.Size());
+	for (size_t i = 0; i < pool.Size(); i++)
+	{
+		const Resource* r = *(pool.begin() + i);
+		MemoryEntry entry;
+		entry.id = (int)pool.IDAt(i);
+		entry.owner = r->owner;
+		entry.name = r->desc.name;
+		entry.category = GetMemoryCategory(r->desc);
+		entry.bytes = r->byteSize;
+		entry.desc = r->desc;
+		snapshot.categoryBytes[entry.category] += entry.bytes;
+		snapshot.resources.push_back(entry);
+	}
+	sort(snapshot.resources.begin(), snapshot.resources.end(), [](const MemoryEntry &a, const MemoryEntry &b)
+	{
+		if (a.owner != b.owner) return a.owner < b.owner;
+		if (a.name != b.name) return a.name < b.name;
+		if (a.category != b.category) return a.category < b.category;
+		return a.bytes < b.bytes;
+	});
+	return snapshot;
+}
+
+string ResourceManager::DumpMemory(bool json) const
+{
+	using json11::Json;
+	MemorySnapshot snapshot = GetMemorySnapshot();
+	ostringstream out;
+	if (json)
+	{
+		//One entry per line so dumps of two builds diff line by line
+		out << "{\n\t\"total\": " << snapshot.totalBytes << ",\n\t\"budget\": " << snapshot.budgetBytes << ",\n\t\"retired\": " << snapshot.retiredBytes << ",\n\t\"categories\": {";
+		for (int i = 0; i < Memory_Category_Count; i++)
+		{
+			out << (i ? "," : "") << "\n\t\t\"" << MemoryCategoryName(i) << "\": " << snapshot.categoryBytes[i];
+		}
+		out << "\n\t},\n\t\"owners\": {";
+		bool first = true;
+		for (auto &owner : snapshot.ownerBytes)
+		{
+			out << (first ? "" : ",") << "\n\t\t" << Json(owner.first).dump() << ": " << owner.second;
+			first = false;
+		}
+		out << "\n\t},\n\t\"resources\": [";
+		first = true;
+		for (const MemoryEntry &e : snapshot.resources)
+		{
+			out << (first ? "" : ",") << "\n\t\t{ \"owner\": " << Json(e.owner).dump() << ", \"name\": " << Json(e.name).dump()
+				<< ", \"category\": \"" << MemoryCategoryName(e.category) << "\", \"bytes\": " << e.bytes
+				<< ", \"size\": [" << e.desc.size[0] << ", " << e.desc.size[1] << ", " << e.desc.size[2] << "], \"format\": " << (int)e.desc.format
+				<< ", \"mips\": " << e.desc.mipLevel << ", \"samples\": " << e.desc.sampleCount << " }";
+			first = false;
+		}
+		out << "\n\t]\n}\n";
+	}
+	else
+	{
+		out << "total " << snapshot.totalBytes << "\nbudget " << snapshot.budgetBytes << "\nretired " << snapshot.retiredBytes << "\n";
+		for (int i = 0; i < Memory_Category_Count; i++)
+		{
+			out << "category " << MemoryCategoryName(i) << " " << snapshot.categoryBytes[i] << "\n";
+		}
+		for (auto &owner : snapshot.ownerBytes)
+		{
+			out << "owner " << (owner.first.empty() ? "-" : owner.first) << " " << owner.second << "\n";
+		}
+		for (const MemoryEntry &e : snapshot.resources)
+		{
+			out << "resource " << (e.owner.empty() ? "-" : e.owner) << " | " << e.name << " | " << MemoryCategoryName(e.category) << " " << e.bytes
+				<< " " << e.desc.size[0] << "x" << e.desc.size[1] << "x" << e.desc.size[2] << " format " << (int)e.desc.format
+				<< " mips " << e.desc.mipLevel << " samples " << e.desc.sampleCount << "\n";
+		}
+	}
+	return out.str();
+}
+
+MemoryOwnerScope::MemoryOwnerScope(const string & owner)
+{
+	previous = PipeLine::Resources().SetMemoryOwner(owner);
+}
+
+MemoryOwnerScope::~MemoryOwnerScope()
+{
+	PipeLine::Resources().SetMemoryOwner(previous);
+}
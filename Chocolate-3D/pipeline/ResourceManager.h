@@ -3,45 +3,33 @@
 //============================================================
 
 #pragma once
-#include <windows.h>
-#include <d3d11_1.h>
 #include <unordered_map>
+#include <map>
+#include <deque>
 #include <vector>
 #include"D3Def.h"
+#include"DeviceTypes.h"
 #include"Pipeline.h"
 #include"IDContainer.h"
 #include"Singleton.h"
 using namespace std;
 
-enum ResourceType
+//Direct index of a resource's view per bind flag, see ViewKindOf
+enum ViewKind
 {
-	Resource_Buffer = D3D11_RESOURCE_DIMENSION_BUFFER,
-	Resource_Texture1D = D3D11_RESOURCE_DIMENSION_TEXTURE1D,
-	Resource_Texture2D = D3D11_RESOURCE_DIMENSION_TEXTURE2D,
-	Resource_Texture3D = D3D11_RESOURCE_DIMENSION_TEXTURE3D
+	View_Vertex_Buffer,
+	View_Constant_Buffer,
+	View_Shader_Resource,
+	View_Index_Buffer,
+	View_Stream_Out,
+	View_Render_Target,
+	View_Depth_Stencil,
+	View_Unordered_Access,
+	View_Kind_Count
 };
 
-enum AccessType
-{
-	Access_Default = D3D11_USAGE_DEFAULT,
-	Access_Immutable = D3D11_USAGE_IMMUTABLE,
-	Access_Dynamic = D3D11_USAGE_DYNAMIC,
-	Access_Staging = D3D11_USAGE_STAGING
-};
-
-enum BindFlag
-{
-	Bind_Vertex_Buffer = D3D11_BIND_VERTEX_BUFFER,
-	Bind_Index_Buffer = D3D11_BIND_INDEX_BUFFER,
-	Bind_Constant_Buffer = D3D11_BIND_CONSTANT_BUFFER,
-	Bind_Shader_Resource = D3D11_BIND_SHADER_RESOURCE,
-	Bind_Stream_Out = D3D11_BIND_STREAM_OUTPUT,
-	Bind_Render_Target = D3D11_BIND_RENDER_TARGET,
-	Bind_Depth_Stencil = D3D11_BIND_DEPTH_STENCIL,
-	Bind_Unordered_Access = D3D11_BIND_UNORDERED_ACCESS,
-	Bind_Decoder = D3D11_BIND_DECODER,
-	Bind_Video_Encoder = D3D11_BIND_VIDEO_ENCODER
-};
+//-1 for flags without a view
+int ViewKindOf(BindFlag bindFlag);
 
 struct ResourceDesc 
 {
@@ -49,7 +37,7 @@ struct ResourceDesc
 	ResourceType type;
 	AccessType access;
 	UINT bindFlag;
-	DXGI_FORMAT format;
+	Format format;
 	UINT size[3];
 	UINT mipLevel;
 	UINT elementStride;
@@ -61,6 +49,7 @@ struct ResourceDesc
 		type = Resource_Buffer;
 		access = Access_Default;
 		bindFlag = 0;
+		format = Format_UNKNOWN;
 		mipLevel = 0;
 		elementStride = 0;
 		miscFlag = 0;
@@ -70,6 +59,43 @@ struct ResourceDesc
 	}
 };
 
+//Video memory is counted in one of these per resource, by its first matching use: depth stencil
+//or render target (unless it has mips to generate), UAV, then vertex / index / constant / other buffer, texture
+enum MemoryCategory
+{
+	Memory_Texture,
+	Memory_Vertex,
+	Memory_Index,
+	Memory_Constant,
+	Memory_Buffer,
+	Memory_Target,
+	Memory_Unordered_Access,
+	Memory_Category_Count
+};
+
+//Lower case name used in dumps
+const char* MemoryCategoryName(int category);
+
+struct MemoryEntry
+{
+	int id;
+	string owner;
+	string name;
+	int category;
+	size_t bytes;
+	ResourceDesc desc;
+};
+
+struct MemorySnapshot
+{
+	size_t totalBytes;
+	size_t budgetBytes; //0 for none
+	size_t categoryBytes[Memory_Category_Count];
+	size_t retiredBytes; //Deleted, still held by frames in flight. Part of the total and the breakdowns
+	map<string, size_t> ownerBytes;
+	vector<MemoryEntry> resources; //Sorted by owner, name, category then bytes
+};
+
 class Resource
 {
 protected:
@@ -78,17 +104,30 @@ protected:
 	static  Resource* GetBackBuffer();
 	bool ResetData(const UINT value[4]);
 	bool UpdateData(const void * pData, size_t size);
+	bool UpdateData(const void * pData, size_t size, size_t offset, bool discard);
 	bool GenerateMips();
 	void Release();
+	//Bytes the resource takes with all its mips and samples, 0 for formats missing from the table
+	static size_t ByteSize(const ResourceDesc &desc);
+	static bool IsBlockCompressed(Format format);
+	//Bytes of a row of texels, a row of 4x4 blocks for block formats. 0 for formats missing from the table
+	static UINT RowPitch(Format format, UINT width);
+	//Rows in a level of that height: texel rows, or block rows for block formats
+	static UINT RowCount(Format format, UINT height);
 	virtual ~Resource();
 
 private:
-	ID3D11Resource* ptr;
+	DeviceResource* ptr;
 	ResourceDesc desc;
-	unordered_map<D3D11_BIND_FLAG, IUnknown*> viewPool;
-	static unordered_map<DXGI_FORMAT, UINT> FormatSizeTable;
+	DeviceObject* views[View_Kind_Count]; //NULL where the bind flag isn't supported
+	//Set by the ResourceManager when the resource is counted
+	string owner;
+	size_t byteSize;
+	//Passed to SetBinding at least once, only then can the binding shadow hold its ID
+	bool everBound;
+	static unordered_map<Format, UINT> FormatSizeTable;
 	static Resource* pBackBuffer;
-	static ResourceDesc GetDesc(ID3D11Resource* pD3DResource);
+	static ResourceDesc GetDesc(const TextureDesc& textureDesc);
 	static void InitFormatTable();
 	bool CreateBuffer(void* pData = NULL, size_t dataSize = 0);
 	bool CreateTexture2D(void* pData = NULL, size_t dataSize = 0);
@@ -99,25 +138,118 @@ private:
 	Resource();
 };
 
-class ResourceManager : public	IDContainer<Resource*>
+class ResourceManager : public	IDContainer<Resource*>, public ShadowState
 {
 	SINGLETON(ResourceManager)
 public:
-	bool SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, vector<int>& idList);
+	//Vertex buffers, constant buffers and shader resources are only recorded here and sent by
+	//CommitBindings, adjacent dirty slots of a stage go out as one call. Other kinds bind at once.
+	bool SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, const int* idList, UINT count);
+	bool SetBinding(PipelineStage stage, BindFlag bindFlag, UINT startSlot, const vector<int>& idList);
 	bool SetBinding(PipelineStage stage, BindFlag bindFlag, UINT slot, int id);
+	//Sends the recorded input bindings, PipeLine::Draw and Compute call it
+	void CommitBindings();
+	//Binds size bytes of a constant buffer from offset at once, both multiples of 256.
+	//Needs PipeLine::SupportsConstantBufferRanges. The slot is left UNKNOWN in the shadow.
+	bool SetConstantBufferRange(PipelineStage stage, UINT slot, int id, UINT offset, UINT size);
 	int Create(ResourceDesc desc, void* pData = NULL, size_t dataSize = 0);
 	int CreateFromFile(const string& filePath);
 	int GetBackBuffer();
+	//NULL if the resource doesn't exist
+	const ResourceDesc* GetDesc(int id) const;
 	bool UpdateResourceData(UINT resourceID, const void* pData, UINT size);
+	//Write a byte range of a buffer. Dynamic buffers map with NO_OVERWRITE unless discard is set
+	bool UpdateResourceData(UINT resourceID, const void* pData, UINT size, UINT offset, bool discard);
 	void CopyResourceData(UINT srcID, UINT dstID);
 	bool GenerateMipMap(UINT id);
+	static size_t GetByteSize(const ResourceDesc &desc);
+	static bool IsBlockCompressed(Format format);
+	static UINT GetRowPitch(Format format, UINT width);
+	static UINT GetRowCount(Format format, UINT height);
+	static MemoryCategory GetMemoryCategory(const ResourceDesc &desc);
+
+	//----Memory accounting----
+	//Resources created from now on are counted for owner, see MemoryOwnerScope. Returns the previous one
+	string SetMemoryOwner(const string &owner);
+	const string& GetMemoryOwner() const;
+	//0 for none. Creations taking the total past it are logged with OutputDebugString, not refused
+	void SetMemoryBudget(size_t bytes);
+	size_t GetMemoryUsage() const;
+	size_t GetMemoryUsage(const string &owner) const;
+	MemorySnapshot GetMemorySnapshot() const;
+	//Stable between runs to diff builds: no IDs, sorted as the snapshot. Text has one line per entry
+	string DumpMemory(bool json) const;
 	void Reset(UINT id, const float value[4]);
 	void Reset(UINT id, const UINT value[4]);
 	void Reset(UINT id, UINT flag, float depth, UINT8 stencil);
+	//Also drops the resource from the shadow and the kept RTV / DSV. The ID is stale at once,
+	//the device objects are retired and released once the frames that may use them are done
+	void Delete(UINT id) override;
+	//Releases retired resources of frames at least FRAMES_IN_FLIGHT behind PipeLine::GetFrameIndex,
+	//everything with all. PipeLine::Swap calls it
+	void ReleaseRetired(bool all = false);
+	size_t GetRetiredCount() const;
+	size_t GetRetiredBytes() const;
+	void Clear() override;
+	void Invalidate() override;
 private:
 	void Release(Resource* &element) override;
-	ID3D11DepthStencilView* currentDSV;
-	vector<ID3D11RenderTargetView*> currentRTVs;
+	int Insert(Resource* r);
+	struct RetiredResource
+	{
+		Resource* resource;
+		UINT64 frame; //PipeLine frame it was deleted in
+	};
+	deque<RetiredResource> retired; //In frame order
+	size_t retiredBytes;
+	DeviceDepthStencilView* currentDSV;
+	vector<DeviceRenderTargetView*> currentRTVs;
 	int backBufferID;
-	void Bind(UINT stages, D3D11_BIND_FLAG bindFlag, UINT startSlot, UINT numViews, void** ptr, UINT elementStride = 0, UINT offset = 0);
+	//strides are per view, vertex buffers only
+	void Bind(UINT stages, BindFlag bindFlag, UINT startSlot, UINT numViews, DeviceObject** ptr, const UINT* strides = NULL);
+
+	//----Binding shadow----
+	//Resource ID bound per kind, stage and slot: INVALID for NULL, UNKNOWN when not known.
+	//Render targets and stream out targets are set as a whole, their unused slots hold INVALID.
+	//D3D11 unbinds inputs of a resource that gets bound as output, and refuses to bind a
+	//resource as input while it is an output, both are mirrored here.
+	static const UINT numShadowStages = 10; //One per PipelineStage bit
+	int shadow[View_Kind_Count][numShadowStages][MAX_SLOT_NUMBER];
+	vector<int> boundOutputs; //IDs in the output kinds
+	static UINT StageIndex(UINT stageBit);
+	static bool IsOutput(int kind);
+	//Stages a kind can be bound to
+	static UINT StagesOf(int kind);
+	//Slots set by one call for kinds bound as a whole, 0 for the others
+	static UINT SetSize(int kind);
+	//Marks every entry of the resource UNKNOWN
+	void Forget(int id);
+	void CollectOutputs();
+
+	//----Recorded input bindings----
+	//The kinds before View_Index_Buffer wait for CommitBindings. pending holds what the caller
+	//asked for, a dirty bit is set per slot where it differs from the shadow.
+	static const UINT numDeferredKinds = View_Index_Buffer;
+	int pending[numDeferredKinds][numShadowStages][MAX_SLOT_NUMBER];
+	UINT64 dirty[numDeferredKinds][numShadowStages];
+	void Record(int kind, UINT stages, UINT startSlot, const int* idList, UINT count);
+	void Commit(int kind, UINT stageBit, UINT begin, UINT end);
+
+	//----Memory accounting----
+	string memoryOwner;
+	size_t memoryBudget;
+	size_t memoryTotal;
+	unordered_map<string, size_t> memoryByOwner;
+};
+
+//Counts the resources created during its lifetime for owner, restores the previous owner after
+class MemoryOwnerScope
+{
+public:
+	MemoryOwnerScope(const string &owner);
+	~MemoryOwnerScope();
+private:
+	string previous;
+	MemoryOwnerScope(MemoryOwnerScope const&);
+	MemoryOwnerScope& operator=(MemoryOwnerScope const&);
 };
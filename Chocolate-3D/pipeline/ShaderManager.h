@@ -4,24 +4,23 @@
 //--------------------------------------------------------------------------------
 
 #pragma once
-#include <windows.h>
-#include <d3d11_1.h>
+#include "DeviceTypes.h"
 #include "Pipeline.h"
 #include "IDContainer.h"
 #include "Singleton.h"
 using namespace std;
 
 
-class ShaderManager : public IDContainer<IUnknown*>
+class ShaderManager : public IDContainer<DeviceObject*>
 {
 protected:
-	void Release(IUnknown* & element) override;
-	string version;
+	void Release(DeviceObject* & element) override;
 	int activeShaderID;
 
-	static ID3DBlob * Compile(wstring fileName, string entryPoint, string target);
-	static ID3DBlob * Compile(string fileName, string entryPoint, string target);
-	virtual IUnknown* CreateFromFile(string fileName, string entryPoint) = 0;
+	virtual DeviceObject* CreateFromFile(string fileName, string entryPoint) = 0;
+	//Shared by the shader stages, stage is a single PipelineStage bit
+	static DeviceShader* CreateShader(PipelineStage stage, const string& fileName, const string& entryPoint);
+	void ActivateShader(PipelineStage stage, int id);
 
 public:
 	ShaderManager();
@@ -38,7 +37,7 @@ class InputLayout :public ShaderManager
 {
 	SINGLETON(InputLayout)
 protected:
-	ID3D11InputLayout* CreateFromFile(string fileName, string entryPoint) override;
+	DeviceInputLayout* CreateFromFile(string fileName, string entryPoint) override;
 public:
 	void Activate(int id) override;
 };
@@ -47,7 +46,7 @@ class VertexShader :public ShaderManager
 {
 	SINGLETON(VertexShader)
 protected:
-	ID3D11VertexShader* CreateFromFile(string fileName, string entryPoint) override;
+	DeviceShader* CreateFromFile(string fileName, string entryPoint) override;
 public:
 	void Activate(int id) override;
 };
@@ -56,7 +55,7 @@ class PixelShader :public ShaderManager
 {
 	SINGLETON(PixelShader)
 protected:
-	ID3D11PixelShader* CreateFromFile(string fileName, string entryPoint) override;
+	DeviceShader* CreateFromFile(string fileName, string entryPoint) override;
 public:
 	void Activate(int id) override;
 };
@@ -65,7 +64,7 @@ class ComputeShader :public ShaderManager
 {
 	SINGLETON(ComputeShader)
 protected:
-	ID3D11ComputeShader* CreateFromFile(string fileName, string entryPoint) override;
+	DeviceShader* CreateFromFile(string fileName, string entryPoint) override;
 public:
 	void Activate(int id) override;
 };
@@ -74,7 +73,7 @@ class GeometryShader :public ShaderManager
 {
 	SINGLETON(GeometryShader)
 protected:
-	ID3D11GeometryShader* CreateFromFile(string fileName, string entryPoint) override;
+	DeviceShader* CreateFromFile(string fileName, string entryPoint) override;
 public:
 	void Activate(int id) override;
 };
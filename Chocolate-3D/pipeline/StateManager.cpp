@@ -11,23 +11,21 @@ using namespace FileLoader;
 
 DepthStencilState::DepthStencilState()
 {
+	Invalidate();
 }
 DepthStencilState::~DepthStencilState() {}
-void DepthStencilState::Release(ID3D11DepthStencilState *& element) 
+void DepthStencilState::Release(DeviceDepthStencilState *& element) 
 {
-	element->Release();
+	PipeLine::device->Release(element);
 	element = NULL;
 }
 
 int DepthStencilState::Create(DepthStencilDesc desc)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
-	ID3D11DepthStencilState* ds;
-	HRESULT hr = PipeLine::pDevice->CreateDepthStencilState(&desc, &ds);
-	if (FAILED(hr)) return INVALID;
-	pool[id] = ds;
-	return id;
+	if (IsFull()) return INVALID;
+	DeviceDepthStencilState* ds = PipeLine::device->CreateDepthStencilState(desc);
+	if (!ds) return INVALID;
+	return Insert(ds);
 }
 
 int DepthStencilState::CreateFromFile(const string & filePath)
@@ -37,31 +35,48 @@ int DepthStencilState::CreateFromFile(const string & filePath)
 
 void DepthStencilState::Apply(int id, UINT stencilRef)
 {
-	if (Exist(id))
+	if (!Exist(id)) return;
+	if (id == appliedID && stencilRef == appliedRef)
 	{
-		PipeLine::pContext->OMSetDepthStencilState(pool[id], stencilRef);
+		stats.skipped++;
+		return;
 	}
+	PipeLine::device->SetDepthStencilState(pool[id], stencilRef);
+	appliedID = id;
+	appliedRef = stencilRef;
+	stats.issued++;
+}
+
+void DepthStencilState::Delete(UINT id)
+{
+	//The generation keeps a new state from reusing the ID, until it wraps
+	if ((int)id == appliedID) Invalidate();
+	IDContainer::Delete(id);
+}
+
+void DepthStencilState::Invalidate()
+{
+	appliedID = UNKNOWN;
+	appliedRef = 0;
 }
 
 BlendState::BlendState() 
 {
+	Invalidate();
 }
 BlendState::~BlendState() {}
-void BlendState::Release(ID3D11BlendState *& element)
+void BlendState::Release(DeviceBlendState *& element)
 {
-	element->Release();
+	PipeLine::device->Release(element);
 	element = NULL;
 }
 
 int BlendState::Create(BlendDesc desc)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
-	ID3D11BlendState* bs;
-	HRESULT hr = PipeLine::pDevice->CreateBlendState(&desc, &bs);
-	if (FAILED(hr)) return INVALID;
-	pool[id] = bs;
-	return id;
+	if (IsFull()) return INVALID;
+	DeviceBlendState* bs = PipeLine::device->CreateBlendState(desc);
+	if (!bs) return INVALID;
+	return Insert(bs);
 }
 
 int BlendState::CreateFromFile(const string & filePath)
@@ -71,31 +86,51 @@ int BlendState::CreateFromFile(const string & filePath)
 
 void BlendState::Apply(int id, float blendFactor[4], UINT blendSampleMask)
 {
-	if (Exist(id))
+	if (!Exist(id)) return;
+	float factor[4] = { 1, 1, 1, 1 };
+	if (blendFactor) memcpy(factor, blendFactor, sizeof(factor));
+	if (id == appliedID && blendSampleMask == appliedMask && !memcmp(factor, appliedFactor, sizeof(factor)))
 	{
-		PipeLine::pContext->OMSetBlendState(pool[id], blendFactor, blendSampleMask);
+		stats.skipped++;
+		return;
 	}
+	PipeLine::device->SetBlendState(pool[id], factor, blendSampleMask);
+	appliedID = id;
+	memcpy(appliedFactor, factor, sizeof(factor));
+	appliedMask = blendSampleMask;
+	stats.issued++;
+}
+
+void BlendState::Delete(UINT id)
+{
+	if ((int)id == appliedID) Invalidate();
+	IDContainer::Delete(id);
+}
+
+void BlendState::Invalidate()
+{
+	appliedID = UNKNOWN;
+	ZeroMemory(appliedFactor, sizeof(appliedFactor));
+	appliedMask = 0;
 }
 
 RasterizorState::RasterizorState() 
 {
+	Invalidate();
 }
 RasterizorState::~RasterizorState() {}
-void RasterizorState::Release(ID3D11RasterizerState *& element)
+void RasterizorState::Release(DeviceRasterizerState *& element)
 {
-	element->Release();
+	PipeLine::device->Release(element);
 	element = NULL;
 }
 
 int RasterizorState::Create(RasterizerDesc desc)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
-	ID3D11RasterizerState* rs;
-	HRESULT hr = PipeLine::pDevice->CreateRasterizerState(&desc, &rs);
-	if (FAILED(hr)) return INVALID;
-	pool[id] = rs;
-	return id;
+	if (IsFull()) return INVALID;
+	DeviceRasterizerState* rs = PipeLine::device->CreateRasterizerState(desc);
+	if (!rs) return INVALID;
+	return Insert(rs);
 }
 
 int RasterizorState::CreateFromFile(const string & filePath)
@@ -105,29 +140,45 @@ int RasterizorState::CreateFromFile(const string & filePath)
 
 void RasterizorState::Apply(int id)
 {
-	if (Exist(id))
+	if (!Exist(id)) return;
+	if (id == appliedID)
 	{
-		PipeLine::pContext->RSSetState(pool[id]);
+		stats.skipped++;
+		return;
 	}
+	PipeLine::device->SetRasterizerState(pool[id]);
+	appliedID = id;
+	stats.issued++;
+}
+
+void RasterizorState::Delete(UINT id)
+{
+	if ((int)id == appliedID) Invalidate();
+	IDContainer::Delete(id);
+}
+
+void RasterizorState::Invalidate()
+{
+	appliedID = UNKNOWN;
 }
 
-SamplerState::SamplerState() {}
+SamplerState::SamplerState() 
+{
+	Invalidate();
+}
 SamplerState::~SamplerState() {}
-void SamplerState::Release(ID3D11SamplerState *& element)
+void SamplerState::Release(DeviceSamplerState *& element)
 {
-	element->Release();
+	PipeLine::device->Release(element);
 	element = NULL;
 }
 
 int SamplerState::Create(SamplerDesc desc)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
-	ID3D11SamplerState* ss;
-	HRESULT hr = PipeLine::pDevice->CreateSamplerState(&desc, &ss);
-	if (FAILED(hr)) return INVALID;
-	pool[id] = ss;
-	return id;
+	if (IsFull()) return INVALID;
+	DeviceSamplerState* ss = PipeLine::device->CreateSamplerState(desc);
+	if (!ss) return INVALID;
+	return Insert(ss);
 }
 
 int SamplerState::CreateFromFile(const string & filePath)
@@ -139,41 +190,77 @@ int SamplerState::CreateFromFile(const string & filePath)
 void SamplerState::Apply(int id, UINT stage, UINT slot)
 {
 	if (!Exist(id)) return;
-	if (stage&Stage_Vertex_Shader)
+	if ((stage&Stage_Vertex_Shader) && Changed(0, slot, id))
+	{
+		PipeLine::device->SetSamplers(Stage_Vertex_Shader, slot, 1, &pool[id]);
+	}
+	if ((stage&Stage_Pixel_Shader) && Changed(4, slot, id))
+	{
+		PipeLine::device->SetSamplers(Stage_Pixel_Shader, slot, 1, &pool[id]);
+	}
+	if ((stage&Stage_Compute_Shader) && Changed(5, slot, id))
 	{
-		PipeLine::pContext->VSSetSamplers(slot, 1, &pool[id]);
+		PipeLine::device->SetSamplers(Stage_Compute_Shader, slot, 1, &pool[id]);
 	}
-	if (stage&Stage_Pixel_Shader)
+	if ((stage&Stage_Domain_Shader) && Changed(2, slot, id))
 	{
-		PipeLine::pContext->PSSetSamplers(slot, 1, &pool[id]);
+		PipeLine::device->SetSamplers(Stage_Domain_Shader, slot, 1, &pool[id]);
 	}
-	if (stage&Stage_Compute_Shader)
+	if ((stage&Stage_Hull_Shader) && Changed(1, slot, id))
 	{
-		PipeLine::pContext->CSSetSamplers(slot, 1, &pool[id]);
+		PipeLine::device->SetSamplers(Stage_Hull_Shader, slot, 1, &pool[id]);
 	}
-	if (stage&Stage_Domain_Shader)
+	if ((stage&Stage_Geometry_Shader) && Changed(3, slot, id))
 	{
-		PipeLine::pContext->DSSetSamplers(slot, 1, &pool[id]);
+		PipeLine::device->SetSamplers(Stage_Geometry_Shader, slot, 1, &pool[id]);
 	}
-	if (stage&Stage_Hull_Shader)
+}
+
+bool SamplerState::Changed(UINT stageIndex, UINT slot, int id)
+{
+	//Out of range slots are left for the runtime to reject
+	if (slot < SAMPLER_SLOT_COUNT)
 	{
-		PipeLine::pContext->HSSetSamplers(slot, 1, &pool[id]);
+		if (applied[stageIndex][slot] == id)
+		{
+			stats.skipped++;
+			return false;
+		}
+		applied[stageIndex][slot] = id;
 	}
-	if (stage&Stage_Geometry_Shader)
+	stats.issued++;
+	return true;
+}
+
+void SamplerState::Delete(UINT id)
+{
+	for (UINT i = 0; i < numStages; i++)
 	{
-		PipeLine::pContext->GSSetSamplers(slot, 1, &pool[id]);
+		for (UINT j = 0; j < SAMPLER_SLOT_COUNT; j++)
+		{
+			if (applied[i][j] == (int)id) applied[i][j] = UNKNOWN;
+		}
+	}
+	IDContainer::Delete(id);
+}
+
+void SamplerState::Invalidate()
+{
+	for (UINT i = 0; i < numStages; i++)
+	{
+		for (UINT j = 0; j < SAMPLER_SLOT_COUNT; j++)
+		{
+			applied[i][j] = UNKNOWN;
+		}
 	}
 }
 
 
 ViewPort::ViewPort() {}
 ViewPort::~ViewPort() {};
-int ViewPort::Create(const D3D11_VIEWPORT &desc)
+int ViewPort::Create(const ViewPortDesc &desc)
 {
-	int id = GenerateID();
-	if (id == INVALID) return INVALID;
-	pool[id] = desc;
-	return id;
+	return Insert(desc);
 }
 
 int ViewPort::CreateFromFile(const string & filePath)
@@ -181,23 +268,59 @@ int ViewPort::CreateFromFile(const string & filePath)
 	return Create(LoadViewPort(filePath));
 }
 
-void ViewPort::Apply(vector<int> id)
+void ViewPort::Apply(const vector<int> &id)
 {
 	if (id.size() == 1)
 	{
-		PipeLine::pContext->RSSetViewports(1, &pool[id[0]]);
+		Apply(id[0]);
+		return;
+	}
+	if (!id.empty() && id == appliedIDs)
+	{
+		stats.skipped++;
 		return;
 	}
-	vector<D3D11_VIEWPORT> res;
-	res.reserve(id.size());
+	ViewPortDesc res[VIEWPORT_SLOT_COUNT];
+	UINT count = 0;
 	for (int i : id) 
 	{
-		res.push_back(pool[i]);
+		if (Exist(i) && count < VIEWPORT_SLOT_COUNT) res[count++] = pool[i];
+	}
+	if (count)
+	{
+		PipeLine::device->SetViewports(count, res);
+		appliedIDs = id;
+		stats.issued++;
 	}
-	PipeLine::pContext->RSSetViewports(res.size(), &res[0]);
 }
 
 void ViewPort::Apply(int id)
 {
-	PipeLine::pContext->RSSetViewports(1, &pool[id]);
+	if (!Exist(id)) return;
+	if (appliedIDs.size() == 1 && appliedIDs[0] == id)
+	{
+		stats.skipped++;
+		return;
+	}
+	PipeLine::device->SetViewports(1, &pool[id]);
+	appliedIDs.assign(1, id);
+	stats.issued++;
+}
+
+void ViewPort::Delete(UINT id)
+{
+	for (int i : appliedIDs)
+	{
+		if (i == (int)id)
+		{
+			Invalidate();
+			break;
+		}
+	}
+	IDContainer::Delete(id);
+}
+
+void ViewPort::Invalidate()
+{
+	appliedIDs.clear();
 }
\ No newline at end of file
@@ -5,73 +5,114 @@
 //-------------------------------------------------------------------------
 
 #pragma once
-#include <windows.h>
-#include <d3d11_1.h>
+#include "DeviceTypes.h"
 #include "IDContainer.h"
 #include "Singleton.h"
 using namespace std;
 
-typedef D3D11_DEPTH_STENCIL_DESC DepthStencilDesc;
-
-typedef D3D11_BLEND_DESC BlendDesc;
-
-typedef D3D11_RASTERIZER_DESC RasterizerDesc;
-
-typedef D3D11_SAMPLER_DESC SamplerDesc;
+//Context calls made and dropped as redundant since the last ResetStats
+struct BindingStats
+{
+	UINT issued;
+	UINT skipped;
+};
 
-typedef D3D11_VIEWPORT ViewPortDesc;
+//----Shadow State----
+//Managers remember what they last set on the context and drop calls that would set it again.
+//UNKNOWN marks state the context may hold differently, the next call touching it is always issued.
+class ShadowState
+{
+public:
+	static const int UNKNOWN = -2;
+	const BindingStats& GetStats() const { return stats; }
+	void ResetStats() { stats.issued = stats.skipped = 0; }
+	//Forget the shadow, call after the context was changed behind the managers' back
+	virtual void Invalidate() = 0;
+protected:
+	ShadowState() { ResetStats(); }
+	virtual ~ShadowState() {}
+	BindingStats stats;
+};
 
-class DepthStencilState : public IDContainer<ID3D11DepthStencilState*>
+class DepthStencilState : public IDContainer<DeviceDepthStencilState*>, public ShadowState
 {
 	SINGLETON(DepthStencilState)
 protected:
-	void Release(ID3D11DepthStencilState* &element) override;
+	void Release(DeviceDepthStencilState* &element) override;
 public:
 	int Create(DepthStencilDesc desc);
 	int CreateFromFile(const string& filePath);
 	void Apply(int id, UINT depthStencilRef);
+	void Delete(UINT id) override;
+	void Invalidate() override;
+private:
+	int appliedID;
+	UINT appliedRef;
 };
 
 
-class BlendState : public IDContainer<ID3D11BlendState*>
+class BlendState : public IDContainer<DeviceBlendState*>, public ShadowState
 {
 	SINGLETON(BlendState)
 protected:
-	void Release(ID3D11BlendState* &element) override;
+	void Release(DeviceBlendState* &element) override;
 public:
 	int Create(BlendDesc desc);
 	int CreateFromFile(const string& filePath);
+	//A NULL blendFactor means 1,1,1,1
 	void Apply(int id, float blendFactor[4], UINT blendSampleMask);
+	void Delete(UINT id) override;
+	void Invalidate() override;
+private:
+	int appliedID;
+	float appliedFactor[4];
+	UINT appliedMask;
 };
 
-class RasterizorState : public IDContainer<ID3D11RasterizerState*>
+class RasterizorState : public IDContainer<DeviceRasterizerState*>, public ShadowState
 {
 	SINGLETON(RasterizorState)
 protected:
-	void Release(ID3D11RasterizerState* &element) override;
+	void Release(DeviceRasterizerState* &element) override;
 public:
 	int Create(RasterizerDesc desc);
 	int CreateFromFile(const string& filePath);
 	void Apply(int id);
+	void Delete(UINT id) override;
+	void Invalidate() override;
+private:
+	int appliedID;
 };
 
-class SamplerState : public IDContainer<ID3D11SamplerState*>
+class SamplerState : public IDContainer<DeviceSamplerState*>, public ShadowState
 {
 	SINGLETON(SamplerState)
 protected:
-	void Release(ID3D11SamplerState* &element) override;
+	void Release(DeviceSamplerState* &element) override;
 public:
 	int Create(SamplerDesc desc);
 	int CreateFromFile(const string& filePath);
 	void Apply(int id, UINT stage, UINT slot);
+	void Delete(UINT id) override;
+	void Invalidate() override;
+private:
+	//VS, HS, DS, GS, PS, CS
+	static const UINT numStages = 6;
+	int applied[numStages][SAMPLER_SLOT_COUNT];
+	//Records the sampler, false when the stage already has it
+	bool Changed(UINT stageIndex, UINT slot, int id);
 };
 
-class ViewPort : public IDContainer<ViewPortDesc>
+class ViewPort : public IDContainer<ViewPortDesc>, public ShadowState
 {
 	SINGLETON(ViewPort)
 public:
 	int Create(const ViewPortDesc& desc);
 	int CreateFromFile(const string& filePath);
-	void Apply(vector<int> id);
+	void Apply(const vector<int> &id);
 	void Apply(int id);
+	void Delete(UINT id) override;
+	void Invalidate() override;
+private:
+	vector<int> appliedIDs;
 };
\ No newline at end of file
@@ -0,0 +1,421 @@
+#include "AABBTree.h"
+#include <algorithm>
+#include <cfloat>
+using namespace std;
+
+AABBTree::AABBTree()
+{
+	margin = 0.1f;
+	lastQueryVisits = 0;
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	proxyCount = 0;
+}
+
+int AABBTree::AllocateNode()
+{
+	int id;
+	if (freeList != NULL_NODE)
+	{
+		id = freeList;
+		freeList = nodes[id].parent;
+	}
+	else
+	{
+		id = (int)nodes.size();
+		nodes.push_back(Node());
+	}
+	Node &node = nodes[id];
+	node.box = AABB::Empty();
+	node.userData = NULL;
+	node.parent = NULL_NODE;
+	node.left = NULL_NODE;
+	node.right = NULL_NODE;
+	node.height = 0;
+	return id;
+}
+
+void AABBTree::FreeNode(int node)
+{
+	nodes[node].parent = freeList;
+	nodes[node].height = -1;
+	nodes[node].userData = NULL;
+	freeList = node;
+}
+
+int AABBTree::Insert(const AABB & box, void * userData)
+{
+	int leaf = AllocateNode();
+	nodes[leaf].box = box;
+	nodes[leaf].box.Inflate(margin);
+	nodes[leaf].userData = userData;
+	InsertLeaf(leaf);
+	proxyCount++;
+	return leaf;
+}
+
+void AABBTree::Remove(int proxyID)
+{
+	if (proxyID < 0 || proxyID >= (int)nodes.size() || nodes[proxyID].height != 0)
+		return;
+	RemoveLeaf(proxyID);
+	FreeNode(proxyID);
+	proxyCount--;
+}
+
+bool AABBTree::Move(int proxyID, const AABB & box)
+{
+	//Only leaves are proxies, internal nodes and free nodes are rejected
+	if (proxyID < 0 || proxyID >= (int)nodes.size() || nodes[proxyID].height != 0)
+		return false;
+	if (nodes[proxyID].box.Contains(box))
+		return false;
+	RemoveLeaf(proxyID);
+	nodes[proxyID].box = box;
+	nodes[proxyID].box.Inflate(margin);
+	InsertLeaf(proxyID);
+	return true;
+}
+
+void AABBTree::Clear()
+{
+	nodes.clear();
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	proxyCount = 0;
+}
+
+void * AABBTree::GetUserData(int proxyID) const
+{
+	return nodes[proxyID].userData;
+}
+
+const AABB & AABBTree::GetFatAABB(int proxyID) const
+{
+	return nodes[proxyID].box;
+}
+
+int AABBTree::GetHeight() const
+{
+	return root == NULL_NODE ? 0 : nodes[root].height;
+}
+
+size_t AABBTree::GetProxyCount() const
+{
+	return proxyCount;
+}
+
+int AABBTree::FindBestSibling(const AABB & box) const
+{
+	//Greedy descent on surface area cost: stop where pairing with the current node
+	//is cheaper than pushing the box further down either child
+	int index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const Node &node = nodes[index];
+		float area = node.box.SurfaceArea();
+		float combinedArea = AABB::Union(node.box, box).SurfaceArea();
+		float cost = 2.0f * combinedArea;
+		float inheritance = 2.0f * (combinedArea - area);
+
+		float childCost[2];
+		int child[2] = { node.left, node.right };
+		for (int i = 0; i < 2; i++)
+		{
+			const Node &c = nodes[child[i]];
+			float unionArea = AABB::Union(c.box, box).SurfaceArea();
+			childCost[i] = (c.IsLeaf() ? unionArea : unionArea - c.box.SurfaceArea()) + inheritance;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+		index = childCost[0] < childCost[1] ? child[0] : child[1];
+	}
+	return index;
+}
+
+void AABBTree::InsertLeaf(int leaf)
+{
+	if (root == NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	int sibling = FindBestSibling(nodes[leaf].box);
+
+	int oldParent = nodes[sibling].parent;
+	int newParent = AllocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].left = sibling;
+	nodes[newParent].right = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].left == sibling)
+	{
+		nodes[oldParent].left = newParent;
+	}
+	else
+	{
+		nodes[oldParent].right = newParent;
+	}
+
+	for (int index = newParent; index != NULL_NODE; index = nodes[index].parent)
+	{
+		Refit(index);
+		Rotate(index);
+	}
+}
+
+void AABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+	if (grandParent == NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+	}
+	else
+	{
+		if (nodes[grandParent].left == parent)
+			nodes[grandParent].left = sibling;
+		else
+			nodes[grandParent].right = sibling;
+		nodes[sibling].parent = grandParent;
+	}
+	FreeNode(parent);
+
+	for (int index = grandParent; index != NULL_NODE; index = nodes[index].parent)
+	{
+		Refit(index);
+		Rotate(index);
+	}
+}
+
+void AABBTree::Refit(int node)
+{
+	Node &n = nodes[node];
+	if (n.IsLeaf()) return;
+	n.box = AABB::Union(nodes[n.left].box, nodes[n.right].box);
+	n.height = 1 + max(nodes[n.left].height, nodes[n.right].height);
+}
+
+void AABBTree::Rotate(int a)
+{
+	//Try swapping a child of A with a grandchild on the other side, keep the
+	//swap that shrinks the surface area of the affected internal node the most
+	if (nodes[a].IsLeaf()) return;
+	int b = nodes[a].left;
+	int c = nodes[a].right;
+
+	float bestGain = 0;
+	int swapChild = NULL_NODE, swapGrandChild = NULL_NODE;
+
+	if (!nodes[c].IsLeaf())
+	{
+		int f = nodes[c].left, g = nodes[c].right;
+		float area = nodes[c].box.SurfaceArea();
+		float gain = area - AABB::Union(nodes[b].box, nodes[g].box).SurfaceArea();
+		if (gain > bestGain) { bestGain = gain; swapChild = b; swapGrandChild = f; }
+		gain = area - AABB::Union(nodes[f].box, nodes[b].box).SurfaceArea();
+		if (gain > bestGain) { bestGain = gain; swapChild = b; swapGrandChild = g; }
+	}
+	if (!nodes[b].IsLeaf())
+	{
+		int d = nodes[b].left, e = nodes[b].right;
+		float area = nodes[b].box.SurfaceArea();
+		float gain = area - AABB::Union(nodes[c].box, nodes[e].box).SurfaceArea();
+		if (gain > bestGain) { bestGain = gain; swapChild = c; swapGrandChild = d; }
+		gain = area - AABB::Union(nodes[d].box, nodes[c].box).SurfaceArea();
+		if (gain > bestGain) { bestGain = gain; swapChild = c; swapGrandChild = e; }
+	}
+	if (swapChild == NULL_NODE) return;
+
+	int other = nodes[swapGrandChild].parent;
+	if (nodes[a].left == swapChild) nodes[a].left = swapGrandChild;
+	else nodes[a].right = swapGrandChild;
+	if (nodes[other].left == swapGrandChild) nodes[other].left = swapChild;
+	else nodes[other].right = swapChild;
+	nodes[swapGrandChild].parent = a;
+	nodes[swapChild].parent = other;
+
+	Refit(other);
+	Refit(a);
+}
+
+void AABBTree::CollectLeaves(int node, vector<void*>& outUserData) const
+{
+	//Shares the query's stack, entries below base belong to the query
+	vector<int> &stack = traversalStack;
+	size_t base = stack.size();
+	stack.push_back(node);
+	while (stack.size() > base)
+	{
+		int index = stack.back();
+		stack.pop_back();
+		lastQueryVisits++;
+		const Node &n = nodes[index];
+		if (n.IsLeaf())
+		{
+			outUserData.push_back(n.userData);
+			continue;
+		}
+		stack.push_back(n.left);
+		stack.push_back(n.right);
+	}
+}
+
+void AABBTree::QueryFrustum(const Frustum & frustum, vector<void*>& outUserData) const
+{
+	lastQueryVisits = 0;
+	if (root == NULL_NODE) return;
+	vector<int> &stack = traversalStack;
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		lastQueryVisits++;
+		const Node &n = nodes[index];
+		FrustumTest test = frustum.Test(n.box);
+		if (test == Frustum_Outside)
+			continue;
+		if (n.IsLeaf())
+		{
+			outUserData.push_back(n.userData);
+		}
+		else if (test == Frustum_Inside)
+		{
+			//Whole subtree is visible, no more plane tests needed
+			CollectLeaves(n.left, outUserData);
+			CollectLeaves(n.right, outUserData);
+		}
+		else
+		{
+			stack.push_back(n.left);
+			stack.push_back(n.right);
+		}
+	}
+}
+
+void AABBTree::QueryBox(const AABB & box, vector<void*>& outUserData) const
+{
+	lastQueryVisits = 0;
+	if (root == NULL_NODE) return;
+	vector<int> &stack = traversalStack;
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		lastQueryVisits++;
+		const Node &n = nodes[index];
+		if (!n.box.Overlaps(box))
+			continue;
+		if (n.IsLeaf())
+		{
+			outUserData.push_back(n.userData);
+			continue;
+		}
+		stack.push_back(n.left);
+		stack.push_back(n.right);
+	}
+}
+
+void AABBTree::QuerySphere(const BoundingSphere & sphere, vector<void*>& outUserData) const
+{
+	lastQueryVisits = 0;
+	if (root == NULL_NODE) return;
+	vector<int> &stack = traversalStack;
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty())
+	{
+		int index = stack.back();
+		stack.pop_back();
+		lastQueryVisits++;
+		const Node &n = nodes[index];
+		if (!sphere.Overlaps(n.box))
+			continue;
+		if (n.IsLeaf())
+		{
+			outUserData.push_back(n.userData);
+			continue;
+		}
+		stack.push_back(n.left);
+		stack.push_back(n.right);
+	}
+}
+
+void * AABBTree::RayCast(const Ray & ray, float maxDistance, float * outDistance, RayLeafTest leafTest, void* context) const
+{
+	lastQueryVisits = 0;
+	void* result = NULL;
+	float best = maxDistance;
+	float t;
+	if (root == NULL_NODE || !ray.Intersects(nodes[root].box, best, t))
+		return NULL;
+
+	vector<pair<float, int>> stack;
+	stack.push_back(make_pair(t, root));
+	while (!stack.empty())
+	{
+		pair<float, int> entry = stack.back();
+		stack.pop_back();
+		if (entry.first > best)
+			continue;
+		lastQueryVisits++;
+		const Node &n = nodes[entry.second];
+		if (n.IsLeaf())
+		{
+			float leafDistance = entry.first;
+			if (leafTest && !leafTest(context, n.userData, ray, best, leafDistance))
+				continue;
+			if (leafDistance <= best)
+			{
+				best = leafDistance;
+				result = n.userData;
+			}
+			continue;
+		}
+		//Push the far child first so the near one is visited next
+		float tl, tr;
+		bool hitL = ray.Intersects(nodes[n.left].box, best, tl);
+		bool hitR = ray.Intersects(nodes[n.right].box, best, tr);
+		if (hitL && hitR)
+		{
+			if (tl < tr)
+			{
+				stack.push_back(make_pair(tr, n.right));
+				stack.push_back(make_pair(tl, n.left));
+			}
+			else
+			{
+				stack.push_back(make_pair(tl, n.left));
+				stack.push_back(make_pair(tr, n.right));
+			}
+		}
+		else if (hitL) stack.push_back(make_pair(tl, n.left));
+		else if (hitR) stack.push_back(make_pair(tr, n.right));
+	}
+	if (result && outDistance)
+		*outDistance = best;
+	return result;
+}
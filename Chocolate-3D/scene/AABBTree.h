@@ -0,0 +1,71 @@
+//-------------------------------Dynamic AABB Tree----------------------------------
+//Incremental bounding volume hierarchy over scene objects.
+//Leaves store fat AABBs so small movements do not touch the tree; inserts choose
+//the sibling with the lowest surface area cost and refits apply SAH-guided rotations.
+//---------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "BoundingVolume.h"
+using namespace std;
+
+//Optional exact test for leaves hit by a ray, returns the refined distance
+typedef bool(*RayLeafTest)(void* context, void* userData, const Ray &ray, float maxDistance, float &outDistance);
+
+class AABBTree
+{
+public:
+	static const int NULL_NODE = -1;
+
+	//Extra space around leaf boxes, in world units
+	float margin;
+	//Nodes touched by the last query, for profiling
+	mutable size_t lastQueryVisits;
+
+	AABBTree();
+
+	int Insert(const AABB &box, void* userData);
+	void Remove(int proxyID);
+	//Returns true if the leaf was re-inserted (box left its fat AABB)
+	bool Move(int proxyID, const AABB &box);
+	void Clear();
+
+	void* GetUserData(int proxyID) const;
+	const AABB& GetFatAABB(int proxyID) const;
+	int GetHeight() const;
+	size_t GetProxyCount() const;
+
+	void QueryFrustum(const Frustum &frustum, vector<void*> &outUserData) const;
+	void QueryBox(const AABB &box, vector<void*> &outUserData) const;
+	void QuerySphere(const BoundingSphere &sphere, vector<void*> &outUserData) const;
+	//Closest leaf hit by the ray within maxDistance, NULL if none
+	void* RayCast(const Ray &ray, float maxDistance, float* outDistance = NULL, RayLeafTest leafTest = NULL, void* context = NULL) const;
+
+private:
+	struct Node
+	{
+		AABB box;
+		void* userData;
+		int parent; //Also next free node while in the free list
+		int left;
+		int right;
+		int height; //Leaf = 0, free = -1
+		bool IsLeaf() const { return left == NULL_NODE; }
+	};
+
+	vector<Node> nodes;
+	//Node stack of the queries, kept so a query doesn't allocate. Queries on one tree can't run concurrently
+	mutable vector<int> traversalStack;
+	int root;
+	int freeList;
+	size_t proxyCount;
+
+	int AllocateNode();
+	void FreeNode(int node);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int FindBestSibling(const AABB &box) const;
+	void Refit(int node);
+	void Rotate(int node);
+	void CollectLeaves(int node, vector<void*> &outUserData) const;
+};
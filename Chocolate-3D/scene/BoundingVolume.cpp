@@ -0,0 +1,220 @@
+#include "BoundingVolume.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+using namespace std;
+
+AABB::AABB()
+{
+	min = aiVector3D(FLT_MAX, FLT_MAX, FLT_MAX);
+	max = aiVector3D(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+}
+
+AABB::AABB(const aiVector3D & min, const aiVector3D & max)
+{
+	this->min = min;
+	this->max = max;
+}
+
+AABB AABB::Empty()
+{
+	return AABB();
+}
+
+bool AABB::IsEmpty() const
+{
+	return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+aiVector3D AABB::Center() const
+{
+	return (min + max) * 0.5f;
+}
+
+aiVector3D AABB::Extent() const
+{
+	return (max - min) * 0.5f;
+}
+
+float AABB::SurfaceArea() const
+{
+	if (IsEmpty()) return 0;
+	aiVector3D d = max - min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+void AABB::Expand(const aiVector3D & point)
+{
+	min.x = std::min(min.x, point.x);
+	min.y = std::min(min.y, point.y);
+	min.z = std::min(min.z, point.z);
+	max.x = std::max(max.x, point.x);
+	max.y = std::max(max.y, point.y);
+	max.z = std::max(max.z, point.z);
+}
+
+void AABB::Expand(const AABB & other)
+{
+	if (other.IsEmpty()) return;
+	Expand(other.min);
+	Expand(other.max);
+}
+
+void AABB::Inflate(float margin)
+{
+	aiVector3D m(margin, margin, margin);
+	min -= m;
+	max += m;
+}
+
+bool AABB::Contains(const AABB & other) const
+{
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+		max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+bool AABB::Overlaps(const AABB & other) const
+{
+	return min.x <= other.max.x && max.x >= other.min.x &&
+		min.y <= other.max.y && max.y >= other.min.y &&
+		min.z <= other.max.z && max.z >= other.min.z;
+}
+
+AABB AABB::Union(const AABB & a, const AABB & b)
+{
+	AABB result = a;
+	result.Expand(b);
+	return result;
+}
+
+AABB AABB::Transform(const AABB & box, const aiMatrix4x4 & m)
+{
+	if (box.IsEmpty()) return box;
+	//Column vector matrix: translation in a4, b4, c4
+	const float row[3][3] = {
+		{ m.a1, m.a2, m.a3 },
+		{ m.b1, m.b2, m.b3 },
+		{ m.c1, m.c2, m.c3 } };
+	const float srcMin[3] = { box.min.x, box.min.y, box.min.z };
+	const float srcMax[3] = { box.max.x, box.max.y, box.max.z };
+	float dstMin[3] = { m.a4, m.b4, m.c4 };
+	float dstMax[3] = { m.a4, m.b4, m.c4 };
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			float e = row[i][j] * srcMin[j];
+			float f = row[i][j] * srcMax[j];
+			dstMin[i] += std::min(e, f);
+			dstMax[i] += std::max(e, f);
+		}
+	}
+	return AABB(aiVector3D(dstMin[0], dstMin[1], dstMin[2]), aiVector3D(dstMax[0], dstMax[1], dstMax[2]));
+}
+
+BoundingSphere::BoundingSphere()
+{
+	center = aiVector3D(0, 0, 0);
+	radius = 0;
+}
+
+BoundingSphere::BoundingSphere(const aiVector3D & center, float radius)
+{
+	this->center = center;
+	this->radius = radius;
+}
+
+bool BoundingSphere::Overlaps(const AABB & box) const
+{
+	//Distance from the center to the closest point in the box
+	float dx = std::max(std::max(box.min.x - center.x, 0.0f), center.x - box.max.x);
+	float dy = std::max(std::max(box.min.y - center.y, 0.0f), center.y - box.max.y);
+	float dz = std::max(std::max(box.min.z - center.z, 0.0f), center.z - box.max.z);
+	return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+Ray::Ray(const aiVector3D & origin, const aiVector3D & direction)
+{
+	this->origin = origin;
+	this->direction = direction;
+	invDirection.x = direction.x != 0 ? 1.0f / direction.x : FLT_MAX;
+	invDirection.y = direction.y != 0 ? 1.0f / direction.y : FLT_MAX;
+	invDirection.z = direction.z != 0 ? 1.0f / direction.z : FLT_MAX;
+}
+
+bool Ray::Intersects(const AABB & box, float tMax, float & tNear) const
+{
+	float t1 = (box.min.x - origin.x) * invDirection.x;
+	float t2 = (box.max.x - origin.x) * invDirection.x;
+	float tmin = std::min(t1, t2), tmax = std::max(t1, t2);
+
+	t1 = (box.min.y - origin.y) * invDirection.y;
+	t2 = (box.max.y - origin.y) * invDirection.y;
+	tmin = std::max(tmin, std::min(t1, t2));
+	tmax = std::min(tmax, std::max(t1, t2));
+
+	t1 = (box.min.z - origin.z) * invDirection.z;
+	t2 = (box.max.z - origin.z) * invDirection.z;
+	tmin = std::max(tmin, std::min(t1, t2));
+	tmax = std::min(tmax, std::max(t1, t2));
+
+	if (tmax < std::max(tmin, 0.0f) || tmin > tMax)
+		return false;
+	tNear = std::max(tmin, 0.0f);
+	return true;
+}
+
+Plane::Plane()
+{
+	normal = aiVector3D(0, 0, 0);
+	d = 0;
+}
+
+Plane::Plane(float a, float b, float c, float d)
+{
+	float length = sqrtf(a * a + b * b + c * c);
+	if (length < 1e-12f) length = 1;
+	normal = aiVector3D(a / length, b / length, c / length);
+	this->d = d / length;
+}
+
+float Plane::Distance(const aiVector3D & point) const
+{
+	return normal * point + d;
+}
+
+Frustum::Frustum()
+{
+}
+
+Frustum::Frustum(const aiMatrix4x4 & m)
+{
+	//Gribb-Hartmann: clip = M * v, inside when -w <= x,y <= w and 0 <= z <= w
+	planes[0] = Plane(m.d1 + m.a1, m.d2 + m.a2, m.d3 + m.a3, m.d4 + m.a4);
+	planes[1] = Plane(m.d1 - m.a1, m.d2 - m.a2, m.d3 - m.a3, m.d4 - m.a4);
+	planes[2] = Plane(m.d1 + m.b1, m.d2 + m.b2, m.d3 + m.b3, m.d4 + m.b4);
+	planes[3] = Plane(m.d1 - m.b1, m.d2 - m.b2, m.d3 - m.b3, m.d4 - m.b4);
+	planes[4] = Plane(m.c1, m.c2, m.c3, m.c4);
+	planes[5] = Plane(m.d1 - m.c1, m.d2 - m.c2, m.d3 - m.c3, m.d4 - m.c4);
+}
+
+FrustumTest Frustum::Test(const AABB & box) const
+{
+	aiVector3D center = box.Center();
+	aiVector3D extent = box.Extent();
+	FrustumTest result = Frustum_Inside;
+	for (int i = 0; i < 6; i++)
+	{
+		const Plane &p = planes[i];
+		float r = extent.x * fabsf(p.normal.x) + extent.y * fabsf(p.normal.y) + extent.z * fabsf(p.normal.z);
+		float s = p.Distance(center);
+		if (s < -r) return Frustum_Outside;
+		if (s < r) result = Frustum_Intersect;
+	}
+	return result;
+}
+
+bool Frustum::Overlaps(const AABB & box) const
+{
+	return Test(box) != Frustum_Outside;
+}
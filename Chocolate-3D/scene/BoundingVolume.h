@@ -0,0 +1,87 @@
+//-------------------------------Bounding Volumes----------------------------------
+//AABB, sphere, ray and view frustum used by scene queries and culling
+//Matrices follow the engine convention: column vectors, aiMatrix4x4 row-major storage
+//---------------------------------------------------------------------------------
+
+#pragma once
+#include <assimp/types.h>
+
+class AABB
+{
+public:
+	aiVector3D min;
+	aiVector3D max;
+
+	AABB();
+	AABB(const aiVector3D &min, const aiVector3D &max);
+
+	static AABB Empty();
+	bool IsEmpty() const;
+	aiVector3D Center() const;
+	aiVector3D Extent() const; //Half size
+	float SurfaceArea() const;
+
+	void Expand(const aiVector3D &point);
+	void Expand(const AABB &other);
+	void Inflate(float margin);
+
+	bool Contains(const AABB &other) const;
+	bool Overlaps(const AABB &other) const;
+
+	static AABB Union(const AABB &a, const AABB &b);
+	//Transform all 8 corners (Arvo), result is the AABB of the transformed box
+	static AABB Transform(const AABB &box, const aiMatrix4x4 &matrix);
+};
+
+class BoundingSphere
+{
+public:
+	aiVector3D center;
+	float radius;
+
+	BoundingSphere();
+	BoundingSphere(const aiVector3D &center, float radius);
+	bool Overlaps(const AABB &box) const;
+};
+
+class Ray
+{
+public:
+	aiVector3D origin;
+	aiVector3D direction;
+	aiVector3D invDirection;
+
+	Ray(const aiVector3D &origin, const aiVector3D &direction);
+	//Slab test, returns entry distance in tNear if the box is hit within [0, tMax]
+	bool Intersects(const AABB &box, float tMax, float &tNear) const;
+};
+
+//Plane: dot(normal, p) + d >= 0 is the inner side
+class Plane
+{
+public:
+	aiVector3D normal;
+	float d;
+	Plane();
+	Plane(float a, float b, float c, float d);
+	float Distance(const aiVector3D &point) const;
+};
+
+enum FrustumTest
+{
+	Frustum_Outside,
+	Frustum_Intersect,
+	Frustum_Inside
+};
+
+class Frustum
+{
+public:
+	Plane planes[6]; //Left, Right, Bottom, Top, Near, Far
+
+	Frustum();
+	//Extract planes from a projection*view matrix (D3D clip space, z in [0, 1])
+	explicit Frustum(const aiMatrix4x4 &viewProjection);
+	FrustumTest Test(const AABB &box) const;
+	bool Overlaps(const AABB &box) const;
+};
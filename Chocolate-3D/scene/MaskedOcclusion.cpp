@@ -0,0 +1,324 @@
+#include "MaskedOcclusion.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <emmintrin.h>
+using namespace std;
+
+static const float nearW = 1e-5f;
+
+MaskedOcclusion::MaskedOcclusion()
+{
+	backfaceCulling = true;
+	width = height = 0;
+	tilesX = tilesY = 0;
+}
+
+void MaskedOcclusion::SetResolution(unsigned int width, unsigned int height)
+{
+	tilesX = (width + tileWidth - 1) / tileWidth;
+	tilesY = (height + tileHeight - 1) / tileHeight;
+	this->width = tilesX * tileWidth;
+	this->height = tilesY * tileHeight;
+	tiles.resize(tilesX * tilesY);
+	Clear();
+}
+
+unsigned int MaskedOcclusion::GetWidth() const
+{
+	return width;
+}
+
+unsigned int MaskedOcclusion::GetHeight() const
+{
+	return height;
+}
+
+unsigned int MaskedOcclusion::GetTileRowCount() const
+{
+	return tilesY;
+}
+
+void MaskedOcclusion::Clear()
+{
+	for (Tile &tile : tiles)
+	{
+		for (unsigned int r = 0; r < tileHeight; r++)
+		{
+			tile.mask[r] = 0;
+		}
+		tile.zMax0 = 1;
+		tile.zMax1 = 0;
+	}
+	triangles.clear();
+}
+
+void MaskedOcclusion::AddOccluder(const aiVector3D * positions, const unsigned int * indices, unsigned int numIndices, const aiMatrix4x4 & m)
+{
+	if (!width || !height)
+		return;
+
+	//Only transform the vertices the index list reaches
+	unsigned int numVertices = 0;
+	for (unsigned int i = 0; i < numIndices; i++)
+	{
+		numVertices = max(numVertices, indices[i] + 1);
+	}
+	clipVertices.resize(numVertices * 4);
+	for (unsigned int i = 0; i < numVertices; i++)
+	{
+		const aiVector3D &p = positions[i];
+		float* c = &clipVertices[i * 4];
+		c[0] = m.a1 * p.x + m.a2 * p.y + m.a3 * p.z + m.a4;
+		c[1] = m.b1 * p.x + m.b2 * p.y + m.b3 * p.z + m.b4;
+		c[2] = m.c1 * p.x + m.c2 * p.y + m.c3 * p.z + m.c4;
+		c[3] = m.d1 * p.x + m.d2 * p.y + m.d3 * p.z + m.d4;
+	}
+
+	for (unsigned int i = 0; i + 2 < numIndices; i += 3)
+	{
+		float x[3], y[3], z[3];
+		bool clipped = false;
+		for (int v = 0; v < 3; v++)
+		{
+			const float* c = &clipVertices[indices[i + v] * 4];
+			if (c[3] < nearW || c[2] < 0)
+			{
+				clipped = true;
+				break;
+			}
+			float invW = 1 / c[3];
+			x[v] = (c[0] * invW * 0.5f + 0.5f) * width;
+			y[v] = (0.5f - c[1] * invW * 0.5f) * height;
+			z[v] = c[2] * invW;
+		}
+		if (clipped)
+			continue;
+
+		//Positive for clockwise triangles, y points down on screen
+		float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0 || (backfaceCulling && area < 0))
+			continue;
+
+		Triangle tri;
+		tri.minX = max(min(min(x[0], x[1]), x[2]), 0.0f);
+		tri.maxX = min(max(max(x[0], x[1]), x[2]), (float)width);
+		tri.minY = max(min(min(y[0], y[1]), y[2]), 0.0f);
+		tri.maxY = min(max(max(y[0], y[1]), y[2]), (float)height);
+		if (tri.minX >= tri.maxX || tri.minY >= tri.maxY)
+			continue;
+		tri.zMax = min(max(max(z[0], z[1]), z[2]), 1.0f);
+
+		float invArea = 1 / area;
+		tri.zA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+		tri.zB = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+		tri.zC = z[0] - tri.zA * x[0] - tri.zB * y[0];
+
+		//Edge function e(p) = a * p.x + b * p.y + c is >= 0 inside
+		float sign = area > 0 ? 1.0f : -1.0f;
+		for (int e = 0; e < 3; e++)
+		{
+			int n = (e + 1) % 3;
+			float a = -(y[n] - y[e]) * sign;
+			float b = (x[n] - x[e]) * sign;
+			float c = -(a * x[e] + b * y[e]);
+			if (a == 0)
+			{
+				tri.side[e] = 0;
+				tri.slope[e] = 0;
+				tri.offset[e] = 0;
+				continue;
+			}
+			tri.side[e] = a > 0 ? 1 : -1;
+			tri.slope[e] = -b / a;
+			tri.offset[e] = -c / a;
+		}
+		triangles.push_back(tri);
+	}
+}
+
+size_t MaskedOcclusion::GetTriangleCount() const
+{
+	return triangles.size();
+}
+
+void MaskedOcclusion::Rasterize(unsigned int tileRowBegin, unsigned int tileRowEnd)
+{
+	tileRowEnd = min(tileRowEnd, tilesY);
+	float bandTop = (float)(tileRowBegin * tileHeight);
+	float bandBottom = (float)(tileRowEnd * tileHeight);
+	for (const Triangle &tri : triangles)
+	{
+		if (tri.maxY <= bandTop || tri.minY >= bandBottom)
+			continue;
+		unsigned int firstRow = max(tileRowBegin, (unsigned int)tri.minY / tileHeight);
+		unsigned int lastRow = min(tileRowEnd - 1, (unsigned int)tri.maxY / tileHeight);
+		unsigned int firstColumn = (unsigned int)tri.minX / tileWidth;
+		unsigned int lastColumn = min(tilesX - 1, (unsigned int)tri.maxX / tileWidth);
+		for (unsigned int ty = firstRow; ty <= lastRow; ty++)
+		{
+			for (unsigned int tx = firstColumn; tx <= lastColumn; tx++)
+			{
+				RasterizeTile(tri, tx, ty);
+			}
+		}
+	}
+}
+
+void MaskedOcclusion::RasterizeTile(const Triangle & tri, unsigned int tileX, unsigned int tileY)
+{
+	float x0 = (float)(tileX * tileWidth);
+	float y0 = (float)(tileY * tileHeight);
+
+	//x span of the triangle on the 4 pixel center rows of the tile
+	__m128 rowY = _mm_add_ps(_mm_set1_ps(y0 + 0.5f), _mm_setr_ps(0, 1, 2, 3));
+	__m128 left = _mm_set1_ps(x0 - 1);
+	__m128 right = _mm_set1_ps(x0 + tileWidth + 1);
+	for (int e = 0; e < 3; e++)
+	{
+		if (tri.side[e] == 0)
+			continue;
+		__m128 bound = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.slope[e]), rowY), _mm_set1_ps(tri.offset[e]));
+		if (tri.side[e] > 0)
+			left = _mm_max_ps(left, bound);
+		else
+			right = _mm_min_ps(right, bound);
+	}
+
+	//Pixel i is covered when its center x0 + i + 0.5 lies in [left, right]
+	__m128 center = _mm_set1_ps(x0 + 0.5f);
+	__m128 lowLimit = _mm_set1_ps(-1);
+	__m128 highLimit = _mm_set1_ps((float)tileWidth + 1);
+	__m128 l = _mm_min_ps(_mm_max_ps(_mm_sub_ps(left, center), lowLimit), highLimit);
+	__m128 r = _mm_min_ps(_mm_max_ps(_mm_sub_ps(right, center), lowLimit), highLimit);
+	//Both are in [-1, 33]: offset to positive values so truncation floors
+	__m128 offset = _mm_set1_ps(34);
+	__m128i first = _mm_sub_epi32(_mm_set1_epi32(34), _mm_cvttps_epi32(_mm_sub_ps(offset, l))); //ceil(l)
+	__m128i last = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(r, offset)), _mm_set1_epi32(34)); //floor(r)
+	int firstPixel[4], lastPixel[4];
+	_mm_storeu_si128((__m128i*)firstPixel, first);
+	_mm_storeu_si128((__m128i*)lastPixel, last);
+
+	unsigned int coverage[tileHeight];
+	bool any = false;
+	for (unsigned int row = 0; row < tileHeight; row++)
+	{
+		float y = y0 + row + 0.5f;
+		int lo = max(firstPixel[row], 0);
+		int hi = min(lastPixel[row], (int)tileWidth - 1);
+		if (y < tri.minY || y > tri.maxY || lo > hi)
+		{
+			coverage[row] = 0;
+			continue;
+		}
+		unsigned int upper = hi == (int)tileWidth - 1 ? 0xffffffff : (1u << (hi + 1)) - 1;
+		coverage[row] = upper & ~((1u << lo) - 1);
+		any = true;
+	}
+	if (!any)
+		return;
+
+	//Farthest depth of the triangle in this tile: plane maximum over the tile corners, capped by the vertices
+	float zx = tri.zA > 0 ? x0 + tileWidth - 0.5f : x0 + 0.5f;
+	float zy = tri.zB > 0 ? y0 + tileHeight - 0.5f : y0 + 0.5f;
+	float z = min(tri.zA * zx + tri.zB * zy + tri.zC, tri.zMax);
+	UpdateTile(tiles[tileY * tilesX + tileX], coverage, max(z, 0.0f));
+}
+
+void MaskedOcclusion::UpdateTile(Tile & tile, const unsigned int coverage[tileHeight], float z)
+{
+	//Behind what the tile already holds
+	if (z >= tile.zMax0)
+		return;
+
+	bool empty = true;
+	for (unsigned int r = 0; r < tileHeight; r++)
+	{
+		empty &= tile.mask[r] == 0;
+	}
+	//A working layer far from the new triangle would only get looser, start a new one
+	if (!empty && fabsf(z - tile.zMax1) > tile.zMax0 - tile.zMax1)
+		empty = true;
+
+	tile.zMax1 = empty ? z : max(tile.zMax1, z);
+	bool full = true;
+	for (unsigned int r = 0; r < tileHeight; r++)
+	{
+		tile.mask[r] = (empty ? 0 : tile.mask[r]) | coverage[r];
+		full &= tile.mask[r] == 0xffffffff;
+	}
+	if (full)
+	{
+		tile.zMax0 = min(tile.zMax0, tile.zMax1);
+		tile.zMax1 = 0;
+		for (unsigned int r = 0; r < tileHeight; r++)
+		{
+			tile.mask[r] = 0;
+		}
+	}
+}
+
+bool MaskedOcclusion::IsVisible(const AABB & box, const aiMatrix4x4 & m) const
+{
+	if (box.IsEmpty() || !width || !height)
+		return true;
+
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	float minZ = FLT_MAX;
+	for (int i = 0; i < 8; i++)
+	{
+		aiVector3D p(i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z);
+		float w = m.d1 * p.x + m.d2 * p.y + m.d3 * p.z + m.d4;
+		if (w < nearW)
+			return true;
+		float invW = 1 / w;
+		float x = ((m.a1 * p.x + m.a2 * p.y + m.a3 * p.z + m.a4) * invW * 0.5f + 0.5f) * width;
+		float y = (0.5f - (m.b1 * p.x + m.b2 * p.y + m.b3 * p.z + m.b4) * invW * 0.5f) * height;
+		float z = (m.c1 * p.x + m.c2 * p.y + m.c3 * p.z + m.c4) * invW;
+		minX = min(minX, x);
+		maxX = max(maxX, x);
+		minY = min(minY, y);
+		maxY = max(maxY, y);
+		minZ = min(minZ, z);
+	}
+	if (minZ <= 0)
+		return true;
+
+	//Every pixel the rectangle touches, clamped to the screen
+	if (maxX <= 0 || maxY <= 0 || minX >= width || minY >= height)
+		return true;
+	int px0 = max((int)floorf(minX), 0);
+	int px1 = min((int)ceilf(maxX), (int)width) - 1;
+	int py0 = max((int)floorf(minY), 0);
+	int py1 = min((int)ceilf(maxY), (int)height) - 1;
+
+	for (int ty = py0 / (int)tileHeight; ty <= py1 / (int)tileHeight; ty++)
+	{
+		for (int tx = px0 / (int)tileWidth; tx <= px1 / (int)tileWidth; tx++)
+		{
+			const Tile &tile = tiles[ty * tilesX + tx];
+			//Pixels in the coverage mask are also bounded by the working layer
+			int lo = max(px0 - tx * (int)tileWidth, 0);
+			int hi = min(px1 - tx * (int)tileWidth, (int)tileWidth - 1);
+			unsigned int rowMask = (hi == (int)tileWidth - 1 ? 0xffffffff : (1u << (hi + 1)) - 1) & ~((1u << lo) - 1);
+			bool insideMask = true;
+			for (unsigned int r = 0; r < tileHeight; r++)
+			{
+				int y = ty * (int)tileHeight + r;
+				if (y >= py0 && y <= py1)
+					insideMask &= (rowMask & ~tile.mask[r]) == 0;
+			}
+			float depth = insideMask ? min(tile.zMax0, tile.zMax1) : tile.zMax0;
+			if (minZ <= depth)
+				return true;
+		}
+	}
+	return false;
+}
+
+float MaskedOcclusion::GetDepthBound(unsigned int x, unsigned int y) const
+{
+	if (x >= width || y >= height)
+		return 1;
+	return tiles[(y / tileHeight) * tilesX + x / tileWidth].zMax0;
+}
@@ -0,0 +1,78 @@
+//-------------------------------Masked Occlusion----------------------------------
+//Low resolution CPU depth buffer for occlusion culling.
+//Occluder triangles are rasterized into 32x4 pixel tiles. Each tile keeps two depth
+//layers instead of per pixel depth: zMax0 bounds the whole tile, zMax1 bounds the
+//pixels set in the coverage mask. When the mask fills up the working layer becomes
+//the tile bound. Depth is D3D clip z / w, 0 is near; all bounds are conservative so
+//a box is only rejected when it is behind the occluders everywhere it can appear.
+//Matrices follow the engine convention: column vectors, aiMatrix4x4 row-major storage
+//---------------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "BoundingVolume.h"
+using namespace std;
+
+class MaskedOcclusion
+{
+public:
+	static const unsigned int tileWidth = 32;
+	static const unsigned int tileHeight = 4;
+
+	//D3D default rasterizer state: clockwise on screen is front, back faces are not drawn
+	bool backfaceCulling;
+
+	MaskedOcclusion();
+
+	//Size is rounded up to whole tiles
+	void SetResolution(unsigned int width, unsigned int height);
+	unsigned int GetWidth() const;
+	unsigned int GetHeight() const;
+	unsigned int GetTileRowCount() const;
+
+	//Resets depth and drops all occluders
+	void Clear();
+	//Indexed triangle list, clip = worldViewProjection * position.
+	//Triangles crossing the near plane are dropped, which only loses occlusion.
+	void AddOccluder(const aiVector3D* positions, const unsigned int* indices, unsigned int numIndices, const aiMatrix4x4 &worldViewProjection);
+	size_t GetTriangleCount() const;
+
+	//Rasterize all occluders into tile rows [tileRowBegin, tileRowEnd).
+	//Disjoint ranges touch disjoint tiles and can run on different threads.
+	void Rasterize(unsigned int tileRowBegin, unsigned int tileRowEnd);
+
+	//False if the box is hidden behind the rasterized occluders.
+	//Boxes crossing the near plane or outside the screen count as visible, leave those to frustum culling.
+	//Read only, safe to call from several threads once Rasterize is done.
+	bool IsVisible(const AABB &box, const aiMatrix4x4 &viewProjection) const;
+	//Farthest depth the tile holding pixel (x, y) can have
+	float GetDepthBound(unsigned int x, unsigned int y) const;
+
+private:
+	struct Tile
+	{
+		unsigned int mask[tileHeight]; //Bit i of row r is pixel (tileX * tileWidth + i, tileY * tileHeight + r)
+		float zMax0;
+		float zMax1;
+	};
+
+	//Screen space triangle, edges are stored as x bounds of a row: x >= slope * y + offset for left edges, <= for right edges
+	struct Triangle
+	{
+		float minX, maxX, minY, maxY;
+		float zMax;
+		float zA, zB, zC; //Depth plane z = zA * x + zB * y + zC
+		float slope[3];
+		float offset[3];
+		int side[3]; //1 left, -1 right, 0 horizontal (covered by minY, maxY)
+	};
+
+	unsigned int width, height;
+	unsigned int tilesX, tilesY;
+	vector<Tile> tiles;
+	vector<Triangle> triangles;
+	vector<float> clipVertices; //Scratch for AddOccluder, 4 floats per vertex
+
+	void RasterizeTile(const Triangle &tri, unsigned int tileX, unsigned int tileY);
+	static void UpdateTile(Tile &tile, const unsigned int coverage[tileHeight], float z);
+};
@@ -0,0 +1,93 @@
+#include "ViewSet.h"
+#include <cfloat>
+#include <xmmintrin.h>
+
+ViewSet::ViewSet()
+{
+}
+
+void ViewSet::Clear()
+{
+	groups.clear();
+}
+
+unsigned int ViewSet::GetCount() const
+{
+	return (unsigned int)groups.size() / 2;
+}
+
+int ViewSet::AddPlanes(const Plane planes[6])
+{
+	if (GetCount() >= maxViews)
+		return -1;
+	PlaneGroup g[2];
+	for (int i = 0; i < 8; i++)
+	{
+		PlaneGroup &group = g[i / 4];
+		int lane = i % 4;
+		if (i < 6)
+		{
+			group.nx[lane] = planes[i].normal.x;
+			group.ny[lane] = planes[i].normal.y;
+			group.nz[lane] = planes[i].normal.z;
+			group.d[lane] = planes[i].d;
+		}
+		else
+		{
+			group.nx[lane] = group.ny[lane] = group.nz[lane] = 0;
+			group.d[lane] = FLT_MAX;
+		}
+	}
+	groups.push_back(g[0]);
+	groups.push_back(g[1]);
+	return (int)GetCount() - 1;
+}
+
+int ViewSet::AddFrustum(const aiMatrix4x4 & viewProjection)
+{
+	Frustum frustum(viewProjection);
+	return AddPlanes(frustum.planes);
+}
+
+int ViewSet::AddVolume(const AABB & volume)
+{
+	Plane planes[6] =
+	{
+		Plane(1, 0, 0, -volume.min.x),
+		Plane(-1, 0, 0, volume.max.x),
+		Plane(0, 1, 0, -volume.min.y),
+		Plane(0, -1, 0, volume.max.y),
+		Plane(0, 0, 1, -volume.min.z),
+		Plane(0, 0, -1, volume.max.z)
+	};
+	return AddPlanes(planes);
+}
+
+unsigned int ViewSet::Test(const AABB & box) const
+{
+	if (box.IsEmpty())
+		return 0;
+	aiVector3D center = box.Center();
+	aiVector3D extent = box.Extent();
+	__m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+	__m128 ex = _mm_set1_ps(extent.x), ey = _mm_set1_ps(extent.y), ez = _mm_set1_ps(extent.z);
+	__m128 signMask = _mm_set1_ps(-0.0f);
+
+	unsigned int mask = 0;
+	for (unsigned int v = 0; v < GetCount(); v++)
+	{
+		int outside = 0;
+		for (int g = 0; g < 2; g++)
+		{
+			const PlaneGroup &group = groups[v * 2 + g];
+			__m128 nx = _mm_loadu_ps(group.nx), ny = _mm_loadu_ps(group.ny), nz = _mm_loadu_ps(group.nz);
+			//Signed distance of the center and the box radius along each plane normal
+			__m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), _mm_loadu_ps(group.d)));
+			__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)), _mm_mul_ps(_mm_andnot_ps(signMask, nz), ez));
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(s, r), _mm_setzero_ps()));
+		}
+		if (!outside)
+			mask |= 1u << v;
+	}
+	return mask;
+}
@@ -0,0 +1,37 @@
+//-------------------------------View Set----------------------------------
+//Up to 32 views tested together: frustums and axis aligned volumes are both
+//stored as 6 planes, packed 4 per SSE register, so one bound is classified
+//against every view while it is in cache.
+//Matrices follow the engine convention: column vectors, aiMatrix4x4 row-major storage
+//-------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include "BoundingVolume.h"
+using namespace std;
+
+class ViewSet
+{
+public:
+	static const unsigned int maxViews = 32;
+
+	ViewSet();
+	void Clear();
+	//Return the view index, -1 when the set is full
+	int AddFrustum(const aiMatrix4x4 &viewProjection);
+	int AddVolume(const AABB &volume);
+	unsigned int GetCount() const;
+
+	//Bit v is set when the box overlaps view v, conservative like Frustum::Overlaps
+	unsigned int Test(const AABB &box) const;
+
+private:
+	//Planes of a view: two groups of 4, the last two lanes always pass
+	struct PlaneGroup
+	{
+		float nx[4], ny[4], nz[4], d[4];
+	};
+	vector<PlaneGroup> groups;
+
+	int AddPlanes(const Plane planes[6]);
+};
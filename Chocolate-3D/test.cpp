@@ -118,7 +118,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT umessage, WPARAM wparam, LPARAM lparam)
 	}
 }
 
-ModelInstance* testSP;
+InstanceHandle testSP;
 int flag = 0;
 float speed = 0.2;
 void CALLBACK Timer15ms(HWND hWnd, UINT nMsg, UINT_PTR nTimerid, DWORD dwTime)
@@ -178,7 +178,7 @@ void CALLBACK Timer15ms(HWND hWnd, UINT nMsg, UINT_PTR nTimerid, DWORD dwTime)
 		}
 		in->animationTime += 0.015;
 	}
-	testSP->animationTime += 0.015;
+	engine.instances.SetAnimationTime(testSP, engine.instances.GetAnimationTime(testSP) + 0.015);
 }
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline, int iCmdshow)
@@ -201,89 +201,89 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline,
 	//--------------------------------------------------------------------------------
 
 	engine.LoadPostMesh(workingFolder + "Models\\fullScreen.obj");
-	D3D11_TEXTURE2D_DESC a;
 
 	engine.camera.SetPosition(0, 0, -8);
 	engine.camera.FaceTo(aiVector3D(0, -0.2, 0.8));
 	auto test = engine.LoadAsset(workingFolder + "Models\\TestModel.fbx");
 	auto testi = engine.CreateInstance(test->defaultInstance);
-	testi->animationID = 1;
-	testi->animationTime = 0;
-	testi->transform.SetScaling(0.7);
-	testi->transform.SetPosition(0, 0, 3.5);
-	//testi->components[1].materialInstance.diffuseBlendFactor = 1;
+	engine.instances.SetAnimationID(testi, 1);
+	engine.instances.SetAnimationTime(testi, 0);
+	engine.instances.GetTransform(testi).SetScaling(0.7);
+	engine.instances.GetTransform(testi).SetPosition(0, 0, 3.5);
+	//engine.instances.GetComponents(testi)[1].materialInstance.diffuseBlendFactor = 1;
 	testSP = testi;
 
 	auto rect = engine.LoadAsset(workingFolder + "Models\\Rect.obj");
+	rect->defaultInstance.occluder = true;
 	auto back = engine.CreateInstance(rect->defaultInstance);
-	back->transform.verticalLock = false;
-	back->transform.SetScaling(9);
-	back->transform.SetPosition(0,0,4.5);
+	engine.instances.GetTransform(back).verticalLock = false;
+	engine.instances.GetTransform(back).SetScaling(9);
+	engine.instances.GetTransform(back).SetPosition(0,0,4.5);
 
 	auto down = engine.CreateInstance(rect->defaultInstance);
-	down->transform.verticalLock = false;
-	down->transform.SetScaling(9);
-	down->transform.SpinPitch(-90);
-	down->transform.SetPosition(0, -4.5, 0);
+	engine.instances.GetTransform(down).verticalLock = false;
+	engine.instances.GetTransform(down).SetScaling(9);
+	engine.instances.GetTransform(down).SpinPitch(-90);
+	engine.instances.GetTransform(down).SetPosition(0, -4.5, 0);
 
 	auto up = engine.CreateInstance(rect->defaultInstance);
-	up->transform.verticalLock = false;
-	up->transform.SetScaling(9);
-	up->transform.SpinPitch(90);
-	up->transform.SetPosition(0, 4.5, 0);
+	engine.instances.GetTransform(up).verticalLock = false;
+	engine.instances.GetTransform(up).SetScaling(9);
+	engine.instances.GetTransform(up).SpinPitch(90);
+	engine.instances.GetTransform(up).SetPosition(0, 4.5, 0);
 
 	auto right = engine.CreateInstance(rect->defaultInstance);
-	right->transform.verticalLock = false;
-	right->transform.SetScaling(9);
-	right->transform.SpinYaw(-90);
-	right->transform.SetPosition(4.5, 0, 0);
-	right->components[0].materialInstance.specularPower = 2;
-	right->components[0].materialInstance.specularBlendFactor = 1;
-	right->components[0].materialInstance.specularColor[0] = 1;
-	right->components[0].materialInstance.specularColor[1] = 1;
-	right->components[0].materialInstance.specularColor[2] = 1;
-	right->components[0].materialInstance.specularHardness = 30;
-	right->components[0].materialInstance.diffusePower = 0.2;
+	engine.instances.GetTransform(right).verticalLock = false;
+	engine.instances.GetTransform(right).SetScaling(9);
+	engine.instances.GetTransform(right).SpinYaw(-90);
+	engine.instances.GetTransform(right).SetPosition(4.5, 0, 0);
+	engine.instances.GetComponents(right)[0].materialInstance.specularPower = 2;
+	engine.instances.GetComponents(right)[0].materialInstance.specularBlendFactor = 1;
+	engine.instances.GetComponents(right)[0].materialInstance.specularColor[0] = 1;
+	engine.instances.GetComponents(right)[0].materialInstance.specularColor[1] = 1;
+	engine.instances.GetComponents(right)[0].materialInstance.specularColor[2] = 1;
+	engine.instances.GetComponents(right)[0].materialInstance.specularHardness = 30;
+	engine.instances.GetComponents(right)[0].materialInstance.diffusePower = 0.2;
 
 
 	auto left = engine.CreateInstance(rect->defaultInstance);
-	left->transform.verticalLock = false;
-	left->transform.SetScaling(9);
-	left->transform.SpinYaw(90);
-	left->transform.SetPosition(-4.5, 0, 0);
-	left->components[0].materialInstance.diffuseColor[0] = 0.8;
-	left->components[0].materialInstance.diffuseColor[1] = 0.2;
-	left->components[0].materialInstance.diffuseColor[2] = 0.2;
+	engine.instances.GetTransform(left).verticalLock = false;
+	engine.instances.GetTransform(left).SetScaling(9);
+	engine.instances.GetTransform(left).SpinYaw(90);
+	engine.instances.GetTransform(left).SetPosition(-4.5, 0, 0);
+	engine.instances.GetComponents(left)[0].materialInstance.diffuseColor[0] = 0.8;
+	engine.instances.GetComponents(left)[0].materialInstance.diffuseColor[1] = 0.2;
+	engine.instances.GetComponents(left)[0].materialInstance.diffuseColor[2] = 0.2;
 
 
 	auto dragon = engine.LoadAsset(workingFolder + "Models\\dragon.obj");
 	auto dragon1 = engine.CreateInstance(dragon->defaultInstance);
-	dragon1->transform.SetPosition(0, -4.5, -1);
-	dragon1->transform.SetScaling(0.3);
-	dragon1->components[0].materialInstance.diffusePower = 0.1;
-	dragon1->components[0].materialInstance.refractiveIndex = 1.5;
-	dragon1->components[0].materialInstance.opacity = 0.1;
-	dragon1->components[0].materialInstance.specularPower = 1.3;
-	dragon1->components[0].materialInstance.specularBlendFactor = 1;
-	dragon1->components[0].materialInstance.specularColor[0] = 1;
-	dragon1->components[0].materialInstance.specularColor[1] = 1;
-	dragon1->components[0].materialInstance.specularColor[2] = 1;
-	dragon1->components[0].materialInstance.specularHardness = 30;
+	engine.instances.GetTransform(dragon1).SetPosition(0, -4.5, -1);
+	engine.instances.GetTransform(dragon1).SetScaling(0.3);
+	engine.instances.GetComponents(dragon1)[0].materialInstance.diffusePower = 0.1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.refractiveIndex = 1.5;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.opacity = 0.1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularPower = 1.3;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularBlendFactor = 1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularColor[0] = 1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularColor[1] = 1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularColor[2] = 1;
+	engine.instances.GetComponents(dragon1)[0].materialInstance.specularHardness = 30;
 
 	auto post = engine.LoadAsset(workingFolder + "Models\\fullScreen.obj");
 
 	auto sphere = engine.LoadAsset(workingFolder + "Models\\sphere.obj");
 
 	auto s1 = engine.CreateInstance(sphere->defaultInstance);
-	s1->transform.SetScaling(0.4);
-	s1->transform.SetPosition(-3, 2, 3);
-	s1->components[0].materialInstance.diffusePower = 0.1;
-	s1->components[0].materialInstance.specularPower = 1.5;
-	s1->components[0].materialInstance.specularBlendFactor = 1;
-	s1->components[0].materialInstance.specularColor[0] = 1;
-	s1->components[0].materialInstance.specularColor[1] = 1;
-	s1->components[0].materialInstance.specularColor[2] = 1;
-	s1->components[0].materialInstance.specularHardness = 30;
+	engine.instances.GetTransform(s1).SetScaling(0.4);
+	engine.instances.GetTransform(s1).SetPosition(-3, 2, 3);
+	engine.instances.GetComponents(s1)[0].materialInstance.diffusePower = 0.1;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularPower = 1.5;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularBlendFactor = 1;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularColor[0] = 1;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularColor[1] = 1;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularColor[2] = 1;
+	engine.instances.GetComponents(s1)[0].materialInstance.specularHardness = 30;
 
 	Light x;
 	x.color[0] = 1.0f;
@@ -357,6 +357,6 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline,
 		//engine.Render("direct_light");
 		//engine.Render("depth");
 		PipeLine::Swap();
-		dragon1->transform.SpinYaw(2);
+		engine.instances.GetTransform(dragon1).SpinYaw(2);
 	}
 }
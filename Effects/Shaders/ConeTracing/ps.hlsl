@@ -115,6 +115,8 @@ float4 main(PSinput input) : SV_TARGET
 	{
 		normalMap = normalTexture.Sample(Sampler, input.tex);
 		normalMap = (normalMap - 0.5f)*2.0f;
+		//BC5 normal maps only store x and y
+		normalMap.z = sqrt(saturate(1.0f - dot(normalMap.xy, normalMap.xy)));
 		pixelNormal = (normalMap.x*input.tangent) + (normalMap.y*input.bitangent) + (normalMap.z*input.normal);
 		pixelNormal = normalize(pixelNormal);
 	}
@@ -17,3 +17,9 @@ cbuffer cbPerFrame : register(b1)
 	float2	g_PixelSize					: packoffset(c16);
 	float2	pad3								: packoffset(c16.z);
 };
+
+cbuffer cbPerDraw : register(b0)
+{
+	uint		g_InstanceBase				: packoffset(c0.x);
+	uint3	padDraw							: packoffset(c0.y);
+};
@@ -81,6 +81,8 @@ Pixel GetPixel(uniform PSinput input)
 	{
 		float4 normalMap = SampleTexture(TEXTURE_NORMAL, SAMPLER_WARP, input.tex);
 		normalMap = (normalMap - 0.5f)*2.0f;
+		//BC5 normal maps only store x and y
+		normalMap.z = sqrt(saturate(1.0f - dot(normalMap.xy, normalMap.xy)));
 		p.normal = (normalMap.x*input.tangent) + (normalMap.y*input.bitangent) + (normalMap.z*input.normal);
 		p.normal = normalize(p.normal);
 	}
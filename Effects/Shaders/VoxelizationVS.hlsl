@@ -15,6 +15,8 @@ StructuredBuffer<Light> Lights: register(t7);
 
 PSinput main(VSinput input)
 {
+	//Instances of this draw start at g_InstanceBase in the instance ring buffer
+	input.instanceID += g_InstanceBase;
 	PSinput output;
     // Change the position vector to be 4 units for proper matrix calculations.
 	float4 position = float4(input.position, 1.0f);